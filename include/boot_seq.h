@@ -0,0 +1,154 @@
+/**
+ * @file boot_seq.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Dependency-aware module start: init_fn / run_fn of independent modules in parallel
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * `MGR_Init()` and `MGR_Run()` hand their module lists to `bootseq_Run()`. A step
+ * (one module's init_fn or run_fn) starts as soon as every module in its
+ * `depends` mask has finished the same phase; independent steps run at the same
+ * time on `CONFIG_MGR_BOOT_WORKERS` short-lived tasks. With 0 workers the caller
+ * runs the steps one after another, in list order whenever the dependencies allow.
+ *
+ * Each step records when it became ready, started and finished, and what it
+ * waited for last: a dependency, or the step which freed its worker. Following
+ * that link back from the step which finished last gives the critical path.
+ *
+ * Besides the two phases, `bootseq_Mark()` stamps the first time the device got
+ * past each milestone of the start (NVS, link, IP, MQTT, ...). `bootseq_Report()`
+ * prints all of it as `[<section>][<name>] key=value ...` lines, the format read
+ * by scripts/parse_boot_log.py.
+ */
+
+#ifndef __BOOT_SEQ_H__
+#define __BOOT_SEQ_H__
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+
+/** Max number of steps (modules) in one phase. */
+#define BOOTSEQ_STEP_MAX        (16U)
+
+/** `bootseq_step_t.worker` of a step run by the calling task. */
+#define BOOTSEQ_CALLER          (0xFFU)
+
+typedef enum {
+  BOOTSEQ_PHASE_INIT,   /**< init_fn, from `MGR_Init()` */
+  BOOTSEQ_PHASE_RUN,    /**< run_fn, from `MGR_Run()` */
+
+  BOOTSEQ_PHASE_MAX
+} bootseq_phase_e;
+
+/** Milestones of the start, in the order they are expected. */
+typedef enum {
+  BOOTSEQ_MARK_APP,       /**< app_main() entered */
+  BOOTSEQ_MARK_NVS,       /**< NVS_Init() done */
+  BOOTSEQ_MARK_INIT,      /**< Every init_fn returned */
+  BOOTSEQ_MARK_RUN,       /**< Every run_fn returned */
+  BOOTSEQ_MARK_LINK,      /**< First link up, Ethernet or Wi-Fi */
+  BOOTSEQ_MARK_IP,        /**< First IP address */
+  BOOTSEQ_MARK_MQTT,      /**< First MQTT connection */
+  BOOTSEQ_MARK_PUBLISH,   /**< First message handed to the MQTT client */
+
+  BOOTSEQ_MARK_MAX
+} bootseq_mark_e;
+
+/**
+ * Run one step; @p id is the REG_*_BIT of the module.
+ */
+typedef esp_err_t (*bootseq_step_f)(int id);
+
+/** @brief One step; times are `esp_timer_get_time()` (us since boot). */
+typedef struct {
+  uint8_t   id;         /**< REG_*_BIT of the module. */
+  int8_t    after;      /**< Step it waited for last (dependency or busy worker), -1 if none. */
+  uint8_t   worker;     /**< Worker which ran it, BOOTSEQ_CALLER for the calling task. */
+  esp_err_t result;
+  uint32_t  ready_us;   /**< Dependencies done. */
+  uint32_t  begin_us;
+  uint32_t  end_us;
+} bootseq_step_t;
+
+/** @brief Summary of one phase (see `bootseq_GetPhase()`). */
+typedef struct {
+  uint32_t  cnt;                        /**< Steps. */
+  uint32_t  workers;                    /**< Worker tasks used, 0 when run by the caller. */
+  uint32_t  begin_us;
+  uint32_t  end_us;
+  uint32_t  busy_us;                    /**< Sum of step times, i.e. the phase run serially. */
+  uint32_t  path_cnt;
+  uint8_t   path[BOOTSEQ_STEP_MAX];     /**< Steps on the critical path, first to last. */
+} bootseq_phase_t;
+
+
+/**
+ * @brief Run @p step for every module of a phase, honouring the dependencies.
+ *
+ * @param phase   Phase the steps belong to.
+ * @param ids     REG_*_BIT of the modules, in the preferred order.
+ * @param depends For each module, the REG_*_CTRL mask of modules in @p ids which must finish first.
+ * @param cnt     Number of modules (at most BOOTSEQ_STEP_MAX).
+ * @param step    Called once per module.
+ *
+ * @return ESP_OK, or the first error returned by a step. All steps run either way.
+ */
+esp_err_t bootseq_Run(bootseq_phase_e phase, const uint8_t* ids, const uint32_t* depends, uint32_t cnt, bootseq_step_f step);
+
+/**
+ * @brief Summary of @p phase, NULL before it ran.
+ */
+const bootseq_phase_t* bootseq_GetPhase(bootseq_phase_e phase);
+
+/**
+ * @brief Steps of @p phase in `ids` order; the number of entries is `bootseq_GetPhase()->cnt`.
+ */
+const bootseq_step_t* bootseq_GetSteps(bootseq_phase_e phase);
+
+/**
+ * @brief Log the steps of @p phase, the time saved against a serial start and the critical path.
+ */
+void bootseq_LogPhase(bootseq_phase_e phase);
+
+const char* bootseq_GetPhaseName(bootseq_phase_e phase);
+
+/**
+ * @brief Stamp @p mark with the current time; only the first call per mark counts.
+ *
+ * Safe from any task and from event handlers.
+ */
+void bootseq_Mark(bootseq_mark_e mark);
+
+/**
+ * @brief Time of @p mark in us since boot, 0 if not reached yet.
+ */
+uint32_t bootseq_GetMark(bootseq_mark_e mark);
+
+const char* bootseq_GetMarkName(bootseq_mark_e mark);
+
+/**
+ * Receives one line of the report, without '\n'; @p line is valid only for the call.
+ */
+typedef void (*bootseq_line_f)(void* ctx, const char* line);
+
+/**
+ * @brief Hand the marks and both phases to @p fn, one line at a time:
+ *
+ *   [mark][<mark>] t_ms=<ms since boot, -1 if not reached>
+ *   [<phase>][total] modules= workers= begin_ms= end_ms= wall_ms= serial_ms= saved_ms=
+ *   [<phase>][<module>] ready_ms= start_ms= end_ms= took_ms= after= worker= result=
+ *   [<phase>][path] steps=<module>><module>... took_ms=
+ */
+void bootseq_Report(bootseq_line_f fn, void* ctx);
+
+/**
+ * @brief `bootseq_Report()` to the log.
+ */
+void bootseq_LogReport(void);
+
+#endif /* __BOOT_SEQ_H__ */
@@ -0,0 +1,196 @@
+/**
+ * @file bus_trace.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Bus trace ring and per-type latency histograms
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Every hop of a message on the bus (accepted by `MGR_Send()`, taken by the
+ * manager, handed to a module, taken and parsed by the module) writes one
+ * fixed-size record into a ring owned by the CPU core it runs on. Writers only
+ * reserve a slot with an atomic increment, so no lock is taken on the hot path;
+ * a reader that races a writer detects the torn record by its sequence byte.
+ *
+ * Hops that carry a duration also bump a log4 histogram bucket of their message
+ * type, so the latency distribution survives after the ring has wrapped. When a
+ * module has handled a message, its age is added to the end-to-end counters of
+ * the path it took (module queue or direct dispatch).
+ *
+ * With `CONFIG_MGR_BUS_TRACE_ENABLE` unset every call below is an empty inline
+ * function and the implementation is not built.
+ */
+
+#ifndef __BUS_TRACE_H__
+#define __BUS_TRACE_H__
+
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+#include "esp_err.h"
+
+#include "msg.h"
+
+
+/** Binary dump header magic ("BTRC", little endian). */
+#define BUS_TRACE_MAGIC         (0x43525442UL)
+#define BUS_TRACE_VERSION       (1U)
+
+/** Number of histogram buckets; bucket `n` counts samples below `64 << (2 * n)` us, the last one the rest. */
+#define BUS_TRACE_BUCKET_MAX    (8U)
+
+typedef enum {
+  BUS_HOP_SEND,         /**< `MGR_Send()` accepted the message; val: lane. */
+  BUS_HOP_DROP,         /**< `MGR_Send()` lost the message; val: lane. */
+  BUS_HOP_MGR_RECV,     /**< Manager task took it; val: time in the lane (us). */
+  BUS_HOP_MGR_DONE,     /**< Manager parsed and fanned it out; val: time spent (us). */
+  BUS_HOP_NOTIFY,       /**< Handed to module `to`; val: time spent in its `send_fn` (us). */
+  BUS_HOP_MOD_RECV,     /**< Module `to` took it; val: age since it entered the bus (us). */
+  BUS_HOP_MOD_DONE,     /**< Module `to` parsed it; val: time spent in its `ParseMsg` (us). */
+  BUS_HOP_DIRECT,       /**< Module `to` handled it inline on the manager task; val: time spent (us). */
+
+  BUS_HOP_MAX
+} bus_hop_e;
+
+/** Histogram stages, one per hop with a latency. */
+typedef enum {
+  BUS_STAGE_MGR_WAIT,   /**< BUS_HOP_MGR_RECV */
+  BUS_STAGE_MGR_PARSE,  /**< BUS_HOP_MGR_DONE */
+  BUS_STAGE_DELIVERY,   /**< BUS_HOP_MOD_RECV */
+  BUS_STAGE_MOD_PARSE,  /**< BUS_HOP_MOD_DONE, BUS_HOP_DIRECT */
+
+  BUS_STAGE_MAX
+} bus_stage_e;
+
+/** How a message reached the module which handled it. */
+typedef enum {
+  BUS_PATH_QUEUED,      /**< Module queue and task (`send_fn`). */
+  BUS_PATH_DIRECT,      /**< Inline on the manager task (`direct_fn`). */
+
+  BUS_PATH_MAX
+} bus_path_e;
+
+/** @brief End-to-end latency of one path: bus entry (pool copy) until the handler returned. */
+typedef struct {
+  uint32_t count;
+  uint32_t max_us;
+  uint64_t sum_us;
+} bus_trace_path_t;
+
+/**
+ * @brief One trace record (24 bytes, also the layout of the binary dump).
+ */
+typedef struct {
+  uint32_t ts;          /**< Low 32 bits of `esp_timer_get_time()` (us). */
+  uint32_t id;          /**< Pool handle (address) the hop worked on, 0 before the message is pooled. */
+  uint32_t from;        /**< `msg.from` */
+  uint32_t to;          /**< `msg.to`, or the module for NOTIFY / MOD_RECV / MOD_DONE. */
+  uint32_t val;         /**< Hop-specific value, see `bus_hop_e`. */
+  uint8_t  type;        /**< `msg.type` */
+  uint8_t  hop;         /**< `bus_hop_e` */
+  uint8_t  core;        /**< Core which wrote the record. */
+  uint8_t  seq;         /**< Written last: 0x80 | low 7 bits of the ring index, 0 while being written. */
+} bus_trace_rec_t;
+
+/** @brief Header in front of the records of a binary dump. */
+typedef struct {
+  uint32_t magic;       /**< BUS_TRACE_MAGIC */
+  uint16_t version;     /**< BUS_TRACE_VERSION */
+  uint16_t rec_size;    /**< sizeof(bus_trace_rec_t) */
+  uint32_t count;       /**< Records following the header. */
+  uint32_t now;         /**< `ts` of the newest record (0 if none). */
+} bus_trace_hdr_t;
+
+
+#if CONFIG_MGR_BUS_TRACE_ENABLE
+
+/**
+ * @brief Clear the rings and the histograms.
+ */
+void bustrace_Reset(void);
+
+/**
+ * @brief Write one record for @p msg and, for timed hops, count @p val in its histogram.
+ *
+ * @param hop Hop kind.
+ * @param msg Message on the hop (pooled handle or the producer's copy).
+ * @param to  Module for module hops, otherwise `msg.to`.
+ * @param val Hop-specific value.
+ */
+void bustrace_Record(bus_hop_e hop, const msg_t* msg, uint32_t to, uint32_t val);
+
+/**
+ * @brief Record that @p module took @p msg from its queue.
+ *
+ * @return Start time for `bustrace_ModEnd()`.
+ */
+int64_t bustrace_ModBegin(uint32_t module, const msg_t* msg);
+
+/**
+ * @brief Record that @p module finished parsing @p msg.
+ *
+ * @param begin Value returned by `bustrace_ModBegin()`.
+ */
+void bustrace_ModEnd(uint32_t module, const msg_t* msg, int64_t begin);
+
+/**
+ * @brief Record that @p module handled @p msg inline (direct dispatch) starting at @p begin.
+ */
+void bustrace_Direct(uint32_t module, const msg_t* msg, int64_t begin);
+
+/**
+ * @brief Copy the end-to-end latency of @p type delivered over @p path into @p stats.
+ *
+ * @return ESP_OK or ESP_ERR_INVALID_ARG.
+ */
+esp_err_t bustrace_GetPath(msg_type_e type, bus_path_e path, bus_trace_path_t* stats);
+
+/**
+ * @brief Copy the histogram of @p type at @p stage into @p buckets (BUS_TRACE_BUCKET_MAX entries).
+ *
+ * @return Number of samples.
+ */
+uint32_t bustrace_GetHist(msg_type_e type, bus_stage_e stage, uint32_t* buckets);
+
+/**
+ * @brief Upper bound (us) of histogram bucket @p bucket, 0 for the open-ended last one.
+ */
+uint32_t bustrace_GetBucketLimit(uint32_t bucket);
+
+/**
+ * @brief Estimate the @p pct percentile (us) from a histogram, as the upper bound of its bucket.
+ *
+ * @return Bucket limit, UINT32_MAX for the last bucket, 0 for an empty histogram.
+ */
+uint32_t bustrace_GetPercentile(const uint32_t* buckets, uint32_t pct);
+
+/**
+ * @brief Copy up to @p max of the newest valid records of all cores, oldest first.
+ *
+ * @return Number of records written.
+ */
+uint32_t bustrace_Read(bus_trace_rec_t* rec, uint32_t max);
+
+#else /* !CONFIG_MGR_BUS_TRACE_ENABLE */
+
+static inline void bustrace_Reset(void) {}
+static inline void bustrace_Record(bus_hop_e hop, const msg_t* msg, uint32_t to, uint32_t val) {
+  (void) hop; (void) msg; (void) to; (void) val;
+}
+static inline int64_t bustrace_ModBegin(uint32_t module, const msg_t* msg) {
+  (void) module; (void) msg;
+  return 0;
+}
+static inline void bustrace_ModEnd(uint32_t module, const msg_t* msg, int64_t begin) {
+  (void) module; (void) msg; (void) begin;
+}
+static inline void bustrace_Direct(uint32_t module, const msg_t* msg, int64_t begin) {
+  (void) module; (void) msg; (void) begin;
+}
+
+#endif /* CONFIG_MGR_BUS_TRACE_ENABLE */
+
+#endif /* __BUS_TRACE_H__ */
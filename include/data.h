@@ -8,7 +8,8 @@
  * Kconfig guards around `#include`.
  *
  * Lifetime: unless documented otherwise, `data` is valid only for the duration
- * of the synchronous callback or until the producer invalidates the snapshot.
+ * of the synchronous callback, or while the reader holds the snapshot
+ * (`datasnap_Acquire()` .. `datasnap_Release()`, see data_snap.h).
  */
 
 #ifndef __DATA_H__
@@ -17,22 +18,31 @@
 #include <stdint.h>
 
 /**
- * Kind of payload carried by `data_t`. Extend with prefixed names per domain
- * (e.g. DATA_WIFI_*, DATA_MQTT_*). Values must stay stable if blobs are stored.
+ * Kind of payload carried by `data_t`, one `X(_name)` per DATA_TYPE_<_name>.
+ * Extend with prefixed names per domain (e.g. WIFI_*, MQTT_*). Values must stay
+ * stable if blobs are stored: append, avoid renumbering existing entries.
+ *
+ * WIFI_SCAN_LIST       last scan of wifi_ctrl: `count` x `wifi_ui_ap_row_t` (data_wifi.h), published as a snapshot
+ * WIFI_CONNECT_STATUS  placeholder: single struct or blob for connect attempt outcome; layout TBD
+ * MQTT_STORE_STATS     mqtt_ctrl outbound queue: one `data_mqtt_store_stats_t` (data_mqtt.h), from get_fn
+ * MQTT_CONN_STATS      mqtt_ctrl reconnect engine: one `data_mqtt_conn_stats_t` (data_mqtt.h), from get_fn
+ * MQTT_RX_STATS        mqtt_ctrl inbound reassembly: one `data_mqtt_rx_stats_t` (data_mqtt.h), from get_fn
  */
-typedef enum {
-  DATA_TYPE_NONE = 0,
-
-  /** Placeholder: homogeneous array; layout = TBD in wifi module header (e.g. UI row). */
-  DATA_TYPE_WIFI_SCAN_LIST,
+#define DATA_TYPE_SCHEMA(X) \
+  X(NONE) \
+  X(WIFI_SCAN_LIST) \
+  X(WIFI_CONNECT_STATUS) \
+  X(MQTT_STORE_STATS) \
+  X(MQTT_CONN_STATS) \
+  X(MQTT_RX_STATS)
 
-  /** Placeholder: single struct or blob for connect attempt outcome; layout TBD. */
-  DATA_TYPE_WIFI_CONNECT_STATUS,
+#define DATA_TYPE_ENUM(_name)   DATA_TYPE_##_name,
 
-  /* Add more kinds as needed; avoid renumbering existing entries. */
+typedef enum {
+  DATA_TYPE_SCHEMA(DATA_TYPE_ENUM)
 
   DATA_TYPE_MAX
-  
+
 } data_type_e;
 
 typedef struct {
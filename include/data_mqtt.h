@@ -0,0 +1,74 @@
+/**
+ * @file data_mqtt.h
+ * @brief Neutral MQTT data layouts for `data_type_e` blobs (no ESP-IDF MQTT headers).
+ *
+ * Semantics are owned by `mqtt_ctrl` (producer, `MqttCtrl_GetData()`); this file is
+ * only the shared contract. Used with `DATA_TYPE_MQTT_STORE_STATS`,
+ * `DATA_TYPE_MQTT_CONN_STATS` and `DATA_TYPE_MQTT_RX_STATS` in `data.h`.
+ */
+
+#ifndef __DATA_MQTT_H__
+#define __DATA_MQTT_H__
+
+#include <stdint.h>
+
+/** Outbound store-and-forward queue of mqtt_ctrl (mqtt_store.c), one record. */
+typedef struct {
+  uint32_t depth;         /* records waiting, in flight included (RAM + flash) */
+  uint32_t bytes;         /* topic + payload bytes of these records */
+  uint32_t ram_depth;
+  uint32_t ram_used;      /* bytes of the RAM ring in use, record headers included */
+  uint32_t ram_size;
+  uint32_t flash_depth;
+  uint32_t flash_used;    /* bytes of the partition in use, consumed records included until erased */
+  uint32_t flash_size;    /* 0 when no spill partition was found */
+  uint32_t inflight;      /* published, PUBACK outstanding */
+  uint32_t queued;        /* records taken since boot */
+  uint32_t spilled;       /* of these, written to flash */
+  uint32_t replaced;      /* superseded by a newer record of a keep-latest topic */
+  uint32_t dropped;       /* lost: store full or record too large */
+  uint32_t published;     /* handed to the client, resends included */
+  uint32_t acked;         /* PUBACK received */
+  uint32_t ack_lost;      /* PUBACKs which found the collection list full, their records stay in flight */
+  uint32_t replay_cnt;    /* records sent by the last replay */
+  uint32_t replay_ms;     /* last replay, from the connection to an empty queue; 0 while one runs */
+  uint8_t  online;        /* 1 while connected to the broker */
+  uint8_t  replaying;     /* 1 while a backlog is replayed at the limited rate */
+} data_mqtt_store_stats_t;
+
+/** State of the broker connection, `data_mqtt_conn_stats_t.state`. */
+typedef enum {
+  DATA_MQTT_CONN_STOPPED = 0,   /* no link, or stopped on request: no attempts */
+  DATA_MQTT_CONN_CONNECTING,    /* attempt in progress */
+  DATA_MQTT_CONN_CONNECTED,
+  DATA_MQTT_CONN_BACKOFF,       /* waiting for the next attempt */
+} data_mqtt_conn_state_e;
+
+/** Reconnect engine of mqtt_ctrl (mqtt_conn.c), one record. */
+typedef struct {
+  uint32_t state;           /* data_mqtt_conn_state_e */
+  uint32_t attempts;        /* failed attempts since the connection was lost */
+  uint32_t backoff_ms;      /* delay drawn for the pending retry */
+  uint32_t retry_in_ms;     /* time left until it, 0 unless waiting */
+  uint32_t connects;        /* connections since boot */
+  uint32_t resumed;         /* of these, with the session kept by the broker (no re-subscribe) */
+  uint32_t disconnects;     /* connections lost or stopped */
+  uint32_t failures;        /* failed attempts since boot */
+  uint32_t ttr_last_ms;     /* time to reconnect: from losing the connection to the next one */
+  uint32_t ttr_avg_ms;
+  uint32_t ttr_max_ms;
+  uint32_t session_expiry_s; /* requested from the broker, 0 = clean start on every connection */
+} data_mqtt_conn_stats_t;
+
+/** Reassembly of inbound data of mqtt_ctrl (mqtt_rx.c), one record. */
+typedef struct {
+  uint32_t max_size;        /* bytes of a bus buffer: topic + message + 2 terminators */
+  uint32_t received;        /* messages handed to the bus */
+  uint32_t chunked;         /* of these, delivered by the client in several chunks */
+  uint32_t largest;         /* longest message received, in bytes */
+  uint32_t too_big;         /* dropped: larger than max_size */
+  uint32_t no_buffer;       /* dropped: all bus buffers held */
+  uint32_t broken;          /* dropped: a chunk missing or out of order, or the connection lost mid-message */
+} data_mqtt_rx_stats_t;
+
+#endif /* __DATA_MQTT_H__ */
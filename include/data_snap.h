@@ -0,0 +1,92 @@
+/**
+ * @file data_snap.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Versioned, immutable snapshots of bulk data per (producer, data_type_e)
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * A producer fills a snapshot once, when its data changes, and publishes it:
+ *
+ *   data_snap_t* snap = datasnap_Alloc(DATA_TYPE_WIFI_SCAN_LIST, cnt, cnt * sizeof(row));
+ *   ... write the rows to snap->buf ...
+ *   datasnap_Publish(REG_WIFI_CTRL, snap);
+ *
+ * From then on the snapshot is read-only. Consumers take a reference
+ * (`datasnap_Acquire()`), read `snap->data` without copying and give it back with
+ * `datasnap_Release()`; `MGR_GetData()` does the same for its callback. A newer
+ * publish replaces the snapshot for new readers, the old one is freed when its
+ * last reader releases it, so a reader never sees the producer rewriting it.
+ *
+ * Every publish bumps `version`; a consumer which remembers the version it
+ * rendered can compare it with `datasnap_GetVersion()` and skip the work.
+ */
+
+#ifndef __DATA_SNAP_H__
+#define __DATA_SNAP_H__
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "data.h"
+
+
+/** Max number of (producer, data type) pairs with a snapshot. */
+#define DATASNAP_SLOT_MAX       (8U)
+
+typedef struct {
+  data_t    data;       /**< View of the payload; `data.data` points to `buf`. */
+  uint32_t  version;    /**< 1 for the first publish of a (producer, type), +1 per publish. */
+  uint32_t  from;       /**< REG_*_CTRL of the producer. */
+  uint32_t  refs;       /**< References, owned by data_snap.c. */
+  uint8_t   buf[];      /**< Payload, written by the producer before `datasnap_Publish()`. */
+} data_snap_t;
+
+
+/**
+ * @brief Allocate a snapshot for @p size bytes of payload.
+ *
+ * @return The snapshot, to be filled through `buf` and handed to `datasnap_Publish()`
+ *         (or freed with `datasnap_Release()`); NULL when out of memory.
+ */
+data_snap_t* datasnap_Alloc(data_type_e type, uint32_t count, uint32_t size);
+
+/**
+ * @brief Make @p snap the current snapshot of @p module_type for its `data.type`.
+ *
+ * Takes over @p snap also on error. The previous snapshot stays valid for the
+ * readers which hold it.
+ *
+ * @param module_type One REG_*_CTRL bit, the producer.
+ * @param snap        From `datasnap_Alloc()`, filled in.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM when all DATASNAP_SLOT_MAX slots are taken.
+ */
+esp_err_t datasnap_Publish(uint32_t module_type, data_snap_t* snap);
+
+/**
+ * @brief Take a reference to the current snapshot of @p module_type / @p type.
+ *
+ * @return ESP_OK with @p snap set, ESP_ERR_NOT_FOUND if nothing was published.
+ */
+esp_err_t datasnap_Acquire(uint32_t module_type, data_type_e type, const data_snap_t** snap);
+
+/**
+ * @brief Give back a reference from `datasnap_Acquire()` (or an unpublished snapshot).
+ */
+void datasnap_Release(const data_snap_t* snap);
+
+/**
+ * @brief Version of the current snapshot of @p module_type / @p type, 0 if none.
+ */
+uint32_t datasnap_GetVersion(uint32_t module_type, data_type_e type);
+
+/**
+ * @brief Drop every snapshot (from `MGR_Done()`); ones still held are freed on their release.
+ */
+void datasnap_Clear(void);
+
+#endif /* __DATA_SNAP_H__ */
@@ -21,6 +21,7 @@
 
 #include "data.h"
 
+#include "data_mqtt.h"
 #include "data_wifi.h"
 
 #endif /* __DATA_TYPES_H__ */
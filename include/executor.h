@@ -0,0 +1,121 @@
+/**
+ * @file executor.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Message handler units, run on a dedicated task or on a shared worker pool
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * A module which only reacts to bus messages hands its `ParseMsg` to
+ * `executor_Create()` instead of creating a queue, a task and a semaphore itself.
+ *
+ * By default every unit still gets its own task, with the stack and priority from
+ * its `executor_cfg_t`. With `CONFIG_MGR_EXECUTOR_ENABLE` the units share
+ * `CONFIG_MGR_EXECUTOR_WORKERS` worker tasks instead: a unit with waiting
+ * messages is queued for the workers once, and only one worker runs it at a time,
+ * so the messages of one module are still handled one by one, in queue order.
+ * Handlers of different modules may run in parallel.
+ *
+ * In pool mode a handler must not wait for long (it holds a worker); modules with
+ * blocking I/O or their own timing (mqtt, sys, wifi) keep a dedicated task.
+ */
+
+#ifndef __EXECUTOR_H__
+#define __EXECUTOR_H__
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "freertos/FreeRTOS.h"
+
+#include "msg.h"
+
+
+/** Max number of units (modules using the executor). */
+#define EXECUTOR_UNIT_MAX       (12U)
+
+/** Messages a worker handles for one unit before it lets the next unit in. */
+#define EXECUTOR_BATCH          (4U)
+
+/**
+ * Handle one message; the same contract as a module `ParseMsg`. ESP_TASK_DONE
+ * stops the unit, any other value except ESP_OK is logged.
+ */
+typedef esp_err_t (*executor_handler_f)(const msg_t* msg);
+
+typedef struct {
+  const char*         name;       /**< Queue label (`msgpool_LogMemory()`) and task name in task mode. */
+  uint32_t            module;     /**< REG_*_CTRL of the owner, for the bus trace. */
+  UBaseType_t         depth;      /**< Queue length. */
+  executor_handler_f  handler;
+  uint32_t            stack;      /**< Task stack in task mode (bytes). */
+  UBaseType_t         priority;   /**< Task priority in task mode. */
+} executor_cfg_t;
+
+typedef struct executor_unit_s executor_unit_t;
+
+/** @brief Executor counters (see `executor_GetStats()`). */
+typedef struct {
+  uint32_t units;         /**< Units created. */
+  uint32_t workers;       /**< Worker tasks, 0 in task mode. */
+  uint32_t unit_stack;    /**< Stack bytes the units asked for, dedicated tasks or not. */
+  uint32_t worker_stack;  /**< Stack bytes of the worker tasks. */
+  uint32_t tcb_size;      /**< Bytes of one task control block. */
+  int32_t  reclaimed;     /**< Stack + TCB bytes saved by the pool compared to one task per unit. */
+} executor_stats_t;
+
+/** @brief One unit, as listed by `executor_GetUnits()`. */
+typedef struct {
+  const char* name;
+  uint32_t    stack;      /**< Stack a dedicated task gets (bytes). */
+  uint32_t    waiting;    /**< Messages in the unit queue right now. */
+  uint32_t    runs;       /**< Messages handled. */
+} executor_unit_info_t;
+
+
+/**
+ * @brief Start the worker tasks (pool mode); call once before the first `executor_Create()`.
+ */
+esp_err_t executor_Init(void);
+
+/**
+ * @brief Stop the worker tasks; every unit must have been deleted.
+ */
+esp_err_t executor_Done(void);
+
+/**
+ * @brief Create the message queue of a module and start handling it.
+ *
+ * @return Unit or NULL on error.
+ */
+executor_unit_t* executor_Create(const executor_cfg_t* cfg);
+
+/**
+ * @brief Post @p msg to the unit queue (`msgpool_Post()`) and schedule the unit.
+ */
+esp_err_t executor_Post(executor_unit_t* unit, const msg_t* msg, TickType_t wait);
+
+/**
+ * @brief Post @p done (a MSG_TYPE_DONE message), wait until the handler returned
+ *        ESP_TASK_DONE and release the queue and the unit.
+ */
+esp_err_t executor_Delete(executor_unit_t* unit, const msg_t* done);
+
+void executor_GetStats(executor_stats_t* stats);
+
+/**
+ * @brief Copy up to @p max entries of the unit table into @p info.
+ *
+ * @return Number of entries written.
+ */
+uint32_t executor_GetUnits(executor_unit_info_t* info, uint32_t max);
+
+/**
+ * @brief Log the units and the RAM saved by the worker pool.
+ */
+void executor_LogStats(void);
+
+#endif /* __EXECUTOR_H__ */
@@ -12,76 +12,35 @@
 #ifndef __LUT_H__
 #define __LUT_H__
 
+#include <stdint.h>
+
 #include "msg.h"
 #include "data.h"
 
-#define GET_MSG_TYPE_NAME(_type) ( \
-  _type == MSG_TYPE_INIT                      ? "MSG_TYPE_INIT"                   : \
-  _type == MSG_TYPE_DONE                      ? "MSG_TYPE_DONE"                   : \
-  _type == MSG_TYPE_RUN                       ? "MSG_TYPE_RUN"                    : \
-  _type == MSG_TYPE_MGR_LIST                  ? "MSG_TYPE_MGR_LIST"               : \
-  _type == MSG_TYPE_MGR_UID                   ? "MSG_TYPE_MGR_UID"                : \
-  _type == MSG_TYPE_ETH_EVENT                 ? "MSG_TYPE_ETH_EVENT"              : \
-  _type == MSG_TYPE_ETH_MAC                   ? "MSG_TYPE_ETH_MAC"                : \
-  _type == MSG_TYPE_ETH_IP                    ? "MSG_TYPE_ETH_IP"                 : \
-  _type == MSG_TYPE_WIFI_EVENT                ? "MSG_TYPE_WIFI_EVENT"             : \
-  _type == MSG_TYPE_WIFI_IP                   ? "MSG_TYPE_WIFI_IP"                : \
-  _type == MSG_TYPE_WIFI_MAC                  ? "MSG_TYPE_WIFI_MAC"               : \
-  _type == MSG_TYPE_WIFI_SCAN_REQ             ? "MSG_TYPE_WIFI_SCAN_REQ"          : \
-  _type == MSG_TYPE_WIFI_SCAN_RESULT          ? "MSG_TYPE_WIFI_SCAN_RESULT"       : \
-  _type == MSG_TYPE_WIFI_CONNECT              ? "MSG_TYPE_WIFI_CONNECT"           : \
-  _type == MSG_TYPE_WIFI_DISCONNECT           ? "MSG_TYPE_WIFI_DISCONNECT"        : \
-  _type == MSG_TYPE_WIFI_CTRL_GOT_IP          ? "MSG_TYPE_WIFI_CTRL_GOT_IP"       : \
-  _type == MSG_TYPE_MQTT_START                ? "MSG_TYPE_MQTT_START"             : \
-  _type == MSG_TYPE_MQTT_STOP                 ? "MSG_TYPE_MQTT_STOP"              : \
-  _type == MSG_TYPE_MQTT_EVENT                ? "MSG_TYPE_MQTT_EVENT"             : \
-  _type == MSG_TYPE_MQTT_DATA                 ? "MSG_TYPE_MQTT_DATA"              : \
-  _type == MSG_TYPE_MQTT_PUBLISH              ? "MSG_TYPE_MQTT_PUBLISH"           : \
-  _type == MSG_TYPE_MQTT_SUBSCRIBE            ? "MSG_TYPE_MQTT_SUBSCRIBE"         : \
-  _type == MSG_TYPE_MQTT_SUBSCRIBE_LIST       ? "MSG_TYPE_MQTT_SUBSCRIBE_LIST"    : \
-  _type == MSG_TYPE_SENSORS                   ? "MSG_TYPE_SENSORS"                : \
-  _type == MSG_TYPE_LCD_DATA                  ? "MSG_TYPE_LCD_DATA"               : \
-                                                "MSG_TYPE_UNKNOWN"                  \
-)
+/* Name tables generated from msg_schema.h / data.h (main/lut.c), indexed by value */
+extern const char* const lut_msg_type_name[MSG_TYPE_MAX];
+extern const char* const lut_data_type_name[DATA_TYPE_MAX];
+extern const char* const lut_data_eth_event_name[DATA_ETH_EVENT_CNT];
+extern const char* const lut_data_wifi_event_name[DATA_WIFI_EVENT_CNT];
+extern const char* const lut_data_mqtt_event_name[DATA_MQTT_EVENT_CNT];
+
+/* Entry @p _idx of a name table of @p _cnt entries, @p _unknown when out of range */
+#define LUT_GET_NAME(_list, _cnt, _idx, _unknown) \
+  (((uint32_t) (_idx) < (uint32_t) (_cnt)) ? (_list)[(uint32_t) (_idx)] : (_unknown))
+
+#define GET_MSG_TYPE_NAME(_type) \
+  LUT_GET_NAME(lut_msg_type_name, MSG_TYPE_MAX, _type, "MSG_TYPE_UNKNOWN")
 
-#define GET_DATA_TYPE_NAME(_type) ( \
-  _type == DATA_TYPE_NONE               ? "DATA_TYPE_NONE"               : \
-  _type == DATA_TYPE_WIFI_SCAN_LIST     ? "DATA_TYPE_WIFI_SCAN_LIST"   : \
-  _type == DATA_TYPE_WIFI_CONNECT_STATUS ? "DATA_TYPE_WIFI_CONNECT_STATUS" : \
-  _type == DATA_TYPE_MAX                ? "DATA_TYPE_MAX"                : \
-                                          "DATA_TYPE_UNKNOWN"              \
-)
+#define GET_DATA_TYPE_NAME(_type) \
+  LUT_GET_NAME(lut_data_type_name, DATA_TYPE_MAX, _type, "DATA_TYPE_UNKNOWN")
 
-#define GET_DATA_ETH_EVENT_NAME(_event) ( \
-  _event == DATA_ETH_EVENT_START              ? "DATA_ETH_EVENT_START"            : \
-  _event == DATA_ETH_EVENT_STOP               ? "DATA_ETH_EVENT_STOP"             : \
-  _event == DATA_ETH_EVENT_CONNECTED          ? "DATA_ETH_EVENT_CONNECTED"        : \
-  _event == DATA_ETH_EVENT_DISCONNECTED       ? "DATA_ETH_EVENT_DISCONNECTED"     : \
-                                                "DATA_ETH_EVENT_UNKNOWN"            \
-)
+#define GET_DATA_ETH_EVENT_NAME(_event) \
+  LUT_GET_NAME(lut_data_eth_event_name, DATA_ETH_EVENT_CNT, _event, "DATA_ETH_EVENT_UNKNOWN")
 
-#define GET_DATA_WIFI_EVENT_NAME(_event) ( \
-  _event == DATA_WIFI_EVENT_STA_START         ? "DATA_WIFI_EVENT_STA_START"       : \
-  _event == DATA_WIFI_EVENT_STA_STOP          ? "DATA_WIFI_EVENT_STA_STOP"        : \
-  _event == DATA_WIFI_EVENT_SCAN_FAILED       ? "DATA_WIFI_EVENT_SCAN_FAILED"     : \
-  _event == DATA_WIFI_EVENT_CONNECTED         ? "DATA_WIFI_EVENT_CONNECTED"       : \
-  _event == DATA_WIFI_EVENT_DISCONNECTED      ? "DATA_WIFI_EVENT_DISCONNECTED"    : \
-                                                "DATA_WIFI_EVENT_UNKNOWN"           \
-)
+#define GET_DATA_WIFI_EVENT_NAME(_event) \
+  LUT_GET_NAME(lut_data_wifi_event_name, DATA_WIFI_EVENT_CNT, _event, "DATA_WIFI_EVENT_UNKNOWN")
 
-#define GET_DATA_MQTT_EVENT_NAME(_event) ( \
-  _event == DATA_MQTT_EVENT_ANY               ? "DATA_MQTT_EVENT_ANY"             : \
-  _event == DATA_MQTT_EVENT_ERROR             ? "DATA_MQTT_EVENT_ERROR"           : \
-  _event == DATA_MQTT_EVENT_CONNECTED         ? "DATA_MQTT_EVENT_CONNECTED"       : \
-  _event == DATA_MQTT_EVENT_DISCONNECTED      ? "DATA_MQTT_EVENT_DISCONNECTED"    : \
-  _event == DATA_MQTT_EVENT_SUBSCRIBED        ? "DATA_MQTT_EVENT_SUBSCRIBED"      : \
-  _event == DATA_MQTT_EVENT_UNSUBSCRIBED      ? "DATA_MQTT_EVENT_UNSUBSCRIBED"    : \
-  _event == DATA_MQTT_EVENT_PUBLISHED         ? "DATA_MQTT_EVENT_PUBLISHED"       : \
-  _event == DATA_MQTT_EVENT_DATA              ? "DATA_MQTT_EVENT_DATA"            : \
-  _event == DATA_MQTT_EVENT_BEFORE_CONNECT    ? "DATA_MQTT_EVENT_BEFORE_CONNECT"  : \
-  _event == DATA_MQTT_EVENT_DELETED           ? "DATA_MQTT_EVENT_DELETED"         : \
-  _event == DATA_MQTT_EVENT_USER              ? "DATA_MQTT_EVENT_USER"            : \
-                                                "DATA_MQTT_EVENT_UNKNOWN"           \
-)
+#define GET_DATA_MQTT_EVENT_NAME(_event) \
+  LUT_GET_NAME(lut_data_mqtt_event_name, DATA_MQTT_EVENT_CNT, _event, "DATA_MQTT_EVENT_UNKNOWN")
 
 #endif /* __LUT_H__ */
@@ -0,0 +1,83 @@
+/**
+ * @file mgr_call.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Pending calls of MGR_Call() / MGR_CallAsync(), matched to replies by correlation id
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Every call takes a slot with a new id (`msg_t.call`) and a deadline before its
+ * request is sent. `MSG_TYPE_MGR_REPLY` messages reach `mgrcall_Complete()` on the
+ * manager task, which looks the id up and frees the slot: a blocking caller gets
+ * the reply copied to its buffer and a task notification (index
+ * MGRCALL_NOTIFY_INDEX, the default index stays free for the task), an async
+ * caller its callback. A reply without a slot came after its deadline and is dropped.
+ *
+ * Blocking callers time out on their own (`mgrcall_Cancel()`); the deadlines of
+ * async calls are checked by the manager task, which wakes up for the nearest one
+ * (`mgrcall_GetWaitTicks()`, `mgrcall_Expire()`).
+ */
+
+#ifndef __MGR_CALL_H__
+#define __MGR_CALL_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "mgr_ctrl.h"
+#include "msg.h"
+
+
+/** Max number of calls waiting for a reply at the same time. */
+#define MGRCALL_PENDING_MAX     (CONFIG_MGR_CALL_PENDING_MAX)
+
+/** Task notification index a blocking caller waits on. */
+#define MGRCALL_NOTIFY_INDEX    (1)
+
+#if CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES <= MGRCALL_NOTIFY_INDEX
+#error "MGR_Call() needs CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES >= 2"
+#endif
+
+
+/**
+ * @brief Take a slot for a new call.
+ *
+ * @param task    Blocking caller to notify, NULL for an async call.
+ * @param reply   Blocking caller's buffer for the reply.
+ * @param cb      Async callback.
+ *
+ * @return The correlation id, MSG_CALL_NONE when all slots are taken.
+ */
+uint32_t mgrcall_Open(TaskHandle_t task, msg_t* reply, mgr_call_cb_f cb, void* ctx, uint32_t timeout_ms);
+
+/**
+ * @brief Free the slot of @p id, counting a timeout if @p timeout.
+ *
+ * @return false when the reply got there first; for a blocking call it is then
+ *         copied and the notification is on its way.
+ */
+bool mgrcall_Cancel(uint32_t id, bool timeout);
+
+/**
+ * @brief Hand @p reply to its caller, or drop it when the call is gone. Manager task only.
+ */
+void mgrcall_Complete(const msg_t* reply);
+
+/**
+ * @brief Call back the async calls past their deadline with NULL. Manager task only.
+ */
+void mgrcall_Expire(void);
+
+/**
+ * @brief Ticks until the nearest async deadline, portMAX_DELAY when none is pending.
+ */
+TickType_t mgrcall_GetWaitTicks(void);
+
+void mgrcall_GetStats(mgr_call_stats_t* stats);
+
+#endif /* __MGR_CALL_H__ */
@@ -14,23 +14,213 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "esp_err.h"
 
+#include "freertos/FreeRTOS.h"
+
 #include "mgr_reg.h"
 
+/**
+ * Manager queue lanes. Every message type is mapped to one lane (see `MGR_SetLane`);
+ * the manager task always empties the control lane before it takes the next bulk message.
+ */
+typedef enum {
+  MGR_LANE_CTRL,    /* commands, link/MQTT events, lifecycle */
+  MGR_LANE_BULK,    /* publishes, LCD updates, scan results */
+
+  MGR_LANE_MAX
+} mgr_lane_e;
+
+/** Counters of one lane (see `MGR_GetLaneStats`). Latency is measured from entering the bus to dispatch. */
+typedef struct {
+  uint32_t depth;           /* lane queue length */
+  uint32_t waiting;         /* messages waiting right now */
+  uint32_t posted;          /* messages accepted */
+  uint32_t dropped;         /* messages rejected (lane full or pool empty) */
+  uint32_t dispatched;      /* messages taken by the manager task */
+  uint64_t latency_sum_us;  /* sum of queueing latency of dispatched messages */
+  uint32_t latency_max_us;  /* worst queueing latency */
+} mgr_lane_stats_t;
+
+/** Messages of one producer lost on one bus queue (see `MGR_GetDrops`). */
+typedef struct {
+  const char* from;         /* producer module name, from `msg.from` */
+  const char* to;           /* queue which did not take the messages */
+  uint32_t    count;
+} mgr_drop_t;
+
+/**
+ * Called with the reply of an `MGR_CallAsync()`, or with NULL once its deadline passed.
+ * Runs on the manager task: keep it short and do not call `MGR_Call()` from it.
+ * @p reply is valid only for the call.
+ */
+typedef void (*mgr_call_cb_f)(const msg_t* reply, void* ctx);
+
+/** Counters of `MGR_Call()` / `MGR_CallAsync()` (see `MGR_GetCallStats`). */
+typedef struct {
+  uint32_t pending;         /* calls waiting for a reply right now */
+  uint32_t calls;           /* requests sent */
+  uint32_t replies;         /* replies handed to a caller */
+  uint32_t timeouts;        /* deadlines passed without a reply */
+  uint32_t late;            /* replies dropped, caller gone (deadline passed) */
+  uint32_t full;            /* calls refused, no free pending slot */
+  uint32_t rtt_max_us;      /* slowest reply, from the request to the caller */
+} mgr_call_stats_t;
+
+/** Interrupt source of `MGR_SendFromISR()`, from `MGR_IsrOpen()`. */
+typedef struct mgr_isr_src_s* mgr_isr_src_t;
+
+/** Counters of one interrupt source (see `MGR_GetIsrStats`). */
+typedef struct {
+  const char* name;
+  uint32_t depth;           /* ring entries */
+  uint32_t waiting;         /* entries not taken by the manager yet */
+  uint32_t posted;          /* messages accepted by the ring */
+  uint32_t dropped;         /* messages rejected, ring full */
+  uint32_t drained;         /* entries moved to the lanes */
+  uint32_t invalid;         /* entries of a type which does not fit a small slot */
+  uint32_t latency_max_us;  /* worst time from the interrupt to the lanes */
+} mgr_isr_stats_t;
+
+/** Supervisor counters of one module (see `MGR_GetSupStats`). */
+typedef struct {
+  const char* name;
+  uint8_t  policy;          /* mgr_sup_policy_e */
+  bool     up;              /* false after a failed restart, until the next one succeeds */
+  bool     backoff;         /* restart scheduled */
+  uint32_t faults;          /* faults reported */
+  uint32_t restarts;        /* restarts done, by the supervisor or by `MGR_Restart()` */
+  uint32_t consecutive;     /* restarts in a row, reset once the module stayed up */
+  uint32_t stalls;          /* heartbeats missed with work waiting */
+  uint32_t beat_age_ms;     /* time since the last heartbeat, 0 before the first one */
+  const char* reason;       /* last fault, NULL if none */
+} mgr_sup_stats_t;
+
 esp_err_t MGR_Init(void);
 esp_err_t MGR_Run(void);
 esp_err_t MGR_Done(void);
 esp_err_t MGR_Send(const msg_t* msg);
 
+/**
+ * Move message @p type to @p lane. Takes effect for the next `MGR_Send`.
+ */
+esp_err_t MGR_SetLane(msg_type_e type, mgr_lane_e lane);
+mgr_lane_e MGR_GetLane(msg_type_e type);
+esp_err_t MGR_GetLaneStats(mgr_lane_e lane, mgr_lane_stats_t* stats);
+
+/**
+ * Turn direct dispatch (`mgr_reg_t.direct_fn`) on or off at run time; when off, every
+ * message goes through the module queues. Default: `CONFIG_MGR_DIRECT_DISPATCH`.
+ */
+void MGR_SetDirect(bool enable);
+bool MGR_GetDirect(void);
+
+/**
+ * Name of the registered module owning @p type (one `REG_*_CTRL` bit), "mgr" for the manager.
+ */
+const char* MGR_GetModuleName(uint32_t type);
+
+/**
+ * Copy up to @p max (producer, queue) drop counters into @p drops, with module names.
+ * Returns the number of entries written.
+ */
+uint32_t MGR_GetDrops(mgr_drop_t* drops, uint32_t max);
+
 /**
  * Dispatch bulk data read. @p module_type must be exactly one `REG_*_CTRL` bit (e.g.
- * `REG_MQTT_CTRL`); otherwise `ESP_ERR_INVALID_ARG`. Finds the first registered entry whose
- * `type` overlaps that bit; if `get_fn` is set, calls `get_fn(kind, cb, cb_ctx)` (the module
- * invokes @p cb zero or more times). `ESP_ERR_NOT_SUPPORTED` if the module matches but has no
- * `get_fn`; `ESP_ERR_NOT_FOUND` if no entry matches.
+ * `REG_MQTT_CTRL`); otherwise `ESP_ERR_INVALID_ARG`. When the module published a snapshot
+ * of @p data_type (data_snap.h), calls @p cb once with it, holding a reference for the call,
+ * and returns what @p cb returned. Otherwise, if `get_fn` is set, calls `get_fn(kind, cb, cb_ctx)`
+ * (the module invokes @p cb zero or more times). `ESP_ERR_NOT_SUPPORTED` if the module matches
+ * but has neither; `ESP_ERR_NOT_FOUND` if no entry matches.
  */
 esp_err_t MGR_GetData(uint32_t module_type, data_type_e data_type, mgr_reg_data_cb_f cb, void *cb_ctx);
 
+/**
+ * Send @p request and wait up to @p timeout_ms for its reply, which is copied to @p reply.
+ *
+ * The request gets a new correlation id (`msg_t.call`); the receiving module answers with
+ * `MGR_Reply()` and the manager hands the reply to the waiting caller through its task
+ * notification index MGRCALL_NOTIFY_INDEX (1); the default index is left alone. A reply
+ * which comes after the deadline is dropped. The calling task must be neither the manager
+ * task nor the task of the module which answers.
+ *
+ * @return ESP_OK with @p reply filled in (the responder's status is `reply->payload.reply.result`),
+ *         ESP_ERR_TIMEOUT, ESP_ERR_NO_MEM when all pending slots are taken,
+ *         ESP_ERR_INVALID_STATE when called from the manager task, or the error of `MGR_Send()`.
+ */
+esp_err_t MGR_Call(const msg_t* request, uint32_t timeout_ms, msg_t* reply);
+
+/**
+ * Send @p request and return at once; @p cb gets the reply, or NULL after @p timeout_ms.
+ * @p id (optional) receives the correlation id.
+ *
+ * @return ESP_OK when the request was sent (then @p cb is called exactly once), else as `MGR_Call()`.
+ */
+esp_err_t MGR_CallAsync(const msg_t* request, uint32_t timeout_ms, mgr_call_cb_f cb, void* ctx, uint32_t* id);
+
+/**
+ * Answer @p request, received with a correlation id. Fills in the type, `to`, `call` and `key`
+ * of @p reply; the responder sets `from` and `payload.reply`.
+ *
+ * @return ESP_ERR_INVALID_ARG when @p request is not part of a call, else as `MGR_Send()`.
+ */
+esp_err_t MGR_Reply(const msg_t* request, msg_t* reply);
+
+esp_err_t MGR_GetCallStats(mgr_call_stats_t* stats);
+
+/**
+ * Open an interrupt source with a ring of @p depth messages (rounded up to a power of two).
+ * Call from task context, before the handler is installed; the source stays open until `MGR_Done()`.
+ *
+ * @return ESP_OK with @p src set, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM (no memory, or all
+ *         `CONFIG_MGR_ISR_SOURCE_MAX` sources taken).
+ */
+esp_err_t MGR_IsrOpen(const char* name, uint32_t depth, mgr_isr_src_t* src);
+
+/**
+ * `MGR_Send()` for interrupt handlers: copies @p msg into the ring of @p src and wakes the
+ * manager task, which moves it to its lane in the order the events were raised. Only message
+ * types which fit a small pool slot can be sent. Each source must have a single producer,
+ * one ISR or one task (e.g. an esp_timer callback); placed in IRAM.
+ *
+ * @param woken Set to pdTRUE when the manager task should run at the end of the ISR
+ *              (`portYIELD_FROM_ISR()`); may be NULL from a task.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_FAIL when the ring is full (the message is dropped).
+ */
+esp_err_t MGR_SendFromISR(mgr_isr_src_t src, const msg_t* msg, BaseType_t* woken);
+
+/**
+ * Copy the counters of up to @p max interrupt sources into @p stats; returns the number written.
+ */
+uint32_t MGR_GetIsrStats(mgr_isr_stats_t* stats, uint32_t max);
+
+/**
+ * Heartbeat of module @p module_type (one `REG_*_CTRL` bit): call from the module task each
+ * time it finished a message, including the ones it drops. Units of the executor beat by
+ * themselves. See mgr_sup.h.
+ */
+void MGR_Heartbeat(uint32_t module_type);
+
+/**
+ * Report a fault @p module_type cannot recover from by itself (e.g. repeated connection
+ * errors); the supervisor applies the `restart` policy of the module. Any task, not from an
+ * ISR. @p reason must be a string literal.
+ */
+esp_err_t MGR_ReportFault(uint32_t module_type, const char* reason);
+
+/**
+ * Restart @p module_type now (done_fn, init_fn, run_fn), whatever its policy. Runs on the
+ * manager task; returns once the request is queued.
+ */
+esp_err_t MGR_Restart(uint32_t module_type);
+
+/**
+ * Copy the supervisor counters of up to @p max modules into @p stats; returns the number written.
+ */
+uint32_t MGR_GetSupStats(mgr_sup_stats_t* stats, uint32_t max);
+
 #endif /* __MANAGER_H__ */
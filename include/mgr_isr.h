@@ -0,0 +1,80 @@
+/**
+ * @file mgr_isr.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Lock-free rings which carry messages from interrupt handlers to the manager task
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Every interrupt source opened with `MGR_IsrOpen()` owns one single-producer,
+ * single-consumer ring of small-slot messages. The producer (one ISR, or one
+ * task such as an esp_timer callback) copies the message into the entry at
+ * `head`, stamps it and publishes `head` with a release store; the manager task
+ * is the only consumer and publishes `tail` the same way. Neither side takes a
+ * lock, so the producer never waits and never masks interrupts.
+ *
+ * `MGR_SendFromISR()` wakes the manager with a direct-to-task notification.
+ * `mgrisr_Drain()`, called by the manager before it looks at its lanes, moves
+ * the waiting entries into the lanes through the normal send path, oldest stamp
+ * first across all sources, so the order in which the events were raised is
+ * kept and a ring never overtakes itself.
+ *
+ * The push path only uses inline code, `memcpy()` and `esp_timer_get_time()`,
+ * so it is placed in IRAM and can be called from `ESP_INTR_FLAG_IRAM` handlers.
+ */
+
+#ifndef __MGR_ISR_H__
+#define __MGR_ISR_H__
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "mgr_ctrl.h"
+#include "msg.h"
+
+
+/** Max number of interrupt sources. */
+#define MGRISR_SOURCE_MAX       (CONFIG_MGR_ISR_SOURCE_MAX)
+
+/** Max entries of one ring. */
+#define MGRISR_DEPTH_MAX        (256U)
+
+/**
+ * Hands one drained message to the bus; the message is valid only for the call.
+ */
+typedef esp_err_t (*mgrisr_post_f)(const msg_t* msg);
+
+
+/**
+ * @brief Open a source with a ring of @p depth entries (rounded up to a power of two).
+ */
+esp_err_t mgrisr_Open(const char* name, uint32_t depth, mgr_isr_src_t* src);
+
+/**
+ * @brief Copy @p msg into the ring of @p src. Producer of @p src only; ISR-safe.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_FAIL when the ring is full (counted as dropped).
+ */
+esp_err_t mgrisr_Push(mgr_isr_src_t src, const msg_t* msg);
+
+/**
+ * @brief Hand every waiting entry to @p post, oldest first. Manager task only.
+ *
+ * @return Number of entries taken from the rings.
+ */
+uint32_t mgrisr_Drain(mgrisr_post_f post);
+
+/**
+ * @brief Copy the counters of up to @p max open sources into @p stats; returns the number written.
+ */
+uint32_t mgrisr_GetStats(mgr_isr_stats_t* stats, uint32_t max);
+
+/**
+ * @brief Free every ring (from `MGR_Done()`, after the modules removed their handlers).
+ */
+void mgrisr_Done(void);
+
+#endif /* __MGR_ISR_H__ */
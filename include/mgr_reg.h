@@ -27,9 +27,26 @@ typedef char mgr_reg_topic_t[MGR_REG_TOPIC_MAX];
 
 typedef char mgr_reg_name_t[MGR_REG_NAME_MAX];
 
+/**
+ * Module name for a `mgr_reg_t` initializer; fails to compile when @p _name
+ * (with its '\0') does not fit MGR_REG_NAME_MAX.
+ */
+#define MGR_REG_NAME(_name) \
+  (sizeof(struct { _Static_assert(sizeof(_name) <= MGR_REG_NAME_MAX, "Module name too long: " _name); char c; }) \
+      ? (_name) : (_name))
+
 typedef esp_err_t(*mgr_reg_init_f)(void);
 typedef esp_err_t(*mgr_reg_done_f)(void);
 typedef esp_err_t(*mgr_reg_run_f)(void);
+/**
+ * Queue @p msg for the module task (send_fn), or handle it right away (direct_fn).
+ *
+ * A direct_fn is called on the manager task for the types in `direct`, instead of
+ * send_fn, which saves the module queue hop and a context switch. It must be short
+ * and must not block: no waiting on queues, semaphores or I/O, and no MGR_Send() of
+ * a type with the block policy. It runs concurrently with the module's own task.
+ * Returning ESP_ERR_NOT_SUPPORTED hands the message to send_fn as usual.
+ */
 typedef esp_err_t(*mgr_reg_send_f)(const msg_t* msg);
 
 /**
@@ -50,14 +67,30 @@ typedef esp_err_t (*mgr_reg_data_cb_f)(const data_t *payload, void *cb_ctx);
  */
 typedef esp_err_t (*mgr_reg_get_f)(data_type_e data_type, mgr_reg_data_cb_f cb, void *cb_ctx);
 
+/**
+ * What the supervisor does when a module reports a fault (`MGR_ReportFault()`), see mgr_sup.h.
+ */
+typedef enum {
+  MGR_SUP_NONE,       /* log and count only */
+  MGR_SUP_RESTART,    /* restart the module alone, with back-off; reboot after too many in a row */
+  MGR_SUP_REBOOT,     /* reboot the device */
+
+  MGR_SUP_MAX
+} mgr_sup_policy_e;
+
 typedef struct mgr_reg_s {
-  mgr_reg_topic_t name; /* name of module */
-  uint32_t        type; /* type of module */
+  const char*     name;       /* name of module, see MGR_REG_NAME() */
+  uint32_t        type;       /* type of module, (1 << REG_*_BIT) of its slot in mgr_reg_list */
+  msg_mask_t      subscribe;  /* message types delivered to send_fn, MSG_MASK(MSG_TYPE_xxx) | ... */
+  msg_mask_t      direct;     /* subscribed types handled inline by direct_fn on the manager task */
+  uint32_t        depends;    /* REG_xxx_CTRL of modules whose init_fn / run_fn must finish first, see boot_seq.h */
+  uint8_t         restart;    /* mgr_sup_policy_e, MGR_SUP_NONE when not set */
 
   mgr_reg_init_f  init_fn;
   mgr_reg_done_f  done_fn;
   mgr_reg_run_f   run_fn;
   mgr_reg_send_f  send_fn;
+  mgr_reg_send_f  direct_fn;  /* optional, see mgr_reg_send_f note above */
   mgr_reg_get_f   get_fn;
 } mgr_reg_t;
 
@@ -63,156 +63,246 @@
 #endif
 
 
-#define MGR_REG_LIST_CNT  (sizeof(mgr_reg_list)/sizeof(mgr_reg_t))
-
-static mgr_reg_t mgr_reg_list[] = {
+/**
+ * Registered modules, indexed by REG_*_BIT: the manager finds the receivers of a
+ * message by walking the set bits of its `to` mask, without searching the list.
+ * Slots of disabled or unused bits stay zeroed (`type == 0`).
+ *
+ * Each entry must sit at the bit of its `.type`; a bit used twice is caught by
+ * the check in msg.h and a name which does not fit by MGR_REG_NAME().
+ */
+static const mgr_reg_t mgr_reg_list[REG_BIT_MAX] = {
 
-  /* ETH Controller MUST BE first element in mgr_reg_list */
 #ifdef CONFIG_ETH_CTRL_ENABLE
-  {
-    .name     = "eth",
+  [REG_ETH_BIT] = {
+    .name     = MGR_REG_NAME("eth"),
     .type     = REG_ETH_CTRL,
+    .subscribe= MSG_MASK_NONE,
+    .direct   = MSG_MASK_NONE,
+    .depends  = 0,
     .init_fn  = EthCtrl_Init,
     .done_fn  = EthCtrl_Done,
     .run_fn   = EthCtrl_Run,
     .send_fn  = EthCtrl_Send,
+    .direct_fn= NULL,
     .get_fn   = NULL,
   },
 #endif
 
 #ifdef CONFIG_WIFI_CTRL_ENABLE
-  {
-    .name     = "wifi",
+  [REG_WIFI_BIT] = {
+    .name     = MGR_REG_NAME("wifi"),
     .type     = REG_WIFI_CTRL,
+    .subscribe= MSG_MASK(MSG_TYPE_WIFI_SCAN_REQ) | MSG_MASK(MSG_TYPE_WIFI_CONNECT) |
+                MSG_MASK(MSG_TYPE_WIFI_DISCONNECT),
+    .direct   = MSG_MASK_NONE,
+    .depends  = REG_ETH_CTRL,
     .init_fn  = WifiCtrl_Init,
     .done_fn  = WifiCtrl_Done,
     .run_fn   = WifiCtrl_Run,
     .send_fn  = WifiCtrl_Send,
+    .direct_fn= NULL,
     .get_fn   = NULL,
   },
 #endif
 
 #ifdef CONFIG_GPIO_CTRL_ENABLE
-  {
-    .name     = "gpio",
+  [REG_GPIO_BIT] = {
+    .name     = MGR_REG_NAME("gpio"),
     .type     = REG_GPIO_CTRL,
+    .subscribe= MSG_MASK_NONE,
+    .direct   = MSG_MASK_NONE,
+    .depends  = 0,
     .init_fn  = GpioCtrl_Init,
     .done_fn  = GpioCtrl_Done,
     .run_fn   = GpioCtrl_Run,
     .send_fn  = GpioCtrl_Send,
+    .direct_fn= NULL,
     .get_fn   = NULL,
   },
 #endif
 
 #ifdef CONFIG_POWER_CTRL_ENABLE
-  {
-    .name     = "power",
+  [REG_POWER_BIT] = {
+    .name     = MGR_REG_NAME("power"),
     .type     = REG_POWER_CTRL,
+    .subscribe= MSG_MASK_NONE,
+    .direct   = MSG_MASK_NONE,
+    .depends  = 0,
     .init_fn  = PowerCtrl_Init,
     .done_fn  = PowerCtrl_Done,
     .run_fn   = PowerCtrl_Run,
     .send_fn  = PowerCtrl_Send,
+    .direct_fn= NULL,
     .get_fn   = NULL,
   },
 #endif
 
 #ifdef CONFIG_RELAY_CTRL_ENABLE
-  {
-    .name     = "relay",
+  [REG_RELAY_BIT] = {
+    .name     = MGR_REG_NAME("relay"),
     .type     = REG_RELAY_CTRL,
+    .subscribe= MSG_MASK(MSG_TYPE_MGR_UID) | MSG_MASK(MSG_TYPE_MQTT_EVENT) | MSG_MASK(MSG_TYPE_MQTT_DATA) |
+                MSG_MASK(MSG_TYPE_MQTT_DATA_LOCAL),
+    .direct   = MSG_MASK(MSG_TYPE_MQTT_DATA) | MSG_MASK(MSG_TYPE_MQTT_DATA_LOCAL),
+    .depends  = 0,
     .init_fn  = RelayCtrl_Init,
     .done_fn  = RelayCtrl_Done,
     .run_fn   = RelayCtrl_Run,
     .send_fn  = RelayCtrl_Send,
+    .direct_fn= RelayCtrl_Direct,
     .get_fn   = NULL,
   },
 #endif
 
 #ifdef CONFIG_LCD_CTRL_ENABLE
-  {
-    .name     = "lcd",
+  [REG_LCD_BIT] = {
+    .name     = MGR_REG_NAME("lcd"),
     .type     = REG_LCD_CTRL,
+    .subscribe= MSG_MASK(MSG_TYPE_MGR_UID) |
+                MSG_MASK(MSG_TYPE_ETH_EVENT) | MSG_MASK(MSG_TYPE_ETH_MAC) | MSG_MASK(MSG_TYPE_ETH_IP) |
+                MSG_MASK(MSG_TYPE_WIFI_EVENT) | MSG_MASK(MSG_TYPE_WIFI_MAC) | MSG_MASK(MSG_TYPE_WIFI_IP) |
+                MSG_MASK(MSG_TYPE_MQTT_EVENT) | MSG_MASK(MSG_TYPE_MQTT_DATA) |
+                MSG_MASK(MSG_TYPE_MQTT_DATA_LOCAL) | MSG_MASK(MSG_TYPE_LCD_DATA),
+    .direct   = MSG_MASK_NONE,
+    .depends  = 0,
     .init_fn  = LcdCtrl_Init,
     .done_fn  = LcdCtrl_Done,
     .run_fn   = LcdCtrl_Run,
     .send_fn  = LcdCtrl_Send,
+    .direct_fn= NULL,
     .get_fn   = NULL,
   },
 #endif
 
 #ifdef CONFIG_CFG_CTRL_ENABLE
-  {
-    .name     = "cfg",
+  [REG_CFG_BIT] = {
+    .name     = MGR_REG_NAME("cfg"),
     .type     = REG_CFG_CTRL,
+    .subscribe= MSG_MASK_NONE,
+    .direct   = MSG_MASK_NONE,
+    .depends  = 0,
     .init_fn  = CfgCtrl_Init,
     .done_fn  = CfgCtrl_Done,
     .run_fn   = CfgCtrl_Run,
     .send_fn  = CfgCtrl_Send,
+    .direct_fn= NULL,
     .get_fn   = NULL,
   },
 #endif
 
 #ifdef CONFIG_SYS_CTRL_ENABLE
-  {
-    .name     = "sys",
+  [REG_SYS_BIT] = {
+    .name     = MGR_REG_NAME("sys"),
     .type     = REG_SYS_CTRL,
+    .subscribe= MSG_MASK(MSG_TYPE_MGR_UID) | MSG_MASK(MSG_TYPE_ETH_EVENT) |
+                MSG_MASK(MSG_TYPE_MQTT_EVENT) | MSG_MASK(MSG_TYPE_MQTT_DATA) |
+                MSG_MASK(MSG_TYPE_SYS_INFO_REQ),
+    .direct   = MSG_MASK_NONE,
+    .depends  = 0,
     .init_fn  = SysCtrl_Init,
     .done_fn  = SysCtrl_Done,
     .run_fn   = SysCtrl_Run,
     .send_fn  = SysCtrl_Send,
+    .direct_fn= NULL,
     .get_fn   = NULL,
   },
 #endif
 
 #ifdef CONFIG_SENSOR_CTRL_ENABLE
-  {
-    .name     = "sensor",
+  [REG_SENSOR_BIT] = {
+    .name     = MGR_REG_NAME("sensor"),
     .type     = REG_SENSOR_CTRL,
+    .subscribe= MSG_MASK(MSG_TYPE_MGR_UID) | MSG_MASK(MSG_TYPE_MQTT_EVENT) | MSG_MASK(MSG_TYPE_MQTT_DATA),
+    .direct   = MSG_MASK_NONE,
+    .depends  = 0,
     .init_fn  = SensorCtrl_Init,
     .done_fn  = SensorCtrl_Done,
     .run_fn   = SensorCtrl_Run,
     .send_fn  = SensorCtrl_Send,
+    .direct_fn= NULL,
     .get_fn   = NULL,
   },
 #endif
 
 #ifdef CONFIG_TEMPLATE_CTRL_ENABLE
-  {
-    .name     = "template",
+  [REG_XXX_BIT] = {
+    .name     = MGR_REG_NAME("template"),
     .type     = REG_XXX_CTRL,
+    .subscribe= MSG_MASK(MSG_TYPE_MGR_UID) | MSG_MASK(MSG_TYPE_MQTT_EVENT) | MSG_MASK(MSG_TYPE_MQTT_DATA),
+    .direct   = MSG_MASK_NONE,
+    .depends  = 0,
     .init_fn  = TemplateCtrl_Init,
     .done_fn  = TemplateCtrl_Done,
     .run_fn   = TemplateCtrl_Run,
     .send_fn  = TemplateCtrl_Send,
+    .direct_fn= NULL,
     .get_fn   = NULL,
   },
 #endif
 
 #ifdef CONFIG_CLI_CTRL_ENABLE
-  {
-    .name     = "cli",
+  [REG_CLI_BIT] = {
+    .name     = MGR_REG_NAME("cli"),
     .type     = REG_CLI_CTRL,
+    .subscribe= MSG_MASK_NONE,
+    .direct   = MSG_MASK_NONE,
+    .depends  = 0,
     .init_fn  = CliCtrl_Init,
     .done_fn  = CliCtrl_Done,
     .run_fn   = CliCtrl_Run,
     .send_fn  = CliCtrl_Send,
+    .direct_fn= NULL,
     .get_fn   = NULL,
   },
 #endif
 
 #ifdef CONFIG_MQTT_CTRL_ENABLE
-  /* MQTT Controller MUST BE last element in mgr_reg_list */
-  {
-    .name     = "mqtt",
+  [REG_MQTT_BIT] = {
+    .name     = MGR_REG_NAME("mqtt"),
     .type     = REG_MQTT_CTRL | REG_INT_CTRL,
+    .subscribe= MSG_MASK(MSG_TYPE_MGR_UID) |
+                MSG_MASK(MSG_TYPE_MQTT_START) | MSG_MASK(MSG_TYPE_MQTT_STOP) |
+                MSG_MASK(MSG_TYPE_MQTT_EVENT) | MSG_MASK(MSG_TYPE_MQTT_DATA) |
+                MSG_MASK(MSG_TYPE_MQTT_PUBLISH) | MSG_MASK(MSG_TYPE_MQTT_SUBSCRIBE) |
+                MSG_MASK(MSG_TYPE_MQTT_SUBSCRIBE_LIST),
+    .direct   = MSG_MASK_NONE,
+    .depends  = REG_ETH_CTRL | REG_WIFI_CTRL,
+    .restart  = MGR_SUP_RESTART,
     .init_fn  = MqttCtrl_Init,
     .done_fn  = MqttCtrl_Done,
     .run_fn   = MqttCtrl_Run,
     .send_fn  = MqttCtrl_Send,
-    .get_fn   = NULL,
+    .direct_fn= NULL,
+    .get_fn   = MqttCtrl_GetData,
   },
 #endif
 };
 
+/**
+ * Init/run order of the modules (done runs backwards). Bits of modules which are
+ * not built are skipped. With CONFIG_MGR_BOOT_WORKERS a module may start before
+ * the ones listed ahead of it, unless its `.depends` names them.
+ *
+ * ETH Controller MUST BE first element in mgr_reg_order
+ * MQTT Controller MUST BE last element in mgr_reg_order
+ */
+static const uint8_t mgr_reg_order[] = {
+  REG_ETH_BIT,
+  REG_WIFI_BIT,
+  REG_GPIO_BIT,
+  REG_POWER_BIT,
+  REG_RELAY_BIT,
+  REG_LCD_BIT,
+  REG_CFG_BIT,
+  REG_SYS_BIT,
+  REG_SENSOR_BIT,
+  REG_XXX_BIT,
+  REG_CLI_BIT,
+  REG_MQTT_BIT,
+};
+
+#define MGR_REG_ORDER_CNT   (sizeof(mgr_reg_order)/sizeof(mgr_reg_order[0]))
+
 
 #endif /* __MGR_REG_LIST_H__ */
@@ -0,0 +1,95 @@
+/**
+ * @file mgr_sup.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Module supervisor: liveness heartbeats, fault reports and hot restarts
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Every message a module task finishes is a heartbeat (`MGR_Heartbeat()`, done by
+ * the executor for its units). The manager counts what it hands to send_fn, so a
+ * module is stalled when it holds work it has not finished and has not beaten for
+ * `CONFIG_MGR_SUP_STALL_MS`. An idle module is never stalled, however long it waits,
+ * and a module which never beat is not checked for stalls.
+ *
+ * A module reports a fault it cannot recover from itself with `MGR_ReportFault()`,
+ * from any task. What follows is the `restart` policy of its `mgr_reg_t`:
+ *
+ *   MGR_SUP_NONE     log and count only (the default)
+ *   MGR_SUP_RESTART  done_fn / init_fn / run_fn of that module alone, on the manager
+ *                    task, after a back-off which doubles with every restart in a
+ *                    row; more than `CONFIG_MGR_SUP_RESTART_MAX` in a row reboot
+ *   MGR_SUP_REBOOT   reboot at once
+ *
+ * A stalled task cannot be stopped (its done_fn would wait for it forever), so a
+ * stall of a module with a RESTART or REBOOT policy reboots as well.
+ */
+
+#ifndef __MGR_SUP_H__
+#define __MGR_SUP_H__
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "freertos/FreeRTOS.h"
+
+#include "mgr_ctrl.h"
+
+
+/**
+ * Restarts the module in mgr_reg_list slot @p idx: done_fn, init_fn and run_fn.
+ */
+typedef esp_err_t (*mgrsup_restart_f)(int idx);
+
+
+/**
+ * @brief Watch the module in slot @p idx with @p policy (from `mgr_BuildRoute()`).
+ */
+void mgrsup_Watch(int idx, mgr_sup_policy_e policy);
+
+/**
+ * @brief Count one message accepted by the send_fn of slot @p idx. Manager task only.
+ */
+void mgrsup_Delivered(int idx);
+
+/**
+ * @brief False while the module of slot @p idx is stopped by a failed restart.
+ */
+bool mgrsup_IsUp(int idx);
+
+/**
+ * @brief One message finished by @p module_type (REG_*_CTRL); any task.
+ */
+void mgrsup_Heartbeat(uint32_t module_type);
+
+/**
+ * @brief Record a fault of @p module_type; @p reason must be a string literal. Any task.
+ *
+ * @return ESP_ERR_INVALID_ARG when @p module_type is not a single watched module.
+ */
+esp_err_t mgrsup_Fault(uint32_t module_type, const char* reason);
+
+/**
+ * @brief Ask for a restart of @p module_type, ignoring its policy and back-off. Any task.
+ */
+esp_err_t mgrsup_Restart(uint32_t module_type);
+
+/**
+ * @brief Ticks until the next stall check or scheduled restart, portMAX_DELAY if none.
+ */
+TickType_t mgrsup_GetWaitTicks(void);
+
+/**
+ * @brief Handle reported faults, scheduled restarts and stalls. Manager task only.
+ */
+void mgrsup_Check(mgrsup_restart_f restart);
+
+/**
+ * @brief Copy the counters of up to @p max watched modules into @p stats; returns the number written.
+ */
+uint32_t mgrsup_GetStats(mgr_sup_stats_t* stats, uint32_t max);
+
+#endif /* __MGR_SUP_H__ */
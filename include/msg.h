@@ -12,6 +12,10 @@
 #ifndef __MSG_H__
 #define __MSG_H__
 
+#include <stdint.h>
+
+#include "msg_schema.h"
+
 
 /*
 ==================================================================
@@ -19,81 +23,67 @@
 ==================================================================
 */
 
-/* Message type definition */
+/* Message type definition, one entry per MSG_TYPE_SCHEMA() line (msg_schema.h) */
+#define MSG_TYPE_ENUM(_name, _size)   MSG_TYPE_##_name,
+
 typedef enum {
-  /* Control signals for all modules */
-  MSG_TYPE_INIT,
-  MSG_TYPE_DONE,
-  MSG_TYPE_RUN,
-
-  /* MGR module */
-  MSG_TYPE_MGR_LIST,
-  MSG_TYPE_MGR_UID,
-
-  /* ETH module */
-  MSG_TYPE_ETH_EVENT,
-  MSG_TYPE_ETH_MAC,
-  MSG_TYPE_ETH_IP,
-
-  /* WiFi module */
-  MSG_TYPE_WIFI_EVENT,
-  MSG_TYPE_WIFI_IP,
-  MSG_TYPE_WIFI_MAC,
-  MSG_TYPE_WIFI_SCAN_REQ,
-  MSG_TYPE_WIFI_SCAN_RESULT,
-  MSG_TYPE_WIFI_CONNECT,
-  MSG_TYPE_WIFI_DISCONNECT,
-  MSG_TYPE_WIFI_CTRL_GOT_IP, /* wifi_ctrl worker queue only: defer STA IP/MAC publish from IP_EVENT */
-
-  /* MQTT module */
-  MSG_TYPE_MQTT_START,
-  MSG_TYPE_MQTT_STOP,
-  MSG_TYPE_MQTT_EVENT,
-  MSG_TYPE_MQTT_DATA,
-  MSG_TYPE_MQTT_PUBLISH,
-  MSG_TYPE_MQTT_SUBSCRIBE,
-  MSG_TYPE_MQTT_SUBSCRIBE_LIST,
-
-  /* Sensors module */
-  MSG_TYPE_SENSORS,
-
-  /* LCD module */
-  MSG_TYPE_LCD_DATA,
+  MSG_TYPE_SCHEMA(MSG_TYPE_ENUM)
 
+  /* Number of message types, keep it last */
+  MSG_TYPE_MAX
 } msg_type_e;
 
+/* Set of message types, one bit per msg_type_e (see mgr_reg_t.subscribe) */
+typedef uint64_t msg_mask_t;
+
+#define MSG_MASK(_type)   ((msg_mask_t) 1 << (_type))
+#define MSG_MASK_NONE     ((msg_mask_t) 0)
+#define MSG_MASK_ALL      (~(msg_mask_t) 0)
+
+/*
+ * Coalescing key of a state message (msg_t.key). A newer message with the same
+ * type, from, to and key replaces one still waiting in a queue (last writer wins).
+ */
+#define MSG_KEY_NONE      (0U)
+#define MSG_KEY(_id)      ((uint32_t) (_id) + 1U)
+
+/* Correlation id (msg_t.call) of a message which is not part of an MGR_Call() */
+#define MSG_CALL_NONE     (0U)
+
+/*
+ * Time to live (msg_t.ttl_ms) in ms since the message entered the bus. A message
+ * still waiting when it runs out is dropped before it is parsed. MSG_TTL_NONE
+ * uses the default of the type (msgpool_SetTtl()), which is "never" for most.
+ */
+#define MSG_TTL_NONE      (0U)
+
 /* ETH state definition */
+#define DATA_ETH_EVENT_ENUM(_name)    DATA_ETH_EVENT_##_name,
+
 typedef enum {
-  DATA_ETH_EVENT_START,
-  DATA_ETH_EVENT_STOP,
-  DATA_ETH_EVENT_CONNECTED,
-  DATA_ETH_EVENT_DISCONNECTED,
+  DATA_ETH_EVENT_SCHEMA(DATA_ETH_EVENT_ENUM)
 } data_eth_event_e;
 
+#define DATA_ETH_EVENT_CNT    (0U DATA_ETH_EVENT_SCHEMA(MSG_SCHEMA_COUNT))
+
 /* WiFi state definition (application-level, sent to the manager) */
+#define DATA_WIFI_EVENT_ENUM(_name)   DATA_WIFI_EVENT_##_name,
+
 typedef enum {
-  DATA_WIFI_EVENT_STA_START,
-  DATA_WIFI_EVENT_STA_STOP,
-  DATA_WIFI_EVENT_SCAN_FAILED,
-  DATA_WIFI_EVENT_CONNECTED,
-  DATA_WIFI_EVENT_DISCONNECTED,
+  DATA_WIFI_EVENT_SCHEMA(DATA_WIFI_EVENT_ENUM)
 } data_wifi_event_e;
 
+#define DATA_WIFI_EVENT_CNT   (0U DATA_WIFI_EVENT_SCHEMA(MSG_SCHEMA_COUNT))
+
 /* MQTT state definition */
+#define DATA_MQTT_EVENT_ENUM(_name)   DATA_MQTT_EVENT_##_name,
+
 typedef enum {
-  DATA_MQTT_EVENT_ANY,
-  DATA_MQTT_EVENT_ERROR,
-  DATA_MQTT_EVENT_CONNECTED,
-  DATA_MQTT_EVENT_DISCONNECTED,
-  DATA_MQTT_EVENT_SUBSCRIBED,
-  DATA_MQTT_EVENT_UNSUBSCRIBED,
-  DATA_MQTT_EVENT_PUBLISHED,
-  DATA_MQTT_EVENT_DATA,
-  DATA_MQTT_EVENT_BEFORE_CONNECT,
-  DATA_MQTT_EVENT_DELETED,
-  DATA_MQTT_EVENT_USER,
+  DATA_MQTT_EVENT_SCHEMA(DATA_MQTT_EVENT_ENUM)
 } data_mqtt_event_e;
 
+#define DATA_MQTT_EVENT_CNT   (0U DATA_MQTT_EVENT_SCHEMA(MSG_SCHEMA_COUNT))
+
 
 /*
 ==================================================================
@@ -104,47 +94,75 @@ typedef enum {
 /* ----------[ALL bits]----------- */
 #define REG_ALL_CTRL      (~0)
 
+/* Number of module bits, also the size of the registry table indexed by bit (mgr_reg_list.h) */
+#define REG_BIT_MAX       32
+
 /* [1st byte]==========[8 bits]============= */
-#define REG_MGR_CTRL      (1 << 0)
-#define REG_ETH_CTRL      (1 << 1)
-#define REG_MQTT_CTRL     (1 << 2)
-#define REG_WIFI_CTRL     (1 << 3)
-//#define REG_XXX_CTRL      (1 << 4)
-//#define REG_XXX_CTRL      (1 << 5)
-//#define REG_XXX_CTRL      (1 << 6)
-//#define REG_XXX_CTRL      (1 << 7)
+#define REG_MGR_BIT       0
+#define REG_ETH_BIT       1
+#define REG_MQTT_BIT      2
+#define REG_WIFI_BIT      3
+//#define REG_XXX_BIT       4
+//#define REG_XXX_BIT       5
+//#define REG_XXX_BIT       6
+//#define REG_XXX_BIT       7
 
 /* [2nd byte]==========[8 bits]============= */
-#define REG_GPIO_CTRL     (1 << 8)
-#define REG_POWER_CTRL    (1 << 9)
-#define REG_RELAY_CTRL    (1 << 10)
-#define REG_LCD_CTRL      (1 << 11)
-//#define REG_XXX_CTRL      (1 << 12)
-//#define REG_XXX_CTRL      (1 << 13)
-//#define REG_XXX_CTRL      (1 << 14)
-//#define REG_XXX_CTRL      (1 << 15)
+#define REG_GPIO_BIT      8
+#define REG_POWER_BIT     9
+#define REG_RELAY_BIT     10
+#define REG_LCD_BIT       11
+//#define REG_XXX_BIT       12
+//#define REG_XXX_BIT       13
+//#define REG_XXX_BIT       14
+//#define REG_XXX_BIT       15
 
 /* [3rd byte]==========[8 bits]============= */
-#define REG_CFG_CTRL      (1 << 16)
-#define REG_SYS_CTRL      (1 << 17)
-#define REG_CLI_CTRL      (1 << 18)
-//#define REG_XXX_CTRL      (1 << 19)
-//#define REG_XXX_CTRL      (1 << 20)
-//#define REG_XXX_CTRL      (1 << 21)
-#define REG_SENSOR_CTRL   (1 << 22)
-#define REG_XXX_CTRL      (1 << 23) /* Only for using TemplateCtrl module as example */
+#define REG_CFG_BIT       16
+#define REG_SYS_BIT       17
+#define REG_CLI_BIT       18
+//#define REG_XXX_BIT       19
+//#define REG_XXX_BIT       20
+//#define REG_XXX_BIT       21
+#define REG_SENSOR_BIT    22
+#define REG_XXX_BIT       23  /* Only for using TemplateCtrl module as example */
 
 /* [4th byte]==========[8 bits]============= */
 /*   Control bits                            */
-//#define REG_XXX_CTRL    (1 << 24)
-//#define REG_XXX_CTRL    (1 << 25)
-//#define REG_XXX_CTRL    (1 << 26)
-//#define REG_XXX_CTRL    (1 << 27)
-//#define REG_XXX_CTRL    (1 << 28)
-//#define REG_XXX_CTRL    (1 << 29)
+//#define REG_XXX_BIT       24
+//#define REG_XXX_BIT       25
+//#define REG_XXX_BIT       26
+//#define REG_XXX_BIT       27
+//#define REG_XXX_BIT       28
+//#define REG_XXX_BIT       29
 
 /* Can't communicate with them from the outside */
-#define REG_INT_CTRL    (1 << 30)   /* Internal Controller  */
+#define REG_INT_BIT       30  /* Internal Controller  */
+
+#define REG_MGR_CTRL      (1 << REG_MGR_BIT)
+#define REG_ETH_CTRL      (1 << REG_ETH_BIT)
+#define REG_MQTT_CTRL     (1 << REG_MQTT_BIT)
+#define REG_WIFI_CTRL     (1 << REG_WIFI_BIT)
+#define REG_GPIO_CTRL     (1 << REG_GPIO_BIT)
+#define REG_POWER_CTRL    (1 << REG_POWER_BIT)
+#define REG_RELAY_CTRL    (1 << REG_RELAY_BIT)
+#define REG_LCD_CTRL      (1 << REG_LCD_BIT)
+#define REG_CFG_CTRL      (1 << REG_CFG_BIT)
+#define REG_SYS_CTRL      (1 << REG_SYS_BIT)
+#define REG_CLI_CTRL      (1 << REG_CLI_BIT)
+#define REG_SENSOR_CTRL   (1 << REG_SENSOR_BIT)
+#define REG_XXX_CTRL      (1 << REG_XXX_BIT)
+#define REG_INT_CTRL      (1 << REG_INT_BIT)
+
+/* Every bit above used once: the sum of distinct powers of 2 equals their OR */
+_Static_assert(((uint64_t) REG_MGR_CTRL + REG_ETH_CTRL + REG_MQTT_CTRL + REG_WIFI_CTRL +
+                REG_GPIO_CTRL + REG_POWER_CTRL + REG_RELAY_CTRL + REG_LCD_CTRL +
+                REG_CFG_CTRL + REG_SYS_CTRL + REG_CLI_CTRL + REG_SENSOR_CTRL + REG_XXX_CTRL +
+                REG_INT_CTRL) ==
+               (uint64_t) (REG_MGR_CTRL | REG_ETH_CTRL | REG_MQTT_CTRL | REG_WIFI_CTRL |
+                REG_GPIO_CTRL | REG_POWER_CTRL | REG_RELAY_CTRL | REG_LCD_CTRL |
+                REG_CFG_CTRL | REG_SYS_CTRL | REG_CLI_CTRL | REG_SENSOR_CTRL | REG_XXX_CTRL |
+                REG_INT_CTRL), "Two modules share a REG_*_BIT");
 
 /* ----------[END]---------------- */
 
@@ -232,18 +250,27 @@ typedef struct {
 
 } payload_power_t;
 
-/* MQTT data definition */
+/* MQTT data definition (MSG_TYPE_MQTT_PUBLISH, MSG_TYPE_MQTT_DATA_LOCAL) */
 typedef struct {
   data_topic_t  topic;
   data_msg_t    msg;
 } data_mqtt_data_t;
 
+/* MQTT data from the broker (MSG_TYPE_MQTT_DATA): topic and message live in a bus buffer (msg_buf.h) */
+typedef struct {
+  const char*   topic;    /* terminated */
+  const char*   msg;      /* terminated */
+  uint32_t      msg_len;
+  void*         buf;      /* msgbuf_Alloc() buffer, freed by the pool with the last reference */
+} data_mqtt_in_t;
+
 /* MQTT message payload */
 typedef struct {
   union {
     data_mqtt_event_e event_id;
     data_topic_t      topic;
     data_mqtt_data_t  data;
+    data_mqtt_in_t    in;
     data_json_t       json;
   } u;
 } payload_mqtt_t;
@@ -261,6 +288,24 @@ typedef struct {
   uint32_t d_uint32[8];
 } payload_lcd_t;
 
+/* System state, answer to MSG_TYPE_SYS_INFO_REQ */
+typedef struct {
+  uint32_t  uptime_s;
+  uint32_t  heap_free;
+  uint32_t  heap_min;     /* lowest free heap since boot */
+  uint32_t  time;         /* Unix time of the system clock */
+  uint8_t   synced;       /* 1 once NTP set the clock */
+  data_uid_t uid;
+} data_sys_info_t;
+
+/* MSG_TYPE_MGR_REPLY payload, the member of `u` depends on the request type */
+typedef struct {
+  int32_t   result;       /* esp_err_t of the responder */
+  union {
+    data_sys_info_t sys;
+  } u;
+} payload_reply_t;
+
 /**
  * @brief Message structure
  * 
@@ -269,6 +314,9 @@ typedef struct {
   msg_type_e      type;
   uint32_t        from;
   uint32_t        to;
+  uint32_t        key;  /* coalescing key, MSG_KEY(id) for state snapshots, MSG_KEY_NONE otherwise */
+  uint32_t        call; /* correlation id of an MGR_Call() request and its reply, MSG_CALL_NONE otherwise */
+  uint32_t        ttl_ms; /* drop when older than this on the bus, MSG_TTL_NONE for the type default */
   union {
     payload_mgr_t     mgr;
     payload_eth_t     eth;
@@ -278,6 +326,7 @@ typedef struct {
     payload_power_t   power;
     payload_mqtt_t    mqtt;
     payload_lcd_t     lcd;
+    payload_reply_t   reply;
     payload_error_t   error;
   } payload;
 } msg_t;
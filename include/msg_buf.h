@@ -0,0 +1,79 @@
+/**
+ * @file msg_buf.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Bounded pool of data buffers which travel on the bus by reference
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * A message slot holds at most one `msg_t`; inbound MQTT data can be far larger
+ * (configuration commands). Such data is built in a buffer of this pool and the
+ * message only carries a reference to it (`data_mqtt_in_t`). The buffer belongs
+ * to the message: the pool frees it together with the slot of the last
+ * reference (`msgpool_Release()`), so consumers never free it themselves.
+ *
+ * CONFIG_MGR_MSG_BUF_COUNT buffers of CONFIG_MGR_MSG_BUF_SIZE bytes are
+ * reserved at build time; nothing is taken from the heap.
+ */
+
+#ifndef __MSG_BUF_H__
+#define __MSG_BUF_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "msg.h"
+
+
+/** @brief Buffer pool counters (see `msgbuf_GetStats()`). */
+typedef struct {
+  uint32_t size;          /**< Bytes per buffer, the largest message with its topic. */
+  uint32_t buffers;       /**< Pool capacity. */
+  uint32_t in_use;        /**< Buffers held by messages right now. */
+  uint32_t in_use_max;    /**< High-water mark of `in_use`. */
+  uint32_t allocs;        /**< Buffers handed out since boot. */
+  uint32_t alloc_fail;    /**< Requests which found the pool empty. */
+  uint32_t too_big;       /**< Requests larger than `size`. */
+} msgbuf_stats_t;
+
+
+esp_err_t msgbuf_Init(void);
+
+/**
+ * @brief Bytes of one buffer.
+ */
+size_t msgbuf_GetSize(void);
+
+/**
+ * @brief Take a buffer which holds at least @p size bytes.
+ *
+ * Safe to call from any task.
+ *
+ * @return Buffer or NULL when @p size is too large or the pool is empty.
+ */
+void* msgbuf_Alloc(size_t size);
+
+/**
+ * @brief Return @p buf to the pool; NULL and pointers not taken from it are ignored.
+ */
+void msgbuf_Free(const void* buf);
+
+/**
+ * @brief Take a buffer for the inbound MQTT data @p data and lay it out.
+ *
+ * The buffer gets the topic (@p topic_len bytes, need not be terminated) and room
+ * for @p msg_size bytes of message, terminator included, behind it; `topic`,
+ * `msg` and `buf` of @p data point into it. The caller writes the message,
+ * terminates it and sets `msg_len`.
+ *
+ * @return Message area (@p msg_size bytes) or NULL when no buffer could be taken.
+ */
+char* msgbuf_NewMqttData(data_mqtt_in_t* data, const char* topic, size_t topic_len, size_t msg_size);
+
+void msgbuf_GetStats(msgbuf_stats_t* stats);
+
+#endif /* __MSG_BUF_H__ */
@@ -0,0 +1,65 @@
+/**
+ * @file msg_codec.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Payload size per message type and a flat encoding of msg_t
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Sizes come from the `_size` column of MSG_TYPE_SCHEMA() (msg_schema.h). The
+ * pool copies header + payload size of a type into its slot, so a message which
+ * carries no payload costs the header only.
+ *
+ * Encoding: the six header fields as little endian u32 (type, from, to, key,
+ * call, ttl_ms), followed by exactly the payload size of the type. The payload
+ * is copied as laid out in memory, so both ends must share the ABI of msg.h
+ * (e.g. a dump decoded by the same firmware). A type which needs a portable
+ * layout gets its own case in msgcodec_Encode() / msgcodec_Decode().
+ * MSG_TYPE_MQTT_DATA carries a reference to its buffer (msg_buf.h), not the text.
+ */
+
+#ifndef __MSG_CODEC_H__
+#define __MSG_CODEC_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "msg.h"
+
+
+/** Encoded header: type, from, to, key, call, ttl_ms. */
+#define MSG_CODEC_HEADER_SIZE   (6U * sizeof(uint32_t))
+
+/** Largest encoded message. */
+#define MSG_CODEC_MAX_SIZE      (MSG_CODEC_HEADER_SIZE + sizeof(((msg_t*) 0)->payload))
+
+
+/**
+ * @brief Payload bytes of a message of @p type, 0 for an unknown type.
+ */
+size_t msgcodec_GetPayloadSize(msg_type_e type);
+
+/**
+ * @brief Encode @p msg into @p buf.
+ *
+ * @param len  Bytes written: MSG_CODEC_HEADER_SIZE + payload size of the type.
+ * @return ESP_ERR_INVALID_ARG for an unknown type, ESP_ERR_INVALID_SIZE when
+ *         @p size is too small.
+ */
+esp_err_t msgcodec_Encode(const msg_t* msg, uint8_t* buf, size_t size, size_t* len);
+
+/**
+ * @brief Decode @p len bytes of @p buf into @p msg; payload bytes past the size
+ *        of the type are cleared.
+ *
+ * @return ESP_ERR_INVALID_ARG for an unknown type, ESP_ERR_INVALID_SIZE when
+ *         @p len does not match the type.
+ */
+esp_err_t msgcodec_Decode(const uint8_t* buf, size_t len, msg_t* msg);
+
+
+#endif /* __MSG_CODEC_H__ */
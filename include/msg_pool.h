@@ -0,0 +1,275 @@
+/**
+ * @file msg_pool.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Reference-counted message pool shared by the manager and module queues
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Queues on the bus carry `msg_t*` handles instead of `msg_t` values. A message is
+ * copied once, when it first enters the bus, into a slot of a fixed-size pool; every
+ * further hop (manager queue, fan-out to module queues) only takes a reference.
+ * The last consumer to call `msgpool_Release()` returns the slot to the pool.
+ *
+ * Slots come in two size classes. Control and state messages fit in a small slot
+ * (header + largest non-MQTT payload); only MQTT publish/JSON messages take a large
+ * slot (full `msg_t`). Inbound MQTT data is small as well: its payload is a
+ * reference to a buffer of msg_buf.h, which the pool frees with the slot. A handle into a small slot is still read through `msg_t*`,
+ * so consumers must only touch the payload member selected by `type`.
+ *
+ * Producers keep calling `MGR_Send()` / `send_fn()` with any `const msg_t*`
+ * (stack or pooled): `msgpool_Post()` tells them apart by address.
+ */
+
+#ifndef __MSG_POOL_H__
+#define __MSG_POOL_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#include "msg.h"
+
+
+/** Bytes of `msg_t` in front of the payload union (type, from, to). */
+#define MSG_HEADER_SIZE         (offsetof(msg_t, payload))
+
+/** Small class: header + largest payload apart from MQTT publish/JSON (Wi-Fi connect). */
+#define MSG_SMALL_SIZE          (MSG_HEADER_SIZE + sizeof(payload_wifi_t))
+/** Large class: the whole `msg_t`. */
+#define MSG_LARGE_SIZE          (sizeof(msg_t))
+
+typedef enum {
+  MSGPOOL_CLASS_SMALL,
+  MSGPOOL_CLASS_LARGE,
+
+  MSGPOOL_CLASS_MAX
+} msgpool_class_e;
+
+/** Max number of queues tracked for `msgpool_LogMemory()` (one per module + manager). */
+#define MSGPOOL_QUEUE_MAX       (16U)
+
+/** Max number of keyed messages per queue which later updates can replace. */
+#define MSGPOOL_MERGE_MAX       (4U)
+
+/** Max number of distinct (producer, queue) pairs with drop counters. */
+#define MSGPOOL_DROP_MAX        (16U)
+
+/**
+ * @brief What `msgpool_Post()` does when the target queue is full, chosen per message type.
+ */
+typedef enum {
+  MSGPOOL_POLICY_DROP_NEWEST,   /**< Reject the new message (default). */
+  MSGPOOL_POLICY_DROP_OLDEST,   /**< Discard the head of the queue if it has the same policy, then retry. */
+  MSGPOOL_POLICY_BLOCK,         /**< Wait up to `CONFIG_MGR_MSG_BLOCK_MS` for room. */
+  MSGPOOL_POLICY_COALESCE,      /**< State type: keyed by type alone (see `msgpool_GetKey()`), else drop-newest. */
+
+  MSGPOOL_POLICY_MAX
+} msgpool_policy_e;
+
+
+/** @brief Counters of one size class. */
+typedef struct {
+  uint32_t slot_size;     /**< Bytes per slot. */
+  uint32_t slots;         /**< Class capacity. */
+  uint32_t in_use;        /**< Slots currently referenced. */
+  uint32_t in_use_max;    /**< High-water mark of `in_use`. */
+  uint32_t alloc_fail;    /**< Allocations that found this class empty. */
+} msgpool_class_stats_t;
+
+/**
+ * @brief Pool counters (see `msgpool_GetStats()`).
+ *
+ * `posts` counts queue hops. With the by-value bus each hop moved `sizeof(msg_t)`
+ * into the queue and again out of it; with the pool only `copies` move a message
+ * (`copy_bytes`, header + payload of its type) and each hop moves two pointers.
+ */
+typedef struct {
+  msgpool_class_stats_t cls[MSGPOOL_CLASS_MAX];
+  uint32_t posts;         /**< Queue hops (successful or not). */
+  uint32_t copies;        /**< Messages copied into a pool slot. */
+  uint32_t copy_bytes;    /**< Bytes copied into pool slots. */
+  uint32_t shares;        /**< Hops served by taking a reference (no copy). */
+  uint32_t no_slot;       /**< Posts dropped because no class had a free slot. */
+  uint32_t dropped;       /**< Messages lost: queue full or pool empty (see `msgpool_GetDrops()`). */
+  uint32_t coalesced;     /**< Posts merged into a message still waiting in the queue. */
+  uint32_t expired;       /**< Messages dropped by a consumer because their TTL ran out (see `msgpool_IsExpired()`). */
+} msgpool_stats_t;
+
+/** @brief RAM used by one bus queue (see `msgpool_GetQueueInfo()`). */
+typedef struct {
+  const char* name;
+  uint32_t    depth;      /**< Queue length in items. */
+  uint32_t    waiting;    /**< Items waiting right now. */
+  uint32_t    hwm;        /**< High-water mark of `waiting`. */
+  uint32_t    dropped;    /**< Messages this queue did not take. */
+  uint32_t    coalesced;  /**< Posts merged into a waiting message. */
+  uint32_t    bytes;      /**< Queue storage + control block. */
+  uint32_t    bytes_by_value; /**< Same queue holding `msg_t` values. */
+} msgpool_queue_info_t;
+
+/** @brief Messages of one producer lost on one queue (see `msgpool_GetDrops()`). */
+typedef struct {
+  uint32_t    from;       /**< `msg.from` of the lost messages. */
+  const char* to;         /**< Name of the queue which did not take them. */
+  uint32_t    count;
+} msgpool_drop_info_t;
+
+
+esp_err_t msgpool_Init(void);
+
+/**
+ * @brief Bytes of a message of @p type: header + payload size of the type (msg_schema.h).
+ */
+size_t msgpool_GetMsgSize(msg_type_e type);
+
+/**
+ * @brief Create a bus queue of @p depth handles and track it in the RAM report.
+ *
+ * @param name  Short label shown by `msgpool_LogMemory()` (module name).
+ * @param depth Queue length.
+ * @return Queue handle or NULL.
+ */
+QueueHandle_t msgpool_CreateQueue(const char* name, UBaseType_t depth);
+
+/**
+ * @brief Release every handle still waiting in @p queue and delete it.
+ */
+void msgpool_DeleteQueue(QueueHandle_t queue);
+
+/**
+ * @brief Check whether @p msg is a handle owned by the pool.
+ */
+bool msgpool_IsPooled(const msg_t* msg);
+
+/**
+ * @brief Enqueue @p msg as a pooled handle.
+ *
+ * A pooled @p msg gains one reference; any other @p msg is copied into a slot of
+ * the smallest class that fits its type (falling back to a larger class).
+ * On failure the reference taken here is dropped again, so the caller keeps
+ * ownership of whatever it passed in.
+ *
+ * @param queue Queue created by `msgpool_CreateQueue()`.
+ * A keyed message (`msgpool_GetKey()`) replaces the waiting message with the same
+ * type, from, to and key, without taking another queue entry. Otherwise the
+ * backpressure policy of the message type (`msgpool_SetPolicy()`) decides what
+ * happens when @p queue is full. Every message lost is counted per
+ * (`msg.from`, queue) pair.
+ *
+ * A message which is not pooled hands its buffer (`data_mqtt_in_t.buf`) over in
+ * every case: it goes with the copy, or is freed when the post fails.
+ *
+ * @param msg   Message to post.
+ * @param wait  Ticks to wait for space in @p queue (raised to the block time for MSGPOOL_POLICY_BLOCK).
+ * @return ESP_OK (also when coalesced), ESP_ERR_NO_MEM if the pool is empty, ESP_FAIL if the queue is full.
+ */
+esp_err_t msgpool_Post(QueueHandle_t queue, const msg_t* msg, TickType_t wait);
+
+/**
+ * @brief `msgpool_Post()` which never waits, whatever the policy of the type.
+ *
+ * For a task posting to a queue only it drains (the manager on its own lanes):
+ * waiting there for MSGPOOL_POLICY_BLOCK would stall it for the whole block time
+ * and still end in a drop.
+ */
+esp_err_t msgpool_PostNoWait(QueueHandle_t queue, const msg_t* msg);
+
+/**
+ * @brief Take the next handle from @p queue, the counterpart of `msgpool_Post()`.
+ *
+ * Consumers must use it instead of `xQueueReceive()`: for a keyed message it
+ * returns the newest version posted while it was waiting.
+ *
+ * @return ESP_OK or ESP_ERR_TIMEOUT.
+ */
+esp_err_t msgpool_Receive(QueueHandle_t queue, msg_t** msg, TickType_t wait);
+
+/**
+ * @brief Coalescing key of @p msg or MSG_KEY_NONE.
+ *
+ * `msg.key` when set by the producer; otherwise derived from the type: link
+ * connected/disconnected events share one key, LCD updates are keyed by their
+ * field mask, and types with MSGPOOL_POLICY_COALESCE have a single key.
+ */
+uint32_t msgpool_GetKey(const msg_t* msg);
+
+esp_err_t msgpool_SetPolicy(msg_type_e type, msgpool_policy_e policy);
+msgpool_policy_e msgpool_GetPolicy(msg_type_e type);
+
+/**
+ * @brief Set the default time to live of @p type in ms, 0 for never; used when `msg.ttl_ms` is MSG_TTL_NONE.
+ */
+esp_err_t msgpool_SetTtl(msg_type_e type, uint32_t ttl_ms);
+uint32_t msgpool_GetTtl(msg_type_e type);
+
+/**
+ * @brief Check whether @p msg outlived its time to live; counts it per type when it did.
+ *
+ * Consumers call it on every handle they receive, before parsing it, and only
+ * release an expired one. The age is taken from `msgpool_GetStamp()`, so a
+ * message which is not pooled or has no TTL never expires, and neither do the
+ * lifecycle types (INIT, DONE, RUN).
+ */
+bool msgpool_IsExpired(const msg_t* msg);
+
+/**
+ * @brief Messages of @p type dropped as expired, one per consumer which dropped it.
+ */
+uint32_t msgpool_GetExpired(msg_type_e type);
+
+/**
+ * @brief Drop one reference taken by `msgpool_Post()`; frees the slot, and its buffer, on the last one.
+ *
+ * Call once for every handle received from a pooled queue. Non-pooled pointers are ignored.
+ */
+void msgpool_Release(const msg_t* msg);
+
+/**
+ * @brief Time (`esp_timer_get_time()`, us) when @p msg was copied into the pool.
+ *
+ * Shared hops keep the original time, so `now - stamp` is the age of the message on the bus.
+ *
+ * @return Timestamp or 0 if @p msg is not a pooled handle.
+ */
+int64_t msgpool_GetStamp(const msg_t* msg);
+
+/**
+ * @brief Release every handle still waiting in @p queue without deleting it.
+ */
+void msgpool_Drain(QueueHandle_t queue);
+
+void msgpool_GetStats(msgpool_stats_t* stats);
+
+/**
+ * @brief Copy up to @p max entries of the queue RAM table into @p info.
+ *
+ * @return Number of entries written.
+ */
+uint32_t msgpool_GetQueueInfo(msgpool_queue_info_t* info, uint32_t max);
+
+/**
+ * @brief Copy up to @p max (producer, queue) drop counters into @p info.
+ *
+ * @return Number of entries written.
+ */
+uint32_t msgpool_GetDrops(msgpool_drop_info_t* info, uint32_t max);
+
+/**
+ * @brief Log the pool counters and the bytes moved compared to the by-value bus.
+ */
+void msgpool_LogStats(void);
+
+/**
+ * @brief Log RAM per bus queue and per pool class, next to what by-value queues would take.
+ */
+void msgpool_LogMemory(void);
+
+#endif /* __MSG_POOL_H__ */
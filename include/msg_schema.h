@@ -0,0 +1,102 @@
+/**
+ * @file msg_schema.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Message schema: one line per message type and event id
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Everything derived from a message type comes from the lists below: the
+ * `msg_type_e` enum (msg.h), the name tables of lut.h and the payload size used
+ * by the pool and the codec (msg_codec.h). Adding a message type is one `X()`
+ * line here; append it at the end of its module group, values are not stored.
+ *
+ * The lists only name types declared in msg.h, they are expanded after them.
+ */
+
+#ifndef __MSG_SCHEMA_H__
+#define __MSG_SCHEMA_H__
+
+
+/*
+ * X(_name, _size)
+ *   _name  MSG_TYPE_<_name>
+ *   _size  payload bytes the sender fills in, the pool copies header + _size
+ */
+#define MSG_TYPE_SCHEMA(X) \
+  /* Control signals for all modules */ \
+  X(INIT,                 0U) \
+  X(DONE,                 0U) \
+  X(RUN,                  0U) \
+  /* MGR module */ \
+  X(MGR_LIST,             0U) \
+  X(MGR_UID,              sizeof(payload_mgr_t)) \
+  X(MGR_REPLY,            sizeof(payload_reply_t))        /* answer to an MGR_Call(), routed by msg_t.call */ \
+  /* ETH module */ \
+  X(ETH_EVENT,            sizeof(data_eth_event_e)) \
+  X(ETH_MAC,              sizeof(data_eth_mac_t)) \
+  X(ETH_IP,               sizeof(data_ip_info_t)) \
+  /* WiFi module */ \
+  X(WIFI_EVENT,           sizeof(data_wifi_event_e)) \
+  X(WIFI_IP,              sizeof(data_ip_info_t)) \
+  X(WIFI_MAC,             sizeof(data_eth_mac_t)) \
+  X(WIFI_SCAN_REQ,        0U) \
+  X(WIFI_SCAN_RESULT,     sizeof(data_wifi_scan_t)) \
+  X(WIFI_CONNECT,         sizeof(data_wifi_connect_t)) \
+  X(WIFI_DISCONNECT,      0U) \
+  X(WIFI_CTRL_GOT_IP,     0U)                             /* wifi_ctrl worker queue only: defer STA IP/MAC publish from IP_EVENT */ \
+  /* MQTT module */ \
+  X(MQTT_START,           0U) \
+  X(MQTT_STOP,            0U) \
+  X(MQTT_EVENT,           sizeof(data_mqtt_event_e)) \
+  X(MQTT_DATA,            sizeof(data_mqtt_in_t))         /* by reference: the data stays in its msg_buf.h buffer */ \
+  X(MQTT_PUBLISH,         sizeof(data_mqtt_data_t)) \
+  X(MQTT_SUBSCRIBE,       sizeof(data_topic_t)) \
+  X(MQTT_SUBSCRIBE_LIST,  sizeof(data_json_t)) \
+  X(MQTT_CTRL_LINK,       sizeof(data_mqtt_event_e))      /* mqtt_ctrl queue only: every client CONNECTED / DISCONNECTED, for the reconnect engine */ \
+  X(MQTT_DATA_LOCAL,      sizeof(data_mqtt_data_t))       /* MQTT_DATA of a local sender (relay -> lcd, lcd -> relay): inline, no msg_buf.h buffer */ \
+  /* Relay module */ \
+  X(RELAY_CTRL_STATE,     0U)                             /* relay_ctrl queue only: publish and show relays set by RelayCtrl_Direct() */ \
+  /* SYS module */ \
+  X(SYS_INFO_REQ,         0U)                             /* MGR_Call() only: uptime, heap and time in payload.reply.u.sys */ \
+  /* Sensors module */ \
+  X(SENSORS,              0U) \
+  /* LCD module */ \
+  X(LCD_DATA,             sizeof(payload_lcd_t))
+
+/* X(_name): DATA_ETH_EVENT_<_name>, payload.eth.u.event_id */
+#define DATA_ETH_EVENT_SCHEMA(X) \
+  X(START) \
+  X(STOP) \
+  X(CONNECTED) \
+  X(DISCONNECTED)
+
+/* X(_name): DATA_WIFI_EVENT_<_name>, payload.wifi.u.event_id (application-level, sent to the manager) */
+#define DATA_WIFI_EVENT_SCHEMA(X) \
+  X(STA_START) \
+  X(STA_STOP) \
+  X(SCAN_FAILED) \
+  X(CONNECTED) \
+  X(DISCONNECTED)
+
+/* X(_name): DATA_MQTT_EVENT_<_name>, payload.mqtt.u.event_id */
+#define DATA_MQTT_EVENT_SCHEMA(X) \
+  X(ANY) \
+  X(ERROR) \
+  X(CONNECTED) \
+  X(DISCONNECTED) \
+  X(SUBSCRIBED) \
+  X(UNSUBSCRIBED) \
+  X(PUBLISHED) \
+  X(DATA) \
+  X(BEFORE_CONNECT) \
+  X(DELETED) \
+  X(USER)
+
+/* Number of entries of a list: (0U LIST(MSG_SCHEMA_COUNT)) */
+#define MSG_SCHEMA_COUNT(...)   + 1U
+
+
+#endif /* __MSG_SCHEMA_H__ */
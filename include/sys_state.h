@@ -0,0 +1,115 @@
+/**
+ * @file sys_state.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Shared system-state flags (link, IP, MQTT, time) next to the message bus
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * The module which owns a piece of state sets it here, where it happens (the
+ * driver event handler), before it broadcasts the event:
+ *
+ *   if (sysstate_Set(SYSSTATE_MQTT)) {
+ *     ... MGR_Send() the MQTT_EVENT_CONNECTED broadcast ...
+ *   }
+ *
+ * `sysstate_Set()` / `sysstate_Clear()` return true only on a transition, so a
+ * repeated driver event (e.g. Wi-Fi DISCONNECTED on every failed attempt) is no
+ * longer rebroadcast. Everyone else reads the current state in O(1) without a
+ * message: `sysstate_GetFlags()` for the flags, `sysstate_Get()` for a consistent
+ * copy of the whole state (flags and addresses), or blocks until a set of flags
+ * is up with `sysstate_Wait()`, e.g. "MQTT up and time synced".
+ *
+ * The flags live in a FreeRTOS event group for the waiters and, with the
+ * addresses, in a struct read under a sequence counter, so a reader never takes
+ * a lock and never sees half of an update. Writers (task context only) are
+ * serialized by a mutex.
+ */
+
+#ifndef __SYS_STATE_H__
+#define __SYS_STATE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+
+#define SYSSTATE_ETH_LINK       (1U << 0)   /**< Ethernet link up */
+#define SYSSTATE_WIFI_LINK      (1U << 1)   /**< Wi-Fi STA associated */
+#define SYSSTATE_IP             (1U << 2)   /**< At least one interface has an IPv4 address */
+#define SYSSTATE_MQTT           (1U << 3)   /**< Connected to the MQTT broker */
+#define SYSSTATE_TIME           (1U << 4)   /**< System time set (SNTP or `sys` set time) */
+#define SYSSTATE_MQTT_SESSION   (1U << 5)   /**< MQTT connected and the broker kept the session (subscriptions) */
+
+#define SYSSTATE_FLAG_CNT       (6U)
+#define SYSSTATE_ALL            ((1U << SYSSTATE_FLAG_CNT) - 1U)
+
+/** Interface of `sysstate_SetIp()`. */
+typedef enum {
+  SYSSTATE_NETIF_ETH,
+  SYSSTATE_NETIF_WIFI,
+
+  SYSSTATE_NETIF_MAX
+} sysstate_netif_e;
+
+/** @brief Copy of the state, see `sysstate_Get()`. */
+typedef struct {
+  uint32_t  flags;                      /**< SYSSTATE_* */
+  uint32_t  ip[SYSSTATE_NETIF_MAX];     /**< IPv4 address per interface (network order), 0 if none. */
+  uint32_t  changes;                    /**< Transitions so far. */
+  uint32_t  changed_ms;                 /**< Time of the last transition, ms since boot. */
+} sys_state_t;
+
+
+/**
+ * @brief Create the event group (from `MGR_Init()`, before any module starts).
+ */
+esp_err_t sysstate_Init(void);
+
+/**
+ * @brief Raise @p flags; true when at least one of them was down.
+ */
+bool sysstate_Set(uint32_t flags);
+
+/**
+ * @brief Drop @p flags; true when at least one of them was up.
+ *
+ * Dropping a link flag also forgets the address of that interface.
+ */
+bool sysstate_Clear(uint32_t flags);
+
+/**
+ * @brief Store the address of @p netif (0 to forget it) and update SYSSTATE_IP.
+ *
+ * @return true when the address changed.
+ */
+bool sysstate_SetIp(sysstate_netif_e netif, uint32_t ip);
+
+/**
+ * @brief Current flags, SYSSTATE_*; lock-free, safe from any task.
+ */
+uint32_t sysstate_GetFlags(void);
+
+/**
+ * @brief Consistent copy of the whole state; lock-free, safe from any task.
+ */
+void sysstate_Get(sys_state_t* state);
+
+/**
+ * @brief Block until @p flags are up: all of them, or any of them when @p all is false.
+ *
+ * @param timeout_ms UINT32_MAX waits forever.
+ *
+ * @return ESP_OK, ESP_ERR_TIMEOUT, or ESP_ERR_INVALID_STATE before `sysstate_Init()`.
+ */
+esp_err_t sysstate_Wait(uint32_t flags, bool all, uint32_t timeout_ms);
+
+/**
+ * @brief Name of a single SYSSTATE_* flag ("eth", "wifi", "ip", "mqtt", "time", "session").
+ */
+const char* sysstate_GetFlagName(uint32_t flag);
+
+#endif /* __SYS_STATE_H__ */
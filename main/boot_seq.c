@@ -0,0 +1,437 @@
+/**
+ * @file boot_seq.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Dependency-aware module start: init_fn / run_fn of independent modules in parallel
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * The calling task schedules: it posts ready steps to the job queue while a
+ * worker is idle and waits on the done queue for the next one to finish. Only
+ * the caller touches the pending/done masks; a worker writes the times of the
+ * step it runs, which the caller reads after the step came back through the
+ * done queue.
+ *
+ * The marks are written once, by whichever task gets there first, with a
+ * compare-and-swap on 0; readers see either 0 or the final value.
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sdkconfig.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+#include "boot_seq.h"
+#include "mgr_ctrl.h"
+
+
+#define BOOTSEQ_TASK_NAME       "boot-%u"
+#define BOOTSEQ_WORKERS         (CONFIG_MGR_BOOT_WORKERS)
+#if BOOTSEQ_WORKERS > 0
+#define BOOTSEQ_STACK_SIZE      (CONFIG_MGR_BOOT_STACK_SIZE)
+#endif
+
+/* Job which stops a worker */
+#define BOOTSEQ_STOP            (0xFFU)
+
+#define BOOTSEQ_BIT(_idx)       (1UL << (_idx))
+
+/* Longest report line: a module line with two max length names */
+#define BOOTSEQ_LINE_SIZE       (160U)
+
+static const char* TAG = "ESP::BOOT";
+
+static const char* bootseq_phase_name[BOOTSEQ_PHASE_MAX] = {
+  [BOOTSEQ_PHASE_INIT] = "init",
+  [BOOTSEQ_PHASE_RUN]  = "run",
+};
+
+static const char* bootseq_mark_name[BOOTSEQ_MARK_MAX] = {
+  [BOOTSEQ_MARK_APP]      = "app",
+  [BOOTSEQ_MARK_NVS]      = "nvs",
+  [BOOTSEQ_MARK_INIT]     = "init",
+  [BOOTSEQ_MARK_RUN]      = "run",
+  [BOOTSEQ_MARK_LINK]     = "link",
+  [BOOTSEQ_MARK_IP]       = "ip",
+  [BOOTSEQ_MARK_MQTT]     = "mqtt",
+  [BOOTSEQ_MARK_PUBLISH]  = "publish",
+};
+
+static uint32_t           bootseq_mark_list[BOOTSEQ_MARK_MAX];
+static bootseq_phase_t    bootseq_phase_list[BOOTSEQ_PHASE_MAX];
+static bootseq_step_t     bootseq_step_list[BOOTSEQ_PHASE_MAX][BOOTSEQ_STEP_MAX];
+
+/* State of the phase being run */
+static bootseq_step_t*    bootseq_steps = NULL;
+static bootseq_step_f     bootseq_step_fn = NULL;
+static uint32_t           bootseq_depends[BOOTSEQ_STEP_MAX];  /* step masks */
+
+#if BOOTSEQ_WORKERS > 0
+static QueueHandle_t      bootseq_jobs = NULL;
+static QueueHandle_t      bootseq_done = NULL;
+static SemaphoreHandle_t  bootseq_stop_sem = NULL;
+#endif
+
+
+static inline uint32_t bootseq_Now(void) {
+  return (uint32_t) esp_timer_get_time();
+}
+
+/**
+ * @brief Run step @p idx on the current task.
+ */
+static void bootseq_Exec(uint32_t idx, uint8_t worker) {
+  bootseq_step_t* step = &bootseq_steps[idx];
+
+  step->worker = worker;
+  step->begin_us = bootseq_Now();
+  step->result = bootseq_step_fn(step->id);
+  step->end_us = bootseq_Now();
+}
+
+/**
+ * @brief Note when step @p idx became ready and what held it back last: the
+ *        dependency which finished last, or step @p last when the step then still
+ *        had to wait for a free worker.
+ */
+static void bootseq_SetReady(uint32_t idx, uint32_t begin_us, int last) {
+  bootseq_step_t* step = &bootseq_steps[idx];
+  uint32_t deps = bootseq_depends[idx];
+
+  step->after = -1;
+  step->ready_us = begin_us;
+  while (deps != 0U) {
+    uint32_t dep = (uint32_t) __builtin_ctz(deps);
+
+    deps &= deps - 1U;
+    if ((step->after < 0) || (bootseq_steps[dep].end_us > step->ready_us)) {
+      step->after = (int8_t) dep;
+      step->ready_us = bootseq_steps[dep].end_us;
+    }
+  }
+  if ((last >= 0) && (bootseq_steps[last].end_us > step->ready_us)) {
+    step->after = (int8_t) last;
+  }
+}
+
+#if BOOTSEQ_WORKERS > 0
+static void bootseq_WorkerFn(void* param) {
+  uint8_t worker = (uint8_t) (uintptr_t) param;
+  uint8_t job = BOOTSEQ_STOP;
+
+  ESP_LOGD(TAG, "++%s(%u)", __func__, worker);
+  while ((xQueueReceive(bootseq_jobs, &job, portMAX_DELAY) == pdTRUE) && (job != BOOTSEQ_STOP)) {
+    bootseq_Exec(job, worker);
+    xQueueSend(bootseq_done, &job, portMAX_DELAY);
+  }
+  ESP_LOGD(TAG, "--%s(%u)", __func__, worker);
+  xSemaphoreGive(bootseq_stop_sem);
+  vTaskDelete(NULL);
+}
+
+/**
+ * @brief Start up to BOOTSEQ_WORKERS worker tasks, at the priority of the caller.
+ *
+ * @return Number of workers running, 0 if none could be started.
+ */
+static uint32_t bootseq_StartWorkers(uint32_t cnt) {
+  uint32_t workers = 0;
+
+  bootseq_jobs = xQueueCreate(BOOTSEQ_STEP_MAX + BOOTSEQ_WORKERS, sizeof(uint8_t));
+  bootseq_done = xQueueCreate(BOOTSEQ_STEP_MAX, sizeof(uint8_t));
+  bootseq_stop_sem = xSemaphoreCreateCounting(BOOTSEQ_WORKERS, 0);
+  if ((bootseq_jobs == NULL) || (bootseq_done == NULL) || (bootseq_stop_sem == NULL)) {
+    ESP_LOGE(TAG, "[%s] xQueueCreate() failed.", __func__);
+    return 0;
+  }
+  for (uint32_t idx = 0; (idx < BOOTSEQ_WORKERS) && (idx < cnt); ++idx) {
+    char name[configMAX_TASK_NAME_LEN];
+    TaskHandle_t task = NULL;
+
+    snprintf(name, sizeof(name), BOOTSEQ_TASK_NAME, (unsigned) idx);
+    xTaskCreate(bootseq_WorkerFn, name, BOOTSEQ_STACK_SIZE, (void*) (uintptr_t) idx, uxTaskPriorityGet(NULL), &task);
+    if (task == NULL) {
+      ESP_LOGE(TAG, "[%s] xTaskCreate() failed.", __func__);
+      break;
+    }
+    ++workers;
+  }
+  return workers;
+}
+
+static void bootseq_StopWorkers(uint32_t workers) {
+  uint8_t stop = BOOTSEQ_STOP;
+
+  for (uint32_t idx = 0; idx < workers; ++idx) {
+    xQueueSend(bootseq_jobs, &stop, portMAX_DELAY);
+  }
+  for (uint32_t idx = 0; idx < workers; ++idx) {
+    xSemaphoreTake(bootseq_stop_sem, portMAX_DELAY);
+  }
+  if (bootseq_jobs) {
+    vQueueDelete(bootseq_jobs);
+    bootseq_jobs = NULL;
+  }
+  if (bootseq_done) {
+    vQueueDelete(bootseq_done);
+    bootseq_done = NULL;
+  }
+  if (bootseq_stop_sem) {
+    vSemaphoreDelete(bootseq_stop_sem);
+    bootseq_stop_sem = NULL;
+  }
+}
+#endif /* BOOTSEQ_WORKERS > 0 */
+
+/**
+ * @brief Walk back from the step which finished last along `after`.
+ */
+static void bootseq_FindPath(bootseq_phase_t* phase) {
+  int last = -1;
+
+  phase->busy_us = 0;
+  for (uint32_t idx = 0; idx < phase->cnt; ++idx) {
+    phase->busy_us += bootseq_steps[idx].end_us - bootseq_steps[idx].begin_us;
+    if ((last < 0) || (bootseq_steps[idx].end_us > bootseq_steps[last].end_us)) {
+      last = (int) idx;
+    }
+  }
+  phase->path_cnt = 0;
+  for (int idx = last; (idx >= 0) && (phase->path_cnt < BOOTSEQ_STEP_MAX); idx = bootseq_steps[idx].after) {
+    phase->path[phase->path_cnt++] = (uint8_t) idx;
+  }
+  /* Collected last to first */
+  for (uint32_t lo = 0, hi = phase->path_cnt - 1; (phase->path_cnt > 0) && (lo < hi); ++lo, --hi) {
+    uint8_t tmp = phase->path[lo];
+
+    phase->path[lo] = phase->path[hi];
+    phase->path[hi] = tmp;
+  }
+}
+
+esp_err_t bootseq_Run(bootseq_phase_e phase, const uint8_t* ids, const uint32_t* depends, uint32_t cnt, bootseq_step_f step) {
+  esp_err_t result = ESP_OK;
+  bootseq_phase_t* info = NULL;
+  uint32_t pending = 0;
+  uint32_t done = 0;
+  uint32_t running = 0;
+  uint32_t workers = 0;
+  int last = -1;
+
+  if ((phase >= BOOTSEQ_PHASE_MAX) || (step == NULL) || (cnt > BOOTSEQ_STEP_MAX) || ((cnt > 0U) && ((ids == NULL) || (depends == NULL)))) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  ESP_LOGI(TAG, "++%s(%s, steps: %lu)", __func__, bootseq_phase_name[phase], cnt);
+
+  info = &bootseq_phase_list[phase];
+  memset(info, 0, sizeof(*info));
+  bootseq_steps = bootseq_step_list[phase];
+  memset(bootseq_steps, 0, sizeof(bootseq_step_list[phase]));
+  bootseq_step_fn = step;
+
+  /* REG_*_CTRL masks -> step masks; dependencies outside of the list are ignored */
+  for (uint32_t idx = 0; idx < cnt; ++idx) {
+    bootseq_steps[idx].id = ids[idx];
+    bootseq_depends[idx] = 0;
+    for (uint32_t dep = 0; dep < cnt; ++dep) {
+      if ((dep != idx) && (depends[idx] & BOOTSEQ_BIT(ids[dep]))) {
+        bootseq_depends[idx] |= BOOTSEQ_BIT(dep);
+      }
+    }
+    pending |= BOOTSEQ_BIT(idx);
+  }
+
+#if BOOTSEQ_WORKERS > 0
+  workers = bootseq_StartWorkers(cnt);
+  if (workers == 0U) {
+    ESP_LOGW(TAG, "[%s] No worker, running the steps on the caller.", __func__);
+  }
+#endif
+  info->cnt = cnt;
+  info->workers = workers;
+  info->begin_us = bootseq_Now();
+
+  while ((pending != 0U) || (running != 0U)) {
+    bool started = false;
+
+    for (uint32_t idx = 0; (idx < cnt) && ((workers == 0U) || (running < workers)); ++idx) {
+      if (((pending & BOOTSEQ_BIT(idx)) == 0U) || ((bootseq_depends[idx] & ~done) != 0U)) {
+        continue;
+      }
+      pending &= ~BOOTSEQ_BIT(idx);
+      bootseq_SetReady(idx, info->begin_us, last);
+      started = true;
+      if (workers == 0U) {
+        bootseq_Exec(idx, BOOTSEQ_CALLER);
+        done |= BOOTSEQ_BIT(idx);
+        last = (int) idx;
+      }
+#if BOOTSEQ_WORKERS > 0
+      else {
+        uint8_t job = (uint8_t) idx;
+
+        xQueueSend(bootseq_jobs, &job, portMAX_DELAY);
+        ++running;
+      }
+#endif
+    }
+
+    if (!started && (running == 0U) && (pending != 0U)) {
+      /* Nothing can start: a dependency cycle. Start the first one anyway, as a serial start would. */
+      uint32_t idx = (uint32_t) __builtin_ctz(pending);
+
+      ESP_LOGE(TAG, "[%s] Dependency cycle, steps left: 0x%04lx; starting '%s' anyway.", __func__,
+          pending, MGR_GetModuleName(BOOTSEQ_BIT(bootseq_steps[idx].id)));
+      bootseq_depends[idx] = 0;
+      continue;
+    }
+
+#if BOOTSEQ_WORKERS > 0
+    if (running != 0U) {
+      uint8_t job = BOOTSEQ_STOP;
+
+      if (xQueueReceive(bootseq_done, &job, portMAX_DELAY) == pdTRUE) {
+        done |= BOOTSEQ_BIT(job);
+        last = (int) job;
+        --running;
+      }
+    }
+#endif
+  }
+  info->end_us = bootseq_Now();
+
+#if BOOTSEQ_WORKERS > 0
+  bootseq_StopWorkers(workers);
+#endif
+
+  for (uint32_t idx = 0; idx < cnt; ++idx) {
+    if ((bootseq_steps[idx].result != ESP_OK) && (result == ESP_OK)) {
+      result = bootseq_steps[idx].result;
+    }
+  }
+  bootseq_FindPath(info);
+  bootseq_steps = NULL;
+  bootseq_step_fn = NULL;
+  bootseq_Mark((phase == BOOTSEQ_PHASE_INIT) ? BOOTSEQ_MARK_INIT : BOOTSEQ_MARK_RUN);
+
+  ESP_LOGI(TAG, "--%s(%s) - result: %d", __func__, bootseq_phase_name[phase], result);
+  return result;
+}
+
+const bootseq_phase_t* bootseq_GetPhase(bootseq_phase_e phase) {
+  if ((phase >= BOOTSEQ_PHASE_MAX) || (bootseq_phase_list[phase].end_us == 0U)) {
+    return NULL;
+  }
+  return &bootseq_phase_list[phase];
+}
+
+const bootseq_step_t* bootseq_GetSteps(bootseq_phase_e phase) {
+  return (phase < BOOTSEQ_PHASE_MAX) ? bootseq_step_list[phase] : NULL;
+}
+
+const char* bootseq_GetPhaseName(bootseq_phase_e phase) {
+  return (phase < BOOTSEQ_PHASE_MAX) ? bootseq_phase_name[phase] : "?";
+}
+
+void bootseq_Mark(bootseq_mark_e mark) {
+  uint32_t expected = 0;
+
+  if (mark >= BOOTSEQ_MARK_MAX) {
+    return;
+  }
+  if (__atomic_compare_exchange_n(&bootseq_mark_list[mark], &expected, bootseq_Now(), false,
+      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    ESP_LOGD(TAG, "[%s] %s at %lu ms", __func__, bootseq_mark_name[mark], bootseq_mark_list[mark] / 1000U);
+  }
+}
+
+uint32_t bootseq_GetMark(bootseq_mark_e mark) {
+  return (mark < BOOTSEQ_MARK_MAX) ? __atomic_load_n(&bootseq_mark_list[mark], __ATOMIC_RELAXED) : 0U;
+}
+
+const char* bootseq_GetMarkName(bootseq_mark_e mark) {
+  return (mark < BOOTSEQ_MARK_MAX) ? bootseq_mark_name[mark] : "?";
+}
+
+static void bootseq_ReportPhase(bootseq_phase_e phase, bootseq_line_f fn, void* ctx) {
+  const bootseq_phase_t* info = bootseq_GetPhase(phase);
+  const bootseq_step_t* steps = bootseq_GetSteps(phase);
+  const char* name = NULL;
+  char line[BOOTSEQ_LINE_SIZE];
+  uint32_t wall = 0;
+  uint32_t took = 0;
+  int len = 0;
+
+  if (info == NULL) {
+    return;
+  }
+  name = bootseq_phase_name[phase];
+  wall = info->end_us - info->begin_us;
+  snprintf(line, sizeof(line), "[%s][total] modules=%lu workers=%lu begin_ms=%lu end_ms=%lu wall_ms=%lu serial_ms=%lu saved_ms=%ld",
+      name, info->cnt, info->workers, info->begin_us / 1000U, info->end_us / 1000U, wall / 1000U,
+      info->busy_us / 1000U, ((int32_t) info->busy_us - (int32_t) wall) / 1000);
+  fn(ctx, line);
+  for (uint32_t idx = 0; idx < info->cnt; ++idx) {
+    const bootseq_step_t* step = &steps[idx];
+
+    snprintf(line, sizeof(line), "[%s][%s] ready_ms=%lu start_ms=%lu end_ms=%lu took_ms=%lu after=%s worker=%d result=%d",
+        name, MGR_GetModuleName(BOOTSEQ_BIT(step->id)),
+        step->ready_us / 1000U, step->begin_us / 1000U, step->end_us / 1000U,
+        (step->end_us - step->begin_us) / 1000U,
+        (step->after >= 0) ? MGR_GetModuleName(BOOTSEQ_BIT(steps[step->after].id)) : "-",
+        (step->worker == BOOTSEQ_CALLER) ? -1 : step->worker, step->result);
+    fn(ctx, line);
+  }
+  len = snprintf(line, sizeof(line), "[%s][path] steps=", name);
+  for (uint32_t pos = 0; (pos < info->path_cnt) && (len < (int) sizeof(line)); ++pos) {
+    const bootseq_step_t* step = &steps[info->path[pos]];
+
+    took += step->end_us - step->begin_us;
+    len += snprintf(&line[len], sizeof(line) - len, "%s%s", (pos > 0U) ? ">" : "",
+        MGR_GetModuleName(BOOTSEQ_BIT(step->id)));
+  }
+  if (len < (int) sizeof(line)) {
+    snprintf(&line[len], sizeof(line) - len, "%s took_ms=%lu", (info->path_cnt > 0U) ? "" : "-", took / 1000U);
+  }
+  fn(ctx, line);
+}
+
+static void bootseq_LogLine(void* ctx, const char* line) {
+  (void) ctx;
+  ESP_LOGI(TAG, "%s", line);
+}
+
+void bootseq_LogPhase(bootseq_phase_e phase) {
+  bootseq_ReportPhase(phase, bootseq_LogLine, NULL);
+}
+
+void bootseq_Report(bootseq_line_f fn, void* ctx) {
+  char line[BOOTSEQ_LINE_SIZE];
+
+  if (fn == NULL) {
+    return;
+  }
+  for (uint32_t mark = 0; mark < BOOTSEQ_MARK_MAX; ++mark) {
+    uint32_t at = bootseq_GetMark((bootseq_mark_e) mark);
+
+    snprintf(line, sizeof(line), "[mark][%s] t_ms=%ld", bootseq_mark_name[mark], (at != 0U) ? (long) (at / 1000U) : -1L);
+    fn(ctx, line);
+  }
+  for (uint32_t phase = 0; phase < BOOTSEQ_PHASE_MAX; ++phase) {
+    bootseq_ReportPhase((bootseq_phase_e) phase, fn, ctx);
+  }
+}
+
+void bootseq_LogReport(void) {
+  bootseq_Report(bootseq_LogLine, NULL);
+}
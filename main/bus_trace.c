@@ -0,0 +1,274 @@
+/**
+ * @file bus_trace.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Bus trace ring and per-type latency histograms
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Each core owns one ring, so a writer only competes with tasks preempting it on
+ * the same core: a relaxed atomic increment of the head reserves the slot, the
+ * record is filled and its sequence byte is stored last with release order.
+ * Readers walk every ring backwards from its head and merge them by timestamp,
+ * skipping records which are still being written or have been overwritten.
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_MGR_BUS_TRACE_ENABLE
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "bus_trace.h"
+#include "msg_pool.h"
+
+
+#define BUS_TRACE_DEPTH         (CONFIG_MGR_BUS_TRACE_DEPTH)
+#define BUS_TRACE_MASK          (BUS_TRACE_DEPTH - 1U)
+
+#define BUS_TRACE_SEQ(_idx)     ((uint8_t) (0x80U | ((_idx) & 0x7FU)))
+
+_Static_assert((BUS_TRACE_DEPTH & BUS_TRACE_MASK) == 0, "CONFIG_MGR_BUS_TRACE_DEPTH must be a power of 2");
+_Static_assert(sizeof(bus_trace_rec_t) == 24, "bus_trace_rec_t is part of the binary dump format");
+_Static_assert(MSG_TYPE_MAX <= 256, "msg type must fit bus_trace_rec_t.type");
+
+typedef struct {
+  uint32_t head;        /**< Records ever reserved on this core. */
+  bus_trace_rec_t rec[BUS_TRACE_DEPTH];
+} bustrace_ring_t;
+
+static bustrace_ring_t bustrace_ring[portNUM_PROCESSORS];
+
+static uint32_t bustrace_hist[MSG_TYPE_MAX][BUS_STAGE_MAX][BUS_TRACE_BUCKET_MAX];
+
+static bus_trace_path_t bustrace_path[MSG_TYPE_MAX][BUS_PATH_MAX];
+static portMUX_TYPE bustrace_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const int8_t bustrace_stage_map[BUS_HOP_MAX] = {
+  [BUS_HOP_SEND]      = -1,
+  [BUS_HOP_DROP]      = -1,
+  [BUS_HOP_MGR_RECV]  = BUS_STAGE_MGR_WAIT,
+  [BUS_HOP_MGR_DONE]  = BUS_STAGE_MGR_PARSE,
+  [BUS_HOP_NOTIFY]    = -1,
+  [BUS_HOP_MOD_RECV]  = BUS_STAGE_DELIVERY,
+  [BUS_HOP_MOD_DONE]  = BUS_STAGE_MOD_PARSE,
+  [BUS_HOP_DIRECT]    = BUS_STAGE_MOD_PARSE,
+};
+
+
+static uint32_t bustrace_GetBucket(uint32_t val) {
+  uint32_t bucket = 0;
+
+  if (val >= 64U) {
+    bucket = ((31U - (uint32_t) __builtin_clz(val >> 6)) / 2U) + 1U;
+    if (bucket >= BUS_TRACE_BUCKET_MAX) {
+      bucket = BUS_TRACE_BUCKET_MAX - 1U;
+    }
+  }
+  return bucket;
+}
+
+/**
+ * @brief Copy record @p idx of @p ring into @p rec if it is complete and still at that index.
+ */
+static bool bustrace_Load(const bustrace_ring_t* ring, uint32_t idx, bus_trace_rec_t* rec) {
+  const bus_trace_rec_t* src = &ring->rec[idx & BUS_TRACE_MASK];
+  uint8_t seq = __atomic_load_n(&src->seq, __ATOMIC_ACQUIRE);
+
+  if (seq != BUS_TRACE_SEQ(idx)) {
+    return false;
+  }
+  memcpy(rec, src, sizeof(*rec));
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return (__atomic_load_n(&src->seq, __ATOMIC_RELAXED) == seq);
+}
+
+/**
+ * @brief Add the age of @p msg at @p now to the end-to-end counters of @p path.
+ */
+static void bustrace_CountPath(bus_path_e path, const msg_t* msg, int64_t now) {
+  int64_t stamp = msgpool_GetStamp(msg);
+
+  if ((stamp <= 0) || (msg->type >= MSG_TYPE_MAX)) {
+    return;
+  }
+  uint32_t age = (uint32_t) (now - stamp);
+  bus_trace_path_t* stats = &bustrace_path[msg->type][path];
+
+  taskENTER_CRITICAL(&bustrace_lock);
+  ++stats->count;
+  stats->sum_us += age;
+  if (age > stats->max_us) {
+    stats->max_us = age;
+  }
+  taskEXIT_CRITICAL(&bustrace_lock);
+}
+
+void bustrace_Reset(void) {
+  memset(bustrace_ring, 0, sizeof(bustrace_ring));
+  memset(bustrace_hist, 0, sizeof(bustrace_hist));
+  taskENTER_CRITICAL(&bustrace_lock);
+  memset(bustrace_path, 0, sizeof(bustrace_path));
+  taskEXIT_CRITICAL(&bustrace_lock);
+}
+
+void bustrace_Record(bus_hop_e hop, const msg_t* msg, uint32_t to, uint32_t val) {
+  uint32_t core = (uint32_t) xPortGetCoreID();
+  bustrace_ring_t* ring = &bustrace_ring[core];
+  uint32_t idx = __atomic_fetch_add(&ring->head, 1U, __ATOMIC_RELAXED);
+  bus_trace_rec_t* rec = &ring->rec[idx & BUS_TRACE_MASK];
+
+  __atomic_store_n(&rec->seq, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  rec->ts   = (uint32_t) esp_timer_get_time();
+  rec->id   = msgpool_IsPooled(msg) ? (uint32_t) (uintptr_t) msg : 0U;
+  rec->from = msg->from;
+  rec->to   = to;
+  rec->val  = val;
+  rec->type = (uint8_t) msg->type;
+  rec->hop  = (uint8_t) hop;
+  rec->core = (uint8_t) core;
+  __atomic_store_n(&rec->seq, BUS_TRACE_SEQ(idx), __ATOMIC_RELEASE);
+
+  if ((hop < BUS_HOP_MAX) && (bustrace_stage_map[hop] >= 0) && (msg->type < MSG_TYPE_MAX)) {
+    __atomic_fetch_add(&bustrace_hist[msg->type][bustrace_stage_map[hop]][bustrace_GetBucket(val)],
+        1U, __ATOMIC_RELAXED);
+  }
+}
+
+int64_t bustrace_ModBegin(uint32_t module, const msg_t* msg) {
+  int64_t now = esp_timer_get_time();
+  int64_t stamp = msgpool_GetStamp(msg);
+
+  bustrace_Record(BUS_HOP_MOD_RECV, msg, module, (stamp > 0) ? (uint32_t) (now - stamp) : 0U);
+  return now;
+}
+
+void bustrace_ModEnd(uint32_t module, const msg_t* msg, int64_t begin) {
+  int64_t now = esp_timer_get_time();
+
+  bustrace_Record(BUS_HOP_MOD_DONE, msg, module, (uint32_t) (now - begin));
+  bustrace_CountPath(BUS_PATH_QUEUED, msg, now);
+}
+
+void bustrace_Direct(uint32_t module, const msg_t* msg, int64_t begin) {
+  int64_t now = esp_timer_get_time();
+
+  bustrace_Record(BUS_HOP_DIRECT, msg, module, (uint32_t) (now - begin));
+  bustrace_CountPath(BUS_PATH_DIRECT, msg, now);
+}
+
+esp_err_t bustrace_GetPath(msg_type_e type, bus_path_e path, bus_trace_path_t* stats) {
+  if ((type >= MSG_TYPE_MAX) || (path >= BUS_PATH_MAX) || (stats == NULL)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  taskENTER_CRITICAL(&bustrace_lock);
+  *stats = bustrace_path[type][path];
+  taskEXIT_CRITICAL(&bustrace_lock);
+  return ESP_OK;
+}
+
+uint32_t bustrace_GetHist(msg_type_e type, bus_stage_e stage, uint32_t* buckets) {
+  uint32_t count = 0;
+
+  if ((type >= MSG_TYPE_MAX) || (stage >= BUS_STAGE_MAX) || (buckets == NULL)) {
+    return 0;
+  }
+  for (uint32_t bucket = 0; bucket < BUS_TRACE_BUCKET_MAX; ++bucket) {
+    buckets[bucket] = __atomic_load_n(&bustrace_hist[type][stage][bucket], __ATOMIC_RELAXED);
+    count += buckets[bucket];
+  }
+  return count;
+}
+
+uint32_t bustrace_GetBucketLimit(uint32_t bucket) {
+  return (bucket < (BUS_TRACE_BUCKET_MAX - 1U)) ? (64U << (2U * bucket)) : 0U;
+}
+
+uint32_t bustrace_GetPercentile(const uint32_t* buckets, uint32_t pct) {
+  uint64_t total = 0;
+  uint64_t sum = 0;
+
+  for (uint32_t bucket = 0; bucket < BUS_TRACE_BUCKET_MAX; ++bucket) {
+    total += buckets[bucket];
+  }
+  if (total == 0) {
+    return 0;
+  }
+  uint64_t target = (total * pct + 99U) / 100U;
+  for (uint32_t bucket = 0; bucket < (BUS_TRACE_BUCKET_MAX - 1U); ++bucket) {
+    sum += buckets[bucket];
+    if (sum >= target) {
+      return bustrace_GetBucketLimit(bucket);
+    }
+  }
+  return UINT32_MAX;
+}
+
+uint32_t bustrace_Read(bus_trace_rec_t* rec, uint32_t max) {
+  uint32_t pos[portNUM_PROCESSORS];
+  uint32_t low[portNUM_PROCESSORS];
+  uint32_t last[portNUM_PROCESSORS];
+  bool valid[portNUM_PROCESSORS];
+  bus_trace_rec_t next[portNUM_PROCESSORS];
+  uint32_t now = (uint32_t) esp_timer_get_time();
+  uint32_t cnt = 0;
+
+  if ((rec == NULL) || (max == 0)) {
+    return 0;
+  }
+  /* Cursor of every core: pos is the next index to read going backwards */
+  for (uint32_t core = 0; core < portNUM_PROCESSORS; ++core) {
+    uint32_t head = __atomic_load_n(&bustrace_ring[core].head, __ATOMIC_ACQUIRE);
+
+    pos[core] = head;
+    low[core] = (head > BUS_TRACE_DEPTH) ? (head - BUS_TRACE_DEPTH) : 0U;
+    last[core] = 0U;
+    valid[core] = false;
+  }
+
+  /* Merge the rings newest first, filling rec[] from the end */
+  while (cnt < max) {
+    int pick = -1;
+
+    for (uint32_t core = 0; core < portNUM_PROCESSORS; ++core) {
+      while (!valid[core] && (pos[core] > low[core])) {
+        --pos[core];
+        if (bustrace_Load(&bustrace_ring[core], pos[core], &next[core])) {
+          uint32_t age = now - next[core].ts;
+
+          /* A newer age than the previous record means the slot was overwritten: stop there */
+          if (age < last[core]) {
+            low[core] = pos[core];
+            break;
+          }
+          last[core] = age;
+          valid[core] = true;
+        }
+      }
+      if (valid[core] && ((pick < 0) || ((now - next[core].ts) < (now - next[pick].ts)))) {
+        pick = (int) core;
+      }
+    }
+    if (pick < 0) {
+      break;
+    }
+    rec[max - 1U - cnt] = next[pick];
+    valid[pick] = false;
+    ++cnt;
+  }
+  if (cnt < max) {
+    memmove(rec, &rec[max - cnt], cnt * sizeof(*rec));
+  }
+  return cnt;
+}
+
+#endif /* CONFIG_MGR_BUS_TRACE_ENABLE */
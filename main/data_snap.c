@@ -0,0 +1,192 @@
+/**
+ * @file data_snap.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Versioned, immutable snapshots of bulk data per (producer, data_type_e)
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * The slot table holds one reference to the current snapshot of each pair.
+ * Swapping it and taking or dropping a reference happen under one spinlock, so
+ * a reader cannot pick up a snapshot which is being freed; `free()` itself runs
+ * outside of the lock.
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sdkconfig.h"
+
+#include "esp_log.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "data_snap.h"
+#include "mgr_ctrl.h"
+
+#include "lut.h"
+
+
+typedef struct {
+  uint32_t      from;       /* REG_*_CTRL, 0 for a free slot */
+  data_type_e   type;
+  uint32_t      version;    /* last version published */
+  data_snap_t*  snap;       /* current snapshot, NULL after datasnap_Clear() */
+} datasnap_slot_t;
+
+static const char* TAG = "ESP::SNAP";
+
+static portMUX_TYPE     datasnap_lock = portMUX_INITIALIZER_UNLOCKED;
+static datasnap_slot_t  datasnap_list[DATASNAP_SLOT_MAX];
+
+
+/**
+ * @brief Slot of @p from / @p type, NULL if none; call with datasnap_lock held.
+ */
+static datasnap_slot_t* datasnap_Find(uint32_t from, data_type_e type) {
+  for (uint32_t idx = 0; idx < DATASNAP_SLOT_MAX; ++idx) {
+    if ((datasnap_list[idx].from == from) && (datasnap_list[idx].type == type)) {
+      return &datasnap_list[idx];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Drop one reference; true when it was the last one. Call with datasnap_lock held.
+ */
+static bool datasnap_Unref(data_snap_t* snap) {
+  return (--snap->refs == 0U);
+}
+
+data_snap_t* datasnap_Alloc(data_type_e type, uint32_t count, uint32_t size) {
+  data_snap_t* snap = malloc(sizeof(data_snap_t) + size);
+
+  if (snap == NULL) {
+    ESP_LOGE(TAG, "[%s] malloc(%lu) failed, type: %s", __func__, (uint32_t) (sizeof(data_snap_t) + size),
+        GET_DATA_TYPE_NAME(type));
+    return NULL;
+  }
+  memset(snap, 0, sizeof(data_snap_t));
+  snap->data.type = type;
+  snap->data.count = count;
+  snap->data.size = size;
+  snap->data.data = snap->buf;
+  snap->refs = 1;
+  return snap;
+}
+
+esp_err_t datasnap_Publish(uint32_t module_type, data_snap_t* snap) {
+  esp_err_t result = ESP_OK;
+  data_snap_t* old = NULL;
+  datasnap_slot_t* slot = NULL;
+  data_type_e type = DATA_TYPE_NONE;
+  uint32_t version = 0;
+
+  if (snap == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if ((module_type == 0U) || ((module_type & (module_type - 1U)) != 0U)) {
+    datasnap_Release(snap);
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  type = snap->data.type;
+  taskENTER_CRITICAL(&datasnap_lock);
+  slot = datasnap_Find(module_type, type);
+  if (slot == NULL) {
+    slot = datasnap_Find(0U, DATA_TYPE_NONE);
+    if (slot != NULL) {
+      slot->from = module_type;
+      slot->type = type;
+    }
+  }
+  if (slot != NULL) {
+    snap->from = module_type;
+    snap->version = ++slot->version;
+    version = snap->version;
+    old = slot->snap;
+    /* The reference from datasnap_Alloc() now belongs to the slot */
+    slot->snap = snap;
+    if ((old != NULL) && !datasnap_Unref(old)) {
+      old = NULL;
+    }
+  } else {
+    result = ESP_ERR_NO_MEM;
+  }
+  taskEXIT_CRITICAL(&datasnap_lock);
+
+  if (result != ESP_OK) {
+    ESP_LOGE(TAG, "[%s] No free slot for '%s' / %s", __func__, MGR_GetModuleName(module_type),
+        GET_DATA_TYPE_NAME(type));
+    datasnap_Release(snap);
+    return result;
+  }
+  free(old);
+  /* snap may already be replaced by another publish, do not touch it any more */
+  ESP_LOGD(TAG, "[%s] '%s' / %s: version %lu", __func__, MGR_GetModuleName(module_type),
+      GET_DATA_TYPE_NAME(type), version);
+  return ESP_OK;
+}
+
+esp_err_t datasnap_Acquire(uint32_t module_type, data_type_e type, const data_snap_t** snap) {
+  data_snap_t* found = NULL;
+
+  if (snap == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  taskENTER_CRITICAL(&datasnap_lock);
+  datasnap_slot_t* slot = datasnap_Find(module_type, type);
+  if ((slot != NULL) && (slot->snap != NULL)) {
+    found = slot->snap;
+    ++found->refs;
+  }
+  taskEXIT_CRITICAL(&datasnap_lock);
+
+  *snap = found;
+  return (found != NULL) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+void datasnap_Release(const data_snap_t* snap) {
+  data_snap_t* last = NULL;
+
+  if (snap == NULL) {
+    return;
+  }
+  taskENTER_CRITICAL(&datasnap_lock);
+  if (datasnap_Unref((data_snap_t*) snap)) {
+    last = (data_snap_t*) snap;
+  }
+  taskEXIT_CRITICAL(&datasnap_lock);
+  free(last);
+}
+
+uint32_t datasnap_GetVersion(uint32_t module_type, data_type_e type) {
+  uint32_t version = 0;
+
+  taskENTER_CRITICAL(&datasnap_lock);
+  datasnap_slot_t* slot = datasnap_Find(module_type, type);
+  if ((slot != NULL) && (slot->snap != NULL)) {
+    version = slot->snap->version;
+  }
+  taskEXIT_CRITICAL(&datasnap_lock);
+  return version;
+}
+
+void datasnap_Clear(void) {
+  for (uint32_t idx = 0; idx < DATASNAP_SLOT_MAX; ++idx) {
+    data_snap_t* old = NULL;
+
+    taskENTER_CRITICAL(&datasnap_lock);
+    old = datasnap_list[idx].snap;
+    memset(&datasnap_list[idx], 0, sizeof(datasnap_list[idx]));
+    if ((old != NULL) && !datasnap_Unref(old)) {
+      old = NULL;
+    }
+    taskEXIT_CRITICAL(&datasnap_lock);
+    free(old);
+  }
+}
@@ -0,0 +1,365 @@
+/**
+ * @file executor.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Message handler units, run on a dedicated task or on a shared worker pool
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Pool mode keeps one `scheduled` flag per unit. Whoever sets it (a producer in
+ * `executor_Post()` or a worker that leaves messages behind) puts the unit into
+ * the ready queue, so a unit is in the ready queue or on a worker at most once.
+ * The worker clears the flag after its batch and looks at the unit queue again,
+ * so a message posted in between is never left without a worker.
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sdkconfig.h"
+
+#include "esp_log.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+#include "bus_trace.h"
+#include "err.h"
+#include "executor.h"
+#include "mgr_ctrl.h"
+#include "msg_pool.h"
+
+#include "lut.h"
+
+
+#define EXECUTOR_TASK_NAME      "exec-%u"
+
+#if CONFIG_MGR_EXECUTOR_ENABLE
+#define EXECUTOR_WORKERS        (CONFIG_MGR_EXECUTOR_WORKERS)
+#define EXECUTOR_STACK_SIZE     (CONFIG_MGR_EXECUTOR_STACK_SIZE)
+#define EXECUTOR_PRIORITY       (CONFIG_MGR_EXECUTOR_PRIORITY)
+#endif
+
+struct executor_unit_s {
+  executor_cfg_t    cfg;
+  QueueHandle_t     queue;
+  SemaphoreHandle_t done;       /* given when the handler returned ESP_TASK_DONE */
+  TaskHandle_t      task;       /* task mode only */
+  uint32_t          scheduled;  /* pool mode: 1 while in the ready queue or on a worker */
+  uint32_t          runs;
+  bool              used;
+};
+
+static const char* TAG = "ESP::EXEC";
+
+static executor_unit_t    executor_unit_list[EXECUTOR_UNIT_MAX];
+static portMUX_TYPE       executor_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#if CONFIG_MGR_EXECUTOR_ENABLE
+static QueueHandle_t      executor_ready = NULL;
+static SemaphoreHandle_t  executor_stop_sem = NULL;
+static TaskHandle_t       executor_worker_list[EXECUTOR_WORKERS];
+#endif
+
+
+/**
+ * @brief Run the unit handler for @p msg, unless it expired, and release it.
+ *
+ * @return Handler result.
+ */
+static esp_err_t executor_Run(executor_unit_t* unit, msg_t* msg) {
+  esp_err_t result;
+
+  ESP_LOGD(TAG, "[%s] %s: type: %d [%s], from: 0x%08lx, to: 0x%08lx", __func__, unit->cfg.name,
+      msg->type, GET_MSG_TYPE_NAME(msg->type),
+      msg->from, msg->to);
+
+  if (msgpool_IsExpired(msg)) {
+    /* Stale: waited on the bus past its TTL, not worth parsing */
+    msgpool_Release(msg);
+    MGR_Heartbeat(unit->cfg.module);
+    return ESP_OK;
+  }
+
+  int64_t trace = bustrace_ModBegin(unit->cfg.module, msg);
+  result = unit->cfg.handler(msg);
+  bustrace_ModEnd(unit->cfg.module, msg, trace);
+  msgpool_Release(msg);
+  ++unit->runs;
+  MGR_Heartbeat(unit->cfg.module);
+
+  if ((result != ESP_OK) && (result != ESP_TASK_DONE)) {
+    ESP_LOGE(TAG, "[%s] %s: Error: %d", __func__, unit->cfg.name, result);
+  }
+  return result;
+}
+
+#if !CONFIG_MGR_EXECUTOR_ENABLE
+/**
+ * @brief Dedicated task of a unit (task mode).
+ */
+static void executor_TaskFn(void* param) {
+  executor_unit_t* unit = (executor_unit_t*) param;
+  msg_t* msg = NULL;
+  bool loop = true;
+
+  ESP_LOGI(TAG, "++%s(%s)", __func__, unit->cfg.name);
+  while (loop) {
+    if (msgpool_Receive(unit->queue, &msg, portMAX_DELAY) == ESP_OK) {
+      loop = (executor_Run(unit, msg) != ESP_TASK_DONE);
+    } else {
+      ESP_LOGE(TAG, "[%s] %s: Message error.", __func__, unit->cfg.name);
+    }
+  }
+  ESP_LOGI(TAG, "--%s(%s)", __func__, unit->cfg.name);
+  xSemaphoreGive(unit->done);
+  vTaskDelete(NULL);
+}
+
+#else /* CONFIG_MGR_EXECUTOR_ENABLE */
+/**
+ * @brief Put @p unit into the ready queue unless it is there or on a worker already.
+ */
+static void executor_Schedule(executor_unit_t* unit) {
+  uint32_t expected = 0;
+
+  if (__atomic_compare_exchange_n(&unit->scheduled, &expected, 1U, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+    /* Never blocks: the ready queue holds every unit once */
+    if (xQueueSend(executor_ready, &unit, portMAX_DELAY) != pdTRUE) {
+      ESP_LOGE(TAG, "[%s] %s: xQueueSend() failed.", __func__, unit->cfg.name);
+    }
+  }
+}
+
+static void executor_WorkerFn(void* param) {
+  executor_unit_t* unit = NULL;
+
+  ESP_LOGI(TAG, "++%s(%u)", __func__, (unsigned) (uintptr_t) param);
+  while ((xQueueReceive(executor_ready, &unit, portMAX_DELAY) == pdTRUE) && (unit != NULL)) {
+    bool stop = false;
+
+    for (uint32_t cnt = 0; (cnt < EXECUTOR_BATCH) && !stop; ++cnt) {
+      msg_t* msg = NULL;
+
+      if (msgpool_Receive(unit->queue, &msg, (TickType_t) 0) != ESP_OK) {
+        break;
+      }
+      stop = (executor_Run(unit, msg) == ESP_TASK_DONE);
+    }
+    if (stop) {
+      /* Stays scheduled, so no worker picks it up again */
+      xSemaphoreGive(unit->done);
+      continue;
+    }
+    __atomic_store_n(&unit->scheduled, 0U, __ATOMIC_SEQ_CST);
+    if (uxQueueMessagesWaiting(unit->queue) > 0) {
+      executor_Schedule(unit);
+    }
+  }
+  ESP_LOGI(TAG, "--%s(%u)", __func__, (unsigned) (uintptr_t) param);
+  xSemaphoreGive(executor_stop_sem);
+  vTaskDelete(NULL);
+}
+#endif /* CONFIG_MGR_EXECUTOR_ENABLE */
+
+esp_err_t executor_Init(void) {
+  esp_err_t result = ESP_OK;
+
+  ESP_LOGI(TAG, "++%s()", __func__);
+  memset(executor_unit_list, 0, sizeof(executor_unit_list));
+#if CONFIG_MGR_EXECUTOR_ENABLE
+  executor_ready = xQueueCreate(EXECUTOR_UNIT_MAX + EXECUTOR_WORKERS, sizeof(executor_unit_t*));
+  executor_stop_sem = xSemaphoreCreateCounting(EXECUTOR_WORKERS, 0);
+  if ((executor_ready == NULL) || (executor_stop_sem == NULL)) {
+    ESP_LOGE(TAG, "[%s] xQueueCreate() failed.", __func__);
+    return ESP_FAIL;
+  }
+  for (uint32_t idx = 0; idx < EXECUTOR_WORKERS; ++idx) {
+    char name[configMAX_TASK_NAME_LEN];
+
+    snprintf(name, sizeof(name), EXECUTOR_TASK_NAME, (unsigned) idx);
+    xTaskCreate(executor_WorkerFn, name, EXECUTOR_STACK_SIZE, (void*) (uintptr_t) idx, EXECUTOR_PRIORITY,
+        &executor_worker_list[idx]);
+    if (executor_worker_list[idx] == NULL) {
+      ESP_LOGE(TAG, "[%s] xTaskCreate() failed.", __func__);
+      result = ESP_FAIL;
+      break;
+    }
+  }
+#endif
+  ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
+  return result;
+}
+
+esp_err_t executor_Done(void) {
+  esp_err_t result = ESP_OK;
+
+  ESP_LOGI(TAG, "++%s()", __func__);
+#if CONFIG_MGR_EXECUTOR_ENABLE
+  if (executor_ready) {
+    executor_unit_t* stop = NULL;
+    uint32_t running = 0;
+
+    for (uint32_t idx = 0; idx < EXECUTOR_WORKERS; ++idx) {
+      if (executor_worker_list[idx]) {
+        xQueueSend(executor_ready, &stop, portMAX_DELAY);
+        executor_worker_list[idx] = NULL;
+        ++running;
+      }
+    }
+    while (running--) {
+      xSemaphoreTake(executor_stop_sem, portMAX_DELAY);
+    }
+    vQueueDelete(executor_ready);
+    executor_ready = NULL;
+    vSemaphoreDelete(executor_stop_sem);
+    executor_stop_sem = NULL;
+  }
+#endif
+  ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
+  return result;
+}
+
+executor_unit_t* executor_Create(const executor_cfg_t* cfg) {
+  executor_unit_t* unit = NULL;
+
+  if ((cfg == NULL) || (cfg->handler == NULL)) {
+    return NULL;
+  }
+  ESP_LOGI(TAG, "++%s(%s)", __func__, cfg->name);
+  taskENTER_CRITICAL(&executor_lock);
+  for (uint32_t idx = 0; idx < EXECUTOR_UNIT_MAX; ++idx) {
+    if (!executor_unit_list[idx].used) {
+      unit = &executor_unit_list[idx];
+      memset(unit, 0, sizeof(*unit));
+      unit->used = true;
+      break;
+    }
+  }
+  taskEXIT_CRITICAL(&executor_lock);
+  if (unit == NULL) {
+    ESP_LOGE(TAG, "[%s] No free unit for '%s', raise EXECUTOR_UNIT_MAX.", __func__, cfg->name);
+    return NULL;
+  }
+  unit->cfg = *cfg;
+
+  unit->queue = msgpool_CreateQueue(cfg->name, cfg->depth);
+  unit->done = xSemaphoreCreateBinary();
+  if ((unit->queue == NULL) || (unit->done == NULL)) {
+    ESP_LOGE(TAG, "[%s] xQueueCreate() failed.", __func__);
+    goto error;
+  }
+
+#if !CONFIG_MGR_EXECUTOR_ENABLE
+  xTaskCreate(executor_TaskFn, cfg->name, cfg->stack, unit, cfg->priority, &unit->task);
+  if (unit->task == NULL) {
+    ESP_LOGE(TAG, "[%s] xTaskCreate() failed.", __func__);
+    goto error;
+  }
+#endif
+  ESP_LOGI(TAG, "--%s(%s)", __func__, cfg->name);
+  return unit;
+
+error:
+  if (unit->queue) {
+    msgpool_DeleteQueue(unit->queue);
+  }
+  if (unit->done) {
+    vSemaphoreDelete(unit->done);
+  }
+  unit->used = false;
+  return NULL;
+}
+
+esp_err_t executor_Post(executor_unit_t* unit, const msg_t* msg, TickType_t wait) {
+  esp_err_t result;
+
+  if ((unit == NULL) || (unit->queue == NULL)) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  result = msgpool_Post(unit->queue, msg, wait);
+#if CONFIG_MGR_EXECUTOR_ENABLE
+  if (result == ESP_OK) {
+    executor_Schedule(unit);
+  }
+#endif
+  return result;
+}
+
+esp_err_t executor_Delete(executor_unit_t* unit, const msg_t* done) {
+  esp_err_t result = ESP_OK;
+
+  if ((unit == NULL) || !unit->used) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  ESP_LOGI(TAG, "++%s(%s)", __func__, unit->cfg.name);
+  result = executor_Post(unit, done, (TickType_t) 0);
+  if (result == ESP_OK) {
+    ESP_LOGD(TAG, "[%s] Wait on xSemaphoreTake to finish '%s'...", __func__, unit->cfg.name);
+    xSemaphoreTake(unit->done, portMAX_DELAY);
+  } else {
+    /* Without DONE in the queue the handler never stops - do not free what it uses */
+    ESP_LOGE(TAG, "[%s] %s: DONE not posted: %d", __func__, unit->cfg.name, result);
+    return result;
+  }
+  vSemaphoreDelete(unit->done);
+  msgpool_DeleteQueue(unit->queue);
+  ESP_LOGD(TAG, "[%s] %s: runs: %lu", __func__, unit->cfg.name, unit->runs);
+
+  taskENTER_CRITICAL(&executor_lock);
+  memset(unit, 0, sizeof(*unit));
+  taskEXIT_CRITICAL(&executor_lock);
+  ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
+  return result;
+}
+
+void executor_GetStats(executor_stats_t* stats) {
+  memset(stats, 0, sizeof(*stats));
+  stats->tcb_size = sizeof(StaticTask_t);
+  for (uint32_t idx = 0; idx < EXECUTOR_UNIT_MAX; ++idx) {
+    if (executor_unit_list[idx].used) {
+      ++stats->units;
+      stats->unit_stack += executor_unit_list[idx].cfg.stack;
+    }
+  }
+#if CONFIG_MGR_EXECUTOR_ENABLE
+  stats->workers = EXECUTOR_WORKERS;
+  stats->worker_stack = EXECUTOR_WORKERS * EXECUTOR_STACK_SIZE;
+  stats->reclaimed = (int32_t) (stats->unit_stack + stats->units * stats->tcb_size)
+                   - (int32_t) (stats->worker_stack + stats->workers * stats->tcb_size);
+#endif
+}
+
+uint32_t executor_GetUnits(executor_unit_info_t* info, uint32_t max) {
+  uint32_t cnt = 0;
+
+  for (uint32_t idx = 0; (idx < EXECUTOR_UNIT_MAX) && (cnt < max); ++idx) {
+    const executor_unit_t* unit = &executor_unit_list[idx];
+
+    if (unit->used) {
+      info[cnt].name    = unit->cfg.name;
+      info[cnt].stack   = unit->cfg.stack;
+      info[cnt].waiting = unit->queue ? (uint32_t) uxQueueMessagesWaiting(unit->queue) : 0U;
+      info[cnt].runs    = unit->runs;
+      ++cnt;
+    }
+  }
+  return cnt;
+}
+
+void executor_LogStats(void) {
+  executor_unit_info_t info[EXECUTOR_UNIT_MAX];
+  executor_stats_t stats;
+  uint32_t cnt = executor_GetUnits(info, EXECUTOR_UNIT_MAX);
+
+  executor_GetStats(&stats);
+  for (uint32_t idx = 0; idx < cnt; ++idx) {
+    ESP_LOGI(TAG, "unit: %-8s stack: %5lu, runs: %lu", info[idx].name, info[idx].stack, info[idx].runs);
+  }
+  ESP_LOGI(TAG, "units: %lu (%lu B stack), workers: %lu (%lu B stack), TCB: %lu B, reclaimed: %ld B",
+      stats.units, stats.unit_stack, stats.workers, stats.worker_stack, stats.tcb_size, stats.reclaimed);
+}
@@ -0,0 +1,42 @@
+/**
+ * @file lut.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Name tables of message types, data types and event ids
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Generated from the lists of msg_schema.h and data.h, so a new type gets its
+ * name with its `X()` line. Looked up by value through the GET_*_NAME() macros
+ * of lut.h.
+ */
+#include "lut.h"
+
+
+#define LUT_MSG_TYPE_NAME(_name, _size)   [MSG_TYPE_##_name] = "MSG_TYPE_" #_name,
+#define LUT_DATA_TYPE_NAME(_name)         [DATA_TYPE_##_name] = "DATA_TYPE_" #_name,
+#define LUT_ETH_EVENT_NAME(_name)         [DATA_ETH_EVENT_##_name] = "DATA_ETH_EVENT_" #_name,
+#define LUT_WIFI_EVENT_NAME(_name)        [DATA_WIFI_EVENT_##_name] = "DATA_WIFI_EVENT_" #_name,
+#define LUT_MQTT_EVENT_NAME(_name)        [DATA_MQTT_EVENT_##_name] = "DATA_MQTT_EVENT_" #_name,
+
+const char* const lut_msg_type_name[MSG_TYPE_MAX] = {
+  MSG_TYPE_SCHEMA(LUT_MSG_TYPE_NAME)
+};
+
+const char* const lut_data_type_name[DATA_TYPE_MAX] = {
+  DATA_TYPE_SCHEMA(LUT_DATA_TYPE_NAME)
+};
+
+const char* const lut_data_eth_event_name[DATA_ETH_EVENT_CNT] = {
+  DATA_ETH_EVENT_SCHEMA(LUT_ETH_EVENT_NAME)
+};
+
+const char* const lut_data_wifi_event_name[DATA_WIFI_EVENT_CNT] = {
+  DATA_WIFI_EVENT_SCHEMA(LUT_WIFI_EVENT_NAME)
+};
+
+const char* const lut_data_mqtt_event_name[DATA_MQTT_EVENT_CNT] = {
+  DATA_MQTT_EVENT_SCHEMA(LUT_MQTT_EVENT_NAME)
+};
@@ -16,6 +16,7 @@
 #include "esp_log.h"
 #include "esp_err.h"
 
+#include "boot_seq.h"
 #include "nvs_ctrl.h"
 #include "mgr_ctrl.h"
 #include "mem_check.h"
@@ -36,6 +37,7 @@ static const char* TAG = "ESP::MAIN";
 void app_main(void) {
   esp_err_t result;
 
+  bootseq_Mark(BOOTSEQ_MARK_APP);
   esp_log_level_set(TAG, CONFIG_MAIN_LOG_LEVEL);
 
   ESP_LOGI(TAG, "++%s()", __func__);
@@ -59,6 +61,7 @@ void app_main(void) {
   if (result != ESP_OK) {
     ESP_LOGE(TAG, "[%s]() - NVS_Init() failed", __func__);
   }
+  bootseq_Mark(BOOTSEQ_MARK_NVS);
   MEM_CHECK(mem_LogSnapshot(__func__, "after_nvs_init"));
 
   result = MGR_Init();
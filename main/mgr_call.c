@@ -0,0 +1,210 @@
+/**
+ * @file mgr_call.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Pending calls of MGR_Call() / MGR_CallAsync(), matched to replies by correlation id
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * A slot is taken, completed and cancelled under one spinlock, so a reply and a
+ * timeout of the same call cannot both win: whoever frees the slot first owns
+ * the outcome. Callbacks and notifications run after the lock is released.
+ */
+#include <string.h>
+
+#include "sdkconfig.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "mgr_call.h"
+#include "msg_pool.h"
+
+#include "lut.h"
+
+
+typedef struct {
+  uint32_t        id;           /* MSG_CALL_NONE for a free slot */
+  int64_t         begin_us;
+  int64_t         deadline_us;
+  TaskHandle_t    task;         /* blocking caller, NULL for an async call */
+  msg_t*          reply;        /* blocking caller's buffer */
+  mgr_call_cb_f   cb;           /* async callback */
+  void*           ctx;
+} mgrcall_slot_t;
+
+static const char* TAG = "ESP::CALL";
+
+static portMUX_TYPE     mgrcall_lock = portMUX_INITIALIZER_UNLOCKED;
+static mgrcall_slot_t   mgrcall_list[MGRCALL_PENDING_MAX];
+static uint32_t         mgrcall_last_id = MSG_CALL_NONE;
+static mgr_call_stats_t mgrcall_stats = {};
+
+
+/**
+ * @brief Slot of @p id, NULL if none; call with mgrcall_lock held.
+ */
+static mgrcall_slot_t* mgrcall_Find(uint32_t id) {
+  for (uint32_t idx = 0; idx < MGRCALL_PENDING_MAX; ++idx) {
+    if (mgrcall_list[idx].id == id) {
+      return &mgrcall_list[idx];
+    }
+  }
+  return NULL;
+}
+
+uint32_t mgrcall_Open(TaskHandle_t task, msg_t* reply, mgr_call_cb_f cb, void* ctx, uint32_t timeout_ms) {
+  int64_t now = esp_timer_get_time();
+  uint32_t id = MSG_CALL_NONE;
+
+  taskENTER_CRITICAL(&mgrcall_lock);
+  mgrcall_slot_t* slot = mgrcall_Find(MSG_CALL_NONE);
+  if (slot != NULL) {
+    /* Skip MSG_CALL_NONE when the counter wraps */
+    do {
+      id = ++mgrcall_last_id;
+    } while (id == MSG_CALL_NONE);
+    slot->id = id;
+    slot->begin_us = now;
+    slot->deadline_us = now + (int64_t) timeout_ms * 1000;
+    slot->task = task;
+    slot->reply = reply;
+    slot->cb = cb;
+    slot->ctx = ctx;
+    ++mgrcall_stats.pending;
+    ++mgrcall_stats.calls;
+  } else {
+    ++mgrcall_stats.full;
+  }
+  taskEXIT_CRITICAL(&mgrcall_lock);
+
+  if (id == MSG_CALL_NONE) {
+    ESP_LOGW(TAG, "[%s] All %d call slots are taken", __func__, MGRCALL_PENDING_MAX);
+  }
+  return id;
+}
+
+bool mgrcall_Cancel(uint32_t id, bool timeout) {
+  bool found = false;
+
+  if (id == MSG_CALL_NONE) {
+    return false;
+  }
+  taskENTER_CRITICAL(&mgrcall_lock);
+  mgrcall_slot_t* slot = mgrcall_Find(id);
+  if (slot != NULL) {
+    memset(slot, 0, sizeof(mgrcall_slot_t));
+    --mgrcall_stats.pending;
+    if (timeout) {
+      ++mgrcall_stats.timeouts;
+    }
+    found = true;
+  }
+  taskEXIT_CRITICAL(&mgrcall_lock);
+  return found;
+}
+
+void mgrcall_Complete(const msg_t* reply) {
+  int64_t now = esp_timer_get_time();
+  TaskHandle_t task = NULL;
+  mgr_call_cb_f cb = NULL;
+  void* ctx = NULL;
+  bool found = false;
+
+  taskENTER_CRITICAL(&mgrcall_lock);
+  mgrcall_slot_t* slot = (reply->call != MSG_CALL_NONE) ? mgrcall_Find(reply->call) : NULL;
+  if (slot != NULL) {
+    uint32_t rtt = (uint32_t) (now - slot->begin_us);
+
+    if (slot->task != NULL) {
+      /* Only the small slot of a reply is valid, do not read past it */
+      memcpy(slot->reply, reply, msgpool_GetMsgSize(reply->type));
+      task = slot->task;
+    } else {
+      cb = slot->cb;
+      ctx = slot->ctx;
+    }
+    memset(slot, 0, sizeof(mgrcall_slot_t));
+    --mgrcall_stats.pending;
+    ++mgrcall_stats.replies;
+    if (rtt > mgrcall_stats.rtt_max_us) {
+      mgrcall_stats.rtt_max_us = rtt;
+    }
+    found = true;
+  } else {
+    ++mgrcall_stats.late;
+  }
+  taskEXIT_CRITICAL(&mgrcall_lock);
+
+  if (!found) {
+    ESP_LOGW(TAG, "[%s] Late reply dropped. call: %lu, from: 0x%08lx", __func__, reply->call, reply->from);
+  } else if (task != NULL) {
+    xTaskNotifyGiveIndexed(task, MGRCALL_NOTIFY_INDEX);
+  } else if (cb != NULL) {
+    cb(reply, ctx);
+  }
+}
+
+void mgrcall_Expire(void) {
+  int64_t now = esp_timer_get_time();
+
+  for (uint32_t idx = 0; idx < MGRCALL_PENDING_MAX; ++idx) {
+    mgr_call_cb_f cb = NULL;
+    void* ctx = NULL;
+    uint32_t id = MSG_CALL_NONE;
+
+    taskENTER_CRITICAL(&mgrcall_lock);
+    mgrcall_slot_t* slot = &mgrcall_list[idx];
+    if ((slot->id != MSG_CALL_NONE) && (slot->task == NULL) && (now >= slot->deadline_us)) {
+      id = slot->id;
+      cb = slot->cb;
+      ctx = slot->ctx;
+      memset(slot, 0, sizeof(mgrcall_slot_t));
+      --mgrcall_stats.pending;
+      ++mgrcall_stats.timeouts;
+    }
+    taskEXIT_CRITICAL(&mgrcall_lock);
+
+    if (id != MSG_CALL_NONE) {
+      ESP_LOGW(TAG, "[%s] Call %lu timed out", __func__, id);
+      if (cb != NULL) {
+        cb(NULL, ctx);
+      }
+    }
+  }
+}
+
+TickType_t mgrcall_GetWaitTicks(void) {
+  int64_t deadline = INT64_MAX;
+  int64_t now = esp_timer_get_time();
+
+  taskENTER_CRITICAL(&mgrcall_lock);
+  for (uint32_t idx = 0; idx < MGRCALL_PENDING_MAX; ++idx) {
+    const mgrcall_slot_t* slot = &mgrcall_list[idx];
+
+    if ((slot->id != MSG_CALL_NONE) && (slot->task == NULL) && (slot->deadline_us < deadline)) {
+      deadline = slot->deadline_us;
+    }
+  }
+  taskEXIT_CRITICAL(&mgrcall_lock);
+
+  if (deadline == INT64_MAX) {
+    return portMAX_DELAY;
+  }
+  if (deadline <= now) {
+    return 0;
+  }
+  /* Round up, waking up a tick early would only mean another wait */
+  return pdMS_TO_TICKS((uint32_t) ((deadline - now + 999) / 1000)) + 1;
+}
+
+void mgrcall_GetStats(mgr_call_stats_t* stats) {
+  taskENTER_CRITICAL(&mgrcall_lock);
+  *stats = mgrcall_stats;
+  taskEXIT_CRITICAL(&mgrcall_lock);
+}
@@ -12,16 +12,29 @@
 
 #include "sdkconfig.h"
 
+#include "esp_attr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 
 #include "cJSON.h"
 
+#include "boot_seq.h"
+#include "bus_trace.h"
+#include "data_snap.h"
+#include "executor.h"
+#include "mgr_call.h"
 #include "mgr_ctrl.h"
+#include "mgr_isr.h"
 #include "mgr_reg.h"
+#include "mgr_sup.h"
 #include "mem_check.h"
+#include "msg_buf.h"
+#include "msg_pool.h"
+#include "sys_state.h"
 #include "tools.h"
 
 #include "mgr_reg_list.h"
@@ -30,10 +43,11 @@
 #include "lut.h"
 
 #define MGR_TASK_NAME           "mgr-task"
-#define MGR_TASK_STACK_SIZE     4096
+#define MGR_TASK_STACK_SIZE     6144  /* direct_fn handlers run on this stack */
 #define MGR_TASK_PRIORITY       8
 
-#define MGR_MSG_MAX             16
+#define MGR_LANE_CTRL_MAX       (CONFIG_MGR_LANE_CTRL_DEPTH)
+#define MGR_LANE_BULK_MAX       (CONFIG_MGR_LANE_BULK_DEPTH)
 
 #define GET_ETH_MAC(_mac)       (_mac)[0], (_mac)[1], (_mac)[2], (_mac)[3], (_mac)[4], (_mac)[5]
 /** Use when argument is data_eth_mac_t* (not the array itself); mac[0] would be the whole 6-byte row. */
@@ -54,14 +68,42 @@
 static const char* TAG = "ESP::MGR";
 
 
-static int mgr_modules_cnt = MGR_REG_LIST_CNT;
+/* REG_*_BIT of the registered modules in mgr_reg_order, built by mgr_BuildRoute() */
+static uint8_t  mgr_modules[MGR_REG_ORDER_CNT] = {};
+static int      mgr_modules_cnt = 0;
 
-static QueueHandle_t      mgr_msg_queue = NULL;
+/* mgr_reg_list[].depends of mgr_modules, limited to registered modules */
+static uint32_t mgr_depends[MGR_REG_ORDER_CNT] = {};
+
+/* Slots of mgr_reg_list in use, and those of them with a send_fn() */
+static uint32_t mgr_reg_mask = 0;
+static uint32_t mgr_send_mask = 0;
+
+typedef struct {
+  const char*       name;
+  UBaseType_t       depth;
+  QueueHandle_t     queue;
+  mgr_lane_stats_t  stats;
+} mgr_lane_t;
+
+static mgr_lane_t mgr_lane_list[MGR_LANE_MAX] = {
+  [MGR_LANE_CTRL] = { .name = "mgr/ctrl", .depth = MGR_LANE_CTRL_MAX, },
+  [MGR_LANE_BULK] = { .name = "mgr/bulk", .depth = MGR_LANE_BULK_MAX, },
+};
+
+/* Lane per message type, everything not listed here is control traffic */
+static uint8_t mgr_lane_map[MSG_TYPE_MAX] = {
+  [MSG_TYPE_MQTT_PUBLISH]         = MGR_LANE_BULK,
+  [MSG_TYPE_MQTT_SUBSCRIBE_LIST]  = MGR_LANE_BULK,
+  [MSG_TYPE_WIFI_SCAN_RESULT]     = MGR_LANE_BULK,
+  [MSG_TYPE_LCD_DATA]             = MGR_LANE_BULK,
+};
+
+static portMUX_TYPE       mgr_lane_lock = portMUX_INITIALIZER_UNLOCKED;
 static TaskHandle_t       mgr_task_id = NULL;
 static SemaphoreHandle_t  mgr_sem_id = NULL;
 
 static data_eth_mac_t     mgr_eth_mac = {};
-static data_ip_info_t     mgr_eth_info = {};
 
 
 static char mgr_reg_pub_pattern[] = "REGISTER/ESP/%02X%02X%02X";
@@ -72,10 +114,10 @@ static char mgr_mac_pattern[]     = "%02X:%02X:%02X:%02X:%02X:%02X";
 static char mgr_ip_pattern[]      = "%d.%d.%d.%d";
 
 static char mgr_topic_pattern[] = "%s/req/%s";
+static char mgr_req_pattern[]   = "%s/req/";
 
 static char mgr_uid[MGR_UID_MAX]  = {}; /* keeps only UID, as: ESP/12AB34 */
 static char mgr_mac[MGR_MAC_MAX]  = {}; /* keeps only MAC, as: 12:34:56:78:90:AB */
-static char mgr_ip[MGR_IP_MAX]    = {}; /* keeps only IP, as: 123.123.123.123 */
 
 
 /**
@@ -84,6 +126,12 @@ static char mgr_ip[MGR_IP_MAX]    = {}; /* keeps only IP, as: 123.123.123.123 */
  */
 static mgr_reg_send_f mgr_send_to_mqtt_fn = NULL;
 
+/* Boot report logged, on the first DATA_MQTT_EVENT_CONNECTED */
+static bool mgr_boot_reported = false;
+
+/* Module topics subscribed on a connection of this boot; a resumed session (SYSSTATE_MQTT_SESSION) keeps them */
+static bool mgr_subscribed = false;
+
 typedef struct {
   uint32_t  type;
   char      topic[MGR_TOPIC_MAX_LEN];
@@ -93,7 +141,145 @@ typedef struct {
  * @brief The variable holds the list of modules types along with its topic
  * 
  */
-static mgr_topic_t  mgr_topic_list[MGR_REG_LIST_CNT] = {};
+static mgr_topic_t  mgr_topic_list[MGR_REG_ORDER_CNT] = {};
+
+/* Inbound dispatch, built with the UID: module segment of "{uid}/req/{module}" -> index in mgr_reg_list */
+#define MGR_DISPATCH_SIZE       (64U)   /* power of two, twice the 32 bits of a REG_xxx_CTRL mask */
+#define MGR_DISPATCH_EMPTY      (0xFFU)
+
+static uint8_t      mgr_dispatch[MGR_DISPATCH_SIZE] = {};
+static char         mgr_req_prefix[MGR_UID_MAX + 5U] = {};  /* "ESP/12AB34/req/" */
+static size_t       mgr_req_prefix_len = 0;
+
+/**
+ * @brief Route table: for each message type, the REG_xxx_CTRL mask of modules subscribed to it.
+ *
+ * Built once from mgr_reg_list[].subscribe in MGR_Init(), so a broadcast only reaches
+ * the modules which handle its type and no one wakes up just to drop it. Every set bit
+ * is the slot of a module with a send_fn() in mgr_reg_list.
+ */
+static uint32_t     mgr_type_route[MSG_TYPE_MAX] = {};
+
+/* Deliveries skipped thanks to the route table (module addressed but not subscribed) */
+static uint32_t     mgr_route_skipped = 0;
+
+#if CONFIG_MGR_DIRECT_DISPATCH
+static bool         mgr_direct = true;
+#else
+static bool         mgr_direct = false;
+#endif
+
+/* Deliveries handled inline by direct_fn */
+static uint32_t     mgr_direct_cnt = 0;
+
+
+/**
+ * @brief Take the lowest set bit out of @p mask.
+ *
+ * @return Its position, i.e. the REG_*_BIT / mgr_reg_list slot.
+ */
+static inline int mgr_PopBit(uint32_t* mask) {
+  int bit = __builtin_ctz(*mask);
+
+  *mask &= *mask - 1U;
+  return bit;
+}
+
+static void mgr_BuildRoute(void) {
+  uint32_t ordered = 0;
+
+  ESP_LOGI(TAG, "++%s()", __func__);
+  memset(mgr_type_route, 0, sizeof(mgr_type_route));
+  mgr_reg_mask = 0;
+  mgr_send_mask = 0;
+  for (int idx = 0; idx < REG_BIT_MAX; ++idx) {
+    const mgr_reg_t* reg = &mgr_reg_list[idx];
+
+    if (reg->type == 0U) {
+      continue;
+    }
+    if ((reg->type & (1UL << idx)) == 0U) {
+      ESP_LOGE(TAG, "[%s] Module '%s' (type: 0x%08lx) is not in its slot: %d", __func__, reg->name, reg->type, idx);
+      continue;
+    }
+    mgr_reg_mask |= (1UL << idx);
+    mgrsup_Watch(idx, (mgr_sup_policy_e) reg->restart);
+    if (reg->send_fn == NULL) {
+      continue;
+    }
+    mgr_send_mask |= (1UL << idx);
+    if (reg->subscribe == MSG_MASK_NONE) {
+      ESP_LOGD(TAG, "[%s] Module '%s' has send_fn() but no subscriptions.", __func__, reg->name);
+    }
+    for (int type = 0; type < MSG_TYPE_MAX; ++type) {
+      if (reg->subscribe & MSG_MASK(type)) {
+        mgr_type_route[type] |= (1UL << idx);
+      }
+    }
+    if ((reg->direct != MSG_MASK_NONE) && (reg->direct_fn == NULL)) {
+      ESP_LOGW(TAG, "[%s] Module '%s' has direct types but no direct_fn().", __func__, reg->name);
+    }
+  }
+
+  /* Lifecycle order: registered modules as listed in mgr_reg_order */
+  mgr_modules_cnt = 0;
+  for (int pos = 0; pos < (int) MGR_REG_ORDER_CNT; ++pos) {
+    uint32_t bit = mgr_reg_order[pos];
+
+    ordered |= (1UL << bit);
+    if (mgr_reg_mask & (1UL << bit)) {
+      mgr_depends[mgr_modules_cnt] = mgr_reg_list[bit].depends & mgr_reg_mask;
+      mgr_modules[mgr_modules_cnt++] = (uint8_t) bit;
+    }
+  }
+  if (mgr_reg_mask & ~ordered) {
+    ESP_LOGE(TAG, "[%s] Modules missing in mgr_reg_order: 0x%08lx", __func__, mgr_reg_mask & ~ordered);
+  }
+
+  for (int type = 0; type < MSG_TYPE_MAX; ++type) {
+    ESP_LOGD(TAG, "[%s] type: %2d [%s] -> 0x%08lx", __func__, type, GET_MSG_TYPE_NAME(type), mgr_type_route[type]);
+  }
+  ESP_LOGI(TAG, "--%s() - modules: %d, mask: 0x%08lx", __func__, mgr_modules_cnt, mgr_reg_mask);
+}
+
+/**
+ * @brief Get the mask of modules which will receive a message of @p type sent to @p to.
+ */
+static inline uint32_t mgr_GetRoute(msg_type_e type, uint32_t to) {
+  return (type < MSG_TYPE_MAX) ? (to & mgr_type_route[type]) : 0;
+}
+
+/**
+ * @brief Hand @p msg to the module in slot @p idx: inline through direct_fn for its direct types, else send_fn.
+ */
+static esp_err_t mgr_Deliver(int idx, const msg_t* msg) {
+  const mgr_reg_t* reg = &mgr_reg_list[idx];
+  esp_err_t result = ESP_ERR_NOT_SUPPORTED;
+
+  if (!mgrsup_IsUp(idx)) {
+    /* Stopped by a failed restart, its queue is gone */
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (mgr_direct && reg->direct_fn && (msg->type < MSG_TYPE_MAX) && (reg->direct & MSG_MASK(msg->type))) {
+    int64_t begin = esp_timer_get_time();
+
+    result = reg->direct_fn(msg);
+    if (result != ESP_ERR_NOT_SUPPORTED) {
+      ++mgr_direct_cnt;
+      bustrace_Direct(reg->type, msg, begin);
+    }
+  }
+  if ((result == ESP_ERR_NOT_SUPPORTED) && reg->send_fn) {
+    int64_t begin = esp_timer_get_time();
+
+    result = reg->send_fn(msg);
+    bustrace_Record(BUS_HOP_NOTIFY, msg, reg->type, (uint32_t) (esp_timer_get_time() - begin));
+    if (result == ESP_OK) {
+      mgrsup_Delivered(idx);
+    }
+  }
+  return result;
+}
 
 
 static esp_err_t mgr_Init(int id) {
@@ -106,6 +292,7 @@ static esp_err_t mgr_Init(int id) {
       mgr_send_to_mqtt_fn = mgr_reg_list[id].send_fn;
     }
   }
+  MEM_CHECK(mem_LogSnapshot(__func__, "mgr_init_module_done: %s", mgr_reg_list[id].name));
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
   return result;
 }
@@ -128,24 +315,203 @@ static esp_err_t mgr_Run(int id) {
   if (mgr_reg_list[id].run_fn) {
     result = mgr_reg_list[id].run_fn();
   }
+  MEM_CHECK(mem_LogSnapshot(__func__, "mgr_run_module_done: %s", mgr_reg_list[id].name));
+  ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
+  return result;
+}
+
+static void mgr_StartMqtt(void);
+
+/**
+ * @brief Restart the module in slot @p id alone, for the supervisor (manager task).
+ */
+static esp_err_t mgr_Restart(int id) {
+  esp_err_t result = ESP_OK;
+
+  ESP_LOGI(TAG, "++%s(id: %d, type: 0x%08lx)", __func__, id, mgr_reg_list[id].type);
+  result = mgr_Done(id);
+  if (result != ESP_OK) {
+    /* The old task may still run: no second one next to it, the supervisor counts a failed restart */
+    ESP_LOGE(TAG, "[%s] '%s': done_fn() - result: %d", __func__, mgr_reg_list[id].name, result);
+  } else {
+    result = mgr_Init(id);
+  }
+  if (result == ESP_OK) {
+    result = mgr_Run(id);
+  }
+  if ((result == ESP_OK) && (mgr_reg_list[id].type & REG_MQTT_CTRL) && (sysstate_GetFlags() & SYSSTATE_IP)) {
+    /* The link is up already, no ETH_IP will start the new client */
+    mgr_StartMqtt();
+  }
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
   return result;
 }
 
 static esp_err_t mgr_Send(const msg_t* msg) {
   esp_err_t result = ESP_OK;
+  mgr_lane_e lane = MGR_GetLane(msg->type);
+  esp_err_t posted;
 
-  ESP_LOGI(TAG, "++%s()", __func__);
-  if (xQueueSend(mgr_msg_queue, msg, (TickType_t) 0) != pdPASS) {
+  ESP_LOGI(TAG, "++%s(lane: %d)", __func__, lane);
+  if ((mgr_task_id != NULL) && (xTaskGetCurrentTaskHandle() == mgr_task_id)) {
+    /* Only this task drains the lanes: waiting for room (block policy) would stall the bus */
+    posted = msgpool_PostNoWait(mgr_lane_list[lane].queue, msg);
+  } else {
+    posted = msgpool_Post(mgr_lane_list[lane].queue, msg, (TickType_t) 0);
+  }
+  if (posted != ESP_OK) {
     ESP_LOGE(TAG, "[%s] Message error. type: %d [%s], from: 0x%08lx, to: 0x%08lx", __func__, 
         msg->type, GET_MSG_TYPE_NAME(msg->type),
         msg->from, msg->to);
     result = ESP_FAIL;
+  } else if (mgr_task_id != NULL) {
+    /* mgr_Receive() waits on the task notification, one give per accepted message */
+    xTaskNotifyGive(mgr_task_id);
+  }
+  taskENTER_CRITICAL(&mgr_lane_lock);
+  if (result == ESP_OK) {
+    ++mgr_lane_list[lane].stats.posted;
+  } else {
+    ++mgr_lane_list[lane].stats.dropped;
   }
+  taskEXIT_CRITICAL(&mgr_lane_lock);
+  bustrace_Record((result == ESP_OK) ? BUS_HOP_SEND : BUS_HOP_DROP, msg, msg->to, (uint32_t) lane);
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
   return result;
 }
 
+/**
+ * @brief Next message of the lanes, control lane first; NULL when all are empty.
+ */
+static msg_t* mgr_TakeLane(void) {
+  msg_t* msg = NULL;
+
+  /* mgr_Send() does not wait on this task, a full lane drops the entry */
+  mgrisr_Drain(mgr_Send);
+  for (int lane = 0; lane < MGR_LANE_MAX; ++lane) {
+    if (msgpool_Receive(mgr_lane_list[lane].queue, &msg, (TickType_t) 0) == ESP_OK) {
+      int64_t stamp = msgpool_GetStamp(msg);
+      uint32_t latency = (stamp > 0) ? (uint32_t) (esp_timer_get_time() - stamp) : 0;
+      mgr_lane_stats_t* stats = &mgr_lane_list[lane].stats;
+
+      taskENTER_CRITICAL(&mgr_lane_lock);
+      ++stats->dispatched;
+      stats->latency_sum_us += latency;
+      if (latency > stats->latency_max_us) {
+        stats->latency_max_us = latency;
+      }
+      taskEXIT_CRITICAL(&mgr_lane_lock);
+      ESP_LOGD(TAG, "[%s] lane: %d, latency: %lu us", __func__, lane, latency);
+      bustrace_Record(BUS_HOP_MGR_RECV, msg, msg->to, latency);
+      return msg;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Take the next message, control lane first.
+ *
+ * `mgr_Send()` and `MGR_SendFromISR()` give the manager task's notification after
+ * a message is in place, so when the lanes and the interrupt rings are empty the
+ * task can sleep on the notification without missing one. Messages raised by
+ * interrupts are moved to their lanes first; then the control lane is emptied
+ * before the bulk one is touched.
+ *
+ * @param wait Ticks to wait for a message.
+ * @return Pooled handle or NULL on timeout or error.
+ */
+static msg_t* mgr_Receive(TickType_t wait) {
+  msg_t* msg = mgr_TakeLane();
+
+  /* A notification left over from a message already taken just means one more empty pass */
+  if ((msg == NULL) && (ulTaskNotifyTake(pdTRUE, wait) != 0U)) {
+    msg = mgr_TakeLane();
+  }
+  return msg;
+}
+
+static void mgr_LogLanes(void) {
+  for (int lane = 0; lane < MGR_LANE_MAX; ++lane) {
+    mgr_lane_stats_t stats;
+
+    if (MGR_GetLaneStats(lane, &stats) != ESP_OK) {
+      continue;
+    }
+    ESP_LOGI(TAG, "lane: %-8s posted: %lu, dropped: %lu, dispatched: %lu, latency avg: %lu us, max: %lu us",
+        mgr_lane_list[lane].name, stats.posted, stats.dropped, stats.dispatched,
+        stats.dispatched ? (uint32_t) (stats.latency_sum_us / stats.dispatched) : 0,
+        stats.latency_max_us);
+  }
+}
+
+/**
+ * @brief FNV-1a hash of a module segment
+ *
+ * @param name Module name, e.g. 'relay'
+ * @return uint32_t Hash, the slot is its low bits
+ */
+static uint32_t mgr_HashName(const char* name) {
+  uint32_t hash = 2166136261U;
+
+  while (*name != '\0') {
+    hash ^= (uint8_t) *name++;
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+/**
+ * @brief Find the module a request topic is for, exact match on the module segment
+ *
+ * @param name Module segment of the topic, what follows "{uid}/req/"
+ * @return int Index in mgr_reg_list, -1 when no registered module has that name
+ */
+static int mgr_FindModule(const char* name) {
+  uint32_t slot = mgr_HashName(name) & (MGR_DISPATCH_SIZE - 1U);
+
+  for (uint32_t probe = 0; probe < MGR_DISPATCH_SIZE; ++probe) {
+    uint8_t idx = mgr_dispatch[slot];
+
+    if (idx == MGR_DISPATCH_EMPTY) {
+      break;
+    }
+    if (strcmp(mgr_reg_list[idx].name, name) == 0) {
+      return idx;
+    }
+    slot = (slot + 1U) & (MGR_DISPATCH_SIZE - 1U);
+  }
+  return -1;
+}
+
+/**
+ * @brief Build the request topics and the dispatch table of the registered modules
+ *
+ * Done once the UID is known. mgr_ParseMqttData() then routes "{uid}/req/{module}"
+ * with one hash and one strcmp(), instead of a substring search over every module.
+ *
+ */
+static void mgr_CreateDispatch(void) {
+  ESP_LOGI(TAG, "++%s()", __func__);
+
+  mgr_req_prefix_len = (size_t) snprintf(mgr_req_prefix, sizeof(mgr_req_prefix), mgr_req_pattern, mgr_uid);
+  memset(mgr_dispatch, MGR_DISPATCH_EMPTY, sizeof(mgr_dispatch));
+  for (int idx = 0; idx < mgr_modules_cnt; ++idx) {
+    const mgr_reg_t* reg = &mgr_reg_list[mgr_modules[idx]];
+    uint32_t slot = mgr_HashName(reg->name) & (MGR_DISPATCH_SIZE - 1U);
+
+    mgr_topic_list[idx].type = reg->type;
+    snprintf(mgr_topic_list[idx].topic, sizeof(mgr_topic_list[idx].topic), mgr_topic_pattern, mgr_uid, reg->name);
+
+    while (mgr_dispatch[slot] != MGR_DISPATCH_EMPTY) {
+      slot = (slot + 1U) & (MGR_DISPATCH_SIZE - 1U);
+    }
+    mgr_dispatch[slot] = mgr_modules[idx];
+    ESP_LOGD(TAG, "[%s] '%s' -> slot: %lu", __func__, mgr_topic_list[idx].topic, slot);
+  }
+  ESP_LOGI(TAG, "--%s()", __func__);
+}
+
 /**
  * @brief Create a UID
  *
@@ -162,6 +528,8 @@ static void mgr_CreateUid(void) {
   snprintf(mgr_mac, MGR_MAC_MAX, mgr_mac_pattern, mgr_eth_mac[0], mgr_eth_mac[1], mgr_eth_mac[2], mgr_eth_mac[3], mgr_eth_mac[4], mgr_eth_mac[5]);
   ESP_LOGD(TAG, "[%s]     mgr_mac: '%s'", __func__, mgr_mac);
 
+  mgr_CreateDispatch();
+
   ESP_LOGI(TAG, "--%s()", __func__);
 }
 
@@ -178,12 +546,13 @@ static void mgr_SendUidToAll(void) {
 
   ESP_LOGI(TAG, "++%s()", __func__);
   memcpy(msg.payload.mgr.uid, mgr_uid, MGR_UID_MAX);
-  for (int idx = 0; idx < mgr_modules_cnt; ++idx) {
-    if ((msg.to & mgr_reg_list[idx].type) && mgr_reg_list[idx].send_fn) {
-      esp_err_t result = mgr_reg_list[idx].send_fn(&msg);
-      if (result != ESP_OK) {
-        ESP_LOGE(TAG, "[%s] Send() - Error: %d", __func__, result);
-      }
+  uint32_t route = mgr_GetRoute(msg.type, msg.to);
+  while (route != 0U) {
+    int idx = mgr_PopBit(&route);
+    /* Like every broadcast: skips modules left down by the supervisor */
+    esp_err_t result = mgr_Deliver(idx, &msg);
+    if (result != ESP_OK) {
+      ESP_LOGE(TAG, "[%s] '%s': mgr_Deliver() - Error: %d", __func__, mgr_reg_list[idx].name, result);
     }
   }
   ESP_LOGI(TAG, "--%s()", __func__);
@@ -217,18 +586,26 @@ void mgr_CreateModuleList(void) {
     cJSON *root = cJSON_CreateObject();
     if (root != NULL)
     {
+      char ip_str[MGR_IP_MAX] = {};
+      sys_state_t state;
       int ret = -1;
 
+      /* Address of the interface which is up, Ethernet first */
+      sysstate_Get(&state);
+      uint32_t ip = state.ip[SYSSTATE_NETIF_ETH] ? state.ip[SYSSTATE_NETIF_ETH] : state.ip[SYSSTATE_NETIF_WIFI];
+      const uint8_t* addr = (const uint8_t*) &ip;
+      snprintf(ip_str, MGR_IP_MAX, mgr_ip_pattern, addr[0], addr[1], addr[2], addr[3]);
+
       cJSON_AddStringToObject(root, "operation", "event");
       cJSON_AddStringToObject(root, "uid", mgr_uid);
       cJSON_AddStringToObject(root, "mac", mgr_mac);
-      cJSON_AddStringToObject(root, "ip", mgr_ip);
+      cJSON_AddStringToObject(root, "ip", ip_str);
 
       /* add "list" array */
       cJSON* list = cJSON_AddArrayToObject(root, "list");
       if (list) {
         for (int idx = 0; idx < mgr_modules_cnt; ++idx) {
-          cJSON_AddItemToArray(list, cJSON_CreateString(mgr_reg_list[idx].name));
+          cJSON_AddItemToArray(list, cJSON_CreateString(mgr_reg_list[mgr_modules[idx]].name));
         }
       }
       if ((ret = cJSON_PrintPreallocated(root, msg.payload.mqtt.u.data.msg, DATA_MSG_SIZE, 0)) == 1) {
@@ -251,13 +628,11 @@ void mgr_CreateModuleList(void) {
 }
 
 /**
- * @brief Send message with topic to subscribe for every module
+ * @brief Send messages with the topics to subscribe
  *
  * topic: STRING format
- *   ESP/12AB34/req/topic_1 - 1st topic
- *   ESP/12AB34/req/topic_2 - 2nd topic
- *   ...
- *   ESP/12AB34/req/topic_n - n topic
+ *   REGISTER/ESP/#  - registration requests
+ *   ESP/12AB34/req/+ - requests to every module, routed by mgr_ParseMqttData()
  *
  */
 void mgr_SubscribeTopic(void) {
@@ -277,16 +652,15 @@ void mgr_SubscribeTopic(void) {
       ESP_LOGE(TAG, "[%s] Send() - Error: %d", __func__, result);
     }
 
-    /* Subscribe every registered module */
-    for (int idx = 0; idx < mgr_modules_cnt; ++idx) {
-      mgr_topic_list[idx].type = mgr_reg_list[idx].type;
-      snprintf(mgr_topic_list[idx].topic, sizeof(mgr_topic_list[idx].topic), mgr_topic_pattern, mgr_uid,
-               mgr_reg_list[idx].name);
-      snprintf(msg.payload.mqtt.u.topic, DATA_TOPIC_SIZE, "%s", mgr_topic_list[idx].topic);
-      esp_err_t result = mgr_send_to_mqtt_fn(&msg);
+    /* One subscription for every module: ESP/12AB34/req/+ */
+    if (mgr_req_prefix_len != 0) {
+      snprintf(msg.payload.mqtt.u.topic, DATA_TOPIC_SIZE, "%s+", mgr_req_prefix);
+      result = mgr_send_to_mqtt_fn(&msg);
       if (result != ESP_OK) {
         ESP_LOGE(TAG, "[%s] Send() - Error: %d", __func__, result);
       }
+    } else {
+      ESP_LOGE(TAG, "[%s] No UID yet, no requests subscribed", __func__);
     }
   }
   ESP_LOGI(TAG, "--%s()", __func__);
@@ -318,10 +692,8 @@ void mgr_SubscribeList(void) {
       /* add "topics" array */
       cJSON* topics = cJSON_AddArrayToObject(root, "topics");
       if (topics) {
+        /* Topics of mgr_CreateDispatch() */
         for (int idx = 0; idx < mgr_modules_cnt; ++idx) {
-          mgr_topic_list[idx].type = mgr_reg_list[idx].type;
-          snprintf(mgr_topic_list[idx].topic, sizeof(mgr_topic_list[idx].topic), mgr_topic_pattern, mgr_uid,
-                   mgr_reg_list[idx].name);
           cJSON_AddItemToArray(topics, cJSON_CreateString(mgr_topic_list[idx].topic));
         }
       }
@@ -380,10 +752,21 @@ static esp_err_t mgr_parseMqttEvent(data_mqtt_event_e event_id) {
 
   ESP_LOGI(TAG, "++%s(event_id: %d [%s])", __func__, event_id, GET_DATA_MQTT_EVENT_NAME(event_id));
   if (event_id == DATA_MQTT_EVENT_CONNECTED) {
+    if (!mgr_boot_reported) {
+      mgr_boot_reported = true;
+      bootseq_Mark(BOOTSEQ_MARK_MQTT);
+      ESP_LOGI(TAG, "[%s] Boot to MQTT connected: %lu ms", __func__, bootseq_GetMark(BOOTSEQ_MARK_MQTT) / 1000U);
+      bootseq_LogReport();
+    }
     mgr_CreateModuleList();
 
-    mgr_SubscribeTopic();
-    //mgr_SubscribeList();
+    if (mgr_subscribed && (sysstate_GetFlags() & SYSSTATE_MQTT_SESSION)) {
+      ESP_LOGI(TAG, "[%s] Session resumed, subscriptions kept by the broker", __func__);
+    } else {
+      mgr_SubscribeTopic();
+      //mgr_SubscribeList();
+      mgr_subscribed = true;
+    }
   }
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
   return result;
@@ -410,7 +793,7 @@ static esp_err_t mgr_ParseRegisterEvent(const cJSON* root) {
   return result;
 }
 
-static esp_err_t mgr_ParseRegisterRequest(const data_mqtt_data_t* data_ptr) {
+static esp_err_t mgr_ParseRegisterRequest(const data_mqtt_in_t* data_ptr) {
   esp_err_t result = ESP_FAIL;
 
   ESP_LOGI(TAG, "++%s(topic: '%s', msg: '%s')", __func__, data_ptr->topic, data_ptr->msg);
@@ -439,43 +822,36 @@ static esp_err_t mgr_ParseRegisterRequest(const data_mqtt_data_t* data_ptr) {
 }
 
 static esp_err_t mgr_ParseMqttData(const msg_t* msg) {
-  const data_mqtt_data_t* data_ptr = &(msg->payload.mqtt.u.data);
+  const data_mqtt_in_t* data_ptr = &(msg->payload.mqtt.u.in);
   esp_err_t result = ESP_ERR_NOT_FOUND;
 
   ESP_LOGI(TAG, "++%s(topic: '%s', msg: '%s')", __func__, data_ptr->topic, data_ptr->msg);
 
-  if (memcmp(data_ptr->topic, mgr_reg_sub_pattern, strlen(mgr_reg_sub_pattern)) == 0) {
+  if (strncmp(data_ptr->topic, mgr_reg_sub_pattern, strlen(mgr_reg_sub_pattern)) == 0) {
     /* This is specific topic = REGISTER/ESP */
     /* When it arrived then resend REGISTER/ESP message once again */
     result = mgr_ParseRegisterRequest(data_ptr);
 
   } else {
-    /* topic must be grater than UID len + at least 4 bytes: */
-    /* UID + '/' + module name:  e.g. ESP/12AB34/123 */
-    if (strlen(data_ptr->topic) < (MGR_UID_LEN + 4)) {
-      ESP_LOGE(TAG, "[%s] topic: '%s' too short, size: %d", __func__, data_ptr->topic, strlen(data_ptr->topic));
-      return ESP_ERR_INVALID_SIZE;
-    }
-
-    /* Check UID in the topic */
-    if (memcmp(data_ptr->topic, mgr_uid, MGR_UID_LEN) != 0) {
-      ESP_LOGE(TAG, "[%s] topic: '%s' doesn't contain UID: '%s'", __func__, data_ptr->topic, mgr_uid);
+    /* Topic must be "{uid}/req/{module}": e.g. ESP/12AB34/req/relay */
+    if ((mgr_req_prefix_len == 0) || (strncmp(data_ptr->topic, mgr_req_prefix, mgr_req_prefix_len) != 0)) {
+      ESP_LOGE(TAG, "[%s] topic: '%s' isn't a request to UID: '%s'", __func__, data_ptr->topic, mgr_uid);
       return ESP_ERR_INVALID_ARG;
     }
 
     /* Gets module name and call send_fn() if module was found */
-    ESP_LOGD(TAG, "[%s] Find a module: '%s'", __func__, &(data_ptr->topic[MGR_UID_MAX]));
-    for (int idx = 0; idx < mgr_modules_cnt; ++idx) {
-      ESP_LOGD(TAG, "[%s] Registered module: '%s' on idx: %d", __func__, mgr_reg_list[idx].name, idx);
-      if (strstr(&(data_ptr->topic[MGR_UID_MAX]), mgr_reg_list[idx].name) != NULL) {
-        ESP_LOGD(TAG, "[%s] Module '%s' found.", __func__, mgr_reg_list[idx].name);
-        if (mgr_reg_list[idx].send_fn) {
-          result = mgr_reg_list[idx].send_fn(msg);
-        } else {
-          result = ESP_FAIL;
-        }
-        break;
+    const char* name = &(data_ptr->topic[mgr_req_prefix_len]);
+    int idx = mgr_FindModule(name);
+
+    ESP_LOGD(TAG, "[%s] Find a module: '%s' -> idx: %d", __func__, name, idx);
+    if (idx >= 0) {
+      if (mgr_reg_list[idx].send_fn) {
+        result = mgr_Deliver(idx, msg);
+      } else {
+        result = ESP_FAIL;
       }
+    } else {
+      ESP_LOGW(TAG, "[%s] No module '%s'", __func__, name);
     }
   }
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
@@ -503,6 +879,12 @@ static esp_err_t mgr_ParseMsg(const msg_t* msg) {
       break;
     }
 
+    case MSG_TYPE_MGR_REPLY: {
+      ESP_LOGD(TAG, "[%s] Reply: call: %lu, from: 0x%08lx", __func__, msg->call, msg->from);
+      mgrcall_Complete(msg);
+      break;
+    }
+
     case MSG_TYPE_ETH_EVENT: {
       data_eth_event_e event_id = msg->payload.eth.u.event_id;
 
@@ -528,22 +910,21 @@ static esp_err_t mgr_ParseMsg(const msg_t* msg) {
     }
 
     case MSG_TYPE_ETH_IP: {
-      uint8_t* addr = NULL;
-
-      mgr_eth_info = msg->payload.eth.u.info;
+      /* The address itself is kept by sys_state.c, for mgr_CreateModuleList() */
+      const data_ip_info_t* info = &(msg->payload.eth.u.info);
+      const uint8_t* addr = NULL;
 
-      addr = (uint8_t*) &(mgr_eth_info.ip);
-      snprintf(mgr_ip, MGR_IP_MAX, mgr_ip_pattern, addr[0], addr[1], addr[2], addr[3]);
+      addr = (const uint8_t*) &(info->ip);
       ESP_LOGD(TAG, "[%s]   IP: %d.%d.%d.%d", __func__, 
         addr[0], addr[1], addr[2], addr[3]
       );
 
-      addr = (uint8_t*) &(mgr_eth_info.mask);
+      addr = (const uint8_t*) &(info->mask);
       ESP_LOGD(TAG, "[%s] MASK: %d.%d.%d.%d", __func__, 
         addr[0], addr[1], addr[2], addr[3]
       );
 
-      addr = (uint8_t*) &(mgr_eth_info.gw);
+      addr = (const uint8_t*) &(info->gw);
       ESP_LOGD(TAG, "[%s]   GW: %d.%d.%d.%d", __func__, 
         addr[0], addr[1], addr[2], addr[3]
       );
@@ -581,11 +962,23 @@ static esp_err_t mgr_NotifyCtrl(const msg_t* msg) {
   ESP_LOGI(TAG, "++%s(type: %d [%s], from: 0x%08lx, to: 0x%08lx)", __func__, 
       msg->type,  GET_MSG_TYPE_NAME(msg->type),
       msg->from, msg->to);
-  for (int idx = 0; idx < mgr_modules_cnt; ++idx) {
-    if (msg->to & mgr_reg_list[idx].type) {
-      if (mgr_reg_list[idx].send_fn) {
-        result = mgr_reg_list[idx].send_fn(msg);
-      }
+  uint32_t route = mgr_GetRoute(msg->type, msg->to);
+  uint32_t skipped = msg->to & mgr_send_mask & ~route;
+  if (route == 0) {
+    ESP_LOGD(TAG, "[%s] No module subscribed to type: %d", __func__, msg->type);
+  }
+  /* One step per receiver: route only holds slots with a send_fn() */
+  while (route != 0U) {
+    result = mgr_Deliver(mgr_PopBit(&route), msg);
+  }
+  while (skipped != 0U) {
+    int idx = mgr_PopBit(&skipped);
+
+    ++mgr_route_skipped;
+    if (msg->to != REG_ALL_CTRL) {
+      /* Addressed directly but not subscribed - most likely a missing .subscribe bit */
+      ESP_LOGW(TAG, "[%s] Module '%s' is not subscribed to type: %d [%s]", __func__,
+          mgr_reg_list[idx].name, msg->type, GET_MSG_TYPE_NAME(msg->type));
     }
   }
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
@@ -598,22 +991,34 @@ static esp_err_t mgr_NotifyCtrl(const msg_t* msg) {
  * @param param 
  */
 static void mgr_TaskFn(void* param) {
-  msg_t msg;
+  msg_t* msg = NULL;
   bool loop = true;
   esp_err_t result = ESP_OK;
 
   ESP_LOGI(TAG, "++%s()", __func__);
-  memset(&msg, 0x00, sizeof(msg_t));
   while (loop) {
     ESP_LOGD(TAG, "[%s] Wait...", __func__);
-    if(xQueueReceive(mgr_msg_queue, &msg, portMAX_DELAY) == pdTRUE) {
+    /* Wake up for the nearest MGR_CallAsync() deadline and supervisor check as well */
+    TickType_t wait = mgrcall_GetWaitTicks();
+    TickType_t sup_wait = mgrsup_GetWaitTicks();
+    msg = mgr_Receive((sup_wait < wait) ? sup_wait : wait);
+    mgrcall_Expire();
+    mgrsup_Check(mgr_Restart);
+    if ((msg != NULL) && msgpool_IsExpired(msg)) {
+      /* Stale: dropped here, so no module queue gets it either */
+      msgpool_Release(msg);
+      continue;
+    }
+    if (msg != NULL) {
+      int64_t begin = esp_timer_get_time();
+
       ESP_LOGD(TAG, "[%s] Message arrived: type: %d [%s], from: 0x%08lx, to: 0x%08lx", __func__, 
-          msg.type, GET_MSG_TYPE_NAME(msg.type),
-          msg.from, msg.to);
+          msg->type, GET_MSG_TYPE_NAME(msg->type),
+          msg->from, msg->to);
 
       /* First, parse message in manager */
-      if (msg.to & REG_MGR_CTRL) {
-        result = mgr_ParseMsg(&msg);
+      if (msg->to & REG_MGR_CTRL) {
+        result = mgr_ParseMsg(msg);
       }
 
       if (result == ESP_TASK_DONE) {
@@ -622,22 +1027,27 @@ static void mgr_TaskFn(void* param) {
       }
 
       /* Now, notify specific (or all) registered controller */
-      if (msg.to & (~REG_MGR_CTRL)) {
-        result = mgr_NotifyCtrl(&msg);
+      /* The pooled handle is passed on, so modules only take a reference */
+      if (msg->to & (~REG_MGR_CTRL)) {
+        result = mgr_NotifyCtrl(msg);
       }
+      bustrace_Record(BUS_HOP_MGR_DONE, msg, msg->to, (uint32_t) (esp_timer_get_time() - begin));
+      msgpool_Release(msg);
 
       if (result != ESP_OK) {
         // TODO - Send Error to the Broker
         ESP_LOGE(TAG, "[%s] Error: %d", __func__, result);
       }
     } else {
-      ESP_LOGE(TAG, "[%s] Message error.", __func__);
+      ESP_LOGD(TAG, "[%s] No message.", __func__);
     }
   }
+  mgr_task_id = NULL;
   if (mgr_sem_id) {
     xSemaphoreGive(mgr_sem_id);
   }
   ESP_LOGI(TAG, "--%s()", __func__);
+  vTaskDelete(NULL);
 }
 
 /**
@@ -655,14 +1065,38 @@ esp_err_t MGR_Init(void) {
 
   ESP_LOGD(TAG, "[%s] Size of msg_t: %d", __func__, sizeof(msg_t));
 
-  /* Initialization message queue */
-  mgr_msg_queue = xQueueCreate(MGR_MSG_MAX, sizeof(msg_t));
-  if (mgr_msg_queue == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xQueueCreate() failed.", __func__);
+  /* Message pool must be ready before the first queue is used */
+  msgpool_Init();
+  msgbuf_Init();
+  bustrace_Reset();
+
+  /* Link/IP/MQTT/time flags, set by the modules from their event handlers */
+  if (sysstate_Init() != ESP_OK) {
+    ESP_LOGE(TAG, "[%s] sysstate_Init() failed.", __func__);
     return ESP_FAIL;
   }
 
+  /* Worker pool (or nothing in task mode) for the modules using executor units */
+  if (executor_Init() != ESP_OK) {
+    ESP_LOGE(TAG, "[%s] executor_Init() failed.", __func__);
+    return ESP_FAIL;
+  }
+
+  /* Type -> modules route table, used to filter broadcasts */
+  mgr_BuildRoute();
+
+  /* Initialization message lanes, they keep pooled handles only */
+  for (int lane = 0; lane < MGR_LANE_MAX; ++lane) {
+    mgr_lane_list[lane].queue = msgpool_CreateQueue(mgr_lane_list[lane].name, mgr_lane_list[lane].depth);
+    if (mgr_lane_list[lane].queue == NULL)
+    {
+      ESP_LOGE(TAG, "[%s] xQueueCreate() failed.", __func__);
+      return ESP_FAIL;
+    }
+    memset(&mgr_lane_list[lane].stats, 0x00, sizeof(mgr_lane_stats_t));
+    mgr_lane_list[lane].stats.depth = mgr_lane_list[lane].depth;
+  }
+
   mgr_sem_id = xSemaphoreCreateCounting(1, 0);
   if (mgr_sem_id == NULL)
   {
@@ -685,14 +1119,12 @@ esp_err_t MGR_Init(void) {
   }
 
   ESP_LOGD(TAG, "Modules to register: %d", mgr_modules_cnt);
-  result = ESP_OK;
-  for (int idx = 0; idx < mgr_modules_cnt; ++idx) {
-    esp_err_t r = mgr_Init(idx);
-    if (r != ESP_OK && result == ESP_OK) {
-      result = r;
-    }
-    MEM_CHECK(mem_LogSnapshot(__func__, "mgr_init_module_done: %s", mgr_reg_list[idx].name));
-  }
+  /* Independent modules start in parallel, see mgr_reg_list[].depends */
+  result = bootseq_Run(BOOTSEQ_PHASE_INIT, mgr_modules, mgr_depends, mgr_modules_cnt, mgr_Init);
+  bootseq_LogPhase(BOOTSEQ_PHASE_INIT);
+  /* All module queues exist now, report what the bus costs in RAM */
+  msgpool_LogMemory();
+  executor_LogStats();
   MEM_CHECK(mem_LogSnapshot(__func__, "mgr_init_done"));
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
   return result;
@@ -708,24 +1140,45 @@ esp_err_t MGR_Done(void) {
 
   ESP_LOGI(TAG, "++%s()", __func__);
   MEM_CHECK(mem_LogSnapshot(__func__, "mgr_done_begin"));
+  if (mgr_task_id) {
+    /* Still dispatching (MGR_Run() not finished): stop it before the modules go */
+    msg_t msg = {
+      .type = MSG_TYPE_DONE,
+      .from = REG_MGR_CTRL,
+      .to = REG_MGR_CTRL,
+    };
+
+    if ((mgr_Send(&msg) == ESP_OK) && mgr_sem_id) {
+      xSemaphoreTake(mgr_sem_id, portMAX_DELAY);
+      ESP_LOGD(TAG, "[%s] Task stopped", __func__);
+    }
+  }
   for (int idx = mgr_modules_cnt - 1; idx >= 0; --idx) {
-    esp_err_t r = mgr_Done(idx);
+    esp_err_t r = mgr_Done(mgr_modules[idx]);
     if (r != ESP_OK && result == ESP_OK) {
       result = r;
     }
-    MEM_CHECK(mem_LogSnapshot(__func__, "mgr_done_module_done: %s", mgr_reg_list[idx].name));
-  }
-  if (mgr_task_id) {
-    ESP_LOGD(TAG, "[%s] Task stopped", __func__);
+    MEM_CHECK(mem_LogSnapshot(__func__, "mgr_done_module_done: %s", mgr_reg_list[mgr_modules[idx]].name));
   }
+  executor_Done();
+  datasnap_Clear();
+  msgpool_LogStats();
+  mgr_LogLanes();
+  ESP_LOGI(TAG, "[%s] Deliveries skipped by subscriptions: %lu", __func__, mgr_route_skipped);
+  ESP_LOGI(TAG, "[%s] Deliveries handled by direct_fn: %lu", __func__, mgr_direct_cnt);
   if (mgr_sem_id) {
     vSemaphoreDelete(mgr_sem_id);
+    mgr_sem_id = NULL;
     ESP_LOGD(TAG, "[%s] Semaphore deleted", __func__);
   }
-  if (mgr_msg_queue) {
-    vQueueDelete(mgr_msg_queue);
-    ESP_LOGD(TAG, "[%s] Queue deleted", __func__);
+  for (int lane = 0; lane < MGR_LANE_MAX; ++lane) {
+    if (mgr_lane_list[lane].queue) {
+      msgpool_Drain(mgr_lane_list[lane].queue);
+      msgpool_DeleteQueue(mgr_lane_list[lane].queue);
+      mgr_lane_list[lane].queue = NULL;
+    }
   }
+  mgrisr_Done();
   MEM_CHECK(mem_LogSnapshot(__func__, "mgr_done_end"));
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
   return result;
@@ -742,13 +1195,8 @@ esp_err_t MGR_Run(void) {
   ESP_LOGI(TAG, "++%s()", __func__);
   MEM_CHECK(mem_LogSnapshot(__func__, "mgr_run_begin"));
 
-  for (int idx = 0; idx < mgr_modules_cnt; ++idx) {
-    esp_err_t r = mgr_Run(idx);
-    if (r != ESP_OK && result == ESP_OK) {
-      result = r;
-    }
-    MEM_CHECK(mem_LogSnapshot(__func__, "mgr_run_module_done: %s", mgr_reg_list[idx].name));
-  }
+  result = bootseq_Run(BOOTSEQ_PHASE_RUN, mgr_modules, mgr_depends, mgr_modules_cnt, mgr_Run);
+  bootseq_LogPhase(BOOTSEQ_PHASE_RUN);
 
   ESP_LOGD(TAG, "[%s] Wait on xSemaphoreTake...", __func__);
   xSemaphoreTake(mgr_sem_id, portMAX_DELAY);
@@ -774,6 +1222,63 @@ esp_err_t MGR_Send(const msg_t* msg) {
   return result;
 }
 
+esp_err_t MGR_SetLane(msg_type_e type, mgr_lane_e lane) {
+  if ((type >= MSG_TYPE_MAX) || (lane >= MGR_LANE_MAX)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  mgr_lane_map[type] = (uint8_t) lane;
+  ESP_LOGD(TAG, "[%s] type: %d [%s] -> lane: %d", __func__, type, GET_MSG_TYPE_NAME(type), lane);
+  return ESP_OK;
+}
+
+mgr_lane_e MGR_GetLane(msg_type_e type) {
+  return (type < MSG_TYPE_MAX) ? (mgr_lane_e) mgr_lane_map[type] : MGR_LANE_CTRL;
+}
+
+void MGR_SetDirect(bool enable) {
+  ESP_LOGI(TAG, "[%s] Direct dispatch: %s", __func__, enable ? "on" : "off");
+  mgr_direct = enable;
+}
+
+bool MGR_GetDirect(void) {
+  return mgr_direct;
+}
+
+esp_err_t MGR_GetLaneStats(mgr_lane_e lane, mgr_lane_stats_t* stats) {
+  if ((lane >= MGR_LANE_MAX) || (stats == NULL)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  taskENTER_CRITICAL(&mgr_lane_lock);
+  *stats = mgr_lane_list[lane].stats;
+  taskEXIT_CRITICAL(&mgr_lane_lock);
+  stats->waiting = mgr_lane_list[lane].queue ? uxQueueMessagesWaiting(mgr_lane_list[lane].queue) : 0;
+  return ESP_OK;
+}
+
+const char* MGR_GetModuleName(uint32_t type) {
+  if (type & REG_MGR_CTRL) {
+    return "mgr";
+  }
+  type &= mgr_reg_mask;
+  return (type != 0U) ? mgr_reg_list[__builtin_ctz(type)].name : "?";
+}
+
+uint32_t MGR_GetDrops(mgr_drop_t* drops, uint32_t max) {
+  msgpool_drop_info_t info[MSGPOOL_DROP_MAX];
+  uint32_t cnt = 0;
+
+  if (drops == NULL) {
+    return 0;
+  }
+  cnt = msgpool_GetDrops(info, (max < MSGPOOL_DROP_MAX) ? max : MSGPOOL_DROP_MAX);
+  for (uint32_t idx = 0; idx < cnt; ++idx) {
+    drops[idx].from = MGR_GetModuleName(info[idx].from);
+    drops[idx].to = info[idx].to;
+    drops[idx].count = info[idx].count;
+  }
+  return cnt;
+}
+
 esp_err_t MGR_GetData(uint32_t module_type, data_type_e data_type, mgr_reg_data_cb_f cb, void *cb_ctx)
 {
   ESP_LOGI(TAG, "++%s(module_type: 0x%08x, data_type: %d [%s])", __func__, module_type, data_type, GET_DATA_TYPE_NAME(data_type));
@@ -785,18 +1290,170 @@ esp_err_t MGR_GetData(uint32_t module_type, data_type_e data_type, mgr_reg_data_
     return ESP_ERR_INVALID_ARG;
   }
 
-  /* Hot path cost is almost always inside get_fn; this loop is tiny (MGR_REG_LIST_CNT). */
-  for (int idx = 0; idx < mgr_modules_cnt; ++idx) {
-    if ((mgr_reg_list[idx].type & module_type) == 0U) {
-      continue;
+  /* One bit, so it is the slot of the module in mgr_reg_list */
+  if ((module_type & mgr_reg_mask) != 0U) {
+    const mgr_reg_t* reg = &mgr_reg_list[__builtin_ctz(module_type)];
+    const data_snap_t* snap = NULL;
+
+    if (datasnap_Acquire(module_type, data_type, &snap) == ESP_OK) {
+      esp_err_t result = cb(&snap->data, cb_ctx);
+
+      ESP_LOGI(TAG, "[%s] Snapshot of module: '%s', version: %lu - result: %d", __func__, reg->name, snap->version, result);
+      datasnap_Release(snap);
+      return result;
     }
-    if (mgr_reg_list[idx].get_fn == NULL) {
-      ESP_LOGI(TAG, "[%s] get_fn() is NULL for module: '%s'", __func__, mgr_reg_list[idx].name);
+    if (reg->get_fn == NULL) {
+      ESP_LOGI(TAG, "[%s] get_fn() is NULL for module: '%s'", __func__, reg->name);
       return ESP_ERR_NOT_SUPPORTED;
     }
-    ESP_LOGI(TAG, "[%s] Call get_fn() for module: '%s'", __func__, mgr_reg_list[idx].name);
-    return mgr_reg_list[idx].get_fn(data_type, cb, cb_ctx);
+    ESP_LOGI(TAG, "[%s] Call get_fn() for module: '%s'", __func__, reg->name);
+    return reg->get_fn(data_type, cb, cb_ctx);
   }
   ESP_LOGI(TAG, "--%s() - result: ESP_ERR_NOT_FOUND", __func__);
   return ESP_ERR_NOT_FOUND;
 }
+
+/**
+ * @brief Copy @p request to @p msg with a new correlation id; the call slot is freed again on error.
+ */
+static esp_err_t mgr_CallSend(const msg_t* request, msg_t* msg, TaskHandle_t task, msg_t* reply,
+    mgr_call_cb_f cb, void* ctx, uint32_t timeout_ms) {
+  esp_err_t result = ESP_OK;
+
+  msg->call = MSG_CALL_NONE;
+  if (mgr_GetRoute(request->type, request->to) == 0U) {
+    ESP_LOGW(TAG, "[%s] No module of 0x%08lx subscribed to type: %d [%s]", __func__,
+        request->to, request->type, GET_MSG_TYPE_NAME(request->type));
+    return ESP_ERR_NOT_FOUND;
+  }
+  memcpy(msg, request, msgpool_GetMsgSize(request->type));
+  if (msg->ttl_ms == MSG_TTL_NONE) {
+    /* Nobody waits for the answer after the deadline, so do not handle the request either */
+    msg->ttl_ms = timeout_ms;
+  }
+  msg->call = mgrcall_Open(task, reply, cb, ctx, timeout_ms);
+  if (msg->call == MSG_CALL_NONE) {
+    return ESP_ERR_NO_MEM;
+  }
+  result = mgr_Send(msg);
+  if (result != ESP_OK) {
+    mgrcall_Cancel(msg->call, false);
+    msg->call = MSG_CALL_NONE;
+  }
+  return result;
+}
+
+esp_err_t MGR_Call(const msg_t* request, uint32_t timeout_ms, msg_t* reply) {
+  esp_err_t result = ESP_OK;
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  msg_t msg;
+
+  if ((request == NULL) || (reply == NULL)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  ESP_LOGI(TAG, "++%s(type: %d [%s], to: 0x%08lx, timeout: %lu ms)", __func__,
+      request->type, GET_MSG_TYPE_NAME(request->type), request->to, timeout_ms);
+  if (task == mgr_task_id) {
+    /* The reply is dispatched by this very task */
+    ESP_LOGE(TAG, "[%s] Blocking call from the manager task", __func__);
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  /* Own index: notifications the task uses otherwise are neither taken nor mistaken for the reply */
+  (void) ulTaskNotifyTakeIndexed(MGRCALL_NOTIFY_INDEX, pdTRUE, 0);
+  result = mgr_CallSend(request, &msg, task, reply, NULL, NULL, timeout_ms);
+  if ((result == ESP_OK) && (ulTaskNotifyTakeIndexed(MGRCALL_NOTIFY_INDEX, pdTRUE, pdMS_TO_TICKS(timeout_ms)) == 0U)) {
+    if (mgrcall_Cancel(msg.call, true)) {
+      result = ESP_ERR_TIMEOUT;
+    } else {
+      /* The reply got in between: it is copied already, take its notification */
+      (void) ulTaskNotifyTakeIndexed(MGRCALL_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+    }
+  }
+  ESP_LOGI(TAG, "--%s() - call: %lu, result: %d", __func__, msg.call, result);
+  return result;
+}
+
+esp_err_t MGR_CallAsync(const msg_t* request, uint32_t timeout_ms, mgr_call_cb_f cb, void* ctx, uint32_t* id) {
+  esp_err_t result = ESP_OK;
+  msg_t msg;
+
+  if ((request == NULL) || (cb == NULL)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  result = mgr_CallSend(request, &msg, NULL, NULL, cb, ctx, timeout_ms);
+  if (id != NULL) {
+    *id = msg.call;
+  }
+  ESP_LOGI(TAG, "[%s] type: %d [%s], to: 0x%08lx, call: %lu - result: %d", __func__,
+      request->type, GET_MSG_TYPE_NAME(request->type), request->to, msg.call, result);
+  return result;
+}
+
+esp_err_t MGR_Reply(const msg_t* request, msg_t* reply) {
+  if ((request == NULL) || (reply == NULL) || (request->call == MSG_CALL_NONE)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  reply->type = MSG_TYPE_MGR_REPLY;
+  reply->to = REG_MGR_CTRL;
+  reply->key = MSG_KEY_NONE;
+  reply->call = request->call;
+  return mgr_Send(reply);
+}
+
+esp_err_t MGR_GetCallStats(mgr_call_stats_t* stats) {
+  if (stats == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  mgrcall_GetStats(stats);
+  return ESP_OK;
+}
+
+esp_err_t MGR_IsrOpen(const char* name, uint32_t depth, mgr_isr_src_t* src) {
+  return mgrisr_Open(name, depth, src);
+}
+
+IRAM_ATTR esp_err_t MGR_SendFromISR(mgr_isr_src_t src, const msg_t* msg, BaseType_t* woken) {
+  esp_err_t result = mgrisr_Push(src, msg);
+
+  if ((result == ESP_OK) && (mgr_task_id != NULL)) {
+    if (xPortInIsrContext()) {
+      vTaskNotifyGiveFromISR(mgr_task_id, woken);
+    } else {
+      xTaskNotifyGive(mgr_task_id);
+    }
+  }
+  return result;
+}
+
+uint32_t MGR_GetIsrStats(mgr_isr_stats_t* stats, uint32_t max) {
+  return mgrisr_GetStats(stats, max);
+}
+
+void MGR_Heartbeat(uint32_t module_type) {
+  mgrsup_Heartbeat(module_type);
+}
+
+esp_err_t MGR_ReportFault(uint32_t module_type, const char* reason) {
+  esp_err_t result = mgrsup_Fault(module_type, reason);
+
+  ESP_LOGW(TAG, "[%s] '%s': %s - result: %d", __func__, MGR_GetModuleName(module_type), reason ? reason : "-", result);
+  if ((result == ESP_OK) && (mgr_task_id != NULL)) {
+    xTaskNotifyGive(mgr_task_id);
+  }
+  return result;
+}
+
+esp_err_t MGR_Restart(uint32_t module_type) {
+  esp_err_t result = mgrsup_Restart(module_type);
+
+  ESP_LOGI(TAG, "[%s] '%s' - result: %d", __func__, MGR_GetModuleName(module_type), result);
+  if ((result == ESP_OK) && (mgr_task_id != NULL)) {
+    xTaskNotifyGive(mgr_task_id);
+  }
+  return result;
+}
+
+uint32_t MGR_GetSupStats(mgr_sup_stats_t* stats, uint32_t max) {
+  return mgrsup_GetStats(stats, max);
+}
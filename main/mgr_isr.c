@@ -0,0 +1,222 @@
+/**
+ * @file mgr_isr.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Lock-free rings which carry messages from interrupt handlers to the manager task
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * `head` and `tail` are free-running counters; `head - tail` is the number of
+ * waiting entries and `& mask` the index. Only the producer writes `head`,
+ * `posted` and `dropped`, only the manager task writes `tail`, `drained`,
+ * `invalid` and `latency_max_us`, so no entry is ever written by both sides.
+ */
+#include <stdbool.h>
+#include <string.h>
+
+#include "sdkconfig.h"
+
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "mgr_isr.h"
+#include "msg_pool.h"
+
+#include "lut.h"
+
+
+/* msg_t is read through 4-byte fields, keep every entry aligned */
+#define MGRISR_ENTRY_SIZE       ((MSG_SMALL_SIZE + 3U) & ~3U)
+
+struct mgr_isr_src_s {
+  const char* name;           /* NULL for a free source */
+  uint32_t    mask;           /* depth - 1 */
+  uint8_t*    buf;            /* depth entries of MGRISR_ENTRY_SIZE */
+  int64_t*    stamp;          /* time of the push, per entry */
+  uint32_t    head;           /* producer */
+  uint32_t    tail;           /* manager task */
+  uint32_t    posted;         /* producer */
+  uint32_t    dropped;        /* producer, ring full */
+  uint32_t    drained;        /* manager task */
+  uint32_t    invalid;        /* manager task, type too large for an entry */
+  uint32_t    latency_max_us; /* manager task, push to drain */
+};
+
+static const char* TAG = "ESP::ISR";
+
+static portMUX_TYPE         mgrisr_lock = portMUX_INITIALIZER_UNLOCKED;
+static struct mgr_isr_src_s mgrisr_list[MGRISR_SOURCE_MAX];
+
+
+static uint32_t mgrisr_RoundDepth(uint32_t depth) {
+  uint32_t round = 2U;
+
+  while ((round < depth) && (round < MGRISR_DEPTH_MAX)) {
+    round <<= 1;
+  }
+  return round;
+}
+
+esp_err_t mgrisr_Open(const char* name, uint32_t depth, mgr_isr_src_t* src) {
+  struct mgr_isr_src_s* free_src = NULL;
+  uint8_t* buf = NULL;
+  int64_t* stamp = NULL;
+
+  if ((name == NULL) || (src == NULL) || (depth == 0U)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  depth = mgrisr_RoundDepth(depth);
+
+  /* Read from interrupt handlers, so it must not live in PSRAM */
+  buf = heap_caps_calloc(depth, MGRISR_ENTRY_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  stamp = heap_caps_calloc(depth, sizeof(int64_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if ((buf == NULL) || (stamp == NULL)) {
+    ESP_LOGE(TAG, "[%s] '%s': no memory for %lu entries", __func__, name, depth);
+    heap_caps_free(buf);
+    heap_caps_free(stamp);
+    return ESP_ERR_NO_MEM;
+  }
+
+  taskENTER_CRITICAL(&mgrisr_lock);
+  for (uint32_t idx = 0; idx < MGRISR_SOURCE_MAX; ++idx) {
+    if (mgrisr_list[idx].name == NULL) {
+      free_src = &mgrisr_list[idx];
+      memset(free_src, 0, sizeof(*free_src));
+      free_src->mask = depth - 1U;
+      free_src->buf = buf;
+      free_src->stamp = stamp;
+      /* Last, so mgrisr_Drain() never sees a half-built source */
+      __atomic_store_n(&free_src->name, name, __ATOMIC_RELEASE);
+      break;
+    }
+  }
+  taskEXIT_CRITICAL(&mgrisr_lock);
+
+  if (free_src == NULL) {
+    ESP_LOGE(TAG, "[%s] '%s': all %d sources taken", __func__, name, MGRISR_SOURCE_MAX);
+    heap_caps_free(buf);
+    heap_caps_free(stamp);
+    return ESP_ERR_NO_MEM;
+  }
+  ESP_LOGI(TAG, "[%s] '%s': %lu entries, %lu B", __func__, name, depth,
+      (uint32_t) (depth * (MGRISR_ENTRY_SIZE + sizeof(int64_t))));
+  *src = free_src;
+  return ESP_OK;
+}
+
+IRAM_ATTR esp_err_t mgrisr_Push(mgr_isr_src_t src, const msg_t* msg) {
+  uint32_t head;
+  uint32_t tail;
+
+  if ((src == NULL) || (msg == NULL)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  head = src->head;
+  tail = __atomic_load_n(&src->tail, __ATOMIC_ACQUIRE);
+  if ((head - tail) > src->mask) {
+    ++src->dropped;
+    return ESP_FAIL;
+  }
+  /* Large types are turned down by mgrisr_Drain(), the size table is not in IRAM */
+  memcpy(&src->buf[(head & src->mask) * MGRISR_ENTRY_SIZE], msg, MGRISR_ENTRY_SIZE);
+  src->stamp[head & src->mask] = esp_timer_get_time();
+  __atomic_store_n(&src->head, head + 1U, __ATOMIC_RELEASE);
+  ++src->posted;
+  return ESP_OK;
+}
+
+uint32_t mgrisr_Drain(mgrisr_post_f post) {
+  uint32_t cnt = 0;
+
+  for (;;) {
+    struct mgr_isr_src_s* next = NULL;
+    int64_t oldest = 0;
+
+    for (uint32_t idx = 0; idx < MGRISR_SOURCE_MAX; ++idx) {
+      struct mgr_isr_src_s* src = &mgrisr_list[idx];
+
+      if (__atomic_load_n(&src->name, __ATOMIC_ACQUIRE) == NULL) {
+        continue;
+      }
+      if (__atomic_load_n(&src->head, __ATOMIC_ACQUIRE) == src->tail) {
+        continue;
+      }
+      int64_t stamp = src->stamp[src->tail & src->mask];
+      if ((next == NULL) || (stamp < oldest)) {
+        next = src;
+        oldest = stamp;
+      }
+    }
+    if (next == NULL) {
+      break;
+    }
+
+    const msg_t* msg = (const msg_t*) &next->buf[(next->tail & next->mask) * MGRISR_ENTRY_SIZE];
+    uint32_t latency = (uint32_t) (esp_timer_get_time() - oldest);
+
+    if (msgpool_GetMsgSize(msg->type) > MGRISR_ENTRY_SIZE) {
+      ESP_LOGE(TAG, "[%s] '%s': type %d [%s] does not fit an entry", __func__, next->name,
+          msg->type, GET_MSG_TYPE_NAME(msg->type));
+      ++next->invalid;
+    } else {
+      /* The bus copies the entry into the pool, the slot is free again afterwards */
+      (void) post(msg);
+    }
+    if (latency > next->latency_max_us) {
+      next->latency_max_us = latency;
+    }
+    ++next->drained;
+    __atomic_store_n(&next->tail, next->tail + 1U, __ATOMIC_RELEASE);
+    ++cnt;
+  }
+  return cnt;
+}
+
+uint32_t mgrisr_GetStats(mgr_isr_stats_t* stats, uint32_t max) {
+  uint32_t cnt = 0;
+
+  if (stats == NULL) {
+    return 0;
+  }
+  for (uint32_t idx = 0; (idx < MGRISR_SOURCE_MAX) && (cnt < max); ++idx) {
+    const struct mgr_isr_src_s* src = &mgrisr_list[idx];
+    const char* name = __atomic_load_n(&src->name, __ATOMIC_ACQUIRE);
+
+    if (name == NULL) {
+      continue;
+    }
+    stats[cnt].name = name;
+    stats[cnt].depth = src->mask + 1U;
+    stats[cnt].waiting = __atomic_load_n(&src->head, __ATOMIC_ACQUIRE) - src->tail;
+    stats[cnt].posted = src->posted;
+    stats[cnt].dropped = src->dropped;
+    stats[cnt].drained = src->drained;
+    stats[cnt].invalid = src->invalid;
+    stats[cnt].latency_max_us = src->latency_max_us;
+    ++cnt;
+  }
+  return cnt;
+}
+
+void mgrisr_Done(void) {
+  for (uint32_t idx = 0; idx < MGRISR_SOURCE_MAX; ++idx) {
+    struct mgr_isr_src_s* src = &mgrisr_list[idx];
+
+    if (src->name == NULL) {
+      continue;
+    }
+    if (src->dropped != 0U) {
+      ESP_LOGW(TAG, "[%s] '%s': %lu dropped, ring full", __func__, src->name, src->dropped);
+    }
+    heap_caps_free(src->buf);
+    heap_caps_free(src->stamp);
+    memset(src, 0, sizeof(*src));
+  }
+}
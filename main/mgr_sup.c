@@ -0,0 +1,345 @@
+/**
+ * @file mgr_sup.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Module supervisor: liveness heartbeats, fault reports and hot restarts
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Per slot, `handled` and `beat_us` are written by the module task only and
+ * `fault` / `manual` by whoever reports; everything else belongs to the manager
+ * task. `delivered - handled` is the work the module holds. Messages a module
+ * posts to itself are finished without being delivered, so `handled` may run
+ * ahead; the manager then catches `delivered` up instead of going negative.
+ */
+#include <stdbool.h>
+#include <string.h>
+
+#include "sdkconfig.h"
+
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "mgr_sup.h"
+#include "msg.h"
+
+
+#define MGRSUP_STALL_US         ((int64_t) CONFIG_MGR_SUP_STALL_MS * 1000)
+#define MGRSUP_BACKOFF_US       ((int64_t) CONFIG_MGR_SUP_BACKOFF_MS * 1000)
+#define MGRSUP_BACKOFF_MAX_US   ((int64_t) CONFIG_MGR_SUP_BACKOFF_MAX_MS * 1000)
+#define MGRSUP_STABLE_US        ((int64_t) CONFIG_MGR_SUP_STABLE_MS * 1000)
+#define MGRSUP_RESTART_MAX      (CONFIG_MGR_SUP_RESTART_MAX)
+
+/* A stall is found at most this long after the timeout */
+#define MGRSUP_CHECK_US         (MGRSUP_STALL_US / 4)
+
+typedef enum {
+  MGRSUP_STATE_RUNNING,
+  MGRSUP_STATE_BACKOFF,   /* faulty, restart at restart_us */
+  MGRSUP_STATE_DOWN,      /* done_fn called, init_fn failed; retried at restart_us */
+} mgrsup_state_e;
+
+typedef struct {
+  uint8_t     policy;         /* mgr_sup_policy_e */
+  uint8_t     state;          /* mgrsup_state_e */
+  bool        stalled;        /* stall logged, until the module beats again */
+  uint32_t    delivered;      /* manager task */
+  uint32_t    handled;        /* module task */
+  int64_t     beat_us;        /* module task, 0 before the first heartbeat */
+  int64_t     pending_us;     /* manager task, delivery to a module with no work */
+  uint32_t    fault;          /* faults reported since the last check */
+  bool        manual;         /* MGR_Restart() asked */
+  const char* reason;
+  uint32_t    faults;
+  uint32_t    restarts;
+  uint32_t    consecutive;
+  uint32_t    stalls;
+  int64_t     restart_us;
+  int64_t     started_us;
+} mgrsup_slot_t;
+
+static const char* TAG = "ESP::SUP";
+
+static mgrsup_slot_t  mgrsup_list[REG_BIT_MAX] = {};
+static uint32_t       mgrsup_watched = 0;     /* slots of registered modules */
+static bool           mgrsup_request = false; /* a fault or MGR_Restart() waits for mgrsup_Check() */
+static int64_t        mgrsup_next_check_us = 0;
+
+
+/**
+ * @brief Slot of a single watched REG_*_CTRL bit, -1 if none.
+ */
+static int mgrsup_GetIdx(uint32_t module_type) {
+  module_type &= mgrsup_watched;
+  if ((module_type == 0U) || ((module_type & (module_type - 1U)) != 0U)) {
+    return -1;
+  }
+  return __builtin_ctz(module_type);
+}
+
+static void mgrsup_Reboot(int idx, const char* why) {
+  ESP_LOGE(TAG, "[%s] '%s': %s, rebooting", __func__, MGR_GetModuleName(1UL << idx), why);
+  esp_restart();
+}
+
+static void mgrsup_DoRestart(int idx, mgrsup_restart_f restart, bool manual) {
+  mgrsup_slot_t* slot = &mgrsup_list[idx];
+  esp_err_t result = ESP_OK;
+
+  if (!manual) {
+    ++slot->consecutive;
+  }
+  ++slot->restarts;
+  ESP_LOGW(TAG, "[%s] '%s': restart %lu (%lu in a row)", __func__, MGR_GetModuleName(1UL << idx),
+      slot->restarts, slot->consecutive);
+
+  /* The new task starts counting from zero */
+  slot->delivered = 0;
+  __atomic_store_n(&slot->handled, 0U, __ATOMIC_RELAXED);
+  __atomic_store_n(&slot->beat_us, 0, __ATOMIC_RELAXED);
+  slot->pending_us = 0;
+  slot->stalled = false;
+  slot->state = MGRSUP_STATE_DOWN;
+
+  result = restart(idx);
+  slot->started_us = esp_timer_get_time();
+  if (result == ESP_OK) {
+    slot->state = MGRSUP_STATE_RUNNING;
+    return;
+  }
+  ESP_LOGE(TAG, "[%s] '%s': restart failed: %d", __func__, MGR_GetModuleName(1UL << idx), result);
+  if (slot->consecutive >= MGRSUP_RESTART_MAX) {
+    mgrsup_Reboot(idx, "restart failed");
+  }
+  /* Stays DOWN (no deliveries) until the retry */
+  slot->restart_us = slot->started_us + MGRSUP_BACKOFF_US;
+}
+
+/**
+ * @brief Apply the policy of slot @p idx to the faults reported since the last check.
+ */
+static void mgrsup_OnFault(int idx, uint32_t cnt, int64_t now) {
+  mgrsup_slot_t* slot = &mgrsup_list[idx];
+  const char* name = MGR_GetModuleName(1UL << idx);
+  const char* reason = __atomic_load_n(&slot->reason, __ATOMIC_ACQUIRE);
+
+  slot->faults += cnt;
+  ESP_LOGW(TAG, "[%s] '%s': fault: %s (%lu so far)", __func__, name, reason ? reason : "-", slot->faults);
+  switch (slot->policy) {
+    case MGR_SUP_RESTART: {
+      if (slot->state != MGRSUP_STATE_RUNNING) {
+        /* A restart is on its way already */
+        break;
+      }
+      if (slot->consecutive >= MGRSUP_RESTART_MAX) {
+        mgrsup_Reboot(idx, "too many restarts in a row");
+      }
+      int64_t backoff = MGRSUP_BACKOFF_US << slot->consecutive;
+      if ((backoff > MGRSUP_BACKOFF_MAX_US) || (backoff <= 0)) {
+        backoff = MGRSUP_BACKOFF_MAX_US;
+      }
+      slot->state = MGRSUP_STATE_BACKOFF;
+      slot->restart_us = now + backoff;
+      ESP_LOGW(TAG, "[%s] '%s': restart in %lu ms", __func__, name, (uint32_t) (backoff / 1000));
+      break;
+    }
+    case MGR_SUP_REBOOT: {
+      mgrsup_Reboot(idx, reason ? reason : "fault");
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Log a module which holds work and stopped beating; reboot unless its policy is NONE.
+ */
+static void mgrsup_CheckStall(int idx, int64_t now) {
+  mgrsup_slot_t* slot = &mgrsup_list[idx];
+  uint32_t handled = __atomic_load_n(&slot->handled, __ATOMIC_ACQUIRE);
+  int64_t beat = __atomic_load_n(&slot->beat_us, __ATOMIC_ACQUIRE);
+  int32_t waiting = (int32_t) (slot->delivered - handled);
+
+  if ((beat == 0) || (slot->state != MGRSUP_STATE_RUNNING)) {
+    return;
+  }
+  if (waiting <= 0) {
+    slot->delivered = handled;
+    slot->stalled = false;
+    return;
+  }
+  int64_t since = (slot->pending_us > beat) ? slot->pending_us : beat;
+  if ((now - since) < MGRSUP_STALL_US) {
+    slot->stalled = false;
+    return;
+  }
+  if (!slot->stalled) {
+    slot->stalled = true;
+    ++slot->stalls;
+    ESP_LOGE(TAG, "[%s] '%s': no heartbeat for %lu ms, %ld message(s) waiting", __func__,
+        MGR_GetModuleName(1UL << idx), (uint32_t) ((now - since) / 1000), waiting);
+    if (slot->policy != MGR_SUP_NONE) {
+      mgrsup_Reboot(idx, "stalled");
+    }
+  }
+}
+
+void mgrsup_Watch(int idx, mgr_sup_policy_e policy) {
+  if ((idx < 0) || (idx >= REG_BIT_MAX)) {
+    return;
+  }
+  memset(&mgrsup_list[idx], 0, sizeof(mgrsup_slot_t));
+  mgrsup_list[idx].policy = (policy < MGR_SUP_MAX) ? (uint8_t) policy : MGR_SUP_NONE;
+  mgrsup_list[idx].started_us = esp_timer_get_time();
+  mgrsup_watched |= (1UL << idx);
+}
+
+void mgrsup_Delivered(int idx) {
+  mgrsup_slot_t* slot = &mgrsup_list[idx];
+
+  if (slot->delivered == __atomic_load_n(&slot->handled, __ATOMIC_ACQUIRE)) {
+    /* The module had nothing to do, its last heartbeat may be old */
+    slot->pending_us = esp_timer_get_time();
+  }
+  ++slot->delivered;
+}
+
+bool mgrsup_IsUp(int idx) {
+  return mgrsup_list[idx].state != MGRSUP_STATE_DOWN;
+}
+
+void mgrsup_Heartbeat(uint32_t module_type) {
+  int idx = mgrsup_GetIdx(module_type);
+
+  if (idx < 0) {
+    return;
+  }
+  __atomic_store_n(&mgrsup_list[idx].beat_us, esp_timer_get_time(), __ATOMIC_RELAXED);
+  __atomic_add_fetch(&mgrsup_list[idx].handled, 1U, __ATOMIC_RELEASE);
+}
+
+esp_err_t mgrsup_Fault(uint32_t module_type, const char* reason) {
+  int idx = mgrsup_GetIdx(module_type);
+
+  if (idx < 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  __atomic_store_n(&mgrsup_list[idx].reason, reason, __ATOMIC_RELEASE);
+  __atomic_add_fetch(&mgrsup_list[idx].fault, 1U, __ATOMIC_RELEASE);
+  __atomic_store_n(&mgrsup_request, true, __ATOMIC_RELEASE);
+  return ESP_OK;
+}
+
+esp_err_t mgrsup_Restart(uint32_t module_type) {
+  int idx = mgrsup_GetIdx(module_type);
+
+  if (idx < 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  __atomic_store_n(&mgrsup_list[idx].manual, true, __ATOMIC_RELEASE);
+  __atomic_store_n(&mgrsup_request, true, __ATOMIC_RELEASE);
+  return ESP_OK;
+}
+
+TickType_t mgrsup_GetWaitTicks(void) {
+  int64_t deadline = INT64_MAX;
+  int64_t now = esp_timer_get_time();
+
+  if (__atomic_load_n(&mgrsup_request, __ATOMIC_ACQUIRE)) {
+    return 0;
+  }
+  for (uint32_t mask = mgrsup_watched; mask != 0U; mask &= mask - 1U) {
+    const mgrsup_slot_t* slot = &mgrsup_list[__builtin_ctz(mask)];
+
+    if ((slot->state != MGRSUP_STATE_RUNNING) && (slot->restart_us < deadline)) {
+      deadline = slot->restart_us;
+    }
+    if ((slot->state == MGRSUP_STATE_RUNNING) &&
+        (slot->delivered != __atomic_load_n(&slot->handled, __ATOMIC_ACQUIRE)) &&
+        (mgrsup_next_check_us < deadline)) {
+      /* Only a module holding work can stall */
+      deadline = mgrsup_next_check_us;
+    }
+  }
+  if (deadline == INT64_MAX) {
+    return portMAX_DELAY;
+  }
+  if (deadline <= now) {
+    return 0;
+  }
+  return pdMS_TO_TICKS((uint32_t) ((deadline - now + 999) / 1000)) + 1;
+}
+
+void mgrsup_Check(mgrsup_restart_f restart) {
+  int64_t now = esp_timer_get_time();
+  bool request = __atomic_exchange_n(&mgrsup_request, false, __ATOMIC_ACQ_REL);
+  bool check = (now >= mgrsup_next_check_us);
+
+  for (uint32_t mask = mgrsup_watched; mask != 0U; mask &= mask - 1U) {
+    int idx = __builtin_ctz(mask);
+    mgrsup_slot_t* slot = &mgrsup_list[idx];
+
+    if (request) {
+      uint32_t cnt = __atomic_exchange_n(&slot->fault, 0U, __ATOMIC_ACQ_REL);
+
+      if (__atomic_exchange_n(&slot->manual, false, __ATOMIC_ACQ_REL)) {
+        mgrsup_DoRestart(idx, restart, true);
+        continue;
+      }
+      if (cnt != 0U) {
+        mgrsup_OnFault(idx, cnt, now);
+      }
+    }
+    if ((slot->state != MGRSUP_STATE_RUNNING) && (now >= slot->restart_us)) {
+      mgrsup_DoRestart(idx, restart, false);
+      continue;
+    }
+    if ((slot->consecutive != 0U) && (slot->state == MGRSUP_STATE_RUNNING) &&
+        ((now - slot->started_us) >= MGRSUP_STABLE_US)) {
+      ESP_LOGI(TAG, "[%s] '%s': up for %lu s, restarts in a row cleared", __func__,
+          MGR_GetModuleName(1UL << idx), (uint32_t) (MGRSUP_STABLE_US / 1000000));
+      slot->consecutive = 0;
+    }
+    if (check) {
+      mgrsup_CheckStall(idx, now);
+    }
+  }
+  if (check) {
+    mgrsup_next_check_us = now + MGRSUP_CHECK_US;
+  }
+}
+
+uint32_t mgrsup_GetStats(mgr_sup_stats_t* stats, uint32_t max) {
+  int64_t now = esp_timer_get_time();
+  uint32_t cnt = 0;
+
+  if (stats == NULL) {
+    return 0;
+  }
+  for (uint32_t mask = mgrsup_watched; (mask != 0U) && (cnt < max); mask &= mask - 1U) {
+    int idx = __builtin_ctz(mask);
+    const mgrsup_slot_t* slot = &mgrsup_list[idx];
+    int64_t beat = __atomic_load_n(&slot->beat_us, __ATOMIC_ACQUIRE);
+
+    stats[cnt].name = MGR_GetModuleName(1UL << idx);
+    stats[cnt].policy = slot->policy;
+    stats[cnt].up = (slot->state != MGRSUP_STATE_DOWN);
+    stats[cnt].backoff = (slot->state == MGRSUP_STATE_BACKOFF);
+    stats[cnt].faults = slot->faults + __atomic_load_n(&slot->fault, __ATOMIC_ACQUIRE);
+    stats[cnt].restarts = slot->restarts;
+    stats[cnt].consecutive = slot->consecutive;
+    stats[cnt].stalls = slot->stalls;
+    stats[cnt].beat_age_ms = (beat != 0) ? (uint32_t) ((now - beat) / 1000) : 0U;
+    stats[cnt].reason = __atomic_load_n(&slot->reason, __ATOMIC_ACQUIRE);
+    ++cnt;
+  }
+  return cnt;
+}
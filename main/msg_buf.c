@@ -0,0 +1,136 @@
+/**
+ * @file msg_buf.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Bounded pool of data buffers which travel on the bus by reference
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ */
+#include <string.h>
+
+#include "sdkconfig.h"
+
+#include "esp_log.h"
+
+#include "freertos/FreeRTOS.h"
+
+#include "msg_buf.h"
+
+
+#define MSGBUF_NONE             (0xFFU)
+
+#define MSGBUF_COUNT            (CONFIG_MGR_MSG_BUF_COUNT)
+#define MSGBUF_SIZE             (((CONFIG_MGR_MSG_BUF_SIZE) + 3U) & ~3U)
+
+_Static_assert(MSGBUF_COUNT < MSGBUF_NONE, "CONFIG_MGR_MSG_BUF_COUNT too large for the free list");
+/* Never below what MSG_TYPE_MQTT_DATA_LOCAL carries inline: a whole topic and message */
+_Static_assert(MSGBUF_SIZE >= DATA_TOPIC_SIZE + DATA_MSG_SIZE, "CONFIG_MGR_MSG_BUF_SIZE below one publish");
+
+
+static const char* TAG = "ESP::BUF";
+
+static uint8_t          msgbuf_data[MSGBUF_COUNT * MSGBUF_SIZE] __attribute__((aligned(4)));
+static uint8_t          msgbuf_next[MSGBUF_COUNT];
+static uint8_t          msgbuf_free = MSGBUF_NONE;
+
+static msgbuf_stats_t   msgbuf_stats = {};
+
+static portMUX_TYPE     msgbuf_lock = portMUX_INITIALIZER_UNLOCKED;
+
+
+esp_err_t msgbuf_Init(void) {
+  esp_err_t result = ESP_OK;
+
+  esp_log_level_set(TAG, CONFIG_MGR_CTRL_LOG_LEVEL);
+
+  ESP_LOGI(TAG, "++%s(buffers: %d x %d)", __func__, MSGBUF_COUNT, MSGBUF_SIZE);
+
+  taskENTER_CRITICAL(&msgbuf_lock);
+  memset(&msgbuf_stats, 0x00, sizeof(msgbuf_stats));
+  msgbuf_free = MSGBUF_NONE;
+  for (int idx = MSGBUF_COUNT - 1; idx >= 0; --idx) {
+    msgbuf_next[idx] = msgbuf_free;
+    msgbuf_free = (uint8_t) idx;
+  }
+  msgbuf_stats.size = MSGBUF_SIZE;
+  msgbuf_stats.buffers = MSGBUF_COUNT;
+  taskEXIT_CRITICAL(&msgbuf_lock);
+
+  ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
+  return result;
+}
+
+size_t msgbuf_GetSize(void) {
+  return MSGBUF_SIZE;
+}
+
+void* msgbuf_Alloc(size_t size) {
+  uint8_t idx = MSGBUF_NONE;
+
+  taskENTER_CRITICAL(&msgbuf_lock);
+  if (size > MSGBUF_SIZE) {
+    ++msgbuf_stats.too_big;
+  } else if (msgbuf_free == MSGBUF_NONE) {
+    ++msgbuf_stats.alloc_fail;
+  } else {
+    idx = msgbuf_free;
+    msgbuf_free = msgbuf_next[idx];
+    ++msgbuf_stats.allocs;
+    if (++msgbuf_stats.in_use > msgbuf_stats.in_use_max) {
+      msgbuf_stats.in_use_max = msgbuf_stats.in_use;
+    }
+  }
+  taskEXIT_CRITICAL(&msgbuf_lock);
+
+  if (idx == MSGBUF_NONE) {
+    ESP_LOGW(TAG, "[%s] No buffer for %u bytes (size: %d)", __func__, (unsigned) size, MSGBUF_SIZE);
+    return NULL;
+  }
+  return &msgbuf_data[(size_t) idx * MSGBUF_SIZE];
+}
+
+void msgbuf_Free(const void* buf) {
+  const uintptr_t addr = (uintptr_t) buf;
+  const uintptr_t base = (uintptr_t) msgbuf_data;
+
+  if ((addr < base) || (addr >= base + sizeof(msgbuf_data)) || (((addr - base) % MSGBUF_SIZE) != 0U)) {
+    return;
+  }
+
+  uint8_t idx = (uint8_t) ((addr - base) / MSGBUF_SIZE);
+  taskENTER_CRITICAL(&msgbuf_lock);
+  msgbuf_next[idx] = msgbuf_free;
+  msgbuf_free = idx;
+  --msgbuf_stats.in_use;
+  taskEXIT_CRITICAL(&msgbuf_lock);
+}
+
+char* msgbuf_NewMqttData(data_mqtt_in_t* data, const char* topic, size_t topic_len, size_t msg_size) {
+  char* buf = msgbuf_Alloc(topic_len + 1U + msg_size);
+
+  if ((buf == NULL) || (msg_size == 0U)) {
+    msgbuf_Free(buf);
+    memset(data, 0x00, sizeof(*data));
+    return NULL;
+  }
+  memcpy(buf, topic, topic_len);
+  buf[topic_len] = '\0';
+
+  data->topic = buf;
+  data->msg = &buf[topic_len + 1U];
+  data->msg_len = 0;
+  data->buf = buf;
+  buf[topic_len + 1U] = '\0';
+  return &buf[topic_len + 1U];
+}
+
+void msgbuf_GetStats(msgbuf_stats_t* stats) {
+  if (stats == NULL) {
+    return;
+  }
+  taskENTER_CRITICAL(&msgbuf_lock);
+  *stats = msgbuf_stats;
+  taskEXIT_CRITICAL(&msgbuf_lock);
+}
@@ -0,0 +1,92 @@
+/**
+ * @file msg_codec.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Payload size per message type and a flat encoding of msg_t
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ */
+#include <string.h>
+
+#include "msg_codec.h"
+
+
+#define MSGCODEC_PAYLOAD_SIZE(_name, _size)   [MSG_TYPE_##_name] = (_size),
+
+/* Every payload of the schema must fit in msg_t */
+#define MSGCODEC_CHECK_SIZE(_name, _size) \
+  _Static_assert((_size) <= sizeof(((msg_t*) 0)->payload), "MSG_TYPE_" #_name " payload exceeds msg_t");
+
+MSG_TYPE_SCHEMA(MSGCODEC_CHECK_SIZE)
+
+static const uint16_t msgcodec_payload_size[MSG_TYPE_MAX] = {
+  MSG_TYPE_SCHEMA(MSGCODEC_PAYLOAD_SIZE)
+};
+
+
+static void msgcodec_PutU32(uint8_t* buf, uint32_t value) {
+  buf[0] = (uint8_t) value;
+  buf[1] = (uint8_t) (value >> 8);
+  buf[2] = (uint8_t) (value >> 16);
+  buf[3] = (uint8_t) (value >> 24);
+}
+
+static uint32_t msgcodec_GetU32(const uint8_t* buf) {
+  return (uint32_t) buf[0] | ((uint32_t) buf[1] << 8) | ((uint32_t) buf[2] << 16) | ((uint32_t) buf[3] << 24);
+}
+
+size_t msgcodec_GetPayloadSize(msg_type_e type) {
+  return ((uint32_t) type < MSG_TYPE_MAX) ? msgcodec_payload_size[type] : 0U;
+}
+
+esp_err_t msgcodec_Encode(const msg_t* msg, uint8_t* buf, size_t size, size_t* len) {
+  size_t payload;
+
+  if ((msg == NULL) || (buf == NULL) || (len == NULL) || ((uint32_t) msg->type >= MSG_TYPE_MAX)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  payload = msgcodec_payload_size[msg->type];
+  if (size < (MSG_CODEC_HEADER_SIZE + payload)) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  msgcodec_PutU32(&buf[0], (uint32_t) msg->type);
+  msgcodec_PutU32(&buf[4], msg->from);
+  msgcodec_PutU32(&buf[8], msg->to);
+  msgcodec_PutU32(&buf[12], msg->key);
+  msgcodec_PutU32(&buf[16], msg->call);
+  msgcodec_PutU32(&buf[20], msg->ttl_ms);
+  memcpy(&buf[MSG_CODEC_HEADER_SIZE], &msg->payload, payload);
+  *len = MSG_CODEC_HEADER_SIZE + payload;
+  return ESP_OK;
+}
+
+esp_err_t msgcodec_Decode(const uint8_t* buf, size_t len, msg_t* msg) {
+  uint32_t type;
+  size_t payload;
+
+  if ((buf == NULL) || (msg == NULL)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (len < MSG_CODEC_HEADER_SIZE) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  type = msgcodec_GetU32(&buf[0]);
+  if (type >= MSG_TYPE_MAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  payload = msgcodec_payload_size[type];
+  if (len != (MSG_CODEC_HEADER_SIZE + payload)) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  msg->type = (msg_type_e) type;
+  msg->from = msgcodec_GetU32(&buf[4]);
+  msg->to = msgcodec_GetU32(&buf[8]);
+  msg->key = msgcodec_GetU32(&buf[12]);
+  msg->call = msgcodec_GetU32(&buf[16]);
+  msg->ttl_ms = msgcodec_GetU32(&buf[20]);
+  memcpy(&msg->payload, &buf[MSG_CODEC_HEADER_SIZE], payload);
+  memset((uint8_t*) &msg->payload + payload, 0, sizeof(msg->payload) - payload);
+  return ESP_OK;
+}
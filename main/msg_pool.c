@@ -0,0 +1,831 @@
+/**
+ * @file msg_pool.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Reference-counted message pool shared by the manager and module queues
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ */
+#include <string.h>
+
+#include "sdkconfig.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#include "msg_buf.h"
+#include "msg_codec.h"
+#include "msg_pool.h"
+
+#include "lut.h"
+
+
+#define MSGPOOL_SLOT_NONE       (0xFFFFU)
+#define MSGPOOL_QUEUE_NONE      (0xFFU)
+
+#define MSGPOOL_BLOCK_TICKS     (pdMS_TO_TICKS(CONFIG_MGR_MSG_BLOCK_MS))
+
+#define MSGPOOL_ALIGN(_size)    (((_size) + 3U) & ~3U)
+
+#define MSGPOOL_SMALL_SLOTS     (CONFIG_MGR_MSG_POOL_SMALL_SLOTS)
+#define MSGPOOL_SMALL_SLOT_SIZE (MSGPOOL_ALIGN(MSG_SMALL_SIZE))
+#define MSGPOOL_LARGE_SLOTS     (CONFIG_MGR_MSG_POOL_LARGE_SLOTS)
+#define MSGPOOL_LARGE_SLOT_SIZE (MSGPOOL_ALIGN(MSG_LARGE_SIZE))
+
+/* Everything except MQTT topic/data/JSON must fit in a small slot */
+_Static_assert(sizeof(payload_mgr_t) <= sizeof(payload_wifi_t), "payload_mgr_t exceeds small slot");
+_Static_assert(sizeof(payload_eth_t) <= sizeof(payload_wifi_t), "payload_eth_t exceeds small slot");
+_Static_assert(sizeof(payload_lcd_t) <= sizeof(payload_wifi_t), "payload_lcd_t exceeds small slot");
+_Static_assert(sizeof(payload_reply_t) <= sizeof(payload_wifi_t), "payload_reply_t exceeds small slot");
+_Static_assert(sizeof(data_topic_t) <= sizeof(payload_wifi_t), "data_topic_t exceeds small slot");
+_Static_assert(sizeof(data_mqtt_in_t) <= sizeof(payload_wifi_t), "data_mqtt_in_t exceeds small slot");
+
+
+static const char* TAG = "ESP::POOL";
+
+
+typedef struct {
+  uint8_t*  base;
+  uint32_t  slot_size;
+  uint16_t  slots;
+  uint16_t  free;     /* head of the free list */
+  uint16_t* refs;
+  uint16_t* next;     /* free list link, valid only while refs == 0 */
+  int64_t*  stamp;    /* esp_timer time when the message entered the bus */
+} msgpool_class_t;
+
+/*
+ * A keyed message waiting in a queue. `queued` is the handle in the queue (one
+ * reference held by the queue); `latest` is the newest message with the same
+ * (type, from, to, key), which the consumer gets instead (one reference held
+ * here when it differs from `queued`).
+ */
+typedef struct {
+  msg_t*        queued;
+  msg_t*        latest;
+} msgpool_merge_t;
+
+typedef struct {
+  const char*     name;
+  QueueHandle_t   queue;
+  uint32_t        depth;
+  uint32_t        hwm;
+  uint32_t        dropped;
+  uint32_t        coalesced;
+  msgpool_merge_t merge[MSGPOOL_MERGE_MAX];
+} msgpool_queue_t;
+
+static uint8_t  msgpool_small_buf[MSGPOOL_SMALL_SLOTS * MSGPOOL_SMALL_SLOT_SIZE] __attribute__((aligned(4)));
+static uint16_t msgpool_small_refs[MSGPOOL_SMALL_SLOTS];
+static uint16_t msgpool_small_next[MSGPOOL_SMALL_SLOTS];
+static int64_t  msgpool_small_stamp[MSGPOOL_SMALL_SLOTS];
+
+static uint8_t  msgpool_large_buf[MSGPOOL_LARGE_SLOTS * MSGPOOL_LARGE_SLOT_SIZE] __attribute__((aligned(4)));
+static uint16_t msgpool_large_refs[MSGPOOL_LARGE_SLOTS];
+static uint16_t msgpool_large_next[MSGPOOL_LARGE_SLOTS];
+static int64_t  msgpool_large_stamp[MSGPOOL_LARGE_SLOTS];
+
+static msgpool_class_t msgpool_class[MSGPOOL_CLASS_MAX] = {
+  [MSGPOOL_CLASS_SMALL] = {
+    .base = msgpool_small_buf, .slot_size = MSGPOOL_SMALL_SLOT_SIZE, .slots = MSGPOOL_SMALL_SLOTS,
+    .refs = msgpool_small_refs, .next = msgpool_small_next, .stamp = msgpool_small_stamp,
+  },
+  [MSGPOOL_CLASS_LARGE] = {
+    .base = msgpool_large_buf, .slot_size = MSGPOOL_LARGE_SLOT_SIZE, .slots = MSGPOOL_LARGE_SLOTS,
+    .refs = msgpool_large_refs, .next = msgpool_large_next, .stamp = msgpool_large_stamp,
+  },
+};
+
+static msgpool_stats_t  msgpool_stats = {};
+
+static msgpool_queue_t  msgpool_queue_list[MSGPOOL_QUEUE_MAX] = {};
+
+static msgpool_drop_info_t msgpool_drop_list[MSGPOOL_DROP_MAX] = {};
+
+/* Backpressure policy per message type, everything not listed here drops the newest message */
+static uint8_t          msgpool_policy_map[MSG_TYPE_MAX] = {
+  [MSG_TYPE_DONE]             = MSGPOOL_POLICY_BLOCK,
+  [MSG_TYPE_ETH_EVENT]        = MSGPOOL_POLICY_BLOCK,
+  [MSG_TYPE_WIFI_EVENT]       = MSGPOOL_POLICY_BLOCK,
+  [MSG_TYPE_MQTT_EVENT]       = MSGPOOL_POLICY_BLOCK,
+  [MSG_TYPE_MQTT_DATA]        = MSGPOOL_POLICY_BLOCK,
+  [MSG_TYPE_MQTT_DATA_LOCAL]  = MSGPOOL_POLICY_BLOCK,
+  [MSG_TYPE_MQTT_CTRL_LINK]   = MSGPOOL_POLICY_BLOCK,
+  [MSG_TYPE_MGR_REPLY]        = MSGPOOL_POLICY_BLOCK,
+  [MSG_TYPE_MQTT_PUBLISH]     = MSGPOOL_POLICY_DROP_OLDEST,
+  [MSG_TYPE_ETH_MAC]          = MSGPOOL_POLICY_COALESCE,
+  [MSG_TYPE_ETH_IP]           = MSGPOOL_POLICY_COALESCE,
+  [MSG_TYPE_WIFI_MAC]         = MSGPOOL_POLICY_COALESCE,
+  [MSG_TYPE_WIFI_IP]          = MSGPOOL_POLICY_COALESCE,
+  [MSG_TYPE_WIFI_SCAN_RESULT] = MSGPOOL_POLICY_COALESCE,
+  [MSG_TYPE_LCD_DATA]         = MSGPOOL_POLICY_COALESCE,
+};
+
+/* Default time to live per message type in ms, 0 (everything not listed here) never expires */
+static uint32_t         msgpool_ttl_map[MSG_TYPE_MAX] = {
+  [MSG_TYPE_MQTT_PUBLISH]     = CONFIG_MGR_MSG_TTL_PUBLISH_MS,
+  [MSG_TYPE_LCD_DATA]         = CONFIG_MGR_MSG_TTL_LCD_MS,
+};
+
+/* Expired messages per type, see msgpool_IsExpired() */
+static uint32_t         msgpool_expired_list[MSG_TYPE_MAX] = {};
+
+static portMUX_TYPE     msgpool_lock = portMUX_INITIALIZER_UNLOCKED;
+
+
+/**
+ * @brief Find the class and slot index behind @p msg.
+ *
+ * @return Class index or MSGPOOL_CLASS_MAX if @p msg is not a pooled handle.
+ */
+static msgpool_class_e msgpool_FindSlot(const msg_t* msg, uint16_t* slot) {
+  const uintptr_t addr = (uintptr_t) msg;
+
+  for (int cls = 0; cls < MSGPOOL_CLASS_MAX; ++cls) {
+    const msgpool_class_t* c = &msgpool_class[cls];
+    const uintptr_t base = (uintptr_t) c->base;
+
+    if ((addr >= base) && (addr < base + (uintptr_t) c->slots * c->slot_size)
+        && (((addr - base) % c->slot_size) == 0U)) {
+      *slot = (uint16_t) ((addr - base) / c->slot_size);
+      return (msgpool_class_e) cls;
+    }
+  }
+  return MSGPOOL_CLASS_MAX;
+}
+
+/**
+ * @brief Buffer (msg_buf.h) owned by @p msg, freed with its slot, or NULL.
+ */
+static const void* msgpool_GetBuf(const msg_t* msg) {
+  return (msg->type == MSG_TYPE_MQTT_DATA) ? msg->payload.mqtt.u.in.buf : NULL;
+}
+
+/**
+ * @brief Take a free slot of the smallest class that holds @p size bytes.
+ *
+ * Must be called with `msgpool_lock` held.
+ */
+static msg_t* msgpool_Alloc(size_t size, int64_t now) {
+  for (int cls = 0; cls < MSGPOOL_CLASS_MAX; ++cls) {
+    msgpool_class_t* c = &msgpool_class[cls];
+    msgpool_class_stats_t* s = &msgpool_stats.cls[cls];
+
+    if (size > c->slot_size) {
+      continue;
+    }
+    if (c->free == MSGPOOL_SLOT_NONE) {
+      ++s->alloc_fail;
+      continue;
+    }
+
+    uint16_t idx = c->free;
+    c->free = c->next[idx];
+    c->refs[idx] = 1;
+    c->stamp[idx] = now;
+    if (++s->in_use > s->in_use_max) {
+      s->in_use_max = s->in_use;
+    }
+    return (msg_t*) (c->base + (size_t) idx * c->slot_size);
+  }
+  return NULL;
+}
+
+/**
+ * @brief Index of @p queue in the queue table or MSGPOOL_QUEUE_NONE.
+ *
+ * Must be called with `msgpool_lock` held.
+ */
+static uint8_t msgpool_FindQueue(QueueHandle_t queue) {
+  for (int idx = 0; idx < MSGPOOL_QUEUE_MAX; ++idx) {
+    if (msgpool_queue_list[idx].queue == queue) {
+      return (uint8_t) idx;
+    }
+  }
+  return MSGPOOL_QUEUE_NONE;
+}
+
+/**
+ * @brief Count a message from @p from which @p queue did not take.
+ */
+static void msgpool_CountDrop(QueueHandle_t queue, uint32_t from) {
+  taskENTER_CRITICAL(&msgpool_lock);
+  uint8_t q = msgpool_FindQueue(queue);
+  const char* to = (q != MSGPOOL_QUEUE_NONE) ? msgpool_queue_list[q].name : "?";
+
+  ++msgpool_stats.dropped;
+  if (q != MSGPOOL_QUEUE_NONE) {
+    ++msgpool_queue_list[q].dropped;
+  }
+  for (int idx = 0; idx < MSGPOOL_DROP_MAX; ++idx) {
+    msgpool_drop_info_t* d = &msgpool_drop_list[idx];
+
+    if ((d->count == 0) || ((d->from == from) && (d->to == to))) {
+      d->from = from;
+      d->to = to;
+      ++d->count;
+      break;
+    }
+  }
+  taskEXIT_CRITICAL(&msgpool_lock);
+}
+
+/**
+ * @brief Check whether @p a and @p b are two versions of the same state.
+ */
+static bool msgpool_SameKey(const msg_t* a, const msg_t* b, uint32_t key_b) {
+  return (a->type == b->type) && (a->from == b->from) && (a->to == b->to)
+      && (msgpool_GetKey(a) == key_b);
+}
+
+/**
+ * @brief Merge @p handle into a keyed message still waiting in queue @p q, or track it.
+ *
+ * On a match the newest handle replaces the previous `latest`, so the queue keeps
+ * one entry per key no matter how many updates arrive. Otherwise @p handle gets a
+ * free merge entry (if any) before it is sent, so a later update can find it.
+ * Must be called with `msgpool_lock` held.
+ *
+ * @param[out] drop Handle whose reference the caller must release (or NULL).
+ * @return true if @p handle was merged and must not be sent to the queue.
+ */
+static bool msgpool_Merge(uint8_t q, msg_t* handle, uint32_t key, msg_t** drop) {
+  msgpool_merge_t* merge = msgpool_queue_list[q].merge;
+  msgpool_merge_t* empty = NULL;
+
+  *drop = NULL;
+  for (int idx = 0; idx < MSGPOOL_MERGE_MAX; ++idx) {
+    msgpool_merge_t* m = &merge[idx];
+
+    if (m->queued == NULL) {
+      empty = empty ? empty : m;
+      continue;
+    }
+    if (msgpool_SameKey(m->latest, handle, key)) {
+      if (m->latest == handle) {
+        /* The same handle again, one copy in the queue is enough */
+        *drop = handle;
+      } else {
+        *drop = (m->latest != m->queued) ? m->latest : NULL;
+        m->latest = handle;
+      }
+      return true;
+    }
+  }
+  if (empty) {
+    empty->queued = handle;
+    empty->latest = handle;
+  }
+  return false;
+}
+
+/**
+ * @brief Forget the merge entry of @p handle in queue @p q (it never made it into the queue).
+ *
+ * The entry is claimed before the send, so a newer version may already have been
+ * merged into it (`latest != queued`); it is lost with @p handle.
+ * Must be called with `msgpool_lock` held.
+ *
+ * @return Merged handle whose reference the caller must release (or NULL).
+ */
+static msg_t* msgpool_Unmerge(uint8_t q, const msg_t* handle) {
+  msgpool_merge_t* merge = msgpool_queue_list[q].merge;
+  msg_t* latest = NULL;
+
+  for (int idx = 0; idx < MSGPOOL_MERGE_MAX; ++idx) {
+    if (merge[idx].queued == handle) {
+      latest = (merge[idx].latest != handle) ? merge[idx].latest : NULL;
+      merge[idx].queued = NULL;
+      merge[idx].latest = NULL;
+      break;
+    }
+  }
+  return latest;
+}
+
+/**
+ * @brief Drop @p oldest, just taken from the head of full @p queue to make room.
+ *
+ * The head may have changed between the peek and the receive (a consumer, another
+ * producer), so the policy is checked again on the handle actually received; a
+ * message which must not be dropped goes back to the head.
+ *
+ * @return true if @p oldest was dropped and the queue has room.
+ */
+static bool msgpool_DropOldest(QueueHandle_t queue, msg_t* oldest) {
+  if (msgpool_GetPolicy(oldest->type) != MSGPOOL_POLICY_DROP_OLDEST) {
+    if (xQueueSendToFront(queue, &oldest, MSGPOOL_BLOCK_TICKS) != pdPASS) {
+      ESP_LOGE(TAG, "[%s] Head lost. type: %d [%s], from: 0x%08lx", __func__,
+          oldest->type, GET_MSG_TYPE_NAME(oldest->type), oldest->from);
+      msgpool_CountDrop(queue, oldest->from);
+      msgpool_Release(oldest);
+    }
+    return false;
+  }
+  ESP_LOGW(TAG, "[%s] Queue full, drop oldest. type: %d [%s], from: 0x%08lx", __func__,
+      oldest->type, GET_MSG_TYPE_NAME(oldest->type), oldest->from);
+  msgpool_CountDrop(queue, oldest->from);
+  msgpool_Release(oldest);
+  return true;
+}
+
+esp_err_t msgpool_Init(void) {
+  esp_err_t result = ESP_OK;
+
+  esp_log_level_set(TAG, CONFIG_MGR_CTRL_LOG_LEVEL);
+
+  ESP_LOGI(TAG, "++%s(small: %d x %d, large: %d x %d)", __func__,
+      MSGPOOL_SMALL_SLOTS, MSGPOOL_SMALL_SLOT_SIZE, MSGPOOL_LARGE_SLOTS, MSGPOOL_LARGE_SLOT_SIZE);
+
+  taskENTER_CRITICAL(&msgpool_lock);
+  memset(&msgpool_stats, 0x00, sizeof(msgpool_stats));
+  memset(msgpool_drop_list, 0x00, sizeof(msgpool_drop_list));
+  for (int cls = 0; cls < MSGPOOL_CLASS_MAX; ++cls) {
+    msgpool_class_t* c = &msgpool_class[cls];
+
+    c->free = MSGPOOL_SLOT_NONE;
+    for (int idx = c->slots - 1; idx >= 0; --idx) {
+      c->refs[idx] = 0;
+      c->next[idx] = c->free;
+      c->free = (uint16_t) idx;
+    }
+    msgpool_stats.cls[cls].slot_size = c->slot_size;
+    msgpool_stats.cls[cls].slots = c->slots;
+  }
+  taskEXIT_CRITICAL(&msgpool_lock);
+
+  ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
+  return result;
+}
+
+size_t msgpool_GetMsgSize(msg_type_e type) {
+  /* Unknown types keep a whole small slot, as before the schema knew them */
+  return ((uint32_t) type < MSG_TYPE_MAX) ? (MSG_HEADER_SIZE + msgcodec_GetPayloadSize(type)) : MSG_SMALL_SIZE;
+}
+
+QueueHandle_t msgpool_CreateQueue(const char* name, UBaseType_t depth) {
+  QueueHandle_t queue = xQueueCreate(depth, sizeof(msg_t*));
+
+  if (queue == NULL) {
+    return NULL;
+  }
+
+  taskENTER_CRITICAL(&msgpool_lock);
+  for (int idx = 0; idx < MSGPOOL_QUEUE_MAX; ++idx) {
+    if (msgpool_queue_list[idx].queue == NULL) {
+      memset(&msgpool_queue_list[idx], 0x00, sizeof(msgpool_queue_t));
+      msgpool_queue_list[idx].name = name;
+      msgpool_queue_list[idx].queue = queue;
+      msgpool_queue_list[idx].depth = depth;
+      break;
+    }
+  }
+  taskEXIT_CRITICAL(&msgpool_lock);
+  return queue;
+}
+
+void msgpool_DeleteQueue(QueueHandle_t queue) {
+  if (queue == NULL) {
+    return;
+  }
+
+  /* While the queue is still registered: msgpool_Receive() needs its merge entries to release
+     the newer handle of a coalesced key as well */
+  msgpool_Drain(queue);
+
+  taskENTER_CRITICAL(&msgpool_lock);
+  for (int idx = 0; idx < MSGPOOL_QUEUE_MAX; ++idx) {
+    if (msgpool_queue_list[idx].queue == queue) {
+      memset(&msgpool_queue_list[idx], 0x00, sizeof(msgpool_queue_t));
+      break;
+    }
+  }
+  taskEXIT_CRITICAL(&msgpool_lock);
+
+  vQueueDelete(queue);
+}
+
+bool msgpool_IsPooled(const msg_t* msg) {
+  uint16_t slot;
+
+  return msgpool_FindSlot(msg, &slot) != MSGPOOL_CLASS_MAX;
+}
+
+/**
+ * @brief msgpool_Post() / msgpool_PostNoWait(); @p block applies the wait of MSGPOOL_POLICY_BLOCK.
+ */
+static esp_err_t msgpool_PostEx(QueueHandle_t queue, const msg_t* msg, TickType_t wait, bool block) {
+  msg_t* handle = NULL;
+  msg_t* drop = NULL;
+  uint16_t slot = 0;
+  msgpool_class_e cls;
+  msgpool_policy_e policy;
+  uint32_t key;
+  uint8_t q;
+  bool merged = false;
+
+  if ((queue == NULL) || (msg == NULL)) {
+    if ((msg != NULL) && !msgpool_IsPooled(msg)) {
+      msgbuf_Free(msgpool_GetBuf(msg));
+    }
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  policy = msgpool_GetPolicy(msg->type);
+  cls = msgpool_FindSlot(msg, &slot);
+  if (cls != MSGPOOL_CLASS_MAX) {
+    /* Already on the bus: hand over another reference instead of a copy */
+    handle = (msg_t*) msg;
+    taskENTER_CRITICAL(&msgpool_lock);
+    ++msgpool_class[cls].refs[slot];
+    ++msgpool_stats.posts;
+    ++msgpool_stats.shares;
+    taskEXIT_CRITICAL(&msgpool_lock);
+  } else {
+    size_t size = msgpool_GetMsgSize(msg->type);
+    int64_t now = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&msgpool_lock);
+    handle = msgpool_Alloc(size, now);
+    ++msgpool_stats.posts;
+    if (handle != NULL) {
+      ++msgpool_stats.copies;
+      msgpool_stats.copy_bytes += size;
+    } else {
+      ++msgpool_stats.no_slot;
+    }
+    taskEXIT_CRITICAL(&msgpool_lock);
+
+    if (handle == NULL) {
+      ESP_LOGE(TAG, "[%s] Pool empty. type: %d [%s], from: 0x%08lx, to: 0x%08lx", __func__,
+          msg->type, GET_MSG_TYPE_NAME(msg->type), msg->from, msg->to);
+      msgpool_CountDrop(queue, msg->from);
+      /* The buffer was handed over with the message, it goes with it */
+      msgbuf_Free(msgpool_GetBuf(msg));
+      return ESP_ERR_NO_MEM;
+    }
+    memcpy(handle, msg, size);
+  }
+
+  /* State messages: replace an older version still waiting in the queue */
+  key = msgpool_GetKey(handle);
+  taskENTER_CRITICAL(&msgpool_lock);
+  q = msgpool_FindQueue(queue);
+  if ((key != MSG_KEY_NONE) && (q != MSGPOOL_QUEUE_NONE)) {
+    merged = msgpool_Merge(q, handle, key, &drop);
+    if (merged) {
+      ++msgpool_stats.coalesced;
+      ++msgpool_queue_list[q].coalesced;
+    }
+  }
+  taskEXIT_CRITICAL(&msgpool_lock);
+
+  if (merged) {
+    msgpool_Release(drop);
+    return ESP_OK;
+  }
+
+  if (block && (policy == MSGPOOL_POLICY_BLOCK) && (wait < MSGPOOL_BLOCK_TICKS)) {
+    wait = MSGPOOL_BLOCK_TICKS;
+  }
+
+  if (xQueueSend(queue, &handle, wait) != pdPASS) {
+    msg_t* oldest = NULL;
+    bool room = false;
+
+    /* Only a message which may be dropped itself makes room, never a control message at the head */
+    if ((policy == MSGPOOL_POLICY_DROP_OLDEST)
+        && (xQueuePeek(queue, &oldest, (TickType_t) 0) == pdTRUE)
+        && (msgpool_GetPolicy(oldest->type) == MSGPOOL_POLICY_DROP_OLDEST)
+        && (msgpool_Receive(queue, &oldest, (TickType_t) 0) == ESP_OK)) {
+      room = msgpool_DropOldest(queue, oldest);
+    }
+    if (!room || (xQueueSend(queue, &handle, (TickType_t) 0) != pdPASS)) {
+      if (q != MSGPOOL_QUEUE_NONE) {
+        taskENTER_CRITICAL(&msgpool_lock);
+        drop = msgpool_Unmerge(q, handle);
+        taskEXIT_CRITICAL(&msgpool_lock);
+        if (drop != NULL) {
+          msgpool_CountDrop(queue, drop->from);
+          msgpool_Release(drop);
+        }
+      }
+      msgpool_CountDrop(queue, handle->from);
+      msgpool_Release(handle);
+      return ESP_FAIL;
+    }
+  }
+
+  UBaseType_t waiting = uxQueueMessagesWaiting(queue);
+  taskENTER_CRITICAL(&msgpool_lock);
+  if ((q != MSGPOOL_QUEUE_NONE) && (waiting > msgpool_queue_list[q].hwm)) {
+    msgpool_queue_list[q].hwm = waiting;
+  }
+  taskEXIT_CRITICAL(&msgpool_lock);
+  return ESP_OK;
+}
+
+esp_err_t msgpool_Post(QueueHandle_t queue, const msg_t* msg, TickType_t wait) {
+  return msgpool_PostEx(queue, msg, wait, true);
+}
+
+esp_err_t msgpool_PostNoWait(QueueHandle_t queue, const msg_t* msg) {
+  return msgpool_PostEx(queue, msg, (TickType_t) 0, false);
+}
+
+esp_err_t msgpool_Receive(QueueHandle_t queue, msg_t** msg, TickType_t wait) {
+  msg_t* queued = NULL;
+  msg_t* latest = NULL;
+
+  if ((queue == NULL) || (msg == NULL)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (xQueueReceive(queue, &queued, wait) != pdTRUE) {
+    return ESP_ERR_TIMEOUT;
+  }
+
+  /* Hand out the newest version of a keyed message, its merge entry ends here */
+  latest = queued;
+  taskENTER_CRITICAL(&msgpool_lock);
+  uint8_t q = msgpool_FindQueue(queue);
+  if (q != MSGPOOL_QUEUE_NONE) {
+    msgpool_merge_t* merge = msgpool_queue_list[q].merge;
+
+    for (int idx = 0; idx < MSGPOOL_MERGE_MAX; ++idx) {
+      if (merge[idx].queued == queued) {
+        latest = merge[idx].latest;
+        merge[idx].queued = NULL;
+        merge[idx].latest = NULL;
+        break;
+      }
+    }
+  }
+  taskEXIT_CRITICAL(&msgpool_lock);
+
+  if (latest != queued) {
+    msgpool_Release(queued);
+  }
+  *msg = latest;
+  return ESP_OK;
+}
+
+uint32_t msgpool_GetKey(const msg_t* msg) {
+  if (msg->key != MSG_KEY_NONE) {
+    return msg->key;
+  }
+  switch (msg->type) {
+    /* Link state: connected/disconnected replace each other, other events are kept */
+    case MSG_TYPE_ETH_EVENT: {
+      return ((msg->payload.eth.u.event_id == DATA_ETH_EVENT_CONNECTED)
+           || (msg->payload.eth.u.event_id == DATA_ETH_EVENT_DISCONNECTED)) ? MSG_KEY(0) : MSG_KEY_NONE;
+    }
+    case MSG_TYPE_WIFI_EVENT: {
+      return ((msg->payload.wifi.u.event_id == DATA_WIFI_EVENT_CONNECTED)
+           || (msg->payload.wifi.u.event_id == DATA_WIFI_EVENT_DISCONNECTED)) ? MSG_KEY(0) : MSG_KEY_NONE;
+    }
+    case MSG_TYPE_MQTT_EVENT: {
+      return ((msg->payload.mqtt.u.event_id == DATA_MQTT_EVENT_CONNECTED)
+           || (msg->payload.mqtt.u.event_id == DATA_MQTT_EVENT_DISCONNECTED)) ? MSG_KEY(0) : MSG_KEY_NONE;
+    }
+    /* LCD merge updates touching the same fields */
+    case MSG_TYPE_LCD_DATA: {
+      return MSG_KEY(msg->payload.lcd.mask);
+    }
+    default: {
+      return (msgpool_GetPolicy(msg->type) == MSGPOOL_POLICY_COALESCE) ? MSG_KEY(0) : MSG_KEY_NONE;
+    }
+  }
+}
+
+esp_err_t msgpool_SetPolicy(msg_type_e type, msgpool_policy_e policy) {
+  if ((type >= MSG_TYPE_MAX) || (policy >= MSGPOOL_POLICY_MAX)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  msgpool_policy_map[type] = (uint8_t) policy;
+  return ESP_OK;
+}
+
+msgpool_policy_e msgpool_GetPolicy(msg_type_e type) {
+  return (type < MSG_TYPE_MAX) ? (msgpool_policy_e) msgpool_policy_map[type] : MSGPOOL_POLICY_DROP_NEWEST;
+}
+
+esp_err_t msgpool_SetTtl(msg_type_e type, uint32_t ttl_ms) {
+  if (type >= MSG_TYPE_MAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  msgpool_ttl_map[type] = ttl_ms;
+  return ESP_OK;
+}
+
+uint32_t msgpool_GetTtl(msg_type_e type) {
+  return (type < MSG_TYPE_MAX) ? msgpool_ttl_map[type] : 0U;
+}
+
+bool msgpool_IsExpired(const msg_t* msg) {
+  uint32_t ttl_ms;
+  int64_t stamp;
+  int64_t age;
+
+  if ((msg == NULL) || (msg->type >= MSG_TYPE_MAX) ||
+      (msg->type == MSG_TYPE_INIT) || (msg->type == MSG_TYPE_DONE) || (msg->type == MSG_TYPE_RUN)) {
+    return false;
+  }
+  ttl_ms = (msg->ttl_ms != MSG_TTL_NONE) ? msg->ttl_ms : msgpool_ttl_map[msg->type];
+  stamp = msgpool_GetStamp(msg);
+  if ((ttl_ms == 0U) || (stamp == 0)) {
+    return false;
+  }
+  age = esp_timer_get_time() - stamp;
+  if (age <= (int64_t) ttl_ms * 1000) {
+    return false;
+  }
+
+  taskENTER_CRITICAL(&msgpool_lock);
+  ++msgpool_stats.expired;
+  ++msgpool_expired_list[msg->type];
+  taskEXIT_CRITICAL(&msgpool_lock);
+  ESP_LOGW(TAG, "[%s] Expired. type: %d [%s], from: 0x%08lx, to: 0x%08lx, age: %lld ms, ttl: %lu ms", __func__,
+      msg->type, GET_MSG_TYPE_NAME(msg->type), msg->from, msg->to, age / 1000, ttl_ms);
+  return true;
+}
+
+uint32_t msgpool_GetExpired(msg_type_e type) {
+  uint32_t cnt;
+
+  if (type >= MSG_TYPE_MAX) {
+    return 0;
+  }
+  taskENTER_CRITICAL(&msgpool_lock);
+  cnt = msgpool_expired_list[type];
+  taskEXIT_CRITICAL(&msgpool_lock);
+  return cnt;
+}
+
+void msgpool_Release(const msg_t* msg) {
+  uint16_t slot = 0;
+  msgpool_class_e cls = msgpool_FindSlot(msg, &slot);
+  const void* buf = NULL;
+
+  if (cls == MSGPOOL_CLASS_MAX) {
+    return;
+  }
+
+  taskENTER_CRITICAL(&msgpool_lock);
+  msgpool_class_t* c = &msgpool_class[cls];
+  if (c->refs[slot] > 0) {
+    if (--c->refs[slot] == 0) {
+      /* Read before the slot is free, a new message may take it right away */
+      buf = msgpool_GetBuf(msg);
+      c->next[slot] = c->free;
+      c->free = slot;
+      --msgpool_stats.cls[cls].in_use;
+    }
+  }
+  taskEXIT_CRITICAL(&msgpool_lock);
+  msgbuf_Free(buf);
+}
+
+int64_t msgpool_GetStamp(const msg_t* msg) {
+  uint16_t slot = 0;
+  msgpool_class_e cls = msgpool_FindSlot(msg, &slot);
+
+  if (cls == MSGPOOL_CLASS_MAX) {
+    return 0;
+  }
+  return msgpool_class[cls].stamp[slot];
+}
+
+void msgpool_Drain(QueueHandle_t queue) {
+  msg_t* handle = NULL;
+
+  if (queue == NULL) {
+    return;
+  }
+  while (msgpool_Receive(queue, &handle, (TickType_t) 0) == ESP_OK) {
+    msgpool_Release(handle);
+  }
+}
+
+void msgpool_GetStats(msgpool_stats_t* stats) {
+  if (stats == NULL) {
+    return;
+  }
+  taskENTER_CRITICAL(&msgpool_lock);
+  *stats = msgpool_stats;
+  taskEXIT_CRITICAL(&msgpool_lock);
+}
+
+uint32_t msgpool_GetQueueInfo(msgpool_queue_info_t* info, uint32_t max) {
+  msgpool_queue_t list[MSGPOOL_QUEUE_MAX];
+  uint32_t cnt = 0;
+
+  if (info == NULL) {
+    return 0;
+  }
+
+  taskENTER_CRITICAL(&msgpool_lock);
+  memcpy(list, msgpool_queue_list, sizeof(list));
+  taskEXIT_CRITICAL(&msgpool_lock);
+
+  for (int idx = 0; (idx < MSGPOOL_QUEUE_MAX) && (cnt < max); ++idx) {
+    if (list[idx].queue == NULL) {
+      continue;
+    }
+    info[cnt].name = list[idx].name;
+    info[cnt].depth = list[idx].depth;
+    info[cnt].waiting = uxQueueMessagesWaiting(list[idx].queue);
+    info[cnt].hwm = list[idx].hwm;
+    info[cnt].dropped = list[idx].dropped;
+    info[cnt].coalesced = list[idx].coalesced;
+    info[cnt].bytes = sizeof(StaticQueue_t) + list[idx].depth * sizeof(msg_t*);
+    info[cnt].bytes_by_value = sizeof(StaticQueue_t) + list[idx].depth * sizeof(msg_t);
+    ++cnt;
+  }
+  return cnt;
+}
+
+uint32_t msgpool_GetDrops(msgpool_drop_info_t* info, uint32_t max) {
+  uint32_t cnt = 0;
+
+  if (info == NULL) {
+    return 0;
+  }
+
+  taskENTER_CRITICAL(&msgpool_lock);
+  for (int idx = 0; (idx < MSGPOOL_DROP_MAX) && (cnt < max); ++idx) {
+    if (msgpool_drop_list[idx].count == 0) {
+      break;
+    }
+    info[cnt++] = msgpool_drop_list[idx];
+  }
+  taskEXIT_CRITICAL(&msgpool_lock);
+  return cnt;
+}
+
+void msgpool_LogStats(void) {
+  msgpool_stats_t stats;
+
+  msgpool_GetStats(&stats);
+
+  /* By-value bus: every hop copied the whole message into and out of a queue */
+  uint64_t legacy_bytes = (uint64_t) stats.posts * 2U * sizeof(msg_t);
+  uint64_t pool_bytes   = (uint64_t) stats.copy_bytes + (uint64_t) stats.posts * 2U * sizeof(msg_t*);
+
+  for (int cls = 0; cls < MSGPOOL_CLASS_MAX; ++cls) {
+    const msgpool_class_stats_t* s = &stats.cls[cls];
+
+    ESP_LOGI(TAG, "class: %s, slots: %lu x %lu, in_use: %lu, in_use_max: %lu, alloc_fail: %lu",
+        (cls == MSGPOOL_CLASS_SMALL) ? "small" : "large",
+        s->slots, s->slot_size, s->in_use, s->in_use_max, s->alloc_fail);
+  }
+  ESP_LOGI(TAG, "posts: %lu, copies: %lu, shares: %lu, no_slot: %lu, bytes: %llu (by-value: %llu)",
+      stats.posts, stats.copies, stats.shares, stats.no_slot, pool_bytes, legacy_bytes);
+  ESP_LOGI(TAG, "dropped: %lu, coalesced: %lu, expired: %lu", stats.dropped, stats.coalesced, stats.expired);
+
+  msgbuf_stats_t buf;
+  msgbuf_GetStats(&buf);
+  ESP_LOGI(TAG, "buffers: %lu x %lu, in_use: %lu, in_use_max: %lu, allocs: %lu, alloc_fail: %lu, too_big: %lu",
+      buf.buffers, buf.size, buf.in_use, buf.in_use_max, buf.allocs, buf.alloc_fail, buf.too_big);
+  for (int type = 0; type < MSG_TYPE_MAX; ++type) {
+    uint32_t expired = msgpool_GetExpired((msg_type_e) type);
+
+    if (expired != 0U) {
+      ESP_LOGW(TAG, "expired: type: %-28s count: %lu", GET_MSG_TYPE_NAME(type), expired);
+    }
+  }
+
+  msgpool_drop_info_t drops[MSGPOOL_DROP_MAX];
+  uint32_t cnt = msgpool_GetDrops(drops, MSGPOOL_DROP_MAX);
+  for (uint32_t idx = 0; idx < cnt; ++idx) {
+    ESP_LOGW(TAG, "drop: from: 0x%08lx, to: %-8s count: %lu", drops[idx].from, drops[idx].to, drops[idx].count);
+  }
+}
+
+void msgpool_LogMemory(void) {
+  msgpool_queue_info_t info[MSGPOOL_QUEUE_MAX];
+  uint32_t cnt = msgpool_GetQueueInfo(info, MSGPOOL_QUEUE_MAX);
+  uint32_t total = 0;
+  uint32_t total_by_value = 0;
+
+  for (uint32_t idx = 0; idx < cnt; ++idx) {
+    ESP_LOGI(TAG, "queue: %-8s depth: %2lu, waiting: %2lu, hwm: %2lu, bytes: %5lu (by-value: %5lu)",
+        info[idx].name, info[idx].depth, info[idx].waiting, info[idx].hwm, info[idx].bytes, info[idx].bytes_by_value);
+    total += info[idx].bytes;
+    total_by_value += info[idx].bytes_by_value;
+  }
+  for (int cls = 0; cls < MSGPOOL_CLASS_MAX; ++cls) {
+    const msgpool_class_t* c = &msgpool_class[cls];
+    uint32_t bytes = c->slots * (c->slot_size + 2U * sizeof(uint16_t) + sizeof(int64_t));
+
+    ESP_LOGI(TAG, "pool:  %-8s slots: %2d, bytes: %5lu",
+        (cls == MSGPOOL_CLASS_SMALL) ? "small" : "large", c->slots, bytes);
+    total += bytes;
+  }
+  ESP_LOGI(TAG, "total: %lu bytes (by-value queues: %lu, saved: %ld)",
+      total, total_by_value, (long) total_by_value - (long) total);
+}
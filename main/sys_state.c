@@ -0,0 +1,206 @@
+/**
+ * @file sys_state.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Shared system-state flags (link, IP, MQTT, time) next to the message bus
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Readers copy `sysstate_data` between two reads of `sysstate_seq` and retry
+ * when it was odd or moved. The writer bumps the counter, copies and bumps it
+ * again inside a critical section, so it is never preempted with an odd
+ * counter by a reader on its own core, which would then spin forever.
+ */
+#include <string.h>
+
+#include "sdkconfig.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+
+#include "sys_state.h"
+
+
+static const char* TAG = "ESP::STATE";
+
+static EventGroupHandle_t sysstate_group = NULL;
+static SemaphoreHandle_t  sysstate_mutex = NULL;   /* one writer at a time */
+static portMUX_TYPE       sysstate_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t           sysstate_seq = 0;        /* odd while sysstate_data is written */
+static sys_state_t        sysstate_data = {};
+
+static const char* sysstate_flag_names[SYSSTATE_FLAG_CNT] = {
+  "eth", "wifi", "ip", "mqtt", "time", "session",
+};
+
+
+/**
+ * @brief Make @p next the state seen by readers; call with sysstate_mutex held.
+ */
+static void sysstate_Publish(const sys_state_t* next) {
+  taskENTER_CRITICAL(&sysstate_lock);
+  __atomic_store_n(&sysstate_seq, sysstate_seq + 1U, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  memcpy(&sysstate_data, next, sizeof(sys_state_t));
+  __atomic_store_n(&sysstate_seq, sysstate_seq + 1U, __ATOMIC_RELEASE);
+  taskEXIT_CRITICAL(&sysstate_lock);
+}
+
+/**
+ * @brief Apply one change and wake the waiters.
+ *
+ * @param netif SYSSTATE_NETIF_MAX when no address changes.
+ * @param up    Flags which went up (optional).
+ * @param down  Flags which went down (optional).
+ *
+ * @return true when the flags or an address changed.
+ */
+static bool sysstate_Change(uint32_t set, uint32_t clear, sysstate_netif_e netif, uint32_t ip,
+                            uint32_t* up, uint32_t* down) {
+  sys_state_t next;
+  uint32_t raised = 0;
+  uint32_t dropped = 0;
+  bool changed = false;
+
+  if (sysstate_mutex == NULL) {
+    ESP_LOGE(TAG, "[%s] Called before sysstate_Init()", __func__);
+    return false;
+  }
+  xSemaphoreTake(sysstate_mutex, portMAX_DELAY);
+  /* Only writers change sysstate_data, and they hold the mutex */
+  next = sysstate_data;
+  next.flags = (next.flags | set) & ~clear;
+  if (clear & SYSSTATE_ETH_LINK) {
+    next.ip[SYSSTATE_NETIF_ETH] = 0;
+  }
+  if (clear & SYSSTATE_WIFI_LINK) {
+    next.ip[SYSSTATE_NETIF_WIFI] = 0;
+  }
+  if (netif < SYSSTATE_NETIF_MAX) {
+    next.ip[netif] = ip;
+  }
+  if ((next.ip[SYSSTATE_NETIF_ETH] != 0U) || (next.ip[SYSSTATE_NETIF_WIFI] != 0U)) {
+    next.flags |= SYSSTATE_IP;
+  } else {
+    next.flags &= ~SYSSTATE_IP;
+  }
+
+  raised = next.flags & ~sysstate_data.flags;
+  dropped = sysstate_data.flags & ~next.flags;
+  changed = (raised != 0U) || (dropped != 0U) || (memcmp(next.ip, sysstate_data.ip, sizeof(next.ip)) != 0);
+  if (changed) {
+    ++next.changes;
+    next.changed_ms = (uint32_t) (esp_timer_get_time() / 1000);
+    sysstate_Publish(&next);
+    /* Waiters see the flags only after the struct is up to date */
+    if (raised != 0U) {
+      xEventGroupSetBits(sysstate_group, raised);
+    }
+    if (dropped != 0U) {
+      xEventGroupClearBits(sysstate_group, dropped);
+    }
+  }
+  xSemaphoreGive(sysstate_mutex);
+
+  if (changed) {
+    ESP_LOGI(TAG, "[%s] flags: 0x%02lx (up: 0x%02lx, down: 0x%02lx), eth ip: 0x%08lx, wifi ip: 0x%08lx", __func__,
+        next.flags, raised, dropped, next.ip[SYSSTATE_NETIF_ETH], next.ip[SYSSTATE_NETIF_WIFI]);
+  }
+  if (up) {
+    *up = raised;
+  }
+  if (down) {
+    *down = dropped;
+  }
+  return changed;
+}
+
+esp_err_t sysstate_Init(void) {
+  if (sysstate_group == NULL) {
+    sysstate_group = xEventGroupCreate();
+    if (sysstate_group == NULL) {
+      ESP_LOGE(TAG, "[%s] xEventGroupCreate() failed.", __func__);
+      return ESP_FAIL;
+    }
+  }
+  if (sysstate_mutex == NULL) {
+    sysstate_mutex = xSemaphoreCreateMutex();
+    if (sysstate_mutex == NULL) {
+      ESP_LOGE(TAG, "[%s] xSemaphoreCreateMutex() failed.", __func__);
+      return ESP_FAIL;
+    }
+  }
+  return ESP_OK;
+}
+
+bool sysstate_Set(uint32_t flags) {
+  uint32_t up = 0;
+
+  (void) sysstate_Change(flags & SYSSTATE_ALL, 0U, SYSSTATE_NETIF_MAX, 0U, &up, NULL);
+  return (up & flags) != 0U;
+}
+
+bool sysstate_Clear(uint32_t flags) {
+  uint32_t down = 0;
+
+  (void) sysstate_Change(0U, flags & SYSSTATE_ALL, SYSSTATE_NETIF_MAX, 0U, NULL, &down);
+  return (down & flags) != 0U;
+}
+
+bool sysstate_SetIp(sysstate_netif_e netif, uint32_t ip) {
+  if (netif >= SYSSTATE_NETIF_MAX) {
+    return false;
+  }
+  return sysstate_Change(0U, 0U, netif, ip, NULL, NULL);
+}
+
+uint32_t sysstate_GetFlags(void) {
+  return __atomic_load_n(&sysstate_data.flags, __ATOMIC_ACQUIRE);
+}
+
+void sysstate_Get(sys_state_t* state) {
+  uint32_t begin;
+  uint32_t end;
+
+  if (state == NULL) {
+    return;
+  }
+  do {
+    begin = __atomic_load_n(&sysstate_seq, __ATOMIC_ACQUIRE);
+    memcpy(state, &sysstate_data, sizeof(sys_state_t));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    end = __atomic_load_n(&sysstate_seq, __ATOMIC_RELAXED);
+  } while (((begin & 1U) != 0U) || (begin != end));
+}
+
+esp_err_t sysstate_Wait(uint32_t flags, bool all, uint32_t timeout_ms) {
+  EventBits_t bits;
+
+  if (sysstate_group == NULL) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  flags &= SYSSTATE_ALL;
+  bits = xEventGroupWaitBits(sysstate_group, (EventBits_t) flags, pdFALSE, all ? pdTRUE : pdFALSE,
+      (timeout_ms == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms));
+  if (all) {
+    return ((bits & flags) == flags) ? ESP_OK : ESP_ERR_TIMEOUT;
+  }
+  return ((bits & flags) != 0U) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+const char* sysstate_GetFlagName(uint32_t flag) {
+  for (uint32_t idx = 0; idx < SYSSTATE_FLAG_CNT; ++idx) {
+    if (flag == (1U << idx)) {
+      return sysstate_flag_names[idx];
+    }
+  }
+  return "?";
+}
@@ -19,13 +19,14 @@
 
 #include "err.h"
 #include "msg.h"
+#include "executor.h"
+#include "msg_pool.h"
 #include "cfg_ctrl.h"
 
 #include "err.h"
 #include "lut.h"
 
 
-#define CFG_TASK_NAME           "cfg-task"
 #define CFG_TASK_STACK_SIZE     4096
 #define CFG_TASK_PRIORITY       12
 
@@ -35,9 +36,7 @@
 static const char* TAG = "EPS::CFG";
 
 
-static QueueHandle_t      cfg_msg_queue = NULL;
-static TaskHandle_t       cfg_task_id = NULL;
-static SemaphoreHandle_t  cfg_sem_id = NULL;
+static executor_unit_t*   cfg_unit = NULL;
 
 
 static esp_err_t cfgctrl_ParseMsg(const msg_t* msg) {
@@ -69,50 +68,11 @@ static esp_err_t cfgctrl_ParseMsg(const msg_t* msg) {
   return result;
 }
 
-/**
- * @brief Configure task's function
- * 
- * @param param 
- */
-static void cfgctrl_TaskFn(void* param) {
-  msg_t msg;
-  bool loop = true;
-  esp_err_t result;
-
-  ESP_LOGI(TAG, "++%s()", __func__);
-  memset(&msg, 0x00, sizeof(msg_t));
-  while (loop) {
-    ESP_LOGD(TAG, "[%s] Wait...", __func__);
-    if(xQueueReceive(cfg_msg_queue, &msg, portMAX_DELAY) == pdTRUE) {
-      ESP_LOGD(TAG, "[%s] Message arrived: type: %d [%s], from: 0x%08lx, to: 0x%08lx", __func__, 
-          msg.type, GET_MSG_TYPE_NAME(msg.type),
-          msg.from, msg.to);
-      
-      result = cfgctrl_ParseMsg(&msg);
-      if (result == ESP_TASK_DONE) {
-        loop = false;
-        result = ESP_OK;
-      }
-
-      if (result != ESP_OK) {
-        // TODO - Send Error to the Broker
-        ESP_LOGE(TAG, "[%s] Error: %d", __func__, result);
-      }
-    } else {
-      ESP_LOGE(TAG, "[%s] Message error.", __func__);
-    }
-  }
-  if (cfg_sem_id) {
-    xSemaphoreGive(cfg_sem_id);
-  }
-  ESP_LOGI(TAG, "--%s()", __func__);
-}
-
 static esp_err_t cfgctrl_Send(const msg_t* msg) {
   esp_err_t result = ESP_OK;
 
   ESP_LOGI(TAG, "++%s()", __func__);
-  if (xQueueSend(cfg_msg_queue, msg, (TickType_t) 0) != pdPASS) {
+  if (executor_Post(cfg_unit, msg, (TickType_t) 0) != ESP_OK) {
     ESP_LOGE(TAG, "[%s] Message error. type: %d, from: 0x%08lx, to: 0x%08lx", __func__, msg->type, msg->from, msg->to);
     result = ESP_FAIL;
   }
@@ -125,26 +85,17 @@ static esp_err_t cfgctrl_Init(void) {
 
   ESP_LOGI(TAG, "++%s()", __func__);
 
-  /* Initialization message queue */
-  cfg_msg_queue = xQueueCreate(CFG_MSG_MAX, sizeof(msg_t));
-  if (cfg_msg_queue == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xQueueCreate() failed.", __func__);
-    return ESP_FAIL;
-  }
-
-  cfg_sem_id = xSemaphoreCreateCounting(1, 0);
-  if (cfg_sem_id == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xSemaphoreCreateCounting() failed.", __func__);
-    return ESP_FAIL;
-  }
-
-  /* Initialization thread */
-  xTaskCreate(cfgctrl_TaskFn, CFG_TASK_NAME, CFG_TASK_STACK_SIZE, NULL, CFG_TASK_PRIORITY, &cfg_task_id);
-  if (cfg_task_id == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xTaskCreate() failed.", __func__);
+  executor_cfg_t cfg = {
+    .name     = "cfg",
+    .module   = REG_CFG_CTRL,
+    .depth    = CFG_MSG_MAX,
+    .handler  = cfgctrl_ParseMsg,
+    .stack    = CFG_TASK_STACK_SIZE,
+    .priority = CFG_TASK_PRIORITY,
+  };
+  cfg_unit = executor_Create(&cfg);
+  if (cfg_unit == NULL) {
+    ESP_LOGE(TAG, "[%s] executor_Create() failed.", __func__);
     return ESP_FAIL;
   }
 
@@ -156,25 +107,17 @@ static esp_err_t cfgctrl_Done(void) {
   esp_err_t result = ESP_OK;
 
   ESP_LOGI(TAG, "++%s()", __func__);
-  if (cfg_sem_id) {
+  if (cfg_unit) {
     msg_t msg = {
       .type = MSG_TYPE_DONE,
       .from = REG_CFG_CTRL,
       .to = REG_CFG_CTRL,
     };
-    result = cfgctrl_Send(&msg);
-
-    ESP_LOGD(TAG, "[%s] Wait on xSemaphoreTake to finish task...", __func__);
-    xSemaphoreTake(cfg_sem_id, portMAX_DELAY);
-
-    vSemaphoreDelete(cfg_sem_id);
-    ESP_LOGD(TAG, "[%s] Semaphore deleted", __func__);
-
-    ESP_LOGD(TAG, "[%s] Task stopped", __func__);
-  }
-  if (cfg_msg_queue) {
-    vQueueDelete(cfg_msg_queue);
-    ESP_LOGD(TAG, "[%s] Queue deleted", __func__);
+    result = executor_Delete(cfg_unit, &msg);
+    if (result == ESP_OK) {
+      cfg_unit = NULL;
+      ESP_LOGD(TAG, "[%s] Unit deleted", __func__);
+    }
   }
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
   return result;
@@ -22,16 +22,23 @@
 #include "err.h"
 #include "lut.h"
 #include "msg.h"
+#include "executor.h"
+#include "msg_pool.h"
 #include "cli_ctrl.h"
 
+#if CONFIG_CLI_CTRL_ENABLE
+#include "cli_mgr.h"
+#endif
 #if CONFIG_WIFI_CTRL_ENABLE
 #include "cli_wifi.h"
 #endif
 #if CONFIG_CLI_CTRL_ENABLE && CONFIG_LCD_CTRL_ENABLE
 #include "cli_lcd.h"
 #endif
+#if CONFIG_CLI_CTRL_ENABLE && CONFIG_MQTT_CTRL_ENABLE
+#include "cli_mqtt.h"
+#endif
 
-#define CLI_TASK_NAME           "cli-task"
 #define CLI_TASK_STACK_SIZE     4096
 #define CLI_TASK_PRIORITY       12
 
@@ -52,9 +59,7 @@
 
 static const char *TAG = "ESP::CLI";
 
-static QueueHandle_t      cli_msg_queue = NULL;
-static TaskHandle_t       cli_task_id = NULL;
-static SemaphoreHandle_t  cli_sem_id = NULL;
+static executor_unit_t*   cli_unit = NULL;
 
 #if CONFIG_CLI_CTRL_ENABLE
 static esp_console_repl_t *s_repl = NULL;
@@ -62,11 +67,11 @@ static bool                s_console_inited = false;
 #endif
 
 /**
- * @brief Handle one control message dequeued by the CLI module task.
+ * @brief Handle one control message of the CLI unit (see `executor.h`).
  *
  * Maps lifecycle types to `ESP_TASK_*` codes used by the manager pattern.
  *
- * @param msg Incoming message from `cli_msg_queue`.
+ * @param msg Incoming message from the unit queue.
  *
  * @return `ESP_TASK_INIT`, `ESP_TASK_RUN`, `ESP_TASK_DONE`, or `ESP_FAIL` for unsupported types.
  */
@@ -100,48 +105,7 @@ static esp_err_t clictrl_ParseMsg(const msg_t *msg)
 }
 
 /**
- * @brief FreeRTOS task body: block on `cli_msg_queue` and run `clictrl_ParseMsg()`.
- *
- * Signals `cli_sem_id` when exiting after `MSG_TYPE_DONE`.
- *
- * @param param Unused (NULL).
- */
-static void clictrl_TaskFn(void *param)
-{
-  (void)param;
-  msg_t     msg;
-  bool      loop = true;
-  esp_err_t result;
-
-  ESP_LOGI(TAG, "++%s()", __func__);
-  memset(&msg, 0x00, sizeof(msg_t));
-  while (loop) {
-    ESP_LOGD(TAG, "[%s] Wait...", __func__);
-    if (xQueueReceive(cli_msg_queue, &msg, portMAX_DELAY) == pdTRUE) {
-      ESP_LOGD(TAG, "[%s] Message arrived: type: %d [%s], from: 0x%08lx, to: 0x%08lx", __func__,
-               msg.type, GET_MSG_TYPE_NAME(msg.type), (unsigned long)msg.from, (unsigned long)msg.to);
-
-      result = clictrl_ParseMsg(&msg);
-      if (result == ESP_TASK_DONE) {
-        loop   = false;
-        result = ESP_OK;
-      }
-
-      if (result != ESP_OK) {
-        ESP_LOGE(TAG, "[%s] Error: %d", __func__, (int)result);
-      }
-    } else {
-      ESP_LOGE(TAG, "[%s] Message error.", __func__);
-    }
-  }
-  if (cli_sem_id) {
-    xSemaphoreGive(cli_sem_id);
-  }
-  ESP_LOGI(TAG, "--%s()", __func__);
-}
-
-/**
- * @brief Non-blocking post of a message to `cli_msg_queue` (zero tick timeout).
+ * @brief Non-blocking post of a message to the CLI unit (zero tick timeout).
  *
  * @param msg Message to copy into the queue; must not be NULL.
  *
@@ -152,7 +116,7 @@ static esp_err_t clictrl_Send(const msg_t *msg)
   esp_err_t result = ESP_OK;
 
   ESP_LOGI(TAG, "++%s()", __func__);
-  if (xQueueSend(cli_msg_queue, msg, (TickType_t)0) != pdPASS) {
+  if (executor_Post(cli_unit, msg, (TickType_t)0) != ESP_OK) {
     ESP_LOGE(TAG, "[%s] Message error. type: %d, from: 0x%08lx, to: 0x%08lx", __func__, msg->type,
              (unsigned long)msg->from, (unsigned long)msg->to);
     result = ESP_FAIL;
@@ -162,9 +126,9 @@ static esp_err_t clictrl_Send(const msg_t *msg)
 }
 
 /**
- * @brief Create the CLI message queue, shutdown semaphore, and worker task.
+ * @brief Create the CLI executor unit (message queue and task or pool slot).
  *
- * @return ESP_OK on success, ESP_FAIL if any RTOS object or task creation fails.
+ * @return ESP_OK on success, ESP_FAIL if the unit cannot be created.
  */
 static esp_err_t clictrl_Init(void)
 {
@@ -172,20 +136,17 @@ static esp_err_t clictrl_Init(void)
 
   ESP_LOGI(TAG, "++%s()", __func__);
 
-  cli_msg_queue = xQueueCreate(CLI_MSG_MAX, sizeof(msg_t));
-  if (cli_msg_queue == NULL) {
-    ESP_LOGE(TAG, "[%s] xQueueCreate() failed.", __func__);
-    return ESP_FAIL;
-  }
-
-  cli_sem_id = xSemaphoreCreateCounting(1, 0);
-  if (cli_sem_id == NULL) {
-    ESP_LOGE(TAG, "[%s] xSemaphoreCreateCounting() failed.", __func__);
-    return ESP_FAIL;
-  }
-
-  if (xTaskCreate(clictrl_TaskFn, CLI_TASK_NAME, CLI_TASK_STACK_SIZE, NULL, CLI_TASK_PRIORITY, &cli_task_id) != pdPASS) {
-    ESP_LOGE(TAG, "[%s] xTaskCreate() failed.", __func__);
+  executor_cfg_t cfg = {
+    .name     = "cli",
+    .module   = REG_CLI_CTRL,
+    .depth    = CLI_MSG_MAX,
+    .handler  = clictrl_ParseMsg,
+    .stack    = CLI_TASK_STACK_SIZE,
+    .priority = CLI_TASK_PRIORITY,
+  };
+  cli_unit = executor_Create(&cfg);
+  if (cli_unit == NULL) {
+    ESP_LOGE(TAG, "[%s] executor_Create() failed.", __func__);
     return ESP_FAIL;
   }
 
@@ -223,11 +184,11 @@ static esp_err_t clictrl_StopConsole(void)
 #endif
 
 /**
- * @brief Shut down console (if enabled), stop the CLI worker task, and delete RTOS objects.
+ * @brief Shut down console (if enabled) and delete the CLI executor unit.
  *
- * Posts `MSG_TYPE_DONE` to the worker queue and waits on `cli_sem_id` for task exit.
+ * `executor_Delete()` posts `MSG_TYPE_DONE` and waits until the handler returned `ESP_TASK_DONE`.
  *
- * @return Result of the final `clictrl_Send()` for the DONE message, or ESP_OK if semaphore was missing.
+ * @return Result of `executor_Delete()`, or ESP_OK if the unit was missing.
  */
 static esp_err_t clictrl_Done(void)
 {
@@ -239,27 +200,18 @@ static esp_err_t clictrl_Done(void)
   (void)clictrl_StopConsole();
 #endif
 
-  if (cli_sem_id) {
+  if (cli_unit) {
     msg_t msg = {
       .type = MSG_TYPE_DONE,
       .from = REG_CLI_CTRL,
       .to   = REG_CLI_CTRL,
     };
-    result = clictrl_Send(&msg);
-
-    ESP_LOGD(TAG, "[%s] Wait on xSemaphoreTake to finish task...", __func__);
-    xSemaphoreTake(cli_sem_id, portMAX_DELAY);
-
-    vSemaphoreDelete(cli_sem_id);
-    cli_sem_id = NULL;
-    ESP_LOGD(TAG, "[%s] Semaphore deleted", __func__);
-  }
-  if (cli_msg_queue) {
-    vQueueDelete(cli_msg_queue);
-    cli_msg_queue = NULL;
-    ESP_LOGD(TAG, "[%s] Queue deleted", __func__);
+    result = executor_Delete(cli_unit, &msg);
+    if (result == ESP_OK) {
+      cli_unit = NULL;
+      ESP_LOGD(TAG, "[%s] Unit deleted", __func__);
+    }
   }
-  cli_task_id = NULL;
 
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, (int)result);
   return result;
@@ -321,12 +273,16 @@ static esp_err_t clictrl_Run(void)
 
   s_console_inited = true;
 
+  CliMgr_RegisterConsoleCmd();
 #if CONFIG_WIFI_CTRL_ENABLE
   CliWifi_RegisterConsoleCmd();
 #endif
 #if CONFIG_CLI_CTRL_ENABLE && CONFIG_LCD_CTRL_ENABLE
   CliLcd_RegisterConsoleCmd();
 #endif
+#if CONFIG_CLI_CTRL_ENABLE && CONFIG_MQTT_CTRL_ENABLE
+  CliMqtt_RegisterConsoleCmd();
+#endif
 
   err = esp_console_start_repl(s_repl);
   if (err != ESP_OK) {
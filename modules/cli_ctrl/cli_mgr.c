@@ -0,0 +1,597 @@
+/**
+ * @file cli_mgr.c
+ * @brief Console commands to inspect the manager message bus (`bus pool|mem|lanes|isr|drops|trace|direct|exec`),
+ *        the boot timing (`boot`), the system-state flags (`state`), the module supervisor (`sup`) and to query
+ *        modules over the bus (`call`).
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sdkconfig.h"
+
+#if CONFIG_CLI_CTRL_ENABLE
+
+#include "esp_console.h"
+
+#include "boot_seq.h"
+#include "bus_trace.h"
+#include "cli_mgr.h"
+#include "executor.h"
+#include "mgr_ctrl.h"
+#include "msg.h"
+#include "msg_buf.h"
+#include "msg_pool.h"
+#include "sys_state.h"
+
+#include "lut.h"
+
+static const char* clicmd_ClassName(int cls) {
+  return (cls == MSGPOOL_CLASS_SMALL) ? "small" : "large";
+}
+
+static void clicmd_PrintPool(void) {
+  msgpool_stats_t stats;
+
+  msgpool_GetStats(&stats);
+
+  /* Same accounting as msgpool_LogStats(): by-value hops moved msg_t in and out of a queue */
+  unsigned long long legacy_bytes = (unsigned long long)stats.posts * 2U * sizeof(msg_t);
+  unsigned long long pool_bytes   = (unsigned long long)stats.copy_bytes
+                                  + (unsigned long long)stats.posts * 2U * sizeof(msg_t*);
+
+  printf("class  slots  size  in use  max  fail\n");
+  for (int cls = 0; cls < MSGPOOL_CLASS_MAX; ++cls) {
+    const msgpool_class_stats_t* c = &stats.cls[cls];
+    printf("%-5s  %5lu  %4lu  %6lu  %3lu  %4lu\n", clicmd_ClassName(cls), (unsigned long)c->slots,
+           (unsigned long)c->slot_size, (unsigned long)c->in_use, (unsigned long)c->in_use_max,
+           (unsigned long)c->alloc_fail);
+  }
+  msgbuf_stats_t buf;
+  msgbuf_GetStats(&buf);
+  printf("%-5s  %5lu  %4lu  %6lu  %3lu  %4lu  (too big: %lu)\n", "buf", (unsigned long)buf.buffers,
+         (unsigned long)buf.size, (unsigned long)buf.in_use, (unsigned long)buf.in_use_max,
+         (unsigned long)buf.alloc_fail, (unsigned long)buf.too_big);
+  printf("posts:        %lu\n", (unsigned long)stats.posts);
+  printf("copies:       %lu (%lu bytes)\n", (unsigned long)stats.copies, (unsigned long)stats.copy_bytes);
+  printf("shares:       %lu\n", (unsigned long)stats.shares);
+  printf("no slot:      %lu\n", (unsigned long)stats.no_slot);
+  printf("bytes moved:  %llu (by-value bus: %llu)\n", pool_bytes, legacy_bytes);
+}
+
+static void clicmd_PrintMemory(void) {
+  msgpool_queue_info_t info[MSGPOOL_QUEUE_MAX];
+  msgpool_stats_t      stats;
+  uint32_t             cnt = msgpool_GetQueueInfo(info, MSGPOOL_QUEUE_MAX);
+  unsigned long        total = 0;
+  unsigned long        total_by_value = 0;
+
+  msgpool_GetStats(&stats);
+
+  printf("queue     depth  waiting  bytes  by-value\n");
+  for (uint32_t idx = 0; idx < cnt; ++idx) {
+    printf("%-8s  %5lu  %7lu  %5lu  %8lu\n", info[idx].name, (unsigned long)info[idx].depth,
+           (unsigned long)info[idx].waiting, (unsigned long)info[idx].bytes, (unsigned long)info[idx].bytes_by_value);
+    total += info[idx].bytes;
+    total_by_value += info[idx].bytes_by_value;
+  }
+  for (int cls = 0; cls < MSGPOOL_CLASS_MAX; ++cls) {
+    /* slot storage + refs[], next[] and stamp[] bookkeeping */
+    unsigned long bytes = stats.cls[cls].slots * (stats.cls[cls].slot_size + 2U * sizeof(uint16_t) + sizeof(int64_t));
+    printf("pool/%-5s %4lu            %5lu\n", clicmd_ClassName(cls), (unsigned long)stats.cls[cls].slots, bytes);
+    total += bytes;
+  }
+  msgbuf_stats_t buf;
+  msgbuf_GetStats(&buf);
+  printf("pool/%-5s %4lu            %5lu\n", "buf", (unsigned long)buf.buffers, (unsigned long)(buf.buffers * buf.size));
+  total += buf.buffers * buf.size;
+  printf("total: %lu bytes (by-value queues: %lu)\n", total, total_by_value);
+}
+
+static void clicmd_PrintLanes(void) {
+  static const char* names[MGR_LANE_MAX] = { "ctrl", "bulk" };
+
+  printf("lane  depth  waiting  posted  dropped  dispatched  avg us  max us\n");
+  for (int lane = 0; lane < MGR_LANE_MAX; ++lane) {
+    mgr_lane_stats_t st;
+
+    if (MGR_GetLaneStats((mgr_lane_e)lane, &st) != ESP_OK) {
+      continue;
+    }
+    unsigned long avg = st.dispatched ? (unsigned long)(st.latency_sum_us / st.dispatched) : 0UL;
+    printf("%-4s  %5lu  %7lu  %6lu  %7lu  %10lu  %6lu  %6lu\n", names[lane], (unsigned long)st.depth,
+           (unsigned long)st.waiting, (unsigned long)st.posted, (unsigned long)st.dropped,
+           (unsigned long)st.dispatched, avg, (unsigned long)st.latency_max_us);
+  }
+}
+
+static void clicmd_PrintIsr(void) {
+  mgr_isr_stats_t st[CONFIG_MGR_ISR_SOURCE_MAX];
+  uint32_t cnt = MGR_GetIsrStats(st, CONFIG_MGR_ISR_SOURCE_MAX);
+
+  printf("source        depth  waiting  posted  dropped  drained  invalid  max us\n");
+  for (uint32_t idx = 0; idx < cnt; ++idx) {
+    printf("%-12s  %5lu  %7lu  %6lu  %7lu  %7lu  %7lu  %6lu\n", st[idx].name, (unsigned long)st[idx].depth,
+           (unsigned long)st[idx].waiting, (unsigned long)st[idx].posted, (unsigned long)st[idx].dropped,
+           (unsigned long)st[idx].drained, (unsigned long)st[idx].invalid, (unsigned long)st[idx].latency_max_us);
+  }
+  if (cnt == 0U) {
+    printf("(no interrupt source opened)\n");
+  }
+}
+
+static void clicmd_PrintDrops(void) {
+  static const char*    policies[MSGPOOL_POLICY_MAX] = { "drop-newest", "drop-oldest", "block", "coalesce" };
+  msgpool_queue_info_t  info[MSGPOOL_QUEUE_MAX];
+  mgr_drop_t            drops[MSGPOOL_DROP_MAX];
+  uint32_t              cnt = msgpool_GetQueueInfo(info, MSGPOOL_QUEUE_MAX);
+
+  printf("queue     depth  waiting  hwm  dropped  coalesced\n");
+  for (uint32_t idx = 0; idx < cnt; ++idx) {
+    printf("%-8s  %5lu  %7lu  %3lu  %7lu  %9lu\n", info[idx].name, (unsigned long)info[idx].depth,
+           (unsigned long)info[idx].waiting, (unsigned long)info[idx].hwm, (unsigned long)info[idx].dropped,
+           (unsigned long)info[idx].coalesced);
+  }
+
+  cnt = MGR_GetDrops(drops, MSGPOOL_DROP_MAX);
+  printf("\nfrom      to        count\n");
+  for (uint32_t idx = 0; idx < cnt; ++idx) {
+    printf("%-8s  %-8s  %5lu\n", drops[idx].from, drops[idx].to, (unsigned long)drops[idx].count);
+  }
+
+  printf("\npolicies (non-default):\n");
+  for (int type = 0; type < MSG_TYPE_MAX; ++type) {
+    msgpool_policy_e policy = msgpool_GetPolicy((msg_type_e)type);
+    if (policy != MSGPOOL_POLICY_DROP_NEWEST) {
+      printf("  %-28s %s\n", GET_MSG_TYPE_NAME(type), policies[policy]);
+    }
+  }
+
+  printf("\ntype                          ttl ms  expired\n");
+  for (int type = 0; type < MSG_TYPE_MAX; ++type) {
+    uint32_t ttl = msgpool_GetTtl((msg_type_e)type);
+    uint32_t expired = msgpool_GetExpired((msg_type_e)type);
+    if ((ttl != 0U) || (expired != 0U)) {
+      printf("%-28s  %6lu  %7lu\n", GET_MSG_TYPE_NAME(type), (unsigned long)ttl, (unsigned long)expired);
+    }
+  }
+}
+
+#if CONFIG_MGR_BUS_TRACE_ENABLE
+static const char* clicmd_TraceTo(uint32_t to) {
+  return (to == REG_ALL_CTRL) ? "all" : MGR_GetModuleName(to);
+}
+
+static void clicmd_PrintHist(void) {
+  static const char* stages[BUS_STAGE_MAX] = { "mgr-wait", "mgr-parse", "delivery", "mod-parse" };
+
+  printf("type                          stage      count   p50 us   p99 us  buckets");
+  for (uint32_t bucket = 0; bucket < (BUS_TRACE_BUCKET_MAX - 1U); ++bucket) {
+    printf(" <%lu", (unsigned long)bustrace_GetBucketLimit(bucket));
+  }
+  printf(" >=\n");
+  for (int type = 0; type < MSG_TYPE_MAX; ++type) {
+    for (int stage = 0; stage < BUS_STAGE_MAX; ++stage) {
+      uint32_t buckets[BUS_TRACE_BUCKET_MAX];
+      uint32_t count = bustrace_GetHist((msg_type_e)type, (bus_stage_e)stage, buckets);
+
+      if (count == 0) {
+        continue;
+      }
+      printf("%-28s  %-9s  %5lu  %7lu  %7lu  ", GET_MSG_TYPE_NAME(type), stages[stage], (unsigned long)count,
+             (unsigned long)bustrace_GetPercentile(buckets, 50), (unsigned long)bustrace_GetPercentile(buckets, 99));
+      for (uint32_t bucket = 0; bucket < BUS_TRACE_BUCKET_MAX; ++bucket) {
+        printf(" %lu", (unsigned long)buckets[bucket]);
+      }
+      printf("\n");
+    }
+  }
+}
+
+static void clicmd_PrintTrace(uint32_t max, bool binary) {
+  static const char* hops[BUS_HOP_MAX] = { "send", "drop", "mgr-recv", "mgr-done", "notify", "mod-recv", "mod-done", "direct" };
+  bus_trace_rec_t* rec = calloc(max, sizeof(bus_trace_rec_t));
+
+  if (rec == NULL) {
+    printf("Out of memory\n");
+    return;
+  }
+  uint32_t cnt = bustrace_Read(rec, max);
+
+  if (binary) {
+    /* One hex line per header/record, see scripts/parse_bus_trace.py */
+    bus_trace_hdr_t hdr = {
+      .magic    = BUS_TRACE_MAGIC,
+      .version  = BUS_TRACE_VERSION,
+      .rec_size = sizeof(bus_trace_rec_t),
+      .count    = cnt,
+      .now      = (cnt > 0) ? rec[cnt - 1U].ts : 0U,
+    };
+    const uint8_t* bytes = (const uint8_t*)&hdr;
+
+    printf("BTRC ");
+    for (size_t idx = 0; idx < sizeof(hdr); ++idx) {
+      printf("%02x", bytes[idx]);
+    }
+    printf("\n");
+    for (uint32_t idx = 0; idx < cnt; ++idx) {
+      bytes = (const uint8_t*)&rec[idx];
+      printf("BTRC ");
+      for (size_t pos = 0; pos < sizeof(bus_trace_rec_t); ++pos) {
+        printf("%02x", bytes[pos]);
+      }
+      printf("\n");
+    }
+  } else {
+    printf("ts us       core  hop       type                          from      to        id          val\n");
+    for (uint32_t idx = 0; idx < cnt; ++idx) {
+      const bus_trace_rec_t* r = &rec[idx];
+      printf("%10lu  %4u  %-8s  %-28s  %-8s  %-8s  0x%08lx  %lu\n", (unsigned long)r->ts, r->core,
+             (r->hop < BUS_HOP_MAX) ? hops[r->hop] : "?", GET_MSG_TYPE_NAME(r->type), MGR_GetModuleName(r->from),
+             clicmd_TraceTo(r->to), (unsigned long)r->id, (unsigned long)r->val);
+    }
+  }
+  free(rec);
+}
+
+static int clicmd_trace(int argc, char** argv) {
+  uint32_t max = 2U * CONFIG_MGR_BUS_TRACE_DEPTH;
+
+  if (argc < 3) {
+    clicmd_PrintHist();
+    return 0;
+  }
+  if (argc > 3) {
+    long n = strtol(argv[3], NULL, 10);
+    if ((n > 0) && ((uint32_t)n < max)) {
+      max = (uint32_t)n;
+    }
+  }
+  if (strcmp(argv[2], "dump") == 0) {
+    clicmd_PrintTrace(max, false);
+    return 0;
+  }
+  if (strcmp(argv[2], "bin") == 0) {
+    clicmd_PrintTrace(max, true);
+    return 0;
+  }
+  if (strcmp(argv[2], "reset") == 0) {
+    bustrace_Reset();
+    return 0;
+  }
+  printf("Unknown bus trace subcommand: %s\n", argv[2]);
+  return 1;
+}
+#endif /* CONFIG_MGR_BUS_TRACE_ENABLE */
+
+static int clicmd_direct(int argc, char** argv) {
+  if (argc > 2) {
+    if (strcmp(argv[2], "on") == 0) {
+      MGR_SetDirect(true);
+    } else if (strcmp(argv[2], "off") == 0) {
+      MGR_SetDirect(false);
+    } else {
+      printf("Unknown bus direct argument: %s\n", argv[2]);
+      return 1;
+    }
+  }
+  printf("direct dispatch: %s\n", MGR_GetDirect() ? "on" : "off");
+
+#if CONFIG_MGR_BUS_TRACE_ENABLE
+  /* End-to-end latency, bus entry until the handler returned, per path */
+  printf("\ntype                          queued  avg us  max us  direct  avg us  max us\n");
+  for (int type = 0; type < MSG_TYPE_MAX; ++type) {
+    bus_trace_path_t queued;
+    bus_trace_path_t direct;
+
+    if ((bustrace_GetPath((msg_type_e)type, BUS_PATH_QUEUED, &queued) != ESP_OK) ||
+        (bustrace_GetPath((msg_type_e)type, BUS_PATH_DIRECT, &direct) != ESP_OK) ||
+        ((queued.count == 0) && (direct.count == 0))) {
+      continue;
+    }
+    printf("%-28s  %6lu  %6lu  %6lu  %6lu  %6lu  %6lu\n", GET_MSG_TYPE_NAME(type),
+           (unsigned long)queued.count, queued.count ? (unsigned long)(queued.sum_us / queued.count) : 0UL,
+           (unsigned long)queued.max_us,
+           (unsigned long)direct.count, direct.count ? (unsigned long)(direct.sum_us / direct.count) : 0UL,
+           (unsigned long)direct.max_us);
+  }
+#endif /* CONFIG_MGR_BUS_TRACE_ENABLE */
+  return 0;
+}
+
+static void clicmd_PrintExecutor(void) {
+  executor_unit_info_t info[EXECUTOR_UNIT_MAX];
+  executor_stats_t stats;
+  uint32_t cnt = executor_GetUnits(info, EXECUTOR_UNIT_MAX);
+
+  executor_GetStats(&stats);
+  printf("mode: %s\n", stats.workers ? "worker pool" : "task per unit");
+  printf("unit        stack  waiting      runs\n");
+  for (uint32_t idx = 0; idx < cnt; ++idx) {
+    printf("%-10s  %5lu  %7lu  %8lu\n", info[idx].name, (unsigned long)info[idx].stack,
+           (unsigned long)info[idx].waiting, (unsigned long)info[idx].runs);
+  }
+  printf("units: %lu (%lu B stack), workers: %lu (%lu B stack), TCB: %lu B\n",
+         (unsigned long)stats.units, (unsigned long)stats.unit_stack, (unsigned long)stats.workers,
+         (unsigned long)stats.worker_stack, (unsigned long)stats.tcb_size);
+  printf("reclaimed: %ld B\n", (long)stats.reclaimed);
+}
+
+/**
+ * @brief Console handler for the `bus` command.
+ */
+static int clicmd_bus(int argc, char** argv) {
+  if (argc < 2) {
+    printf("Usage:\n");
+    printf("  bus pool\n");
+    printf("  bus mem\n");
+    printf("  bus lanes\n");
+    printf("  bus isr\n");
+    printf("  bus drops\n");
+#if CONFIG_MGR_BUS_TRACE_ENABLE
+    printf("  bus trace [dump|bin [count]|reset]\n");
+#endif
+    printf("  bus direct [on|off]\n");
+    printf("  bus exec\n");
+    return 1;
+  }
+
+  if (strcmp(argv[1], "pool") == 0) {
+    clicmd_PrintPool();
+    return 0;
+  }
+
+  if (strcmp(argv[1], "mem") == 0) {
+    clicmd_PrintMemory();
+    return 0;
+  }
+
+  if (strcmp(argv[1], "lanes") == 0) {
+    clicmd_PrintLanes();
+    return 0;
+  }
+
+  if (strcmp(argv[1], "isr") == 0) {
+    clicmd_PrintIsr();
+    return 0;
+  }
+
+  if (strcmp(argv[1], "drops") == 0) {
+    clicmd_PrintDrops();
+    return 0;
+  }
+
+  if (strcmp(argv[1], "direct") == 0) {
+    return clicmd_direct(argc, argv);
+  }
+
+  if (strcmp(argv[1], "exec") == 0) {
+    clicmd_PrintExecutor();
+    return 0;
+  }
+
+#if CONFIG_MGR_BUS_TRACE_ENABLE
+  if (strcmp(argv[1], "trace") == 0) {
+    return clicmd_trace(argc, argv);
+  }
+#endif
+
+  printf("Unknown bus subcommand: %s\n", argv[1]);
+  return 1;
+}
+
+static void clicmd_PrintLine(void* ctx, const char* line) {
+  (void)ctx;
+  printf("%s\n", line);
+}
+
+/**
+ * @brief Console handler for the `boot` command; same lines as the boot report in the log.
+ */
+static int clicmd_boot(int argc, char** argv) {
+  (void)argc;
+  (void)argv;
+  bootseq_Report(clicmd_PrintLine, NULL);
+  return 0;
+}
+
+static void clicmd_PrintIp(const char* name, uint32_t ip) {
+  const uint8_t* addr = (const uint8_t*)&ip;
+
+  printf("%-5s %u.%u.%u.%u\n", name, addr[0], addr[1], addr[2], addr[3]);
+}
+
+/**
+ * @brief Console handler for the `state` command: flags of sys_state.h, without a message.
+ */
+static int clicmd_state(int argc, char** argv) {
+  sys_state_t state;
+
+  (void)argc;
+  (void)argv;
+  sysstate_Get(&state);
+  printf("flags:");
+  for (uint32_t idx = 0; idx < SYSSTATE_FLAG_CNT; ++idx) {
+    uint32_t flag = 1U << idx;
+    printf(" %s=%s", sysstate_GetFlagName(flag), (state.flags & flag) ? "up" : "down");
+  }
+  printf("\n");
+  clicmd_PrintIp("eth", state.ip[SYSSTATE_NETIF_ETH]);
+  clicmd_PrintIp("wifi", state.ip[SYSSTATE_NETIF_WIFI]);
+  printf("changes: %lu, last at %lu ms\n", (unsigned long)state.changes, (unsigned long)state.changed_ms);
+  return 0;
+}
+
+static const char* clicmd_SupPolicyName(uint8_t policy) {
+  switch (policy) {
+    case MGR_SUP_RESTART: return "restart";
+    case MGR_SUP_REBOOT:  return "reboot";
+    default:              return "none";
+  }
+}
+
+static void clicmd_PrintSup(void) {
+  mgr_sup_stats_t stats[REG_BIT_MAX];
+  uint32_t cnt = MGR_GetSupStats(stats, REG_BIT_MAX);
+
+  printf("module    policy   state    faults  restarts  row  stalls  beat ago  last fault\n");
+  for (uint32_t idx = 0; idx < cnt; ++idx) {
+    const mgr_sup_stats_t* s = &stats[idx];
+    const char* st = !s->up ? "down" : (s->backoff ? "backoff" : "up");
+
+    printf("%-8s  %-7s  %-7s  %6lu  %8lu  %3lu  %6lu  ", s->name, clicmd_SupPolicyName(s->policy), st,
+           (unsigned long)s->faults, (unsigned long)s->restarts, (unsigned long)s->consecutive,
+           (unsigned long)s->stalls);
+    if (s->beat_age_ms != 0U) {
+      printf("%5lu ms  ", (unsigned long)s->beat_age_ms);
+    } else {
+      printf("%8s  ", "-");
+    }
+    printf("%s\n", s->reason ? s->reason : "-");
+  }
+}
+
+/**
+ * @brief Console handler for the `sup` command; lists the supervisor counters or restarts one module.
+ */
+static int clicmd_sup(int argc, char** argv) {
+  if (argc < 2) {
+    clicmd_PrintSup();
+    return 0;
+  }
+  if ((strcmp(argv[1], "restart") == 0) && (argc > 2)) {
+    for (int bit = 0; bit < REG_BIT_MAX; ++bit) {
+      if (strcmp(MGR_GetModuleName(1UL << bit), argv[2]) == 0) {
+        esp_err_t result = MGR_Restart(1UL << bit);
+
+        printf("restart %s: %s\n", argv[2], (result == ESP_OK) ? "queued" : "not supervised");
+        return (result == ESP_OK) ? 0 : 1;
+      }
+    }
+    printf("Unknown module: %s\n", argv[2]);
+    return 1;
+  }
+  printf("Usage:\n");
+  printf("  sup\n");
+  printf("  sup restart <module>\n");
+  return 1;
+}
+
+#define CLICMD_CALL_TIMEOUT_MS  (500U)
+
+static void clicmd_PrintCallStats(void) {
+  mgr_call_stats_t stats;
+
+  MGR_GetCallStats(&stats);
+  printf("pending:   %lu\n", (unsigned long)stats.pending);
+  printf("calls:     %lu\n", (unsigned long)stats.calls);
+  printf("replies:   %lu\n", (unsigned long)stats.replies);
+  printf("timeouts:  %lu\n", (unsigned long)stats.timeouts);
+  printf("late:      %lu\n", (unsigned long)stats.late);
+  printf("no slot:   %lu\n", (unsigned long)stats.full);
+  printf("max rtt:   %lu us\n", (unsigned long)stats.rtt_max_us);
+}
+
+static int clicmd_CallSys(uint32_t timeout_ms) {
+  const msg_t request = {
+    .type = MSG_TYPE_SYS_INFO_REQ,
+    .from = REG_CLI_CTRL,
+    .to = REG_SYS_CTRL,
+  };
+  msg_t reply;
+  esp_err_t result = MGR_Call(&request, timeout_ms, &reply);
+
+  if (result != ESP_OK) {
+    printf("call failed: %d\n", result);
+    return 1;
+  }
+  const data_sys_info_t* info = &reply.payload.reply.u.sys;
+
+  printf("call:      %lu (result: %ld)\n", (unsigned long)reply.call, (long)reply.payload.reply.result);
+  printf("uid:       %s\n", info->uid);
+  printf("uptime:    %lu s\n", (unsigned long)info->uptime_s);
+  printf("heap:      %lu B free, %lu B min\n", (unsigned long)info->heap_free, (unsigned long)info->heap_min);
+  printf("time:      %lu (%s)\n", (unsigned long)info->time, info->synced ? "synced" : "not synced");
+  return 0;
+}
+
+/**
+ * @brief Console handler for the `call` command; queries a module with MGR_Call() and waits for its reply.
+ */
+static int clicmd_call(int argc, char** argv) {
+  if (argc < 2) {
+    printf("Usage:\n");
+    printf("  call sys [timeout_ms]\n");
+    printf("  call stats\n");
+    return 1;
+  }
+
+  if (strcmp(argv[1], "sys") == 0) {
+    uint32_t timeout_ms = CLICMD_CALL_TIMEOUT_MS;
+
+    if (argc > 2) {
+      long n = strtol(argv[2], NULL, 10);
+      if (n > 0) {
+        timeout_ms = (uint32_t)n;
+      }
+    }
+    return clicmd_CallSys(timeout_ms);
+  }
+
+  if (strcmp(argv[1], "stats") == 0) {
+    clicmd_PrintCallStats();
+    return 0;
+  }
+
+  printf("Unknown call subcommand: %s\n", argv[1]);
+  return 1;
+}
+
+void CliMgr_RegisterConsoleCmd(void) {
+  const esp_console_cmd_t cmd = {
+    .command = "bus",
+    .help    = "bus pool | bus mem | bus lanes | bus isr | bus drops | bus trace [dump|bin [count]|reset] | bus direct [on|off] | bus exec",
+    .hint    = NULL,
+    .func    = &clicmd_bus,
+  };
+  (void)esp_console_cmd_register(&cmd);
+
+  const esp_console_cmd_t boot_cmd = {
+    .command = "boot",
+    .help    = "Boot timing: milestones, per-module init/run times and critical path",
+    .hint    = NULL,
+    .func    = &clicmd_boot,
+  };
+  (void)esp_console_cmd_register(&boot_cmd);
+
+  const esp_console_cmd_t state_cmd = {
+    .command = "state",
+    .help    = "System-state flags (link, IP, MQTT, time) and addresses",
+    .hint    = NULL,
+    .func    = &clicmd_state,
+  };
+  (void)esp_console_cmd_register(&state_cmd);
+
+  const esp_console_cmd_t sup_cmd = {
+    .command = "sup",
+    .help    = "sup | sup restart <module> - supervisor counters, or restart one module",
+    .hint    = NULL,
+    .func    = &clicmd_sup,
+  };
+  (void)esp_console_cmd_register(&sup_cmd);
+
+  const esp_console_cmd_t call_cmd = {
+    .command = "call",
+    .help    = "call sys [timeout_ms] | call stats - query a module over the bus and wait for its reply",
+    .hint    = NULL,
+    .func    = &clicmd_call,
+  };
+  (void)esp_console_cmd_register(&call_cmd);
+}
+
+#endif /* CONFIG_CLI_CTRL_ENABLE */
@@ -0,0 +1,170 @@
+/**
+ * @file cli_mqtt.c
+ * @brief Console commands for the MQTT module (`mqtt queue`, `mqtt conn`, `mqtt rx`).
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "esp_console.h"
+
+#include "cli_mqtt.h"
+#include "data_types.h"
+#include "mgr_ctrl.h"
+#include "msg.h"
+
+/**
+ * @brief mgr_reg_data_cb_f: copy the `DATA_TYPE_MQTT_STORE_STATS` record out of the callback.
+ */
+static esp_err_t clicmd_StoreStatsCb(const data_t *payload, void *cb_ctx)
+{
+  if ((payload->type != DATA_TYPE_MQTT_STORE_STATS) || (payload->size != sizeof(data_mqtt_store_stats_t))) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  memcpy(cb_ctx, payload->data, sizeof(data_mqtt_store_stats_t));
+  return ESP_OK;
+}
+
+/**
+ * @brief mgr_reg_data_cb_f: copy the `DATA_TYPE_MQTT_CONN_STATS` record out of the callback.
+ */
+static esp_err_t clicmd_ConnStatsCb(const data_t *payload, void *cb_ctx)
+{
+  if ((payload->type != DATA_TYPE_MQTT_CONN_STATS) || (payload->size != sizeof(data_mqtt_conn_stats_t))) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  memcpy(cb_ctx, payload->data, sizeof(data_mqtt_conn_stats_t));
+  return ESP_OK;
+}
+
+/**
+ * @brief mgr_reg_data_cb_f: copy the `DATA_TYPE_MQTT_RX_STATS` record out of the callback.
+ */
+static esp_err_t clicmd_RxStatsCb(const data_t *payload, void *cb_ctx)
+{
+  if ((payload->type != DATA_TYPE_MQTT_RX_STATS) || (payload->size != sizeof(data_mqtt_rx_stats_t))) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  memcpy(cb_ctx, payload->data, sizeof(data_mqtt_rx_stats_t));
+  return ESP_OK;
+}
+
+/**
+ * @brief Print the outbound store-and-forward queue of mqtt_ctrl.
+ */
+static int clicmd_MqttQueue(void)
+{
+  data_mqtt_store_stats_t stats;
+  esp_err_t err = MGR_GetData(REG_MQTT_CTRL, DATA_TYPE_MQTT_STORE_STATS, clicmd_StoreStatsCb, &stats);
+
+  if (err != ESP_OK) {
+    printf("MGR_GetData(mqtt) failed: %d\n", err);
+    return 1;
+  }
+  printf("state: %s%s\n", stats.online ? "online" : "offline", stats.replaying ? ", replaying" : "");
+  printf("depth: %lu records, %lu bytes, in flight: %lu\n",
+         (unsigned long)stats.depth, (unsigned long)stats.bytes, (unsigned long)stats.inflight);
+  printf("ram:   %lu records, %lu / %lu B\n",
+         (unsigned long)stats.ram_depth, (unsigned long)stats.ram_used, (unsigned long)stats.ram_size);
+  if (stats.flash_size != 0) {
+    printf("flash: %lu records, %lu / %lu B\n",
+           (unsigned long)stats.flash_depth, (unsigned long)stats.flash_used, (unsigned long)stats.flash_size);
+  } else {
+    printf("flash: none (RAM only)\n");
+  }
+  printf("queued: %lu, spilled: %lu, replaced: %lu, dropped: %lu, published: %lu, acked: %lu, ack lost: %lu\n",
+         (unsigned long)stats.queued, (unsigned long)stats.spilled, (unsigned long)stats.replaced,
+         (unsigned long)stats.dropped, (unsigned long)stats.published, (unsigned long)stats.acked,
+         (unsigned long)stats.ack_lost);
+  if (stats.replay_ms != 0) {
+    printf("last replay: %lu records in %lu ms\n", (unsigned long)stats.replay_cnt, (unsigned long)stats.replay_ms);
+  } else if (stats.replaying) {
+    printf("replay: %lu records sent so far\n", (unsigned long)stats.replay_cnt);
+  }
+  return 0;
+}
+
+/**
+ * @brief Print the reconnect engine of mqtt_ctrl: state, back-off and time to reconnect.
+ */
+static int clicmd_MqttConn(void)
+{
+  static const char *const state_name[] = { "stopped", "connecting", "connected", "backoff" };
+  data_mqtt_conn_stats_t stats;
+  esp_err_t err = MGR_GetData(REG_MQTT_CTRL, DATA_TYPE_MQTT_CONN_STATS, clicmd_ConnStatsCb, &stats);
+
+  if (err != ESP_OK) {
+    printf("MGR_GetData(mqtt) failed: %d\n", err);
+    return 1;
+  }
+  printf("state: %s, failed attempts: %lu\n",
+         (stats.state < (sizeof(state_name) / sizeof(state_name[0]))) ? state_name[stats.state] : "?",
+         (unsigned long)stats.attempts);
+  if (stats.state == DATA_MQTT_CONN_BACKOFF) {
+    printf("backoff: %lu ms, next attempt in %lu ms\n",
+           (unsigned long)stats.backoff_ms, (unsigned long)stats.retry_in_ms);
+  }
+  printf("connects: %lu (resumed: %lu), disconnects: %lu, failures: %lu\n",
+         (unsigned long)stats.connects, (unsigned long)stats.resumed,
+         (unsigned long)stats.disconnects, (unsigned long)stats.failures);
+  printf("time to reconnect: last %lu ms, avg %lu ms, max %lu ms\n",
+         (unsigned long)stats.ttr_last_ms, (unsigned long)stats.ttr_avg_ms, (unsigned long)stats.ttr_max_ms);
+  if (stats.session_expiry_s != 0) {
+    printf("session expiry: %lu s\n", (unsigned long)stats.session_expiry_s);
+  } else {
+    printf("session expiry: none (clean start)\n");
+  }
+  return 0;
+}
+
+/**
+ * @brief Print the inbound reassembly of mqtt_ctrl: messages taken and dropped.
+ */
+static int clicmd_MqttRx(void)
+{
+  data_mqtt_rx_stats_t stats;
+  esp_err_t err = MGR_GetData(REG_MQTT_CTRL, DATA_TYPE_MQTT_RX_STATS, clicmd_RxStatsCb, &stats);
+
+  if (err != ESP_OK) {
+    printf("MGR_GetData(mqtt) failed: %d\n", err);
+    return 1;
+  }
+  printf("max size: %lu B (topic + message), largest: %lu B\n",
+         (unsigned long)stats.max_size, (unsigned long)stats.largest);
+  printf("received: %lu (chunked: %lu)\n", (unsigned long)stats.received, (unsigned long)stats.chunked);
+  printf("dropped: too big: %lu, no buffer: %lu, broken: %lu\n",
+         (unsigned long)stats.too_big, (unsigned long)stats.no_buffer, (unsigned long)stats.broken);
+  return 0;
+}
+
+/**
+ * @brief Console handler for the `mqtt` command.
+ */
+static int clicmd_mqtt(int argc, char **argv)
+{
+  if ((argc >= 2) && (strcmp(argv[1], "queue") == 0)) {
+    return clicmd_MqttQueue();
+  }
+  if ((argc >= 2) && (strcmp(argv[1], "conn") == 0)) {
+    return clicmd_MqttConn();
+  }
+  if ((argc >= 2) && (strcmp(argv[1], "rx") == 0)) {
+    return clicmd_MqttRx();
+  }
+  printf("Usage: mqtt queue|conn|rx\n");
+  return 1;
+}
+
+void CliMqtt_RegisterConsoleCmd(void)
+{
+  const esp_console_cmd_t cmd = {
+    .command = "mqtt",
+    .help    = "mqtt queue | mqtt conn | mqtt rx - outbound queue (depth, flash spill, replay), reconnect (back-off, time to reconnect, session), inbound reassembly",
+    .hint    = NULL,
+    .func    = &clicmd_mqtt,
+  };
+  (void)esp_console_cmd_register(&cmd);
+}
@@ -1,6 +1,6 @@
 /**
  * @file cli_wifi.c
- * @brief Console commands for the Wi-Fi module (`wifi scan|connect|disconnect`).
+ * @brief Console commands for the Wi-Fi module (`wifi scan|list|connect|disconnect`).
  *
  * @copyright Copyright (c) 2025 4Embedded.Systems
  */
@@ -13,16 +13,48 @@
 #include "esp_console.h"
 
 #include "cli_wifi.h"
+#include "data_snap.h"
+#include "data_types.h"
 #include "mgr_ctrl.h"
 #include "msg.h"
 
+static const char *clicmd_SecurityName(wifi_ui_security_e security)
+{
+  static const char *names[] = { "open", "wep", "wpa", "wpa2", "wpa3", "other" };
+
+  return ((unsigned)security < (sizeof(names) / sizeof(names[0]))) ? names[security] : "?";
+}
+
+/**
+ * @brief Print the last scan from the `DATA_TYPE_WIFI_SCAN_LIST` snapshot, without copying it.
+ */
+static int clicmd_WifiList(void)
+{
+  const data_snap_t *snap = NULL;
+
+  if (datasnap_Acquire(REG_WIFI_CTRL, DATA_TYPE_WIFI_SCAN_LIST, &snap) != ESP_OK) {
+    printf("No scan yet, run 'wifi scan' first\n");
+    return 1;
+  }
+
+  const wifi_ui_ap_row_t *rows = (const wifi_ui_ap_row_t *)snap->data.data;
+  printf("scan version: %lu, networks: %lu\n", (unsigned long)snap->version, (unsigned long)snap->data.count);
+  printf("  #  rssi  ch  security  ssid\n");
+  for (uint32_t i = 0; i < snap->data.count; ++i) {
+    printf("%3lu  %4d  %2u  %-8s  %s\n", (unsigned long)i, rows[i].rssi, (unsigned)rows[i].channel,
+           clicmd_SecurityName(rows[i].security), rows[i].ssid);
+  }
+  datasnap_Release(snap);
+  return 0;
+}
+
 /**
  * @brief Console handler for the `wifi` command (scan, connect, disconnect).
  */
 static int clicmd_wifi(int argc, char **argv)
 {
   if (argc < 2) {
-    printf("Usage: wifi scan | wifi connect <ssid> <password> [authmode] | wifi disconnect\n");
+    printf("Usage: wifi scan | wifi list | wifi connect <ssid> <password> [authmode] | wifi disconnect\n");
     return 1;
   }
 
@@ -36,10 +68,14 @@ static int clicmd_wifi(int argc, char **argv)
       printf("MGR_Send(scan) failed\n");
       return 1;
     }
-    printf("Scan requested (see ESP::WIFI logs for SSID/RSSI)\n");
+    printf("Scan requested (see ESP::WIFI logs for SSID/RSSI, or 'wifi list')\n");
     return 0;
   }
 
+  if (strcmp(argv[1], "list") == 0) {
+    return clicmd_WifiList();
+  }
+
   if (strcmp(argv[1], "disconnect") == 0) {
     msg_t msg = {
       .type = MSG_TYPE_WIFI_DISCONNECT,
@@ -98,7 +134,7 @@ void CliWifi_RegisterConsoleCmd(void)
 {
   const esp_console_cmd_t cmd = {
     .command = "wifi",
-    .help    = "wifi scan | wifi connect <ssid> <pass> [authmode] | wifi disconnect",
+    .help    = "wifi scan | wifi list | wifi connect <ssid> <pass> [authmode] | wifi disconnect",
     .hint    = NULL,
     .func    = &clicmd_wifi,
   };
@@ -0,0 +1,18 @@
+/**
+ * @file cli_mgr.h
+ * @brief Manager / message bus console commands for the ESP-IDF REPL.
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ */
+
+#ifndef __CLI_MGR_H__
+#define __CLI_MGR_H__
+
+/**
+ * @brief Register the `bus` console command (message bus diagnostics).
+ *
+ * Call after `esp_console_new_repl_*`. Built when `CONFIG_CLI_CTRL_ENABLE` is set.
+ */
+void CliMgr_RegisterConsoleCmd(void);
+
+#endif /* __CLI_MGR_H__ */
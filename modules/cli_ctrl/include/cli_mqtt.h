@@ -0,0 +1,19 @@
+/**
+ * @file cli_mqtt.h
+ * @brief MQTT CLI commands registration for the console REPL.
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ */
+
+#ifndef __CLI_MQTT_H__
+#define __CLI_MQTT_H__
+
+/**
+ * @brief Register MQTT console commands (`mqtt` …) with esp_console.
+ *
+ * Call after `esp_console_new_repl_*` (or equivalent) has initialized the console.
+ * Built only when `CONFIG_MQTT_CTRL_ENABLE` is set (`cli_mqtt.c` is omitted otherwise).
+ */
+void CliMqtt_RegisterConsoleCmd(void);
+
+#endif /* __CLI_MQTT_H__ */
@@ -24,7 +24,9 @@
 
 #include "sdkconfig.h"
 
+#include "boot_seq.h"
 #include "msg.h"
+#include "sys_state.h"
 #include "eth_ctrl.h"
 #include "mgr_ctrl.h"
 
@@ -113,7 +115,9 @@ static void ethctrl_EthEventHandler(void *arg, esp_event_base_t event_base,
   ESP_LOGI(TAG, "++%s(event_id: %ld [%s], event_data: %p)", __func__, event_id, GET_ETHERNET_EVENT_NAME(event_id), event_data);
   switch (event_id) {
     case ETHERNET_EVENT_CONNECTED: {
-      
+      bootseq_Mark(BOOTSEQ_MARK_LINK);
+      (void) sysstate_Set(SYSSTATE_ETH_LINK);
+
       /* Here, we have to send 2 times  */
       /* - 1st time - event_id          */
       /* - 2nd time - MAC address       */
@@ -141,6 +145,8 @@ static void ethctrl_EthEventHandler(void *arg, esp_event_base_t event_base,
     case ETHERNET_EVENT_DISCONNECTED: {
       ESP_LOGD(TAG, "Ethernet Link Down");
       msg.payload.eth.u.event_id = DATA_ETH_EVENT_DISCONNECTED;
+      /* Broadcast the transition only, not a repeated link down */
+      send = sysstate_Clear(SYSSTATE_ETH_LINK);
       break;
     }
     case ETHERNET_EVENT_START: {
@@ -177,6 +183,7 @@ static void ethctrl_IpEventHandler(void *arg, esp_event_base_t event_base,
     .to = REG_MGR_CTRL | REG_LCD_CTRL,
   };
 
+  bootseq_Mark(BOOTSEQ_MARK_IP);
   ESP_LOGI(TAG, "Ethernet Got IP Address");
   ESP_LOGI(TAG, "~~~~~~~~~~~");
   ESP_LOGI(TAG, "ETH IP: " IPSTR, IP2STR(&ip_info->ip));
@@ -188,6 +195,7 @@ static void ethctrl_IpEventHandler(void *arg, esp_event_base_t event_base,
   msg.payload.eth.u.info.mask = ip_info->netmask.addr;
   msg.payload.eth.u.info.gw   = ip_info->gw.addr;
 
+  (void) sysstate_SetIp(SYSSTATE_NETIF_ETH, ip_info->ip.addr);
   esp_err_t result = MGR_Send(&msg);
   ESP_LOGI(TAG, "MSG_Send() - result: %d", result);
 }
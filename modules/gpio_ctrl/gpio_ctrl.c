@@ -18,13 +18,14 @@
 #include "sdkconfig.h"
 
 #include "msg.h"
+#include "executor.h"
+#include "msg_pool.h"
 #include "gpio_ctrl.h"
 
 #include "err.h"
 #include "lut.h"
 
 
-#define GPIO_TASK_NAME            "gpio-task"
 #define GPIO_TASK_STACK_SIZE      4096
 #define GPIO_TASK_PRIORITY        12
 
@@ -34,9 +35,7 @@
 static const char* TAG = "ESP::GPIO";
 
 
-static QueueHandle_t      gpio_msg_queue = NULL;
-static TaskHandle_t       gpio_task_id = NULL;
-static SemaphoreHandle_t  gpio_sem_id = NULL;
+static executor_unit_t*   gpio_unit = NULL;
 
 
 static esp_err_t gpioctrl_ParseMsg(const msg_t* msg) {
@@ -68,50 +67,11 @@ static esp_err_t gpioctrl_ParseMsg(const msg_t* msg) {
   return result;
 }
 
-/**
- * @brief CLI task's function
- * 
- * @param param 
- */
-static void gpioctrl_TaskFn(void* param) {
-  msg_t msg;
-  bool loop = true;
-  esp_err_t result;
-
-  ESP_LOGI(TAG, "++%s()", __func__);
-  memset(&msg, 0x00, sizeof(msg_t));
-  while (loop) {
-    ESP_LOGD(TAG, "[%s] Wait...", __func__);
-    if(xQueueReceive(gpio_msg_queue, &msg, portMAX_DELAY) == pdTRUE) {
-      ESP_LOGD(TAG, "[%s] Message arrived: type: %d [%s], from: 0x%08lx, to: 0x%08lx", __func__, 
-          msg.type, GET_MSG_TYPE_NAME(msg.type),
-          msg.from, msg.to);
-      
-      result = gpioctrl_ParseMsg(&msg);
-      if (result == ESP_TASK_DONE) {
-        loop = false;
-        result = ESP_OK;
-      }
-
-      if (result != ESP_OK) {
-        // TODO - Send Error to the Broker
-        ESP_LOGE(TAG, "[%s] Error: %d", __func__, result);
-      }
-    } else {
-      ESP_LOGE(TAG, "[%s] Message error.", __func__);
-    }
-  }
-  if (gpio_sem_id) {
-    xSemaphoreGive(gpio_sem_id);
-  }
-  ESP_LOGI(TAG, "--%s()", __func__);
-}
-
 static esp_err_t gpioctrl_Send(const msg_t* msg) {
   esp_err_t result = ESP_OK;
 
   ESP_LOGI(TAG, "++%s()", __func__);
-  if (xQueueSend(gpio_msg_queue, msg, (TickType_t) 0) != pdPASS) {
+  if (executor_Post(gpio_unit, msg, (TickType_t) 0) != ESP_OK) {
     ESP_LOGE(TAG, "[%s] Message error. type: %d, from: 0x%08lx, to: 0x%08lx", __func__, msg->type, msg->from, msg->to);
     result = ESP_FAIL;
   }
@@ -124,26 +84,17 @@ static esp_err_t gpioctrl_Init(void) {
 
   ESP_LOGI(TAG, "++%s()", __func__);
 
-  /* Initialization message queue */
-  gpio_msg_queue = xQueueCreate(GPIO_MSG_MAX, sizeof(msg_t));
-  if (gpio_msg_queue == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xQueueCreate() failed.", __func__);
-    return ESP_FAIL;
-  }
-
-  gpio_sem_id = xSemaphoreCreateCounting(1, 0);
-  if (gpio_sem_id == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xSemaphoreCreateCounting() failed.", __func__);
-    return ESP_FAIL;
-  }
-
-  /* Initialization thread */
-  xTaskCreate(gpioctrl_TaskFn, GPIO_TASK_NAME, GPIO_TASK_STACK_SIZE, NULL, GPIO_TASK_PRIORITY, &gpio_task_id);
-  if (gpio_task_id == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xTaskCreate() failed.", __func__);
+  executor_cfg_t cfg = {
+    .name     = "gpio",
+    .module   = REG_GPIO_CTRL,
+    .depth    = GPIO_MSG_MAX,
+    .handler  = gpioctrl_ParseMsg,
+    .stack    = GPIO_TASK_STACK_SIZE,
+    .priority = GPIO_TASK_PRIORITY,
+  };
+  gpio_unit = executor_Create(&cfg);
+  if (gpio_unit == NULL) {
+    ESP_LOGE(TAG, "[%s] executor_Create() failed.", __func__);
     return ESP_FAIL;
   }
 
@@ -155,25 +106,17 @@ static esp_err_t gpioctrl_Done(void) {
   esp_err_t result = ESP_OK;
 
   ESP_LOGI(TAG, "++%s()", __func__);
-  if (gpio_sem_id) {
+  if (gpio_unit) {
     msg_t msg = {
       .type = MSG_TYPE_DONE,
       .from = REG_GPIO_CTRL,
       .to = REG_GPIO_CTRL,
     };
-    result = gpioctrl_Send(&msg);
-
-    ESP_LOGD(TAG, "[%s] Wait on xSemaphoreTake to finish task...", __func__);
-    xSemaphoreTake(gpio_sem_id, portMAX_DELAY);
-
-    vSemaphoreDelete(gpio_sem_id);
-    ESP_LOGD(TAG, "[%s] Semaphore deleted", __func__);
-
-    ESP_LOGD(TAG, "[%s] Task stopped", __func__);
-  }
-  if (gpio_msg_queue) {
-    vQueueDelete(gpio_msg_queue);
-    ESP_LOGD(TAG, "[%s] Queue deleted", __func__);
+    result = executor_Delete(gpio_unit, &msg);
+    if (result == ESP_OK) {
+      gpio_unit = NULL;
+      ESP_LOGD(TAG, "[%s] Unit deleted", __func__);
+    }
   }
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
   return result;
@@ -21,6 +21,8 @@
 
 #include "err.h"
 #include "msg.h"
+#include "executor.h"
+#include "msg_pool.h"
 #include "lcd_ctrl.h"
 
 #include "lcd_hw.h"
@@ -34,7 +36,6 @@
 #endif
 
 
-#define LCD_TASK_NAME             "lcd-task"
 #define LCD_TASK_STACK_SIZE       4096
 #define LCD_TASK_PRIORITY         10
 
@@ -210,9 +211,7 @@ static void lcdctrl_ApplyRelayData(const char* json_str) {
            __func__, have_heater, heater_on, have_pump, pump_on);
 }
 
-static QueueHandle_t      lcd_msg_queue = NULL;
-static TaskHandle_t       lcd_task_id = NULL;
-static SemaphoreHandle_t  lcd_sem_id = NULL;
+static executor_unit_t*   lcd_unit = NULL;
 
 
 /**
@@ -295,6 +294,15 @@ static esp_err_t lcdctrl_ParseMsg(const msg_t* msg) {
     }
 
     case MSG_TYPE_MQTT_DATA: {
+      const data_mqtt_in_t* data_ptr = &(msg->payload.mqtt.u.in);
+
+      if ((msg->from & REG_RELAY_CTRL) || (strstr(data_ptr->topic, "relay") != NULL)) {
+        lcdctrl_ApplyRelayData(data_ptr->msg);
+      }
+      break;
+    }
+
+    case MSG_TYPE_MQTT_DATA_LOCAL: {
       const data_mqtt_data_t* data_ptr = &(msg->payload.mqtt.u.data);
 
       if ((msg->from & REG_RELAY_CTRL) || (strstr(data_ptr->topic, "relay") != NULL)) {
@@ -319,61 +327,15 @@ static esp_err_t lcdctrl_ParseMsg(const msg_t* msg) {
   return result;
 }
 
-/**
- * @brief LCD controller FreeRTOS task: dequeue messages and dispatch via lcdctrl_ParseMsg().
- *
- * @param param Unused (task parameter).
- */
-static void lcdctrl_TaskFn(void* param) {
-  msg_t msg;
-
-  bool loop = true;
-  esp_err_t result;
-
-  ESP_LOGI(TAG, "++%s()", __func__);
-  memset(&msg, 0x00, sizeof(msg_t));
-  while (loop) {
-    ESP_LOGD(TAG, "[%s] Wait...", __func__);
-    if(xQueueReceive(lcd_msg_queue, &msg, portMAX_DELAY) == pdTRUE) {
-      ESP_LOGD(TAG, "[%s] Message arrived: type: %d [%s], from: 0x%08lx, to: 0x%08lx", __func__, 
-          msg.type, GET_MSG_TYPE_NAME(msg.type),
-          msg.from, msg.to);
-      
-      result = lcdctrl_ParseMsg(&msg);
-      if (result == ESP_TASK_DONE) {
-        loop = false;
-        result = ESP_OK;
-      }
-
-      if (result != ESP_OK) {
-        // TODO - Send Error to the Broker
-        ESP_LOGE(TAG, "[%s] Error: %d", __func__, result);
-      }
-    } else {
-      ESP_LOGE(TAG, "[%s] Message error.", __func__);
-    }
-  }
-  if (lcd_sem_id) {
-    xSemaphoreGive(lcd_sem_id);
-  }
-  ESP_LOGI(TAG, "--%s()", __func__);
-}
-
-/**
- * @brief Sends message to LCD controller internal queue.
- *
- * @param msg Pointer to message to enqueue.
- * @return esp_err_t ESP_OK on success, error code otherwise.
- */
 static esp_err_t lcdctrl_Send(const msg_t* msg) {
   esp_err_t result = ESP_OK;
 
   ESP_LOGI(TAG, "++%s()", __func__);
-  if (lcd_msg_queue == NULL) {
+  if (lcd_unit == NULL) {
     ESP_LOGW(TAG, "[%s] skipped (LCD controller not initialized)", __func__);
     return ESP_ERR_INVALID_STATE;
   }
-  if (xQueueSend(lcd_msg_queue, msg, (TickType_t) 0) != pdPASS) {
+  if (executor_Post(lcd_unit, msg, (TickType_t) 0) != ESP_OK) {
     ESP_LOGE(TAG, "[%s] Message error. type: %d, from: 0x%08lx, to: 0x%08lx", __func__, msg->type, msg->from, msg->to);
     result = ESP_FAIL;
   }
@@ -397,26 +359,17 @@ static esp_err_t lcdctrl_Init(void) {
     return result;
   }
 
-  /* Initialization message queue */
-  lcd_msg_queue = xQueueCreate(LCD_MSG_MAX, sizeof(msg_t));
-  if (lcd_msg_queue == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xQueueCreate() failed.", __func__);
-    return ESP_FAIL;
-  }
-
-  lcd_sem_id = xSemaphoreCreateCounting(1, 0);
-  if (lcd_sem_id == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xSemaphoreCreateCounting() failed.", __func__);
-    return ESP_FAIL;
-  }
-
-  /* Initialization thread */
-  xTaskCreate(lcdctrl_TaskFn, LCD_TASK_NAME, LCD_TASK_STACK_SIZE, NULL, LCD_TASK_PRIORITY, &lcd_task_id);
-  if (lcd_task_id == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xTaskCreate() failed.", __func__);
+  executor_cfg_t cfg = {
+    .name     = "lcd",
+    .module   = REG_LCD_CTRL,
+    .depth    = LCD_MSG_MAX,
+    .handler  = lcdctrl_ParseMsg,
+    .stack    = LCD_TASK_STACK_SIZE,
+    .priority = LCD_TASK_PRIORITY,
+  };
+  lcd_unit = executor_Create(&cfg);
+  if (lcd_unit == NULL) {
+    ESP_LOGE(TAG, "[%s] executor_Create() failed.", __func__);
     return ESP_FAIL;
   }
 
@@ -433,25 +386,21 @@ static esp_err_t lcdctrl_Done(void) {
   esp_err_t result = ESP_OK;
 
   ESP_LOGI(TAG, "++%s()", __func__);
-  if (lcd_sem_id) {
+  if (lcd_unit) {
     msg_t msg = {
       .type = MSG_TYPE_DONE,
       .from = REG_LCD_CTRL,
       .to = REG_LCD_CTRL,
     };
-    result = lcdctrl_Send(&msg);
-
-    ESP_LOGD(TAG, "[%s] Wait on xSemaphoreTake to finish task...", __func__);
-    xSemaphoreTake(lcd_sem_id, portMAX_DELAY);
-
-    vSemaphoreDelete(lcd_sem_id);
-    ESP_LOGD(TAG, "[%s] Semaphore deleted", __func__);
-
-    ESP_LOGD(TAG, "[%s] Task stopped", __func__);
-  }
-  if (lcd_msg_queue) {
-    vQueueDelete(lcd_msg_queue);
-    ESP_LOGD(TAG, "[%s] Queue deleted", __func__);
+    result = executor_Delete(lcd_unit, &msg);
+    if (result != ESP_OK) {
+      /* The handler may still draw, keep LVGL and the unit for another try */
+      ESP_LOGE(TAG, "[%s] executor_Delete() result: %d.", __func__, result);
+      ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
+      return result;
+    }
+    lcd_unit = NULL;
+    ESP_LOGD(TAG, "[%s] Unit deleted", __func__);
   }
 
   result = lcd_DoneHelper();
@@ -261,7 +261,7 @@ static void lcd_mqtt_icon_event(lv_event_t* e) {
 
 static void lcd_send_relay_set(uint8_t relay_number, bool on) {
   msg_t msg = {
-    .type = MSG_TYPE_MQTT_DATA,
+    .type = MSG_TYPE_MQTT_DATA_LOCAL,
     .from = REG_LCD_CTRL,
     .to = REG_RELAY_CTRL,
   };
@@ -0,0 +1,73 @@
+/**
+ * @file mqtt_conn.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Reconnect engine of the MQTT controller
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * The client runs with its own auto-reconnect disabled; this engine decides when
+ * to try again. After a lost connection or a failed attempt the next one waits
+ * a delay drawn from [cap / 2, cap], where cap doubles from
+ * CONFIG_MQTT_CTRL_RECONNECT_MIN_MS per failed attempt up to
+ * CONFIG_MQTT_CTRL_RECONNECT_MAX_MS. The random half keeps a fleet which lost
+ * the same broker from coming back in lockstep.
+ *
+ * It also measures the time to reconnect: from the moment the connection is
+ * lost (or stopped) to the next CONNECTED.
+ *
+ * All calls except mqttconn_GetStats() belong to the MQTT task.
+ */
+
+#ifndef __MQTT_CONN_H__
+#define __MQTT_CONN_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "data_mqtt.h"
+
+
+/**
+ * @brief Start an attempt: start the client, or make a started one reconnect.
+ *
+ * @return ESP_OK when the attempt is under way, its outcome comes as
+ *         mqttconn_Connected() / mqttconn_Disconnected().
+ */
+typedef esp_err_t (*mqttconn_connect_f)(void);
+
+esp_err_t mqttconn_Init(mqttconn_connect_f connect_fn);
+void      mqttconn_Done(void);
+
+/**
+ * @brief A connection is wanted (link up): try now, unless connected or trying.
+ */
+void      mqttconn_Start(void);
+
+/**
+ * @brief The client was stopped on purpose (link down): no attempts until mqttconn_Start().
+ */
+void      mqttconn_Stop(void);
+
+/**
+ * @brief Outcome of an attempt, or a connection lost, as reported by the client.
+ */
+void      mqttconn_Connected(bool session_present);
+void      mqttconn_Disconnected(void);
+
+/**
+ * @brief Run a pending attempt when its time has come.
+ *
+ * @return Time in ms after which the MQTT task should call it again, 0 when it
+ *         has nothing to wait for.
+ */
+uint32_t  mqttconn_Pump(void);
+
+void      mqttconn_GetStats(data_mqtt_conn_stats_t* stats);
+
+
+#endif /* __MQTT_CONN_H__ */
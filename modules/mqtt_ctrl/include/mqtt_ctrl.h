@@ -17,9 +17,12 @@
 
 #include "esp_err.h"
 
+#include "mgr_reg.h"
+
 esp_err_t MqttCtrl_Init(void);
 esp_err_t MqttCtrl_Done(void);
 esp_err_t MqttCtrl_Run(void);
 esp_err_t MqttCtrl_Send(const msg_t* msg);
+esp_err_t MqttCtrl_GetData(data_type_e data_type, mgr_reg_data_cb_f cb, void* cb_ctx);
 
 #endif /* __MQTT_CTRL_H__ */
\ No newline at end of file
@@ -0,0 +1,58 @@
+/**
+ * @file mqtt_rx.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Reassembly of inbound MQTT data into bus buffers
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * The client delivers a message larger than its input buffer as several
+ * MQTT_EVENT_DATA: the first one with the topic and `current_data_offset` 0,
+ * the next ones without a topic, in order, until `total_data_len` bytes have
+ * come. Each message is written straight into one buffer of msg_buf.h, so the
+ * consumer gets it by reference and only once complete. A message which does
+ * not fit CONFIG_MGR_MSG_BUF_SIZE, finds no free buffer or loses a chunk is
+ * dropped as a whole and counted.
+ *
+ * All calls except mqttrx_GetStats() belong to the client task (event handler).
+ */
+
+#ifndef __MQTT_RX_H__
+#define __MQTT_RX_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "msg.h"
+#include "data_mqtt.h"
+
+
+esp_err_t mqttrx_Init(void);
+void      mqttrx_Done(void);
+
+/**
+ * @brief Take one MQTT_EVENT_DATA.
+ *
+ * @param topic     Topic of the first chunk (not terminated), ignored on the next ones.
+ * @param offset    `current_data_offset` of the event.
+ * @param total     `total_data_len` of the event.
+ * @param[out] data The message once complete; its buffer belongs to the caller then.
+ * @return ESP_OK when @p data is complete, ESP_ERR_NOT_FINISHED while chunks are
+ *         missing, any other error when the message was dropped.
+ */
+esp_err_t mqttrx_Chunk(const char* topic, size_t topic_len, const char* chunk, size_t chunk_len,
+                       size_t offset, size_t total, data_mqtt_in_t* data);
+
+/**
+ * @brief The connection is gone: a message in progress never completes.
+ */
+void      mqttrx_Reset(void);
+
+void      mqttrx_GetStats(data_mqtt_rx_stats_t* stats);
+
+
+#endif /* __MQTT_RX_H__ */
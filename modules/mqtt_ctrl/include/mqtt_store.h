@@ -0,0 +1,79 @@
+/**
+ * @file mqtt_store.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Outbound store-and-forward queue of the MQTT controller
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Every publish of mqtt_ctrl goes through this queue. Records wait in a RAM
+ * ring; once it is full, new records go to a flash partition until the flash
+ * backlog is sent, so the order stays the order of mqttstore_Push().
+ *
+ * While connected, up to CONFIG_MQTT_CTRL_STORE_INFLIGHT records are handed to
+ * the client (QoS 1). A record leaves the queue on its PUBACK only; after a
+ * disconnect the unacknowledged ones are sent again (at least once). A backlog
+ * found at connection time is replayed at CONFIG_MQTT_CTRL_STORE_REPLAY_RATE.
+ *
+ * Topics matching a keep-latest rule (mqtt_store.c) keep only their newest
+ * record in RAM; older ones not yet sent are dropped when a new one arrives.
+ *
+ * All calls except mqttstore_Ack() and mqttstore_GetStats() belong to the MQTT
+ * task. mqttstore_Ack() is for the client event handler.
+ */
+
+#ifndef __MQTT_STORE_H__
+#define __MQTT_STORE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "data_mqtt.h"
+
+
+/**
+ * @brief Hand one record to the client.
+ *
+ * @return Message id of the QoS 1 publish, negative when the client refused it.
+ */
+typedef int (*mqttstore_publish_f)(const char* topic, const char* data, size_t len);
+
+esp_err_t mqttstore_Init(mqttstore_publish_f publish_fn);
+void      mqttstore_Done(void);
+
+/**
+ * @brief Queue @p data for @p topic; the next mqttstore_Pump() sends it.
+ *
+ * @return ESP_ERR_INVALID_SIZE when the record is larger than a bus message,
+ *         ESP_ERR_NO_MEM when it was dropped because the store is full.
+ */
+esp_err_t mqttstore_Push(const char* topic, const char* data);
+
+/**
+ * @brief Broker connection state (MQTT task). Going online starts a replay of
+ *        the backlog, going offline returns the records in flight to the queue.
+ */
+void      mqttstore_SetOnline(bool online);
+
+/**
+ * @brief PUBACK of @p msg_id (client event handler, MQTT_EVENT_PUBLISHED).
+ */
+void      mqttstore_Ack(int msg_id);
+
+/**
+ * @brief Send what the in-flight window and the replay rate allow.
+ *
+ * @return Time in ms after which the MQTT task should call it again, 0 when it
+ *         has nothing to wait for.
+ */
+uint32_t  mqttstore_Pump(void);
+
+void      mqttstore_GetStats(data_mqtt_store_stats_t* stats);
+
+
+#endif /* __MQTT_STORE_H__ */
@@ -0,0 +1,64 @@
+/**
+ * @file mqtt_topic.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Outbound topics of the MQTT controller: interned topics, aliases, properties
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * The per-device topics published most often ("{uid}/event/sensor",
+ * "{uid}/res/relay", ...) are built once, when the UID arrives. Each gets an
+ * MQTT v5 topic alias, up to CONFIG_MQTT_CTRL_TOPIC_ALIAS_MAX: the first
+ * publish of a connection carries the topic and the alias, the next ones the
+ * alias alone, which saves the topic string on the wire.
+ *
+ * Aliases only live as long as a connection; mqtttopic_Reset() forgets them.
+ *
+ * All calls belong to the MQTT task.
+ */
+
+#ifndef __MQTT_TOPIC_H__
+#define __MQTT_TOPIC_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+
+/** How to publish one record. */
+typedef struct {
+  const char* topic;      /* topic to hand to the client, "" when the broker knows the alias */
+  uint16_t    alias;      /* MQTT v5 topic alias, 0 = none */
+  uint32_t    expiry_s;   /* message expiry interval, 0 = never */
+} mqtttopic_pub_t;
+
+/**
+ * @brief Intern the topics of @p uid and number their aliases (MSG_TYPE_MGR_UID).
+ */
+esp_err_t mqtttopic_Init(const char* uid);
+
+/**
+ * @brief A new connection: the broker knows no alias, aliases allowed again.
+ */
+void      mqtttopic_Reset(void);
+
+/**
+ * @brief Look @p topic up and fill @p pub; the topic itself when it is not interned.
+ */
+void      mqtttopic_Prepare(const char* topic, mqtttopic_pub_t* pub);
+
+/**
+ * @brief The client took the publish of @p pub: its alias is known from now on.
+ */
+void      mqtttopic_Sent(const mqtttopic_pub_t* pub);
+
+/**
+ * @brief The broker takes no aliases (client refused one): none until mqtttopic_Reset().
+ */
+void      mqtttopic_DisableAliases(void);
+
+
+#endif /* __MQTT_TOPIC_H__ */
@@ -0,0 +1,238 @@
+/**
+ * @file mqtt_conn.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Reconnect engine of the MQTT controller
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * STOPPED ──Start──► BACKOFF (retry now) ──Pump──► CONNECTING ──Connected──► CONNECTED
+ *                       ▲                              │                        │
+ *                       └────── Disconnected / timeout ┘◄───── Disconnected ────┘
+ *
+ * Stop() leads back to STOPPED from every state.
+ */
+#include <string.h>
+
+#include "sdkconfig.h"
+
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+
+#include "sys_state.h"
+#include "mqtt_conn.h"
+
+
+#define MQTTCONN_MIN_MS           (CONFIG_MQTT_CTRL_RECONNECT_MIN_MS)
+#define MQTTCONN_MAX_MS           (CONFIG_MQTT_CTRL_RECONNECT_MAX_MS)
+
+/* An attempt the client never reported on (its message lost on a full queue) counts as failed */
+#define MQTTCONN_ATTEMPT_MS       (30000U)
+
+static mqttconn_connect_f mqttconn_connect_fn = NULL;
+
+static data_mqtt_conn_state_e mqttconn_state = DATA_MQTT_CONN_STOPPED;
+static uint32_t         mqttconn_attempts = 0;
+static int64_t          mqttconn_deadline_us = 0;   /* BACKOFF: next attempt, CONNECTING: give up on it */
+static int64_t          mqttconn_down_us = 0;       /* connection lost, 0 while connected or never connected */
+static uint64_t         mqttconn_ttr_sum_ms = 0;
+
+/* Owned by the MQTT task; mqttconn_GetStats() reads the copy published under the lock */
+static data_mqtt_conn_stats_t mqttconn_stats = {};
+static data_mqtt_conn_stats_t mqttconn_stats_copy = {};
+
+static portMUX_TYPE     mqttconn_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char* TAG = "ESP::MQTT::CONN";
+
+
+static void mqttconn_PublishStats(int64_t now) {
+  mqttconn_stats.state = mqttconn_state;
+  mqttconn_stats.attempts = mqttconn_attempts;
+  mqttconn_stats.retry_in_ms = 0;
+  if ((mqttconn_state == DATA_MQTT_CONN_BACKOFF) && (mqttconn_deadline_us > now)) {
+    mqttconn_stats.retry_in_ms = (uint32_t) ((mqttconn_deadline_us - now) / 1000);
+  }
+
+  taskENTER_CRITICAL(&mqttconn_lock);
+  mqttconn_stats_copy = mqttconn_stats;
+  taskEXIT_CRITICAL(&mqttconn_lock);
+}
+
+/**
+ * @brief Draw the delay of the next attempt and wait for it.
+ */
+static void mqttconn_Backoff(int64_t now) {
+  uint32_t shift = (mqttconn_attempts < 16U) ? mqttconn_attempts : 16U;
+  uint64_t cap = (uint64_t) MQTTCONN_MIN_MS << shift;
+  uint32_t delay;
+
+  if (cap > MQTTCONN_MAX_MS) {
+    cap = MQTTCONN_MAX_MS;
+  }
+  delay = (uint32_t) (cap / 2U) + (esp_random() % ((uint32_t) (cap / 2U) + 1U));
+
+  mqttconn_state = DATA_MQTT_CONN_BACKOFF;
+  mqttconn_deadline_us = now + (int64_t) delay * 1000;
+  mqttconn_stats.backoff_ms = delay;
+  ESP_LOGI(TAG, "[%s] Attempt %lu in %lu ms", __func__, mqttconn_attempts + 1U, delay);
+}
+
+static void mqttconn_Failed(int64_t now) {
+  ++mqttconn_attempts;
+  ++mqttconn_stats.failures;
+  mqttconn_Backoff(now);
+}
+
+/**
+ * @brief Leave CONNECTED: the time to reconnect starts now.
+ */
+static void mqttconn_Lost(int64_t now) {
+  ++mqttconn_stats.disconnects;
+  mqttconn_down_us = now;
+  mqttconn_attempts = 0;
+}
+
+
+/* ==================== Public API ==================== */
+
+
+esp_err_t mqttconn_Init(mqttconn_connect_f connect_fn) {
+  esp_err_t result = ESP_OK;
+
+  ESP_LOGI(TAG, "++%s()", __func__);
+  mqttconn_connect_fn = connect_fn;
+  mqttconn_state = DATA_MQTT_CONN_STOPPED;
+  mqttconn_attempts = 0;
+  mqttconn_stats.session_expiry_s = CONFIG_MQTT_CTRL_SESSION_EXPIRY_S;
+  mqttconn_PublishStats(esp_timer_get_time());
+  ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
+  return result;
+}
+
+void mqttconn_Done(void) {
+  ESP_LOGI(TAG, "++%s()", __func__);
+  if (mqttconn_state == DATA_MQTT_CONN_CONNECTED) {
+    mqttconn_Lost(esp_timer_get_time());
+  }
+  mqttconn_state = DATA_MQTT_CONN_STOPPED;
+  mqttconn_connect_fn = NULL;
+  mqttconn_PublishStats(esp_timer_get_time());
+  ESP_LOGI(TAG, "--%s()", __func__);
+}
+
+void mqttconn_Start(void) {
+  int64_t now = esp_timer_get_time();
+
+  ESP_LOGI(TAG, "++%s(state: %d)", __func__, mqttconn_state);
+  if ((mqttconn_state == DATA_MQTT_CONN_STOPPED) || (mqttconn_state == DATA_MQTT_CONN_BACKOFF)) {
+    /* The link is (back) up: worth a try right away, the back-off goes on if it fails */
+    mqttconn_state = DATA_MQTT_CONN_BACKOFF;
+    mqttconn_deadline_us = now;
+  }
+  mqttconn_PublishStats(now);
+  ESP_LOGI(TAG, "--%s()", __func__);
+}
+
+void mqttconn_Stop(void) {
+  int64_t now = esp_timer_get_time();
+
+  ESP_LOGI(TAG, "++%s(state: %d)", __func__, mqttconn_state);
+  if (mqttconn_state == DATA_MQTT_CONN_CONNECTED) {
+    mqttconn_Lost(now);
+  }
+  mqttconn_state = DATA_MQTT_CONN_STOPPED;
+  mqttconn_PublishStats(now);
+  ESP_LOGI(TAG, "--%s()", __func__);
+}
+
+void mqttconn_Connected(bool session_present) {
+  int64_t now = esp_timer_get_time();
+
+  ESP_LOGI(TAG, "++%s(session_present: %d)", __func__, session_present);
+  if (mqttconn_state != DATA_MQTT_CONN_CONNECTED) {
+    if (mqttconn_down_us != 0) {
+      uint32_t ttr_ms = (uint32_t) ((now - mqttconn_down_us) / 1000);
+
+      mqttconn_stats.ttr_last_ms = ttr_ms;
+      if (ttr_ms > mqttconn_stats.ttr_max_ms) {
+        mqttconn_stats.ttr_max_ms = ttr_ms;
+      }
+      mqttconn_ttr_sum_ms += ttr_ms;
+      mqttconn_down_us = 0;
+      ESP_LOGI(TAG, "[%s] Reconnected in %lu ms after %lu failed attempts", __func__, ttr_ms, mqttconn_attempts);
+    }
+    ++mqttconn_stats.connects;
+    if (session_present) {
+      ++mqttconn_stats.resumed;
+    }
+    /* The first connection of a boot has no time to reconnect */
+    if (mqttconn_stats.connects > 1U) {
+      mqttconn_stats.ttr_avg_ms = (uint32_t) (mqttconn_ttr_sum_ms / (mqttconn_stats.connects - 1U));
+    }
+  }
+  mqttconn_state = DATA_MQTT_CONN_CONNECTED;
+  mqttconn_attempts = 0;
+  mqttconn_stats.backoff_ms = 0;
+  mqttconn_PublishStats(now);
+  ESP_LOGI(TAG, "--%s()", __func__);
+}
+
+void mqttconn_Disconnected(void) {
+  int64_t now = esp_timer_get_time();
+
+  ESP_LOGI(TAG, "++%s(state: %d)", __func__, mqttconn_state);
+  if (mqttconn_state == DATA_MQTT_CONN_CONNECTED) {
+    mqttconn_Lost(now);
+    mqttconn_Backoff(now);
+  } else if (mqttconn_state == DATA_MQTT_CONN_CONNECTING) {
+    mqttconn_Failed(now);
+  }
+  /* STOPPED: the client was stopped on purpose; BACKOFF: a retry is already planned */
+  mqttconn_PublishStats(now);
+  ESP_LOGI(TAG, "--%s()", __func__);
+}
+
+uint32_t mqttconn_Pump(void) {
+  int64_t now = esp_timer_get_time();
+  uint32_t wait_ms = 0;
+
+  if ((mqttconn_state == DATA_MQTT_CONN_CONNECTING) && (now >= mqttconn_deadline_us)) {
+    if (sysstate_GetFlags() & SYSSTATE_MQTT) {
+      /* Connected, only the report got lost */
+      mqttconn_Connected((sysstate_GetFlags() & SYSSTATE_MQTT_SESSION) != 0U);
+    } else {
+      ESP_LOGW(TAG, "[%s] No answer to attempt %lu", __func__, mqttconn_attempts + 1U);
+      mqttconn_Failed(now);
+    }
+  }
+
+  if ((mqttconn_state == DATA_MQTT_CONN_BACKOFF) && (now >= mqttconn_deadline_us) && (mqttconn_connect_fn != NULL)) {
+    esp_err_t result;
+
+    mqttconn_state = DATA_MQTT_CONN_CONNECTING;
+    mqttconn_deadline_us = now + (int64_t) MQTTCONN_ATTEMPT_MS * 1000;
+    result = mqttconn_connect_fn();
+    if (result != ESP_OK) {
+      ESP_LOGW(TAG, "[%s] Attempt %lu - result: %d", __func__, mqttconn_attempts + 1U, result);
+      mqttconn_Failed(now);
+    }
+  }
+
+  if ((mqttconn_state == DATA_MQTT_CONN_BACKOFF) || (mqttconn_state == DATA_MQTT_CONN_CONNECTING)) {
+    wait_ms = (mqttconn_deadline_us > now) ? (uint32_t) ((mqttconn_deadline_us - now + 999) / 1000) : 1U;
+  }
+  mqttconn_PublishStats(now);
+  return wait_ms;
+}
+
+void mqttconn_GetStats(data_mqtt_conn_stats_t* stats) {
+  taskENTER_CRITICAL(&mqttconn_lock);
+  *stats = mqttconn_stats_copy;
+  taskEXIT_CRITICAL(&mqttconn_lock);
+}
@@ -29,10 +29,18 @@
 
 #include "sdkconfig.h"
 
+#include "boot_seq.h"
 #include "msg.h"
+#include "bus_trace.h"
+#include "msg_pool.h"
 #include "nvs_ctrl.h"
 #include "mgr_ctrl.h"
+#include "sys_state.h"
 #include "mqtt_ctrl.h"
+#include "mqtt_conn.h"
+#include "mqtt_rx.h"
+#include "mqtt_store.h"
+#include "mqtt_topic.h"
 #include "tools.h"
 
 #include "err.h"
@@ -45,6 +53,8 @@
 #define MQTT_TASK_PRIORITY            9
 
 #define MQTT_MSG_MAX                  8
+/* mqttctrl_Done(): longest wait for the task to reach DONE, it runs on the manager task on a restart */
+#define MQTT_DONE_WAIT_MS             (5000U)
 
 #define MQTT_TOPIC_MAX_LEN            (32U)
 #define MQTT_UID_LEN                  (10U)
@@ -78,6 +88,16 @@
 
 #define MQTT_NVS_FAILS_MAX            3
 
+/* MQTT_EVENT_ERROR in a row, without a connection in between, before the supervisor is asked for a restart */
+#define MQTT_ERROR_MAX                (CONFIG_MQTT_CTRL_ERROR_MAX)
+
+/* MQTT v5 session kept by the broker after a disconnect, 0 starts clean on every connection */
+#define MQTT_SESSION_EXPIRY_S         (CONFIG_MQTT_CTRL_SESSION_EXPIRY_S)
+
+/* MQTT v5 publish: topic aliases of the hot topics (mqtt_topic.c), content type of every payload */
+#define MQTT_TOPIC_ALIAS_MAX          (CONFIG_MQTT_CTRL_TOPIC_ALIAS_MAX)
+#define MQTT_CONTENT_TYPE             CONFIG_MQTT_CTRL_CONTENT_TYPE
+
 /* Configuration slot enumeration */
 typedef enum {
   MQTT_SLOT_1 = 1,
@@ -106,6 +126,18 @@ static mqtt_slot_e        mqtt_slot = MQTT_SLOT_1;
 /* Flag indicating config update in progress (waiting for successful reconnection) */
 static bool               mqtt_config_update_in_progress = false;
 
+/* MQTT_EVENT_ERROR since the last MQTT_EVENT_CONNECTED (client event task only) */
+static uint32_t           mqtt_errors = 0;
+
+/* esp_mqtt_client_start() done: the next attempt starts over with a new client */
+static bool               mqtt_started = false;
+
+#if CONFIG_MQTT_PROTOCOL_5
+/* Publish properties last handed to the client, which applies them to every publish until changed */
+static esp_mqtt5_publish_property_config_t mqtt_pub_property = {};
+static bool               mqtt_pub_property_set = false;
+#endif
+
 typedef struct {
   uint8_t   fails;
   char      uri[MQTT_URI_SIZE];
@@ -123,7 +155,8 @@ static char mqtt_cfg_password[MQTT_PASSWORD_SIZE] = {};
 esp_mqtt_client_config_t mqtt_cfg = {
   .broker.address.uri = mqtt_cfg_uri,
   .session.protocol_ver = MQTT_PROTOCOL_V_5,
-  .network.disable_auto_reconnect = true,
+  .network.disable_auto_reconnect = true,     /* mqtt_conn.c decides when to try again */
+  .session.disable_clean_session = (MQTT_SESSION_EXPIRY_S != 0),
   .credentials.username = mqtt_cfg_username,
   .credentials.authentication.password = mqtt_cfg_password,
   // .session.last_will.topic = "/topic/will",
@@ -549,6 +582,39 @@ static esp_err_t mqttctrl_ConfirmConfigUpdate(void) {
   return result;
 }
 
+static esp_err_t mqttctrl_Send(const msg_t* msg);
+
+/**
+ * @brief Tell the MQTT task about a CONNECTED / DISCONNECTED of the client (event handler)
+ * 
+ * @param event_id DATA_MQTT_EVENT_CONNECTED or DATA_MQTT_EVENT_DISCONNECTED
+ */
+static void mqttctrl_PostLink(data_mqtt_event_e event_id) {
+  msg_t msg = {
+    .type = MSG_TYPE_MQTT_CTRL_LINK,
+    .from = REG_MQTT_CTRL,
+    .to = REG_MQTT_CTRL,
+    .payload.mqtt.u.event_id = event_id,
+  };
+
+  if (mqttctrl_Send(&msg) != ESP_OK) {
+    /* mqtt_conn.c gives up on an attempt it hears nothing about */
+    ESP_LOGW(TAG, "[%s] Link event %d lost", __func__, event_id);
+  }
+}
+
+/**
+ * @brief MQTT_EVENT_ERROR of a connection which failed or broke, not of the protocol
+ * 
+ * @param event Event of the client
+ * @return true for transport errors and a refused connection
+ */
+static bool mqttctrl_IsConnectError(esp_mqtt_event_handle_t event) {
+  return (event->error_handle != NULL) &&
+         ((event->error_handle->error_type == MQTT_ERROR_TYPE_TCP_TRANSPORT) ||
+          (event->error_handle->error_type == MQTT_ERROR_TYPE_CONNECTION_REFUSED));
+}
+
 /**
  * @brief MQTT event handler
  *
@@ -559,7 +625,8 @@ static esp_err_t mqttctrl_ConfirmConfigUpdate(void) {
  */
 static void mqttctrl_EventHandler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data) {
   esp_mqtt_event_handle_t event = event_data;
-  msg_t msg;
+  /* Cleared: a stray key would let the pool merge two commands */
+  msg_t msg = {};
   bool send = false;
 
   ESP_LOGI(TAG, "++%s(handler_args: %p, base: %s, event_id: %ld, event_data: %p)", __func__, handler_args, base ? base : "-", event_id, event_data);
@@ -567,6 +634,17 @@ static void mqttctrl_EventHandler(void *handler_args, esp_event_base_t base, int
 
   switch (event->event_id) {
     case MQTT_EVENT_CONNECTED: {
+      bootseq_Mark(BOOTSEQ_MARK_MQTT);
+      mqtt_errors = 0;
+      /* Before the broadcast: the manager skips the re-subscribe when the broker kept the session */
+      if (event->session_present) {
+        (void) sysstate_Set(SYSSTATE_MQTT_SESSION);
+      } else {
+        (void) sysstate_Clear(SYSSTATE_MQTT_SESSION);
+      }
+      /* Always broadcast: every connection is reported, resumed or not */
+      (void) sysstate_Set(SYSSTATE_MQTT);
+      mqttctrl_PostLink(DATA_MQTT_EVENT_CONNECTED);
       /* If config update was in progress, confirm it on successful connection */
       if (mqtt_config_update_in_progress) {
         ESP_LOGD(TAG, "[%s] Connected with new config, confirming update", __func__);
@@ -589,7 +667,11 @@ static void mqttctrl_EventHandler(void *handler_args, esp_event_base_t base, int
       msg.from = REG_MQTT_CTRL;
       msg.to = REG_ALL_CTRL;
       msg.payload.mqtt.u.event_id = DATA_MQTT_EVENT_DISCONNECTED;
-      send = true;
+      /* The rest of a chunked message will not come */
+      mqttrx_Reset();
+      /* Also dispatched after every failed reconnect: the engine needs each, the bus the transition only */
+      mqttctrl_PostLink(DATA_MQTT_EVENT_DISCONNECTED);
+      send = sysstate_Clear(SYSSTATE_MQTT | SYSSTATE_MQTT_SESSION);
       break;
     }
     case MQTT_EVENT_SUBSCRIBED: {
@@ -600,37 +682,26 @@ static void mqttctrl_EventHandler(void *handler_args, esp_event_base_t base, int
       break;
     }
     case MQTT_EVENT_PUBLISHED: {
+      /* The record leaves the outbound queue on the next mqttstore_Pump() */
+      mqttstore_Ack(event->msg_id);
       break;
     }
     case MQTT_EVENT_DATA: {
-      msg.type = MSG_TYPE_MQTT_DATA;
-      msg.from = REG_MQTT_CTRL;
-      msg.to = REG_MGR_CTRL;
-
-      ESP_LOGD(TAG, " SIZE: topic: %d, data: %d", event->topic_len, event->data_len);
+      ESP_LOGD(TAG, " SIZE: topic: %d, data: %d, offset: %d, total: %d", event->topic_len, event->data_len,
+          event->current_data_offset, event->total_data_len);
 
-      if (event->topic_len && (event->topic_len < DATA_TOPIC_SIZE)) {
-        memcpy(msg.payload.mqtt.u.data.topic, event->topic, event->topic_len);
-        msg.payload.mqtt.u.data.topic[event->topic_len] = 0;
-      } else {
-        ESP_LOGE(TAG, "[%s] Wrong topic size: %d", __func__, event->topic_len);
-        break;
-      }
-
-      if (event->data_len && (event->data_len < DATA_MSG_SIZE)) {
-        memcpy(msg.payload.mqtt.u.data.msg, event->data, event->data_len);
-        msg.payload.mqtt.u.data.msg[event->data_len] = 0;
-
-        /* remove all unnecessary characters */
-        cJSON_Minify(msg.payload.mqtt.u.data.msg);
-
-      } else {
-        ESP_LOGE(TAG, "[%s] Wrong data size: %d", __func__, event->data_len);
+      /* Chunks go straight into a bus buffer; the manager gets a reference once the message is complete */
+      if (mqttrx_Chunk(event->topic, (size_t) event->topic_len, event->data, (size_t) event->data_len,
+                       (size_t) event->current_data_offset, (size_t) event->total_data_len,
+                       &msg.payload.mqtt.u.in) != ESP_OK) {
         break;
       }
+      msg.type = MSG_TYPE_MQTT_DATA;
+      msg.from = REG_MQTT_CTRL;
+      msg.to = REG_MGR_CTRL;
 
-      ESP_LOGD(TAG, "TOPIC: [%3d] '%s'", strlen(msg.payload.mqtt.u.data.topic), msg.payload.mqtt.u.data.topic);
-      ESP_LOGD(TAG, " DATA: [%3d] '%s'", strlen(msg.payload.mqtt.u.data.msg), msg.payload.mqtt.u.data.msg);
+      ESP_LOGD(TAG, "TOPIC: '%s'", msg.payload.mqtt.u.in.topic);
+      ESP_LOGD(TAG, " DATA: [%3lu] '%s'", msg.payload.mqtt.u.in.msg_len, msg.payload.mqtt.u.in.msg);
 
       send = true;
       break;
@@ -640,6 +711,15 @@ static void mqttctrl_EventHandler(void *handler_args, esp_event_base_t base, int
     }
     case MQTT_EVENT_ERROR: {
       ESP_LOGD(TAG, "[%s] MQTT_EVENT_ERROR", __func__);
+      if (mqttctrl_IsConnectError(event)) {
+        /* Broker or network unreachable: the reconnect engine retries, no fault */
+        break;
+      }
+      if ((MQTT_ERROR_MAX != 0) && (++mqtt_errors >= MQTT_ERROR_MAX)) {
+        /* The client does not recover by itself, let the manager start a new one */
+        mqtt_errors = 0;
+        (void) MGR_ReportFault(REG_MQTT_CTRL, "MQTT_EVENT_ERROR");
+      }
       break;
     }
     default: {
@@ -671,8 +751,20 @@ static esp_err_t mqttctrl_InitClient(void) {
   ESP_LOGD(TAG, "[%s] Broker: %s", __func__, mqtt_cfg.broker.address.uri);
   ESP_LOGD(TAG, "[%s]   '%s':'%s'", __func__, mqtt_cfg.credentials.username, mqtt_cfg.credentials.authentication.password);
   mqtt_client = esp_mqtt_client_init(&mqtt_cfg);
+#if CONFIG_MQTT_PROTOCOL_5
+  mqtt_pub_property_set = false;
+#endif
   if (mqtt_client) {
     result = esp_mqtt_client_register_event(mqtt_client, ESP_EVENT_ANY_ID, mqttctrl_EventHandler, NULL);
+#if CONFIG_MQTT_PROTOCOL_5
+    if ((result == ESP_OK) && (MQTT_SESSION_EXPIRY_S != 0)) {
+      /* Without an expiry interval a v5 broker drops the session on disconnect */
+      esp_mqtt5_connection_property_config_t property = {
+        .session_expiry_interval = MQTT_SESSION_EXPIRY_S,
+      };
+      result = esp_mqtt5_client_set_connect_property(mqtt_client, &property);
+    }
+#endif
   } else {
     ESP_LOGE(TAG, "[%s] esp_mqtt_client_init() failed", __func__);
   }
@@ -697,6 +789,9 @@ static esp_err_t mqttctrl_DoneClient(void) {
     result = esp_mqtt_client_destroy(mqtt_client);
     ESP_LOGD(TAG, "[%s] esp_mqtt_client_destroy() - result: %d", __func__, result);
     mqtt_client = NULL;
+    mqtt_started = false;
+    /* The handler is gone, so no DISCONNECTED will clear it */
+    (void) sysstate_Clear(SYSSTATE_MQTT | SYSSTATE_MQTT_SESSION);
   } else {
     ESP_LOGE(TAG, "[%s] Error: %d", __func__, result);
   }
@@ -715,6 +810,7 @@ static esp_err_t mqttctrl_StartClient(void) {
   ESP_LOGI(TAG, "++%s()", __func__);
   if (mqtt_client) {
     result = esp_mqtt_client_start(mqtt_client);
+    mqtt_started = (result == ESP_OK);
   } else {
     ESP_LOGE(TAG, "[%s] Error: %d", __func__, result);
   }
@@ -733,6 +829,11 @@ static esp_err_t mqttctrl_StopClient(void) {
   ESP_LOGI(TAG, "++%s()", __func__);
   if (mqtt_client) {
     result = esp_mqtt_client_stop(mqtt_client);
+    mqtt_started = false;
+    /* A stopped client reports no DISCONNECTED of its own */
+    (void) sysstate_Clear(SYSSTATE_MQTT | SYSSTATE_MQTT_SESSION);
+    mqttconn_Stop();
+    mqttstore_SetOnline(false);
   } else {
     ESP_LOGE(TAG, "[%s] Error: %d", __func__, result);
   }
@@ -755,6 +856,9 @@ static esp_err_t mqttctrl_ReconnectClient(void) {
     ESP_LOGE(TAG, "[%s] Failed to stop client", __func__);
     return result;
   }
+  /* The old client took its outbox along, unacknowledged records go again */
+  mqttconn_Stop();
+  mqttstore_SetOnline(false);
 
   /* Small delay to ensure clean disconnect */
   vTaskDelay(pdMS_TO_TICKS(500));
@@ -765,12 +869,36 @@ static esp_err_t mqttctrl_ReconnectClient(void) {
     return result;
   }
 
-  result = mqttctrl_StartClient();
-  if (result != ESP_OK) {
-    ESP_LOGE(TAG, "[%s] Failed to start client", __func__);
-    return result;
-  }
+  /* First attempt right away, the new broker gets the same back-off as the old one */
+  mqttconn_Start();
+
+  ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
+  return result;
+}
 
+/**
+ * @brief Start one connection attempt, mqttconn_connect_f
+ * 
+ * @return esp_err_t ESP_OK when the client is trying, its outcome comes as MSG_TYPE_MQTT_CTRL_LINK
+ */
+static esp_err_t mqttctrl_Connect(void) {
+  esp_err_t result = ESP_ERR_INVALID_STATE;
+
+  ESP_LOGI(TAG, "++%s(started: %d)", __func__, mqtt_started);
+  if (mqtt_started) {
+    /* The outbox of the old connection would resend its QoS 1 publishes next to mqtt_store, which
+       sends every unacknowledged record again itself, and may hold alias-only publishes which must
+       not go out on a new connection: start over with a new client, its outbox is empty */
+    (void) mqttctrl_DoneClient();
+  }
+  if (mqtt_client == NULL) {
+    (void) mqttctrl_InitClient();
+  }
+  if (mqtt_client == NULL) {
+    ESP_LOGE(TAG, "[%s] No client", __func__);
+  } else {
+    result = mqttctrl_StartClient();
+  }
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
   return result;
 }
@@ -962,24 +1090,88 @@ static esp_err_t mqttctrl_ParseMqttData(const char* json_str) {
  * 
  * @param topic Pointer to topic string
  * @param msg Pointer to message string
- * @return esp_err_t ESP_OK on success, ESP_FAIL on error
+ * @return esp_err_t ESP_OK when queued, ESP_ERR_INVALID_SIZE / ESP_ERR_NO_MEM when dropped
  */
 static esp_err_t mqttctrl_Publish(const char* topic, const char* msg) {
   esp_err_t result = ESP_OK;
 
   ESP_LOGI(TAG, "++%s(topic: '%s', msg: '%s')", __func__, topic, msg);
-  int msg_id = esp_mqtt_client_publish(mqtt_client, topic, msg, 0, 1, 0);
-  ESP_LOGD(TAG, "[%s] PUBLISH(topic: '%s', msg: '%s') -> msg_id: %d", __func__,
-      topic, msg, msg_id);
-  if (msg_id == -1) {
-    result = ESP_FAIL;
-  } else if (msg_id == -2) {
-    result = ESP_ERR_NO_MEM;
-  }
+  /* Queued until the broker acknowledges it, see mqtt_store.h */
+  result = mqttstore_Push(topic, msg);
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
   return result;
 }
 
+#if CONFIG_MQTT_PROTOCOL_5
+/**
+ * @brief Hand the MQTT v5 properties of the next publish to the client, when they changed
+ * 
+ * @param pub Alias and expiry from mqtttopic_Prepare()
+ */
+static void mqttctrl_SetPublishProperty(const mqtttopic_pub_t* pub) {
+  esp_mqtt5_publish_property_config_t property = {
+    .payload_format_indicator = true,     /* every payload is JSON, i.e. UTF-8 */
+    .message_expiry_interval = pub->expiry_s,
+    .topic_alias = pub->alias,
+    .content_type = (MQTT_CONTENT_TYPE[0] != '\0') ? MQTT_CONTENT_TYPE : NULL,
+  };
+
+  if (!mqtt_pub_property_set ||
+      (property.topic_alias != mqtt_pub_property.topic_alias) ||
+      (property.message_expiry_interval != mqtt_pub_property.message_expiry_interval)) {
+    esp_err_t result = esp_mqtt5_client_set_publish_property(mqtt_client, &property);
+
+    if (result == ESP_OK) {
+      mqtt_pub_property = property;
+      mqtt_pub_property_set = true;
+    } else {
+      ESP_LOGE(TAG, "[%s] esp_mqtt5_client_set_publish_property() - result: %d", __func__, result);
+      mqtt_pub_property_set = false;
+    }
+  }
+}
+#endif
+
+/**
+ * @brief Hand one queued record to the client, mqttstore_publish_f
+ * 
+ * @param topic Pointer to topic string
+ * @param data Pointer to message
+ * @param len Length of the message
+ * @return int Message id, negative when the client refused it
+ */
+static int mqttctrl_PublishRecord(const char* topic, const char* data, size_t len) {
+  mqtttopic_pub_t pub;
+  int msg_id;
+
+  mqtttopic_Prepare(topic, &pub);
+#if CONFIG_MQTT_PROTOCOL_5
+  mqttctrl_SetPublishProperty(&pub);
+#endif
+  msg_id = esp_mqtt_client_publish(mqtt_client, pub.topic, data, (int) len, 1, 0);
+  if ((msg_id == -1) && (pub.alias != 0U)) {
+    /* -1 also means not connected: only when the same record goes out without its alias did the
+       broker refuse it (CONNACK Topic Alias Maximum), then full topics until the next connection */
+    pub.topic = topic;
+    pub.alias = 0U;
+#if CONFIG_MQTT_PROTOCOL_5
+    mqttctrl_SetPublishProperty(&pub);
+#endif
+    msg_id = esp_mqtt_client_publish(mqtt_client, pub.topic, data, (int) len, 1, 0);
+    if (msg_id >= 0) {
+      mqtttopic_DisableAliases();
+    }
+  }
+
+  ESP_LOGD(TAG, "[%s] PUBLISH(topic: '%s', alias: %u, len: %u) -> msg_id: %d", __func__, topic, pub.alias,
+           (unsigned) len, msg_id);
+  if (msg_id >= 0) {
+    mqtttopic_Sent(&pub);
+    bootseq_Mark(BOOTSEQ_MARK_PUBLISH);
+  }
+  return msg_id;
+}
+
 /**
  * @brief Subscribe to MQTT topic
  * 
@@ -1080,14 +1272,14 @@ static esp_err_t mqttctrl_ParseMsg(const msg_t* msg) {
       esp_uid[uid_len] = '\0';
 
       ESP_LOGD(TAG, "[%s] UID: '%s'", __func__, esp_uid);
+      /* Hot topics of this device, built once */
+      result = mqtttopic_Init(esp_uid);
       break;
     }
 
     case MSG_TYPE_MQTT_START: {
-      result = mqttctrl_StartClient();
-      if (result != ESP_OK) {
-        ESP_LOGE(TAG, "[%s] mqttctrl_StartClient() - result: %d", __func__, result);
-      }
+      /* The attempt itself is made by mqttconn_Pump() */
+      mqttconn_Start();
       break;
     }
     case MSG_TYPE_MQTT_STOP: {
@@ -1109,8 +1301,20 @@ static esp_err_t mqttctrl_ParseMsg(const msg_t* msg) {
       }
       break;
     }
+    case MSG_TYPE_MQTT_CTRL_LINK: {
+      if (msg->payload.mqtt.u.event_id == DATA_MQTT_EVENT_CONNECTED) {
+        mqttconn_Connected((sysstate_GetFlags() & SYSSTATE_MQTT_SESSION) != 0U);
+        /* Aliases are per connection: the first publish of each sends its topic again */
+        mqtttopic_Reset();
+        mqttstore_SetOnline(true);
+      } else {
+        mqttconn_Disconnected();
+        mqttstore_SetOnline(false);
+      }
+      break;
+    }
     case MSG_TYPE_MQTT_DATA: {
-      const data_mqtt_data_t* data_ptr = &(msg->payload.mqtt.u.data);
+      const data_mqtt_in_t* data_ptr = &(msg->payload.mqtt.u.in);
 
       ESP_LOGD(TAG, "[%s] topic: '%s'", __func__, data_ptr->topic);
       ESP_LOGD(TAG, "[%s]   msg: '%s'", __func__, data_ptr->msg);
@@ -1142,43 +1346,77 @@ static esp_err_t mqttctrl_ParseMsg(const msg_t* msg) {
   return result;
 }
 
+/**
+ * @brief Run the reconnect engine and the outbound queue
+ * 
+ * @return uint32_t Time in ms to the next call, 0 when neither waits for anything
+ */
+static uint32_t mqttctrl_Pump(void) {
+  uint32_t wait_ms = mqttconn_Pump();
+  uint32_t store_ms = mqttstore_Pump();
+
+  if ((wait_ms == 0U) || ((store_ms != 0U) && (store_ms < wait_ms))) {
+    wait_ms = store_ms;
+  }
+  return wait_ms;
+}
+
 /**
  * @brief MQTT control task function
  * 
  * @param param Task parameter (unused)
  */
 static void mqttctrl_TaskFn(void* param) {
-  msg_t msg;
+  msg_t* msg = NULL;
   bool loop = true;
   esp_err_t result;
+  uint32_t wait_ms = 0;
 
   ESP_LOGI(TAG, "++%s()", __func__);
-  memset(&msg, 0x00, sizeof(msg_t));
   while (loop) {
+    /* Wake up for the outbound queue (PUBACKs, replay pace) and the next connection attempt */
+    TickType_t wait = (wait_ms == 0) ? portMAX_DELAY : (pdMS_TO_TICKS(wait_ms) + 1U);
+
     ESP_LOGD(TAG, "[%s] Wait...", __func__);
-    if(xQueueReceive(mqtt_msg_queue, &msg, portMAX_DELAY) == pdTRUE) {
+    if(msgpool_Receive(mqtt_msg_queue, &msg, wait) == ESP_OK) {
       ESP_LOGD(TAG, "[%s] Message arrived: type: %d [%s], from: 0x%08lx, to: 0x%08lx", __func__, 
-          msg.type, GET_MSG_TYPE_NAME(msg.type),
-          msg.from, msg.to);
+          msg->type, GET_MSG_TYPE_NAME(msg->type),
+          msg->from, msg->to);
+
+      if (msgpool_IsExpired(msg)) {
+        /* Stale: waited on the bus past its TTL, not worth parsing */
+        msgpool_Release(msg);
+        MGR_Heartbeat(REG_MQTT_CTRL);
+        wait_ms = mqttctrl_Pump();
+        continue;
+      }
 
-      result = mqttctrl_ParseMsg(&msg);
+      int64_t trace = bustrace_ModBegin(REG_MQTT_CTRL, msg);
+      result = mqttctrl_ParseMsg(msg);
+      bustrace_ModEnd(REG_MQTT_CTRL, msg, trace);
+      msgpool_Release(msg);
+      MGR_Heartbeat(REG_MQTT_CTRL);
       if (result == ESP_TASK_DONE) {
         loop = false;
         result = ESP_OK;
       }
 
       if (result != ESP_OK) {
-        // TODO - Send Error to the Broker
         ESP_LOGE(TAG, "[%s] Error: %d", __func__, result);
       }
-    } else {
+    } else if (wait == portMAX_DELAY) {
       ESP_LOGE(TAG, "[%s] Message error.", __func__);
     }
+    if (loop) {
+      wait_ms = mqttctrl_Pump();
+    }
   }
   if (mqtt_sem_id) {
     xSemaphoreGive(mqtt_sem_id);
   }
   ESP_LOGI(TAG, "--%s()", __func__);
+  /* The supervisor may start a new task after mqttctrl_Done() */
+  vTaskDelete(NULL);
 }
 
 /**
@@ -1191,7 +1429,10 @@ static esp_err_t mqttctrl_Send(const msg_t* msg) {
   esp_err_t result = ESP_OK;
 
   ESP_LOGI(TAG, "++%s()", __func__);
-  if (xQueueSend(mqtt_msg_queue, msg, (TickType_t) 0) != pdPASS) {
+  if (mqtt_msg_queue == NULL) {
+    ESP_LOGE(TAG, "[%s] Not initialized, type: %d", __func__, msg->type);
+    result = ESP_ERR_INVALID_STATE;
+  } else if (msgpool_Post(mqtt_msg_queue, msg, (TickType_t) 0) != ESP_OK) {
     ESP_LOGE(TAG, "[%s] Message error. type: %d, from: 0x%08lx, to: 0x%08lx", __func__, msg->type, msg->from, msg->to);
     result = ESP_FAIL;
   }
@@ -1210,7 +1451,7 @@ static esp_err_t mqttctrl_Init(void) {
   ESP_LOGI(TAG, "++%s()", __func__);
 
   /* Initialization message queue */
-  mqtt_msg_queue = xQueueCreate(MQTT_MSG_MAX, sizeof(msg_t));
+  mqtt_msg_queue = msgpool_CreateQueue("mqtt", MQTT_MSG_MAX);
   if (mqtt_msg_queue == NULL)
   {
     ESP_LOGE(TAG, "[%s] xQueueCreate() failed.", __func__);
@@ -1243,6 +1484,27 @@ static esp_err_t mqttctrl_Init(void) {
     ESP_LOGW(TAG, "[%s] Failed to load active config, using defaults", __func__);
   }
 
+  /* Outbound queue, its backlog is kept across a restart of the controller */
+  result = mqttstore_Init(mqttctrl_PublishRecord);
+  if (result != ESP_OK) {
+    ESP_LOGE(TAG, "[%s] mqttstore_Init() - result: %d", __func__, result);
+    return result;
+  }
+
+  /* Reconnect engine, idle until MSG_TYPE_MQTT_START */
+  result = mqttconn_Init(mqttctrl_Connect);
+  if (result != ESP_OK) {
+    ESP_LOGE(TAG, "[%s] mqttconn_Init() - result: %d", __func__, result);
+    return result;
+  }
+
+  /* Before the client: its first MQTT_EVENT_DATA may come right after the connection */
+  result = mqttrx_Init();
+  if (result != ESP_OK) {
+    ESP_LOGE(TAG, "[%s] mqttrx_Init() - result: %d", __func__, result);
+    return result;
+  }
+
   /* Initialization MQTT thread */
   xTaskCreate(mqttctrl_TaskFn, MQTT_TASK_NAME, MQTT_TASK_STACK_SIZE, NULL, MQTT_TASK_PRIORITY, &mqtt_task_id);
   if (mqtt_task_id == NULL)
@@ -1278,19 +1540,35 @@ static esp_err_t mqttctrl_Done(void) {
       .to = REG_MQTT_CTRL,
     };
     result = mqttctrl_Send(&msg);
-  
-    ESP_LOGD(TAG, "[%s] Wait on xSemaphoreTake to finish task...", __func__);
-    xSemaphoreTake(mqtt_sem_id, portMAX_DELAY);
+    if (result == ESP_OK) {
+      ESP_LOGD(TAG, "[%s] Wait on xSemaphoreTake to finish task...", __func__);
+      if (xSemaphoreTake(mqtt_sem_id, pdMS_TO_TICKS(MQTT_DONE_WAIT_MS)) != pdTRUE) {
+        result = ESP_ERR_TIMEOUT;
+      }
+    }
+    if (result != ESP_OK) {
+      /* The task still runs on the queue and the semaphore: free nothing, a restart fails */
+      ESP_LOGE(TAG, "[%s] Task not stopped - result: %d", __func__, result);
+      ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
+      return result;
+    }
 
     vSemaphoreDelete(mqtt_sem_id);
+    mqtt_sem_id = NULL;
     ESP_LOGD(TAG, "[%s] Semaphore deleted", __func__);
 
+    mqtt_task_id = NULL;
     ESP_LOGD(TAG, "[%s] Task stopped", __func__);
   }
   if (mqtt_msg_queue) {
-    vQueueDelete(mqtt_msg_queue);
+    msgpool_DeleteQueue(mqtt_msg_queue);
+    mqtt_msg_queue = NULL;
     ESP_LOGD(TAG, "[%s] Queue deleted", __func__);
   }
+  mqtt_errors = 0;
+  mqttconn_Done();
+  mqttrx_Done();
+  mqttstore_Done();
 
   result = mqttctrl_DoneConfigPartition();
 
@@ -1360,6 +1638,53 @@ esp_err_t MqttCtrl_Run(void) {
   return result;
 }
 
+/**
+ * @brief Read data of the MQTT controller, mgr_reg_get_f
+ * 
+ * \return esp_err_t ESP_OK on success, ESP_ERR_NOT_SUPPORTED for other data types
+ */
+esp_err_t MqttCtrl_GetData(data_type_e data_type, mgr_reg_data_cb_f cb, void* cb_ctx) {
+  esp_err_t result = ESP_ERR_NOT_SUPPORTED;
+
+  ESP_LOGI(TAG, "++%s(data_type: %d [%s])", __func__, data_type, GET_DATA_TYPE_NAME(data_type));
+  if (data_type == DATA_TYPE_MQTT_STORE_STATS) {
+    data_mqtt_store_stats_t stats;
+    data_t data = {
+      .type = DATA_TYPE_MQTT_STORE_STATS,
+      .count = 0,
+      .size = sizeof(stats),
+      .data = (const uint8_t*) &stats,
+    };
+
+    mqttstore_GetStats(&stats);
+    result = cb(&data, cb_ctx);
+  } else if (data_type == DATA_TYPE_MQTT_CONN_STATS) {
+    data_mqtt_conn_stats_t stats;
+    data_t data = {
+      .type = DATA_TYPE_MQTT_CONN_STATS,
+      .count = 0,
+      .size = sizeof(stats),
+      .data = (const uint8_t*) &stats,
+    };
+
+    mqttconn_GetStats(&stats);
+    result = cb(&data, cb_ctx);
+  } else if (data_type == DATA_TYPE_MQTT_RX_STATS) {
+    data_mqtt_rx_stats_t stats;
+    data_t data = {
+      .type = DATA_TYPE_MQTT_RX_STATS,
+      .count = 0,
+      .size = sizeof(stats),
+      .data = (const uint8_t*) &stats,
+    };
+
+    mqttrx_GetStats(&stats);
+    result = cb(&data, cb_ctx);
+  }
+  ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
+  return result;
+}
+
 /**
  * @brief Send message to the MQTT controller thread
  * 
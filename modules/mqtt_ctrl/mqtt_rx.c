@@ -0,0 +1,184 @@
+/**
+ * @file mqtt_rx.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Reassembly of inbound MQTT data into bus buffers
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * IDLE ──first chunk──► FILLING ──last chunk──► IDLE (message handed over)
+ *   ▲                      │
+ *   └── lost / broken ─────┘  (buffer freed, counted)
+ *
+ * A first chunk which gets no buffer leaves SKIP: its next chunks are ignored.
+ */
+#include <stdbool.h>
+#include <string.h>
+
+#include "sdkconfig.h"
+
+#include "esp_log.h"
+
+#include "freertos/FreeRTOS.h"
+
+#include "msg_buf.h"
+#include "mqtt_rx.h"
+
+
+static data_mqtt_in_t   mqttrx_data = {};       /* message being filled, buf == NULL when none */
+static char*            mqttrx_text = NULL;
+static size_t           mqttrx_total = 0;
+static size_t           mqttrx_next = 0;        /* offset the next chunk must have */
+static bool             mqttrx_skip = false;    /* the rest of a dropped message is on its way */
+
+/* Owned by the client task; mqttrx_GetStats() reads the copy published under the lock */
+static data_mqtt_rx_stats_t mqttrx_stats = {};
+static data_mqtt_rx_stats_t mqttrx_stats_copy = {};
+
+static portMUX_TYPE     mqttrx_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char* TAG = "ESP::MQTT::RX";
+
+
+static void mqttrx_PublishStats(void) {
+  taskENTER_CRITICAL(&mqttrx_lock);
+  mqttrx_stats_copy = mqttrx_stats;
+  taskEXIT_CRITICAL(&mqttrx_lock);
+}
+
+/**
+ * @brief Give up the message being filled.
+ */
+static void mqttrx_Drop(void) {
+  if (mqttrx_data.buf != NULL) {
+    ESP_LOGW(TAG, "[%s] '%s' dropped at %u of %u bytes", __func__, mqttrx_data.topic,
+        (unsigned) mqttrx_next, (unsigned) mqttrx_total);
+    ++mqttrx_stats.broken;
+    msgbuf_Free(mqttrx_data.buf);
+  }
+  memset(&mqttrx_data, 0x00, sizeof(mqttrx_data));
+  mqttrx_text = NULL;
+  mqttrx_total = 0;
+  mqttrx_next = 0;
+}
+
+/**
+ * @brief First chunk: take a buffer for the whole message.
+ */
+static esp_err_t mqttrx_Begin(const char* topic, size_t topic_len, size_t total) {
+  mqttrx_Drop();
+  mqttrx_skip = false;
+
+  if ((topic_len == 0U) || (total == 0U)) {
+    ESP_LOGE(TAG, "[%s] Wrong size. topic: %u, data: %u", __func__, (unsigned) topic_len, (unsigned) total);
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  /* Topic, message and their terminators share one buffer */
+  if (topic_len + total + 2U > msgbuf_GetSize()) {
+    ESP_LOGE(TAG, "[%s] %u + %u bytes, max: %u", __func__,
+        (unsigned) topic_len, (unsigned) total, (unsigned) msgbuf_GetSize());
+    ++mqttrx_stats.too_big;
+    mqttrx_skip = true;
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  mqttrx_text = msgbuf_NewMqttData(&mqttrx_data, topic, topic_len, total + 1U);
+  if (mqttrx_text == NULL) {
+    ++mqttrx_stats.no_buffer;
+    mqttrx_skip = true;
+    return ESP_ERR_NO_MEM;
+  }
+  mqttrx_total = total;
+  mqttrx_next = 0;
+  return ESP_OK;
+}
+
+
+/* ==================== Public API ==================== */
+
+
+esp_err_t mqttrx_Init(void) {
+  esp_err_t result = ESP_OK;
+
+  ESP_LOGI(TAG, "++%s()", __func__);
+  mqttrx_Drop();
+  mqttrx_skip = false;
+  memset(&mqttrx_stats, 0x00, sizeof(mqttrx_stats));
+  mqttrx_stats.max_size = (uint32_t) msgbuf_GetSize();
+  mqttrx_PublishStats();
+  ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
+  return result;
+}
+
+void mqttrx_Done(void) {
+  ESP_LOGI(TAG, "++%s()", __func__);
+  mqttrx_Reset();
+  ESP_LOGI(TAG, "--%s()", __func__);
+}
+
+esp_err_t mqttrx_Chunk(const char* topic, size_t topic_len, const char* chunk, size_t chunk_len,
+                       size_t offset, size_t total, data_mqtt_in_t* data) {
+  esp_err_t result = ESP_OK;
+
+  if (offset == 0U) {
+    result = mqttrx_Begin(topic, topic_len, total);
+  } else if (mqttrx_data.buf == NULL) {
+    /* The rest of a dropped message, or the first chunk went missing */
+    if (!mqttrx_skip) {
+      ++mqttrx_stats.broken;
+    }
+    result = ESP_ERR_INVALID_STATE;
+  }
+
+  if (result == ESP_OK) {
+    if ((offset != mqttrx_next) || (total != mqttrx_total) || (chunk_len > mqttrx_total - offset)) {
+      ESP_LOGE(TAG, "[%s] Chunk %u + %u of %u, expected offset: %u", __func__,
+          (unsigned) offset, (unsigned) chunk_len, (unsigned) total, (unsigned) mqttrx_next);
+      mqttrx_Drop();
+      result = ESP_ERR_INVALID_STATE;
+    }
+  }
+
+  if (result == ESP_OK) {
+    memcpy(&mqttrx_text[offset], chunk, chunk_len);
+    mqttrx_next += chunk_len;
+
+    if (mqttrx_next < mqttrx_total) {
+      result = ESP_ERR_NOT_FINISHED;
+    } else {
+      mqttrx_text[mqttrx_total] = '\0';
+      mqttrx_data.msg_len = (uint32_t) mqttrx_total;
+      ++mqttrx_stats.received;
+      if (chunk_len < mqttrx_total) {
+        ++mqttrx_stats.chunked;
+      }
+      if (mqttrx_total > mqttrx_stats.largest) {
+        mqttrx_stats.largest = (uint32_t) mqttrx_total;
+      }
+
+      /* The buffer leaves with the message */
+      *data = mqttrx_data;
+      memset(&mqttrx_data, 0x00, sizeof(mqttrx_data));
+      mqttrx_text = NULL;
+      mqttrx_total = 0;
+      mqttrx_next = 0;
+    }
+  }
+  mqttrx_PublishStats();
+  return result;
+}
+
+void mqttrx_Reset(void) {
+  mqttrx_Drop();
+  mqttrx_skip = false;
+  mqttrx_PublishStats();
+}
+
+void mqttrx_GetStats(data_mqtt_rx_stats_t* stats) {
+  taskENTER_CRITICAL(&mqttrx_lock);
+  *stats = mqttrx_stats_copy;
+  taskEXIT_CRITICAL(&mqttrx_lock);
+}
@@ -0,0 +1,913 @@
+/**
+ * @file mqtt_store.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Outbound store-and-forward queue of the MQTT controller
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * RAM: a byte ring of records (header, topic, NUL, data), oldest at `head`. A
+ * record which does not fit before the end of the ring leaves a pad (size 0)
+ * and starts at offset 0.
+ *
+ * Flash: the partition CONFIG_MQTT_CTRL_STORE_PARTITION is a ring of erase
+ * sectors. Each sector starts with a magic and a sequence number, followed by
+ * records in the RAM layout up to the first erased size field. A record is
+ * written ready (state 0xFF) and marked done by clearing its state byte in
+ * place, so a sector is only erased when the writer needs it again. When the
+ * writer reaches the oldest sector still holding records, that sector is
+ * dropped. The backlog survives a reboot: mqttstore_Init() finds the newest
+ * sector and walks back to the oldest one of the same run.
+ */
+#include <string.h>
+
+#include "sdkconfig.h"
+
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+
+#include "msg.h"
+#include "mqtt_store.h"
+
+
+#define MQTTSTORE_RAM_SIZE        (CONFIG_MQTT_CTRL_STORE_RAM_SIZE & ~3U)
+#define MQTTSTORE_INFLIGHT_MAX    (CONFIG_MQTT_CTRL_STORE_INFLIGHT)
+#define MQTTSTORE_PARTITION       CONFIG_MQTT_CTRL_STORE_PARTITION
+
+/* Gap between two records of a replay */
+#define MQTTSTORE_REPLAY_US       ((int64_t) 1000000 / CONFIG_MQTT_CTRL_STORE_REPLAY_RATE)
+/* PUBACKs are collected by the MQTT task, which polls for them while records are in flight */
+#define MQTTSTORE_POLL_MS         (20U)
+#define MQTTSTORE_ACK_MAX         (2U * MQTTSTORE_INFLIGHT_MAX)
+
+#define MQTTSTORE_ALIGN(_size)    (((_size) + 3U) & ~3U)
+#define MQTTSTORE_REC_SIZE(_topic_len, _data_len) \
+  ((uint32_t) MQTTSTORE_ALIGN(sizeof(mqttstore_rec_t) + (_topic_len) + 1U + (_data_len)))
+#define MQTTSTORE_REC_MAX         MQTTSTORE_REC_SIZE(DATA_TOPIC_SIZE - 1U, DATA_MSG_SIZE - 1U)
+
+#define MQTTSTORE_SECTOR_MAGIC    (0x5153514DUL)  /* "MQSQ", little endian */
+#define MQTTSTORE_ERASED16        (0xFFFFU)
+
+#define MQTTSTORE_STATE_READY     (0xFFU)   /* erased value: a flash record is written ready */
+#define MQTTSTORE_STATE_SENT      (0x0FU)   /* RAM only: handed to the client, PUBACK outstanding */
+#define MQTTSTORE_STATE_DONE      (0x00U)   /* acknowledged, replaced or dropped */
+
+typedef enum {
+  MQTTSTORE_KEEP_ALL,
+  MQTTSTORE_KEEP_LATEST,
+} mqttstore_keep_e;
+
+typedef struct {
+  uint16_t  size;       /* whole record, multiple of 4; 0 is the pad at the end of the RAM ring */
+  uint8_t   state;      /* MQTTSTORE_STATE_xxx */
+  uint8_t   topic_len;  /* without the NUL which follows the topic */
+  uint16_t  data_len;
+  uint16_t  crc;        /* CRC-16/CCITT of topic and data, checked on flash records */
+  uint32_t  seq;
+} mqttstore_rec_t;
+
+typedef struct {
+  uint32_t  magic;
+  uint32_t  seq;
+} mqttstore_sector_t;
+
+typedef struct {
+  int       msg_id;
+  bool      flash;
+  uint32_t  pos;        /* RAM offset or partition offset of the record */
+  uint32_t  seq;        /* to tell a recycled position from the record sent */
+} mqttstore_inflight_t;
+
+typedef struct {
+  const char*       match;
+  mqttstore_keep_e  keep;
+} mqttstore_rule_t;
+
+_Static_assert(MQTTSTORE_RAM_SIZE >= 2U * MQTTSTORE_REC_MAX, "CONFIG_MQTT_CTRL_STORE_RAM_SIZE below two records");
+_Static_assert(DATA_TOPIC_SIZE <= 256U, "topic length must fit mqttstore_rec_t.topic_len");
+
+
+/* Retention per topic, first substring match wins; topics matching none keep every record */
+static const mqttstore_rule_t mqttstore_rule_list[] = {
+  { "/res/",    MQTTSTORE_KEEP_LATEST },  /* answers and relay state: only the newest is worth sending */
+  { "/event/",  MQTTSTORE_KEEP_ALL },     /* sensor and sys events: every one counts */
+};
+
+static uint8_t          mqttstore_ram[MQTTSTORE_RAM_SIZE] __attribute__((aligned(4)));
+static uint32_t         mqttstore_ram_head = 0;
+static uint32_t         mqttstore_ram_tail = 0;
+static uint32_t         mqttstore_ram_used = 0;   /* pads included */
+
+static const esp_partition_t* mqttstore_part = NULL;
+static uint32_t         mqttstore_sec_size = 0;
+static uint32_t         mqttstore_sec_cnt = 0;
+static uint32_t         mqttstore_sec_seq = 0;    /* sequence number of the sector being written */
+static uint32_t         mqttstore_rd = 0;         /* oldest flash record not done, == wr when none */
+static uint32_t         mqttstore_wr = 0;         /* where the next flash record goes */
+static uint32_t         mqttstore_cursor = 0;     /* next flash record to send */
+static uint8_t          mqttstore_buf[MQTTSTORE_REC_MAX] __attribute__((aligned(4)));
+
+static mqttstore_publish_f mqttstore_publish_fn = NULL;
+static uint32_t         mqttstore_seq = 0;
+static bool             mqttstore_online = false;
+static bool             mqttstore_replaying = false;
+static int64_t          mqttstore_replay_begin = 0;
+static int64_t          mqttstore_next_us = 0;
+
+static mqttstore_inflight_t mqttstore_inflight_list[MQTTSTORE_INFLIGHT_MAX];
+static uint32_t         mqttstore_inflight_cnt = 0;
+
+/* Filled by the client event handler, emptied by the MQTT task */
+static int              mqttstore_ack_list[MQTTSTORE_ACK_MAX];
+static uint32_t         mqttstore_ack_cnt = 0;
+static uint32_t         mqttstore_ack_lost = 0;
+
+/* Owned by the MQTT task; mqttstore_GetStats() reads the copy published under the lock */
+static data_mqtt_store_stats_t mqttstore_stats = {};
+static data_mqtt_store_stats_t mqttstore_stats_copy = {};
+
+static portMUX_TYPE     mqttstore_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char* TAG = "ESP::MQTT::STORE";
+
+
+static uint16_t mqttstore_Crc16(uint16_t crc, const uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    crc ^= (uint16_t) data[i] << 8;
+    for (int j = 0; j < 8; j++) {
+      crc = (crc & 0x8000U) ? (uint16_t) ((crc << 1) ^ 0x1021U) : (uint16_t) (crc << 1);
+    }
+  }
+  return crc;
+}
+
+static uint16_t mqttstore_RecCrc(const mqttstore_rec_t* rec) {
+  return mqttstore_Crc16(0xFFFFU, (const uint8_t*) (rec + 1), rec->topic_len + 1U + rec->data_len);
+}
+
+static mqttstore_keep_e mqttstore_GetKeep(const char* topic) {
+  for (size_t idx = 0; idx < (sizeof(mqttstore_rule_list) / sizeof(mqttstore_rule_list[0])); ++idx) {
+    if (strstr(topic, mqttstore_rule_list[idx].match) != NULL) {
+      return mqttstore_rule_list[idx].keep;
+    }
+  }
+  return MQTTSTORE_KEEP_ALL;
+}
+
+static void mqttstore_PublishStats(void) {
+  mqttstore_stats.depth = mqttstore_stats.ram_depth + mqttstore_stats.flash_depth;
+  mqttstore_stats.ram_used = mqttstore_ram_used;
+  mqttstore_stats.flash_used = 0;
+  if (mqttstore_part != NULL) {
+    mqttstore_stats.flash_used = (mqttstore_wr + mqttstore_sec_cnt * mqttstore_sec_size - mqttstore_rd)
+        % (mqttstore_sec_cnt * mqttstore_sec_size);
+  }
+  mqttstore_stats.inflight = mqttstore_inflight_cnt;
+  mqttstore_stats.online = mqttstore_online;
+  mqttstore_stats.replaying = mqttstore_replaying;
+
+  taskENTER_CRITICAL(&mqttstore_lock);
+  mqttstore_stats_copy = mqttstore_stats;
+  taskEXIT_CRITICAL(&mqttstore_lock);
+}
+
+static void mqttstore_Forget(const mqttstore_rec_t* rec, bool flash) {
+  uint32_t bytes = rec->topic_len + rec->data_len;
+
+  if (flash) {
+    --mqttstore_stats.flash_depth;
+  } else {
+    --mqttstore_stats.ram_depth;
+  }
+  mqttstore_stats.bytes -= bytes;
+}
+
+
+/* ==================== RAM ring ==================== */
+
+
+static mqttstore_rec_t* mqttstore_RamRec(uint32_t pos) {
+  return (mqttstore_rec_t*) &mqttstore_ram[pos];
+}
+
+/**
+ * @brief Reserve @p size bytes at the tail.
+ *
+ * @return Offset of the record or -1 when the ring is full.
+ */
+static int32_t mqttstore_RamAlloc(uint32_t size) {
+  uint32_t pos;
+  uint32_t pad = 0;
+
+  if (mqttstore_ram_used == 0) {
+    mqttstore_ram_head = 0;
+    mqttstore_ram_tail = 0;
+  } else if (mqttstore_ram_tail == mqttstore_ram_head) {
+    return -1;
+  }
+
+  if (mqttstore_ram_tail >= mqttstore_ram_head) {
+    if ((MQTTSTORE_RAM_SIZE - mqttstore_ram_tail) >= size) {
+      pos = mqttstore_ram_tail;
+    } else if (mqttstore_ram_head >= size) {
+      pad = MQTTSTORE_RAM_SIZE - mqttstore_ram_tail;
+      pos = 0;
+    } else {
+      return -1;
+    }
+  } else if ((mqttstore_ram_head - mqttstore_ram_tail) >= size) {
+    pos = mqttstore_ram_tail;
+  } else {
+    return -1;
+  }
+
+  if (pad != 0) {
+    mqttstore_RamRec(mqttstore_ram_tail)->size = 0;
+    mqttstore_ram_used += pad;
+  }
+  mqttstore_ram_tail = (pos + size) % MQTTSTORE_RAM_SIZE;
+  mqttstore_ram_used += size;
+  return (int32_t) pos;
+}
+
+/**
+ * @brief Release done records and pads at the head.
+ */
+static void mqttstore_RamTrim(void) {
+  while (mqttstore_ram_used > 0) {
+    mqttstore_rec_t* rec = mqttstore_RamRec(mqttstore_ram_head);
+
+    if (rec->size == 0) {
+      mqttstore_ram_used -= MQTTSTORE_RAM_SIZE - mqttstore_ram_head;
+      mqttstore_ram_head = 0;
+      continue;
+    }
+    if (rec->state != MQTTSTORE_STATE_DONE) {
+      break;
+    }
+    mqttstore_ram_used -= rec->size;
+    mqttstore_ram_head = (mqttstore_ram_head + rec->size) % MQTTSTORE_RAM_SIZE;
+  }
+}
+
+/**
+ * @brief First record from the head in @p state, or -1.
+ *
+ * @param topic When set, only records of this topic.
+ */
+static int32_t mqttstore_RamFind(uint8_t state, const char* topic) {
+  uint32_t pos = mqttstore_ram_head;
+  uint32_t left = mqttstore_ram_used;
+
+  while (left > 0) {
+    mqttstore_rec_t* rec = mqttstore_RamRec(pos);
+
+    if (rec->size == 0) {
+      left -= MQTTSTORE_RAM_SIZE - pos;
+      pos = 0;
+      continue;
+    }
+    if ((rec->state == state) && ((topic == NULL) || (strcmp((const char*) (rec + 1), topic) == 0))) {
+      return (int32_t) pos;
+    }
+    left -= rec->size;
+    pos = (pos + rec->size) % MQTTSTORE_RAM_SIZE;
+  }
+  return -1;
+}
+
+/**
+ * @brief Return every record in flight to the queue (connection lost or restart).
+ */
+static void mqttstore_RamUnsend(void) {
+  int32_t pos;
+
+  while ((pos = mqttstore_RamFind(MQTTSTORE_STATE_SENT, NULL)) >= 0) {
+    mqttstore_RamRec((uint32_t) pos)->state = MQTTSTORE_STATE_READY;
+  }
+}
+
+static void mqttstore_RamDone(uint32_t pos) {
+  mqttstore_rec_t* rec = mqttstore_RamRec(pos);
+
+  rec->state = MQTTSTORE_STATE_DONE;
+  mqttstore_Forget(rec, false);
+}
+
+
+/* ==================== Flash ring ==================== */
+
+
+static uint32_t mqttstore_SectorEnd(uint32_t off) {
+  return ((off / mqttstore_sec_size) + 1U) * mqttstore_sec_size;
+}
+
+static uint32_t mqttstore_NextSector(uint32_t off) {
+  return (((off / mqttstore_sec_size) + 1U) % mqttstore_sec_cnt) * mqttstore_sec_size + sizeof(mqttstore_sector_t);
+}
+
+/**
+ * @brief Read the record header at @p off.
+ *
+ * @return false at the end of the records of the sector.
+ */
+static bool mqttstore_FlashHeader(uint32_t off, mqttstore_rec_t* rec) {
+  uint32_t end = mqttstore_SectorEnd(off);
+
+  if ((off + sizeof(mqttstore_rec_t)) > end) {
+    return false;
+  }
+  if (esp_partition_read(mqttstore_part, off, rec, sizeof(mqttstore_rec_t)) != ESP_OK) {
+    return false;
+  }
+  return (rec->size != MQTTSTORE_ERASED16) && (rec->size >= sizeof(mqttstore_rec_t)) &&
+         (rec->size <= MQTTSTORE_REC_MAX) && ((off + rec->size) <= end);
+}
+
+/**
+ * @brief Read the whole record at @p off into mqttstore_buf and check it.
+ */
+static bool mqttstore_FlashLoad(uint32_t off, uint32_t size) {
+  const mqttstore_rec_t* rec = (const mqttstore_rec_t*) mqttstore_buf;
+
+  if (esp_partition_read(mqttstore_part, off, mqttstore_buf, size) != ESP_OK) {
+    return false;
+  }
+  return (MQTTSTORE_REC_SIZE(rec->topic_len, rec->data_len) == rec->size) && (mqttstore_RecCrc(rec) == rec->crc);
+}
+
+static void mqttstore_FlashDone(uint32_t off, const mqttstore_rec_t* rec) {
+  uint8_t state = MQTTSTORE_STATE_DONE;
+
+  (void) esp_partition_write(mqttstore_part, off + offsetof(mqttstore_rec_t, state), &state, sizeof(state));
+  mqttstore_Forget(rec, true);
+}
+
+/**
+ * @brief Move the read position over done records; reset it when the flash is empty.
+ */
+static void mqttstore_FlashTrim(void) {
+  mqttstore_rec_t rec;
+
+  while ((mqttstore_stats.flash_depth > 0) && (mqttstore_rd != mqttstore_wr)) {
+    if (!mqttstore_FlashHeader(mqttstore_rd, &rec)) {
+      mqttstore_rd = mqttstore_NextSector(mqttstore_rd);
+      continue;
+    }
+    if (rec.state != MQTTSTORE_STATE_DONE) {
+      break;
+    }
+    mqttstore_rd += rec.size;
+  }
+  if (mqttstore_stats.flash_depth == 0) {
+    mqttstore_rd = mqttstore_wr;
+    mqttstore_cursor = mqttstore_wr;
+  }
+}
+
+static esp_err_t mqttstore_FlashStartSector(uint32_t sector) {
+  mqttstore_sector_t hdr = {
+    .magic = MQTTSTORE_SECTOR_MAGIC,
+    .seq = mqttstore_sec_seq + 1U,
+  };
+  esp_err_t result = esp_partition_erase_range(mqttstore_part, sector * mqttstore_sec_size, mqttstore_sec_size);
+
+  if (result == ESP_OK) {
+    result = esp_partition_write(mqttstore_part, sector * mqttstore_sec_size, &hdr, sizeof(hdr));
+  }
+  if (result == ESP_OK) {
+    mqttstore_sec_seq = hdr.seq;
+    mqttstore_wr = sector * mqttstore_sec_size + sizeof(hdr);
+  } else {
+    ESP_LOGE(TAG, "[%s] Sector %lu - result: %d", __func__, sector, result);
+  }
+  return result;
+}
+
+/**
+ * @brief Give up the records left in the oldest sector, the writer needs it.
+ */
+static void mqttstore_FlashDropSector(void) {
+  uint32_t sector = mqttstore_rd / mqttstore_sec_size;
+  uint32_t dropped = 0;
+  mqttstore_rec_t rec;
+
+  while (mqttstore_FlashHeader(mqttstore_rd, &rec)) {
+    if (rec.state != MQTTSTORE_STATE_DONE) {
+      mqttstore_Forget(&rec, true);
+      ++dropped;
+    }
+    mqttstore_rd += rec.size;
+  }
+  for (uint32_t idx = 0; idx < mqttstore_inflight_cnt; ) {
+    if (mqttstore_inflight_list[idx].flash && ((mqttstore_inflight_list[idx].pos / mqttstore_sec_size) == sector)) {
+      mqttstore_inflight_list[idx] = mqttstore_inflight_list[--mqttstore_inflight_cnt];
+    } else {
+      ++idx;
+    }
+  }
+  mqttstore_stats.dropped += dropped;
+  mqttstore_rd = mqttstore_NextSector(mqttstore_rd);
+  if ((mqttstore_cursor / mqttstore_sec_size) == sector) {
+    mqttstore_cursor = mqttstore_rd;
+  }
+  ESP_LOGW(TAG, "[%s] Flash full, sector %lu dropped with %lu records", __func__, sector, dropped);
+}
+
+/**
+ * @brief Append the record built in mqttstore_buf.
+ */
+static esp_err_t mqttstore_FlashAppend(uint32_t size) {
+  esp_err_t result = ESP_OK;
+
+  if ((mqttstore_wr + size) > mqttstore_SectorEnd(mqttstore_wr)) {
+    uint32_t next = (mqttstore_wr / mqttstore_sec_size + 1U) % mqttstore_sec_cnt;
+
+    if ((mqttstore_stats.flash_depth > 0) && ((mqttstore_rd / mqttstore_sec_size) == next)) {
+      mqttstore_FlashDropSector();
+    }
+    result = mqttstore_FlashStartSector(next);
+    if (result != ESP_OK) {
+      return result;
+    }
+  }
+  if (mqttstore_stats.flash_depth == 0) {
+    mqttstore_rd = mqttstore_wr;
+    mqttstore_cursor = mqttstore_wr;
+  }
+  result = esp_partition_write(mqttstore_part, mqttstore_wr, mqttstore_buf, size);
+  if (result == ESP_OK) {
+    mqttstore_wr += size;
+  }
+  return result;
+}
+
+/**
+ * @brief Whether the flash record at @p off is in flight.
+ */
+static bool mqttstore_FlashInflight(uint32_t off, uint32_t seq) {
+  for (uint32_t idx = 0; idx < mqttstore_inflight_cnt; ++idx) {
+    const mqttstore_inflight_t* entry = &mqttstore_inflight_list[idx];
+
+    if (entry->flash && (entry->pos == off) && (entry->seq == seq)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Mark done the flash records of @p topic which are not in flight (keep-latest).
+ *
+ * @return Number of records replaced.
+ */
+static uint32_t mqttstore_FlashReplace(const char* topic, size_t topic_len) {
+  char name[DATA_TOPIC_SIZE];
+  mqttstore_rec_t rec;
+  uint32_t off = mqttstore_rd;
+  uint32_t cnt = 0;
+
+  while ((mqttstore_stats.flash_depth > 0) && (off != mqttstore_wr)) {
+    if (!mqttstore_FlashHeader(off, &rec)) {
+      off = mqttstore_NextSector(off);
+      continue;
+    }
+    if ((rec.state != MQTTSTORE_STATE_DONE) && (rec.topic_len == topic_len) &&
+        !mqttstore_FlashInflight(off, rec.seq) &&
+        (esp_partition_read(mqttstore_part, off + sizeof(rec), name, topic_len) == ESP_OK) &&
+        (memcmp(name, topic, topic_len) == 0)) {
+      mqttstore_FlashDone(off, &rec);
+      ++cnt;
+    }
+    off += rec.size;
+  }
+  return cnt;
+}
+
+/**
+ * @brief Next flash record to send, loaded into mqttstore_buf.
+ *
+ * @return false when every record has been sent.
+ */
+static bool mqttstore_FlashNext(uint32_t* off) {
+  mqttstore_rec_t rec;
+
+  while ((mqttstore_stats.flash_depth > 0) && (mqttstore_cursor != mqttstore_wr)) {
+    if (!mqttstore_FlashHeader(mqttstore_cursor, &rec)) {
+      mqttstore_cursor = mqttstore_NextSector(mqttstore_cursor);
+      continue;
+    }
+    *off = mqttstore_cursor;
+    mqttstore_cursor += rec.size;
+    if (rec.state == MQTTSTORE_STATE_DONE) {
+      continue;
+    }
+    if (mqttstore_FlashLoad(*off, rec.size)) {
+      return true;
+    }
+    ESP_LOGW(TAG, "[%s] Bad record at 0x%lx, skipped", __func__, *off);
+    mqttstore_FlashDone(*off, &rec);
+    ++mqttstore_stats.dropped;
+  }
+  return false;
+}
+
+/**
+ * @brief Find the backlog left by the last run, or format the first sector.
+ */
+static esp_err_t mqttstore_FlashInit(void) {
+  mqttstore_sector_t hdr;
+  mqttstore_rec_t rec;
+  uint32_t newest = UINT32_MAX;
+  uint32_t oldest;
+  uint32_t off;
+
+  mqttstore_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, MQTTSTORE_PARTITION);
+  if (mqttstore_part == NULL) {
+    ESP_LOGW(TAG, "[%s] No partition '%s', RAM only", __func__, MQTTSTORE_PARTITION);
+    return ESP_ERR_NOT_FOUND;
+  }
+  mqttstore_sec_size = mqttstore_part->erase_size;
+  mqttstore_sec_cnt = mqttstore_part->size / mqttstore_sec_size;
+  if ((mqttstore_sec_cnt < 2U) || (mqttstore_sec_size < (sizeof(mqttstore_sector_t) + MQTTSTORE_REC_MAX))) {
+    ESP_LOGE(TAG, "[%s] Partition '%s' too small, RAM only", __func__, MQTTSTORE_PARTITION);
+    mqttstore_part = NULL;
+    return ESP_ERR_INVALID_SIZE;
+  }
+  mqttstore_stats.flash_size = mqttstore_sec_cnt * mqttstore_sec_size;
+  mqttstore_stats.flash_depth = 0;
+
+  for (uint32_t sector = 0; sector < mqttstore_sec_cnt; ++sector) {
+    if ((esp_partition_read(mqttstore_part, sector * mqttstore_sec_size, &hdr, sizeof(hdr)) == ESP_OK) &&
+        (hdr.magic == MQTTSTORE_SECTOR_MAGIC) && ((newest == UINT32_MAX) || (hdr.seq > mqttstore_sec_seq))) {
+      newest = sector;
+      mqttstore_sec_seq = hdr.seq;
+    }
+  }
+  if (newest == UINT32_MAX) {
+    mqttstore_sec_seq = 0;
+    return mqttstore_FlashStartSector(0);
+  }
+
+  /* Sectors of the same run have consecutive numbers, going back from the newest */
+  oldest = newest;
+  for (uint32_t cnt = 1; cnt < mqttstore_sec_cnt; ++cnt) {
+    uint32_t prev = (oldest + mqttstore_sec_cnt - 1U) % mqttstore_sec_cnt;
+
+    if ((esp_partition_read(mqttstore_part, prev * mqttstore_sec_size, &hdr, sizeof(hdr)) != ESP_OK) ||
+        (hdr.magic != MQTTSTORE_SECTOR_MAGIC) || (hdr.seq != (mqttstore_sec_seq - cnt))) {
+      break;
+    }
+    oldest = prev;
+  }
+
+  /* Count what is left, from the oldest sector up to the end of the newest */
+  off = oldest * mqttstore_sec_size + sizeof(mqttstore_sector_t);
+  mqttstore_rd = off;
+  for (;;) {
+    if (!mqttstore_FlashHeader(off, &rec)) {
+      if ((off / mqttstore_sec_size) == newest) {
+        break;
+      }
+      off = mqttstore_NextSector(off);
+      continue;
+    }
+    if (rec.state != MQTTSTORE_STATE_DONE) {
+      if (mqttstore_FlashLoad(off, rec.size)) {
+        ++mqttstore_stats.flash_depth;
+        mqttstore_stats.bytes += rec.topic_len + rec.data_len;
+        if (rec.seq > mqttstore_seq) {
+          mqttstore_seq = rec.seq;
+        }
+      } else {
+        /* Torn by a reset while it was written: nothing was appended after it */
+        uint8_t state = MQTTSTORE_STATE_DONE;
+
+        (void) esp_partition_write(mqttstore_part, off + offsetof(mqttstore_rec_t, state), &state, sizeof(state));
+        ++mqttstore_stats.dropped;
+        if ((off / mqttstore_sec_size) == newest) {
+          off = mqttstore_SectorEnd(off);
+          break;
+        }
+      }
+    }
+    off += rec.size;
+  }
+  mqttstore_wr = off;
+  mqttstore_cursor = mqttstore_rd;
+  mqttstore_FlashTrim();
+
+  ESP_LOGI(TAG, "[%s] '%s': %lu x %lu B, backlog: %lu records", __func__, MQTTSTORE_PARTITION,
+      mqttstore_sec_cnt, mqttstore_sec_size, mqttstore_stats.flash_depth);
+  return ESP_OK;
+}
+
+
+/* ==================== Send and acknowledge ==================== */
+
+
+static void mqttstore_CheckReplay(int64_t now) {
+  if (mqttstore_replaying && ((mqttstore_stats.ram_depth + mqttstore_stats.flash_depth) == 0)) {
+    mqttstore_replaying = false;
+    mqttstore_stats.replay_ms = (uint32_t) ((now - mqttstore_replay_begin) / 1000);
+    if (mqttstore_stats.replay_ms == 0) {
+      mqttstore_stats.replay_ms = 1;
+    }
+    ESP_LOGI(TAG, "[%s] Replay done: %lu records in %lu ms", __func__,
+        mqttstore_stats.replay_cnt, mqttstore_stats.replay_ms);
+  }
+}
+
+/**
+ * @brief Apply the PUBACKs collected by mqttstore_Ack().
+ */
+static void mqttstore_ApplyAcks(void) {
+  int ack_list[MQTTSTORE_ACK_MAX];
+  uint32_t ack_cnt;
+
+  taskENTER_CRITICAL(&mqttstore_lock);
+  ack_cnt = mqttstore_ack_cnt;
+  memcpy(ack_list, mqttstore_ack_list, ack_cnt * sizeof(ack_list[0]));
+  mqttstore_ack_cnt = 0;
+  mqttstore_stats.ack_lost = mqttstore_ack_lost;
+  taskEXIT_CRITICAL(&mqttstore_lock);
+
+  for (uint32_t ack = 0; ack < ack_cnt; ++ack) {
+    for (uint32_t idx = 0; idx < mqttstore_inflight_cnt; ++idx) {
+      mqttstore_inflight_t* entry = &mqttstore_inflight_list[idx];
+
+      if (entry->msg_id != ack_list[ack]) {
+        continue;
+      }
+      if (entry->flash) {
+        mqttstore_rec_t rec;
+
+        if (mqttstore_FlashHeader(entry->pos, &rec) && (rec.seq == entry->seq) && (rec.state != MQTTSTORE_STATE_DONE)) {
+          mqttstore_FlashDone(entry->pos, &rec);
+        }
+      } else if ((mqttstore_RamRec(entry->pos)->seq == entry->seq) &&
+                 (mqttstore_RamRec(entry->pos)->state == MQTTSTORE_STATE_SENT)) {
+        mqttstore_RamDone(entry->pos);
+      }
+      ++mqttstore_stats.acked;
+      *entry = mqttstore_inflight_list[--mqttstore_inflight_cnt];
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Hand the oldest unsent record to the client.
+ *
+ * @return false when there is none or the client refused it.
+ */
+static bool mqttstore_SendNext(bool* refused) {
+  mqttstore_inflight_t entry = {};
+  const mqttstore_rec_t* rec;
+  int32_t pos;
+  uint32_t off;
+
+  /* Flash only holds records newer than every one in RAM */
+  pos = mqttstore_RamFind(MQTTSTORE_STATE_READY, NULL);
+  if (pos >= 0) {
+    rec = mqttstore_RamRec((uint32_t) pos);
+    entry.pos = (uint32_t) pos;
+  } else if ((mqttstore_part != NULL) && mqttstore_FlashNext(&off)) {
+    rec = (const mqttstore_rec_t*) mqttstore_buf;
+    entry.flash = true;
+    entry.pos = off;
+  } else {
+    return false;
+  }
+
+  entry.seq = rec->seq;
+  entry.msg_id = mqttstore_publish_fn((const char*) (rec + 1), (const char*) (rec + 1) + rec->topic_len + 1U, rec->data_len);
+  if (entry.msg_id < 0) {
+    ESP_LOGW(TAG, "[%s] Publish refused: %d", __func__, entry.msg_id);
+    if (entry.flash) {
+      /* Not sent: start over from this record next time */
+      mqttstore_cursor = entry.pos;
+    }
+    *refused = true;
+    return false;
+  }
+  if (!entry.flash) {
+    mqttstore_RamRec(entry.pos)->state = MQTTSTORE_STATE_SENT;
+  }
+  mqttstore_inflight_list[mqttstore_inflight_cnt++] = entry;
+  ++mqttstore_stats.published;
+  return true;
+}
+
+
+/* ==================== Public API ==================== */
+
+
+esp_err_t mqttstore_Init(mqttstore_publish_f publish_fn) {
+  esp_err_t result = ESP_OK;
+
+  ESP_LOGI(TAG, "++%s()", __func__);
+  mqttstore_publish_fn = publish_fn;
+  mqttstore_online = false;
+  mqttstore_replaying = false;
+  mqttstore_inflight_cnt = 0;
+  taskENTER_CRITICAL(&mqttstore_lock);
+  mqttstore_ack_cnt = 0;
+  taskEXIT_CRITICAL(&mqttstore_lock);
+
+  /* After a restart of the controller the RAM backlog is still there */
+  mqttstore_RamUnsend();
+  mqttstore_stats.ram_size = MQTTSTORE_RAM_SIZE;
+  if (mqttstore_part == NULL) {
+    (void) mqttstore_FlashInit();
+  } else {
+    mqttstore_cursor = mqttstore_rd;
+  }
+  mqttstore_PublishStats();
+  ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
+  return result;
+}
+
+void mqttstore_Done(void) {
+  ESP_LOGI(TAG, "++%s()", __func__);
+  mqttstore_online = false;
+  mqttstore_replaying = false;
+  mqttstore_inflight_cnt = 0;
+  mqttstore_publish_fn = NULL;
+  mqttstore_PublishStats();
+  ESP_LOGI(TAG, "--%s()", __func__);
+}
+
+esp_err_t mqttstore_Push(const char* topic, const char* data) {
+  mqttstore_rec_t* rec;
+  size_t topic_len = strlen(topic);
+  size_t data_len = strlen(data);
+  uint32_t size;
+  int32_t pos = -1;
+
+  if ((topic_len == 0) || (topic_len >= DATA_TOPIC_SIZE) || (data_len >= DATA_MSG_SIZE)) {
+    ++mqttstore_stats.dropped;
+    return ESP_ERR_INVALID_SIZE;
+  }
+  size = MQTTSTORE_REC_SIZE(topic_len, data_len);
+
+  mqttstore_ApplyAcks();
+  mqttstore_RamTrim();
+  if (mqttstore_part != NULL) {
+    mqttstore_FlashTrim();
+  }
+
+  /* Keep-latest: the newest value replaces older ones which have not left yet */
+  if (mqttstore_GetKeep(topic) == MQTTSTORE_KEEP_LATEST) {
+    while ((pos = mqttstore_RamFind(MQTTSTORE_STATE_READY, topic)) >= 0) {
+      mqttstore_RamDone((uint32_t) pos);
+      ++mqttstore_stats.replaced;
+    }
+    mqttstore_RamTrim();
+    if ((mqttstore_part != NULL) && (mqttstore_stats.flash_depth > 0)) {
+      /* A long outage spills: the old values wait in flash, the new one goes there too */
+      mqttstore_stats.replaced += mqttstore_FlashReplace(topic, topic_len);
+      mqttstore_FlashTrim();
+    }
+  }
+
+  /* RAM while no newer records wait in flash, so the order is kept */
+  if (mqttstore_stats.flash_depth == 0) {
+    pos = mqttstore_RamAlloc(size);
+    if ((pos < 0) && (mqttstore_part == NULL)) {
+      /* No flash to spill to: the oldest records not in flight make room */
+      int32_t old;
+
+      while ((pos < 0) && ((old = mqttstore_RamFind(MQTTSTORE_STATE_READY, NULL)) >= 0)) {
+        mqttstore_RamDone((uint32_t) old);
+        ++mqttstore_stats.dropped;
+        mqttstore_RamTrim();
+        pos = mqttstore_RamAlloc(size);
+      }
+    }
+  }
+
+  rec = (pos >= 0) ? mqttstore_RamRec((uint32_t) pos) : (mqttstore_rec_t*) mqttstore_buf;
+  if ((pos < 0) && (mqttstore_part == NULL)) {
+    ++mqttstore_stats.dropped;
+    mqttstore_PublishStats();
+    ESP_LOGW(TAG, "[%s] Store full, dropped: '%s'", __func__, topic);
+    return ESP_ERR_NO_MEM;
+  }
+
+  rec->size = (uint16_t) size;
+  rec->state = MQTTSTORE_STATE_READY;
+  rec->topic_len = (uint8_t) topic_len;
+  rec->data_len = (uint16_t) data_len;
+  rec->seq = ++mqttstore_seq;
+  memcpy(rec + 1, topic, topic_len + 1U);
+  memcpy((uint8_t*) (rec + 1) + topic_len + 1U, data, data_len);
+  memset((uint8_t*) (rec + 1) + topic_len + 1U + data_len, 0, size - sizeof(*rec) - topic_len - 1U - data_len);
+  rec->crc = mqttstore_RecCrc(rec);
+
+  if (pos >= 0) {
+    ++mqttstore_stats.ram_depth;
+  } else if (mqttstore_FlashAppend(size) == ESP_OK) {
+    ++mqttstore_stats.flash_depth;
+    ++mqttstore_stats.spilled;
+  } else {
+    ++mqttstore_stats.dropped;
+    mqttstore_PublishStats();
+    return ESP_FAIL;
+  }
+  mqttstore_stats.bytes += topic_len + data_len;
+  ++mqttstore_stats.queued;
+  mqttstore_PublishStats();
+  return ESP_OK;
+}
+
+void mqttstore_SetOnline(bool online) {
+  int64_t now = esp_timer_get_time();
+
+  if (online == mqttstore_online) {
+    return;
+  }
+  ESP_LOGI(TAG, "++%s(online: %d)", __func__, online);
+  /* PUBACKs which came in before the connection dropped still count */
+  mqttstore_ApplyAcks();
+  mqttstore_online = online;
+  if (online) {
+    mqttstore_RamTrim();
+    if (mqttstore_part != NULL) {
+      mqttstore_FlashTrim();
+    }
+    if ((mqttstore_stats.ram_depth + mqttstore_stats.flash_depth) > 0) {
+      mqttstore_replaying = true;
+      mqttstore_replay_begin = now;
+      mqttstore_next_us = now;
+      mqttstore_stats.replay_cnt = 0;
+      mqttstore_stats.replay_ms = 0;
+      ESP_LOGI(TAG, "[%s] Replay: %lu records, %lu bytes", __func__,
+          mqttstore_stats.ram_depth + mqttstore_stats.flash_depth, mqttstore_stats.bytes);
+    }
+  } else {
+    /* Unacknowledged records go out again after the next connection */
+    mqttstore_inflight_cnt = 0;
+    mqttstore_replaying = false;
+    mqttstore_RamUnsend();
+    mqttstore_cursor = mqttstore_rd;
+  }
+  mqttstore_PublishStats();
+  ESP_LOGI(TAG, "--%s()", __func__);
+}
+
+void mqttstore_Ack(int msg_id) {
+  taskENTER_CRITICAL(&mqttstore_lock);
+  if (mqttstore_ack_cnt < MQTTSTORE_ACK_MAX) {
+    mqttstore_ack_list[mqttstore_ack_cnt++] = msg_id;
+  } else {
+    ++mqttstore_ack_lost;
+  }
+  taskEXIT_CRITICAL(&mqttstore_lock);
+}
+
+uint32_t mqttstore_Pump(void) {
+  int64_t now = esp_timer_get_time();
+  uint32_t wait_ms = 0;
+  bool refused = false;
+
+  mqttstore_ApplyAcks();
+  mqttstore_RamTrim();
+  if (mqttstore_part != NULL) {
+    mqttstore_FlashTrim();
+  }
+
+  if (mqttstore_online && (mqttstore_publish_fn != NULL)) {
+    while (mqttstore_inflight_cnt < MQTTSTORE_INFLIGHT_MAX) {
+      if (mqttstore_replaying && (now < mqttstore_next_us)) {
+        wait_ms = (uint32_t) ((mqttstore_next_us - now + 999) / 1000);
+        break;
+      }
+      if (!mqttstore_SendNext(&refused)) {
+        break;
+      }
+      if (mqttstore_replaying) {
+        ++mqttstore_stats.replay_cnt;
+        mqttstore_next_us = now + MQTTSTORE_REPLAY_US;
+      }
+    }
+    if ((wait_ms == 0) && (refused || (mqttstore_inflight_cnt > 0))) {
+      wait_ms = MQTTSTORE_POLL_MS;
+    }
+  }
+
+  mqttstore_CheckReplay(now);
+  mqttstore_PublishStats();
+  return wait_ms;
+}
+
+void mqttstore_GetStats(data_mqtt_store_stats_t* stats) {
+  taskENTER_CRITICAL(&mqttstore_lock);
+  *stats = mqttstore_stats_copy;
+  taskEXIT_CRITICAL(&mqttstore_lock);
+}
@@ -0,0 +1,134 @@
+/**
+ * @file mqtt_topic.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Outbound topics of the MQTT controller: interned topics, aliases, properties
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * mqtttopic_rule_list[] names the hot topics. mqtttopic_Init() builds them for
+ * the UID into mqtttopic_list[], in the order of the rules, and the first
+ * CONFIG_MQTT_CTRL_TOPIC_ALIAS_MAX of them get the aliases 1, 2, ... A record
+ * is matched by length and memcmp() against these few entries only.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "sdkconfig.h"
+
+#include "esp_log.h"
+
+#include "msg.h"
+#include "mqtt_topic.h"
+
+
+#define MQTTTOPIC_ALIAS_MAX       (CONFIG_MQTT_CTRL_TOPIC_ALIAS_MAX)
+#define MQTTTOPIC_EVENT_EXPIRY_S  (CONFIG_MQTT_CTRL_EVENT_EXPIRY_S)
+
+#define MQTTTOPIC_LIST_CNT        (sizeof(mqtttopic_rule_list) / sizeof(mqtttopic_rule_list[0]))
+
+typedef struct {
+  const char* kind;       /* "res" or "event" */
+  const char* module;
+  uint32_t    expiry_s;
+} mqtttopic_rule_t;
+
+typedef struct {
+  data_topic_t  topic;
+  uint8_t       len;
+  bool          known;    /* published with its alias on this connection */
+  uint16_t      alias;
+  uint32_t      expiry_s;
+} mqtttopic_t;
+
+
+/* Hot topics "{uid}/{kind}/{module}", most frequent first: they get the aliases first */
+static const mqtttopic_rule_t mqtttopic_rule_list[] = {
+  { "event",  "sensor",   MQTTTOPIC_EVENT_EXPIRY_S },   /* lux on every reading */
+  { "res",    "relay",    0 },                          /* relay state, no expiry: the last one must arrive */
+  { "event",  "sys",      MQTTTOPIC_EVENT_EXPIRY_S },
+  { "res",    "sensor",   0 },
+  { "res",    "sys",      0 },
+  { "res",    "template", 0 },
+};
+
+static mqtttopic_t      mqtttopic_list[MQTTTOPIC_LIST_CNT] = {};
+static size_t           mqtttopic_cnt = 0;
+static bool             mqtttopic_aliases = false;
+
+static const char* TAG = "ESP::MQTT::TOPIC";
+
+
+/* ==================== Public API ==================== */
+
+
+esp_err_t mqtttopic_Init(const char* uid) {
+  esp_err_t result = ESP_OK;
+
+  ESP_LOGI(TAG, "++%s(uid: '%s')", __func__, uid);
+  mqtttopic_cnt = 0;
+  for (size_t idx = 0; idx < MQTTTOPIC_LIST_CNT; ++idx) {
+    const mqtttopic_rule_t* rule = &mqtttopic_rule_list[idx];
+    mqtttopic_t* entry = &mqtttopic_list[mqtttopic_cnt];
+    int len = snprintf(entry->topic, sizeof(entry->topic), "%s/%s/%s", uid, rule->kind, rule->module);
+
+    if ((len <= 0) || ((size_t) len >= sizeof(entry->topic))) {
+      ESP_LOGE(TAG, "[%s] Topic of '%s/%s' too long", __func__, rule->kind, rule->module);
+      result = ESP_ERR_INVALID_SIZE;
+      continue;
+    }
+    entry->len = (uint8_t) len;
+    entry->known = false;
+    entry->alias = (mqtttopic_cnt < MQTTTOPIC_ALIAS_MAX) ? (uint16_t) (mqtttopic_cnt + 1U) : 0U;
+    entry->expiry_s = rule->expiry_s;
+    ESP_LOGD(TAG, "[%s] '%s' -> alias: %u, expiry: %lu s", __func__, entry->topic, entry->alias, entry->expiry_s);
+    ++mqtttopic_cnt;
+  }
+  ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
+  return result;
+}
+
+void mqtttopic_Reset(void) {
+  for (size_t idx = 0; idx < mqtttopic_cnt; ++idx) {
+    mqtttopic_list[idx].known = false;
+  }
+  mqtttopic_aliases = (MQTTTOPIC_ALIAS_MAX != 0);
+}
+
+void mqtttopic_Prepare(const char* topic, mqtttopic_pub_t* pub) {
+  size_t len = strnlen(topic, DATA_TOPIC_SIZE);
+
+  pub->topic = topic;
+  pub->alias = 0;
+  pub->expiry_s = 0;
+  for (size_t idx = 0; idx < mqtttopic_cnt; ++idx) {
+    const mqtttopic_t* entry = &mqtttopic_list[idx];
+
+    if ((entry->len == len) && (memcmp(entry->topic, topic, len) == 0)) {
+      pub->expiry_s = entry->expiry_s;
+      if (mqtttopic_aliases && (entry->alias != 0U)) {
+        pub->alias = entry->alias;
+        if (entry->known) {
+          pub->topic = "";
+        }
+      }
+      break;
+    }
+  }
+}
+
+void mqtttopic_Sent(const mqtttopic_pub_t* pub) {
+  if ((pub->alias != 0U) && (pub->alias <= mqtttopic_cnt)) {
+    /* Aliases are numbered in list order */
+    mqtttopic_list[pub->alias - 1U].known = true;
+  }
+}
+
+void mqtttopic_DisableAliases(void) {
+  if (mqtttopic_aliases) {
+    ESP_LOGW(TAG, "[%s] Topic aliases refused, full topics until the next connection", __func__);
+  }
+  mqtttopic_aliases = false;
+}
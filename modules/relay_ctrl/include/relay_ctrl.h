@@ -24,5 +24,6 @@ esp_err_t RelayCtrl_Init(void);
 esp_err_t RelayCtrl_Done(void);
 esp_err_t RelayCtrl_Run(void);
 esp_err_t RelayCtrl_Send(const msg_t* msg);
+esp_err_t RelayCtrl_Direct(const msg_t* msg);
 
 #endif /* __Relay_CTRL_H__ */
\ No newline at end of file
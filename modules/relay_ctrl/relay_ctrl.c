@@ -22,6 +22,8 @@
 #include "driver/gpio.h"
 
 #include "msg.h"
+#include "executor.h"
+#include "msg_pool.h"
 #include "mgr_ctrl.h"
 #include "relay_ctrl.h"
 
@@ -29,7 +31,6 @@
 #include "lut.h"
 
 
-#define RELAY_TASK_NAME           "relay-task"
 #define RELAY_TASK_STACK_SIZE     4096
 #define RELAY_TASK_PRIORITY       12
 
@@ -48,12 +49,16 @@ typedef struct {
 static const char* TAG = "ESP::RELAY";
 
 
-static QueueHandle_t      relay_msg_queue = NULL;
-static TaskHandle_t       relay_task_id = NULL;
-static SemaphoreHandle_t  relay_sem_id = NULL;
+static executor_unit_t*   relay_unit = NULL;
+
+/* RelayCtrl_Direct() sets relays on the manager task, the relay task reads them */
+static portMUX_TYPE       relay_lock = portMUX_INITIALIZER_UNLOCKED;
 
 static data_uid_t         esp_uid = {0};
 
+/* Topics of this device, built when the UID arrives */
+static data_topic_t       relay_res_topic = {0};
+
 static relay_t relay_slots[] = {
   {
     .gpio = GPIO_NUM_32,
@@ -100,10 +105,12 @@ static esp_err_t relayctrl_SetRelayState(const int number, const uint32_t level)
   esp_err_t result = ESP_FAIL;
 
   ESP_LOGI(TAG, "++%s(number: %d, level: %ld)", __func__, number, level);
+  taskENTER_CRITICAL(&relay_lock);
   result = gpio_set_level(relay_slots[number].gpio, level);
   if (result == ESP_OK) {
     relay_slots[number].level = level;
   }
+  taskEXIT_CRITICAL(&relay_lock);
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
   return result;
 }
@@ -112,8 +119,10 @@ static esp_err_t relayctrl_GetRelayState(const int number, uint32_t* level) {
   esp_err_t result = ESP_OK;
 
   ESP_LOGI(TAG, "++%s(number: %d)", __func__, number);
+  taskENTER_CRITICAL(&relay_lock);
   relay_slots[number].level = gpio_get_level(relay_slots[number].gpio);
   *level = relay_slots[number].level;
+  taskEXIT_CRITICAL(&relay_lock);
   ESP_LOGI(TAG, "--%s(level: %ld) - result: %d", __func__, *level, result);
   return result;
 }
@@ -177,9 +186,11 @@ static esp_err_t relayctrl_ParseSetRelays(const cJSON* relays) {
 
 static esp_err_t relayctrl_NotifyLcd(void) {
   msg_t msg = {
-    .type = MSG_TYPE_MQTT_DATA,
+    .type = MSG_TYPE_MQTT_DATA_LOCAL,
     .from = REG_RELAY_CTRL,
     .to = REG_LCD_CTRL,
+    .key = MSG_KEY(0),  /* state of all relays, a newer one replaces a pending one */
+    .ttl_ms = CONFIG_MGR_MSG_TTL_LCD_MS,  /* not worth drawing once it is this old */
   };
   esp_err_t result = ESP_FAIL;
 
@@ -209,9 +220,10 @@ static esp_err_t relayctrl_NotifyLcd(void) {
     }
 
     if (result == ESP_OK) {
+      /* Inline: the msg_buf.h buffers are left to the data from the broker */
       ret = cJSON_PrintPreallocated(response, msg.payload.mqtt.u.data.msg, DATA_MSG_SIZE, 0);
       if (ret == 1) {
-        snprintf(msg.payload.mqtt.u.data.topic, DATA_TOPIC_SIZE, "%s/res/relay", esp_uid);
+        memcpy(msg.payload.mqtt.u.data.topic, relay_res_topic, sizeof(data_topic_t));
         result = MGR_Send(&msg);
         if (result != ESP_OK) {
           ESP_LOGE(TAG, "[%s] MGR_Send() - Error: %d", __func__, result);
@@ -290,7 +302,7 @@ static esp_err_t relayctrl_PrepareResponse(const bool is_event) {
       /* Send json to the thread */
       if ((ret = cJSON_PrintPreallocated(response, msg.payload.mqtt.u.data.msg, DATA_MSG_SIZE, 0)) == 1) {
         /* add topic -> ESP/12AB34/res/relay */
-        snprintf(msg.payload.mqtt.u.data.topic, DATA_TOPIC_SIZE, "%s/res/relay", esp_uid);
+        memcpy(msg.payload.mqtt.u.data.topic, relay_res_topic, sizeof(data_topic_t));
 
         result = MGR_Send(&msg);
         if (result != ESP_OK) {
@@ -397,6 +409,7 @@ static esp_err_t relayctrl_ParseMsg(const msg_t* msg) {
       esp_uid[uid_len] = '\0';
 
       ESP_LOGD(TAG, "[%s] UID: '%s'", __func__, esp_uid);
+      snprintf(relay_res_topic, sizeof(relay_res_topic), "%s/res/relay", esp_uid);
       break;
     }
 
@@ -407,7 +420,7 @@ static esp_err_t relayctrl_ParseMsg(const msg_t* msg) {
     }
 
     case MSG_TYPE_MQTT_DATA: {
-      const data_mqtt_data_t* data_ptr = &(msg->payload.mqtt.u.data);
+      const data_mqtt_in_t* data_ptr = &(msg->payload.mqtt.u.in);
 
       ESP_LOGD(TAG, "[%s] topic: '%s'", __func__, data_ptr->topic);
       ESP_LOGD(TAG, "[%s]   msg: '%s'", __func__, data_ptr->msg);
@@ -415,6 +428,19 @@ static esp_err_t relayctrl_ParseMsg(const msg_t* msg) {
       break;
     }
 
+    case MSG_TYPE_MQTT_DATA_LOCAL: {
+      ESP_LOGD(TAG, "[%s] topic: '%s'", __func__, msg->payload.mqtt.u.data.topic);
+      ESP_LOGD(TAG, "[%s]   msg: '%s'", __func__, msg->payload.mqtt.u.data.msg);
+      result = relayctrl_ParseMqttData(msg->payload.mqtt.u.data.msg);
+      break;
+    }
+
+    case MSG_TYPE_RELAY_CTRL_STATE: {
+      /* Relays already set by RelayCtrl_Direct(), only the event is left */
+      result = relayctrl_PrepareResponse(true);
+      break;
+    }
+
     default: {
       ESP_LOGW(TAG, "[%s] Unknown message type: %d [%s]", __func__, msg->type, GET_MSG_TYPE_NAME(msg->type));
       result = ESP_FAIL;
@@ -425,50 +451,11 @@ static esp_err_t relayctrl_ParseMsg(const msg_t* msg) {
   return result;
 }
 
-/**
- * @brief Relay task's function
- * 
- * @param param 
- */
-static void relayctrl_TaskFn(void* param) {
-  msg_t msg;
-  bool loop = true;
-  esp_err_t result;
-
-  ESP_LOGI(TAG, "++%s()", __func__);
-  memset(&msg, 0x00, sizeof(msg_t));
-  while (loop) {
-    ESP_LOGD(TAG, "[%s] Wait...", __func__);
-    if(xQueueReceive(relay_msg_queue, &msg, portMAX_DELAY) == pdTRUE) {
-      ESP_LOGD(TAG, "[%s] Message arrived: type: %d [%s], from: 0x%08lx, to: 0x%08lx", __func__, 
-          msg.type, GET_MSG_TYPE_NAME(msg.type),
-          msg.from, msg.to);
-      
-      result = relayctrl_ParseMsg(&msg);
-      if (result == ESP_TASK_DONE) {
-        loop = false;
-        result = ESP_OK;
-      }
-
-      if (result != ESP_OK) {
-        // TODO - Send Error to the Broker
-        ESP_LOGE(TAG, "[%s] Error: %d", __func__, result);
-      }
-    } else {
-      ESP_LOGE(TAG, "[%s] Message error.", __func__);
-    }
-  }
-  if (relay_sem_id) {
-    xSemaphoreGive(relay_sem_id);
-  }
-  ESP_LOGI(TAG, "--%s()", __func__);
-}
-
 static esp_err_t relayctrl_Send(const msg_t* msg) {
   esp_err_t result = ESP_OK;
 
   ESP_LOGI(TAG, "++%s()", __func__);
-  if (xQueueSend(relay_msg_queue, msg, (TickType_t) 0) != pdPASS) {
+  if (executor_Post(relay_unit, msg, (TickType_t) 0) != ESP_OK) {
     ESP_LOGE(TAG, "[%s] Message error. type: %d, from: 0x%08lx, to: 0x%08lx", __func__, msg->type, msg->from, msg->to);
     result = ESP_FAIL;
   }
@@ -483,26 +470,17 @@ static esp_err_t relayctrl_Init(void) {
 
   ESP_LOGD(TAG, "[%s] UID: '%s'", __func__, esp_uid);
 
-  /* Initialization message queue */
-  relay_msg_queue = xQueueCreate(RELAY_MSG_MAX, sizeof(msg_t));
-  if (relay_msg_queue == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xQueueCreate() failed.", __func__);
-    return ESP_FAIL;
-  }
-
-  relay_sem_id = xSemaphoreCreateCounting(1, 0);
-  if (relay_sem_id == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xSemaphoreCreateCounting() failed.", __func__);
-    return ESP_FAIL;
-  }
-
-  /* Initialization thread */
-  xTaskCreate(relayctrl_TaskFn, RELAY_TASK_NAME, RELAY_TASK_STACK_SIZE, NULL, RELAY_TASK_PRIORITY, &relay_task_id);
-  if (relay_task_id == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xTaskCreate() failed.", __func__);
+  executor_cfg_t cfg = {
+    .name     = "relay",
+    .module   = REG_RELAY_CTRL,
+    .depth    = RELAY_MSG_MAX,
+    .handler  = relayctrl_ParseMsg,
+    .stack    = RELAY_TASK_STACK_SIZE,
+    .priority = RELAY_TASK_PRIORITY,
+  };
+  relay_unit = executor_Create(&cfg);
+  if (relay_unit == NULL) {
+    ESP_LOGE(TAG, "[%s] executor_Create() failed.", __func__);
     return ESP_FAIL;
   }
 
@@ -516,25 +494,17 @@ static esp_err_t relayctrl_Done(void) {
   esp_err_t result = ESP_OK;
 
   ESP_LOGI(TAG, "++%s()", __func__);
-  if (relay_sem_id) {
+  if (relay_unit) {
     msg_t msg = {
       .type = MSG_TYPE_DONE,
       .from = REG_RELAY_CTRL,
       .to = REG_RELAY_CTRL,
     };
-    result = relayctrl_Send(&msg);
-
-    ESP_LOGD(TAG, "[%s] Wait on xSemaphoreTake to finish task...", __func__);
-    xSemaphoreTake(relay_sem_id, portMAX_DELAY);
-
-    vSemaphoreDelete(relay_sem_id);
-    ESP_LOGD(TAG, "[%s] Semaphore deleted", __func__);
-
-    ESP_LOGD(TAG, "[%s] Task stopped", __func__);
-  }
-  if (relay_msg_queue) {
-    vQueueDelete(relay_msg_queue);
-    ESP_LOGD(TAG, "[%s] Queue deleted", __func__);
+    result = executor_Delete(relay_unit, &msg);
+    if (result == ESP_OK) {
+      relay_unit = NULL;
+      ESP_LOGD(TAG, "[%s] Unit deleted", __func__);
+    }
   }
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
   return result;
@@ -611,3 +581,48 @@ esp_err_t RelayCtrl_Send(const msg_t* msg) {
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
   return result;
 }
+
+/**
+ * @brief Handle a relay command inline on the manager task
+ *
+ * Only the GPIO write of a "set" is done here. The MQTT event and the LCD
+ * update are MGR_Send() calls the manager task must not make (MQTT_DATA_LOCAL has the
+ * block policy), so they are queued to the relay task as one
+ * MSG_TYPE_RELAY_CTRL_STATE; a newer one replaces a pending one. "get" and
+ * anything unparsable go through the task.
+ *
+ * \return ESP_ERR_NOT_SUPPORTED to queue the message instead
+ */
+esp_err_t RelayCtrl_Direct(const msg_t* msg) {
+  esp_err_t result = ESP_ERR_NOT_SUPPORTED;
+
+  ESP_LOGI(TAG, "++%s()", __func__);
+  if ((msg->type == MSG_TYPE_MQTT_DATA) || (msg->type == MSG_TYPE_MQTT_DATA_LOCAL)) {
+    cJSON* root = cJSON_Parse((msg->type == MSG_TYPE_MQTT_DATA) ?
+                              msg->payload.mqtt.u.in.msg : msg->payload.mqtt.u.data.msg);
+
+    if (root != NULL) {
+      const char* o_str = cJSON_GetStringValue(cJSON_GetObjectItem(root, "operation"));
+
+      if ((o_str != NULL) && (strcmp(o_str, "set") == 0)) {
+        result = relayctrl_ParseSetRelays(cJSON_GetObjectItem(root, "relays"));
+        if (result == ESP_OK) {
+          msg_t state = {
+            .type = MSG_TYPE_RELAY_CTRL_STATE,
+            .from = REG_RELAY_CTRL,
+            .to = REG_RELAY_CTRL,
+            .key = MSG_KEY(0),
+          };
+
+          result = executor_Post(relay_unit, &state, (TickType_t) 0);
+          if (result != ESP_OK) {
+            ESP_LOGE(TAG, "[%s] executor_Post() - Error: %d", __func__, result);
+          }
+        }
+      }
+      cJSON_Delete(root);
+    }
+  }
+  ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
+  return result;
+}
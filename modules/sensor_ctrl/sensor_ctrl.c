@@ -21,6 +21,8 @@
 
 #include "err.h"
 #include "msg.h"
+#include "executor.h"
+#include "msg_pool.h"
 #include "types.h"
 #include "mgr_ctrl.h"
 #include "sensor_ctrl.h"
@@ -31,7 +33,6 @@
 #include "lut.h"
 
 
-#define SENSOR_TASK_NAME              "sensor-ctrl-task"
 #define SENSOR_TASK_STACK_SIZE        4096
 #define SENSOR_TASK_PRIORITY          12
 
@@ -41,12 +42,14 @@
 static const char* TAG = "ESP::SENSOR";
 
 
-static QueueHandle_t      sensor_msg_queue = NULL;
-static TaskHandle_t       sensor_task_id = NULL;
-static SemaphoreHandle_t  sensor_sem_id = NULL;
+static executor_unit_t*   sensor_unit = NULL;
 
 static data_uid_t         esp_uid = {0};
 
+/* Topics of this device, built when the UID arrives */
+static data_topic_t       sensor_event_topic = {0};
+static data_topic_t       sensor_res_topic = {0};
+
 
 static esp_err_t sensorCb(cJSON* data, void* param) {
   esp_err_t result = ESP_FAIL;
@@ -69,6 +72,8 @@ static esp_err_t sensorCb(cJSON* data, void* param) {
       ESP_LOGW(TAG, "[%s] Passed param: %lu is wrong", __func__, (unsigned long) idx);
       return result;
     }
+    /* Sensor readings are state, keep only the newest pending event per sensor */
+    msg.key = MSG_KEY(idx);
 
     /* create root of json for event */
     cJSON* event = cJSON_CreateObject();
@@ -85,7 +90,7 @@ static esp_err_t sensorCb(cJSON* data, void* param) {
     int ret = -1;
     if ((ret = cJSON_PrintPreallocated(event, msg.payload.mqtt.u.data.msg, DATA_MSG_SIZE, 0)) == 1) {
       /* add topic -> ESP/12AB34/event/sensor */
-      snprintf(msg.payload.mqtt.u.data.topic, DATA_TOPIC_SIZE, "%s/event/sensor", esp_uid);
+      memcpy(msg.payload.mqtt.u.data.topic, sensor_event_topic, sizeof(data_topic_t));
 
       result = MGR_Send(&msg);
       if (result != ESP_OK) {
@@ -138,7 +143,7 @@ static esp_err_t publishResponse(cJSON* response, msg_t* msg) {
   ESP_LOGI(TAG, "++%s(response: %p, msg: %p)", __func__, response, msg);
   if ((ret = cJSON_PrintPreallocated(response, msg->payload.mqtt.u.data.msg, DATA_MSG_SIZE, 0)) == 1) {
     /* add topic -> ESP/12AB34/res/sensor */
-    snprintf(msg->payload.mqtt.u.data.topic, DATA_TOPIC_SIZE, "%s/res/sensor", esp_uid);
+    memcpy(msg->payload.mqtt.u.data.topic, sensor_res_topic, sizeof(data_topic_t));
 
     result = MGR_Send(msg);
     if (result != ESP_OK) {
@@ -358,6 +363,8 @@ static esp_err_t parseMsg(const msg_t* msg) {
       esp_uid[uid_len] = '\0';
 
       ESP_LOGD(TAG, "[%s] UID: '%s'", __func__, esp_uid);
+      snprintf(sensor_event_topic, sizeof(sensor_event_topic), "%s/event/sensor", esp_uid);
+      snprintf(sensor_res_topic, sizeof(sensor_res_topic), "%s/res/sensor", esp_uid);
       break;
     }
 
@@ -368,7 +375,7 @@ static esp_err_t parseMsg(const msg_t* msg) {
     }
 
     case MSG_TYPE_MQTT_DATA: {
-      const data_mqtt_data_t* data_ptr = &(msg->payload.mqtt.u.data);
+      const data_mqtt_in_t* data_ptr = &(msg->payload.mqtt.u.in);
 
       ESP_LOGD(TAG, "[%s] topic: '%s'", __func__, data_ptr->topic);
       ESP_LOGD(TAG, "[%s]   msg: '%s'", __func__, data_ptr->msg);
@@ -386,51 +393,11 @@ static esp_err_t parseMsg(const msg_t* msg) {
   return result;
 }
 
-/**
- * @brief Sensors task's function
- * 
- * @param param 
- */
-static void taskFn(void* param) {
-  msg_t msg;
-  bool loop = true;
-  esp_err_t result;
-
-  ESP_LOGI(TAG, "++%s()", __func__);
-  memset(&msg, 0x00, sizeof(msg_t));
-  initSensors();
-  while (loop) {
-    ESP_LOGD(TAG, "[%s] Wait...", __func__);
-    if(xQueueReceive(sensor_msg_queue, &msg, portMAX_DELAY) == pdTRUE) {
-      ESP_LOGD(TAG, "[%s] Message arrived: type: %d [%s], from: 0x%08lx, to: 0x%08lx", __func__, 
-          msg.type, GET_MSG_TYPE_NAME(msg.type),
-          msg.from, msg.to);
-      
-      result = parseMsg(&msg);
-      if (result == ESP_TASK_DONE) {
-        loop = false;
-        result = ESP_OK;
-      }
-
-      if (result != ESP_OK) {
-        // TODO - Send Error to the Broker
-        ESP_LOGE(TAG, "[%s] Error: %d", __func__, result);
-      }
-    } else {
-      ESP_LOGE(TAG, "[%s] Message error.", __func__);
-    }
-  }
-  if (sensor_sem_id) {
-    xSemaphoreGive(sensor_sem_id);
-  }
-  ESP_LOGI(TAG, "--%s()", __func__);
-}
-
 static esp_err_t send(const msg_t* msg) {
   esp_err_t result = ESP_OK;
 
   ESP_LOGI(TAG, "++%s()", __func__);
-  if (xQueueSend(sensor_msg_queue, msg, (TickType_t) 0) != pdPASS) {
+  if (executor_Post(sensor_unit, msg, (TickType_t) 0) != ESP_OK) {
     ESP_LOGE(TAG, "[%s] Message error. type: %d, from: 0x%08lx, to: 0x%08lx", __func__, msg->type, msg->from, msg->to);
     result = ESP_FAIL;
   }
@@ -443,26 +410,19 @@ static esp_err_t init(void) {
 
   ESP_LOGI(TAG, "++%s()", __func__);
 
-  /* Initialization message queue */
-  sensor_msg_queue = xQueueCreate(SENSOR_MSG_MAX, sizeof(msg_t));
-  if (sensor_msg_queue == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xQueueCreate() failed.", __func__);
-    return ESP_FAIL;
-  }
-
-  sensor_sem_id = xSemaphoreCreateCounting(1, 0);
-  if (sensor_sem_id == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xSemaphoreCreateCounting() failed.", __func__);
-    return ESP_FAIL;
-  }
+  initSensors();
 
-  /* Initialization thread */
-  xTaskCreate(taskFn, SENSOR_TASK_NAME, SENSOR_TASK_STACK_SIZE, NULL, SENSOR_TASK_PRIORITY, &sensor_task_id);
-  if (sensor_task_id == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xTaskCreate() failed.", __func__);
+  executor_cfg_t cfg = {
+    .name     = "sensor",
+    .module   = REG_SENSOR_CTRL,
+    .depth    = SENSOR_MSG_MAX,
+    .handler  = parseMsg,
+    .stack    = SENSOR_TASK_STACK_SIZE,
+    .priority = SENSOR_TASK_PRIORITY,
+  };
+  sensor_unit = executor_Create(&cfg);
+  if (sensor_unit == NULL) {
+    ESP_LOGE(TAG, "[%s] executor_Create() failed.", __func__);
     return ESP_FAIL;
   }
 
@@ -474,25 +434,17 @@ static esp_err_t done(void) {
   esp_err_t result = ESP_OK;
 
   ESP_LOGI(TAG, "++%s()", __func__);
-  if (sensor_sem_id) {
+  if (sensor_unit) {
     msg_t msg = {
       .type = MSG_TYPE_DONE,
       .from = REG_SENSOR_CTRL,
       .to = REG_SENSOR_CTRL,
     };
-    result = send(&msg);
-
-    ESP_LOGD(TAG, "[%s] Wait on xSemaphoreTake to finish task...", __func__);
-    xSemaphoreTake(sensor_sem_id, portMAX_DELAY);
-
-    vSemaphoreDelete(sensor_sem_id);
-    ESP_LOGD(TAG, "[%s] Semaphore deleted", __func__);
-
-    ESP_LOGD(TAG, "[%s] Task stopped", __func__);
-  }
-  if (sensor_msg_queue) {
-    vQueueDelete(sensor_msg_queue);
-    ESP_LOGD(TAG, "[%s] Queue deleted", __func__);
+    result = executor_Delete(sensor_unit, &msg);
+    if (result == ESP_OK) {
+      sensor_unit = NULL;
+      ESP_LOGD(TAG, "[%s] Unit deleted", __func__);
+    }
   }
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
   return result;
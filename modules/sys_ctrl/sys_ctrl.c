@@ -14,6 +14,8 @@
 
 #include "esp_log.h"
 #include "esp_mac.h"
+#include "esp_system.h"
+#include "esp_timer.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -23,9 +25,13 @@
 #include "sdkconfig.h"
 
 #include "err.h"
+#include "boot_seq.h"
 #include "msg.h"
+#include "bus_trace.h"
+#include "msg_pool.h"
 #include "mgr_ctrl.h"
 #include "sys_ctrl.h"
+#include "sys_state.h"
 #include "tools.h"
 
 #include "cJSON.h"
@@ -55,6 +61,10 @@ static SemaphoreHandle_t  sys_sem_id = NULL;
 static data_eth_mac_t     sys_esp_mac = {0};
 static data_uid_t         esp_uid = {0};
 
+/* Topics of this device, built when the UID arrives */
+static data_topic_t       sys_res_topic = {0};
+static data_topic_t       sys_event_topic = {0};
+
 #define SYS_NTP_DEFAULT_SERVER    CONFIG_SYS_CTRL_NTP_SERVER_DEFAULT
 #define SYS_NTP_SERVER_LEN        (64U)
 
@@ -64,11 +74,17 @@ static bool   sys_ntp_wait_pending = false;
 static int    sys_ntp_wait_retry = 0;
 static TickType_t sys_ntp_next_check_tick = 0;
 
+/* Boot report sent, see sysctrl_PublishBootReport() */
+static bool   sys_boot_reported = false;
+
 typedef enum {
   SYS_FIELDS_TIMEZONE = (1U << 0),
   SYS_FIELDS_TIME     = (1U << 1),
   SYS_FIELDS_NTP      = (1U << 2),
   SYS_FIELDS_ALL      = (SYS_FIELDS_TIMEZONE | SYS_FIELDS_TIME | SYS_FIELDS_NTP),
+  SYS_FIELDS_BUS      = (1U << 3),  /* only on explicit request, not part of "all" */
+  SYS_FIELDS_TRACE    = (1U << 4),  /* only on explicit request, not part of "all" */
+  SYS_FIELDS_BOOT     = (1U << 5),  /* only on explicit request, not part of "all" */
 } sys_fields_mask_e;
 
 static void sysctrl_GetTime(void);
@@ -84,6 +100,7 @@ static void sysctrl_GetTime(void);
 static void sysctrl_TimeSyncNotificationCb(struct timeval *tv)
 {
   ESP_LOGI(TAG, "[%s] Notification of a time synchronization event", __func__);
+  (void) sysstate_Set(SYSSTATE_TIME);
 }
 
 /**
@@ -336,7 +353,7 @@ static void sysctrl_GetTime(void) {
  * Blocks indefinitely when no SNTP wait is pending. When waiting for SNTP sync,
  * waits only until the next planned poll check tick.
  *
- * @return TickType_t Number of ticks to pass into xQueueReceive timeout
+ * @return TickType_t Number of ticks to pass into msgpool_Receive timeout
  */
 static TickType_t sysctrl_GetQueueWaitTicks(void) {
   if (!sys_ntp_wait_pending) {
@@ -394,11 +411,210 @@ static void sysctrl_BuildNtpInfo(cJSON* ntp_obj) {
     cJSON_AddItemToArray(servers, cJSON_CreateString(sys_ntp_servers[idx]));
   }
 
-  sntp_sync_status_t status = sntp_get_sync_status();
-  bool synced = (status == SNTP_SYNC_STATUS_COMPLETED) || (status == SNTP_SYNC_STATUS_IN_PROGRESS);
+  /* sntp_get_sync_status() resets COMPLETED once read, the flag stays up */
+  bool synced = (sysstate_GetFlags() & SYSSTATE_TIME) != 0U;
   cJSON_AddBoolToObject(ntp_obj, "synced", synced);
 }
 
+/**
+ * @brief Build message bus backpressure JSON object
+ *
+ * Adds total drop/coalesce counters, per-queue depth, high-water mark and drops
+ * (only queues which were used), per-producer drop counters and the supervisor
+ * counters of modules which had a fault, a stall or a restart. Arrays are kept
+ * compact so the report fits in one MQTT message.
+ *
+ * @param bus_obj cJSON object to fill with bus data
+ */
+static void sysctrl_BuildBusInfo(cJSON* bus_obj) {
+  msgpool_stats_t       stats;
+  msgpool_queue_info_t  queues[MSGPOOL_QUEUE_MAX];
+  mgr_drop_t            drops[MSGPOOL_DROP_MAX];
+  mgr_sup_stats_t       sup[REG_BIT_MAX];
+  uint32_t              cnt;
+
+  if (!bus_obj) {
+    return;
+  }
+
+  msgpool_GetStats(&stats);
+  cJSON_AddNumberToObject(bus_obj, "dropped", (double) stats.dropped);
+  cJSON_AddNumberToObject(bus_obj, "coalesced", (double) stats.coalesced);
+  cJSON_AddNumberToObject(bus_obj, "expired", (double) stats.expired);
+
+  /* "queues": [[name, depth, hwm, dropped], ...] */
+  cJSON* queues_arr = cJSON_AddArrayToObject(bus_obj, "queues");
+  cnt = msgpool_GetQueueInfo(queues, MSGPOOL_QUEUE_MAX);
+  for (uint32_t idx = 0; queues_arr && (idx < cnt); ++idx) {
+    if ((queues[idx].hwm == 0) && (queues[idx].dropped == 0)) {
+      continue;
+    }
+    cJSON* item = cJSON_CreateArray();
+    cJSON_AddItemToArray(item, cJSON_CreateString(queues[idx].name));
+    cJSON_AddItemToArray(item, cJSON_CreateNumber((double) queues[idx].depth));
+    cJSON_AddItemToArray(item, cJSON_CreateNumber((double) queues[idx].hwm));
+    cJSON_AddItemToArray(item, cJSON_CreateNumber((double) queues[idx].dropped));
+    cJSON_AddItemToArray(queues_arr, item);
+  }
+
+  /* "drops": [[from, to, count], ...] */
+  cJSON* drops_arr = cJSON_AddArrayToObject(bus_obj, "drops");
+  cnt = MGR_GetDrops(drops, MSGPOOL_DROP_MAX);
+  for (uint32_t idx = 0; drops_arr && (idx < cnt); ++idx) {
+    cJSON* item = cJSON_CreateArray();
+    cJSON_AddItemToArray(item, cJSON_CreateString(drops[idx].from));
+    cJSON_AddItemToArray(item, cJSON_CreateString(drops[idx].to));
+    cJSON_AddItemToArray(item, cJSON_CreateNumber((double) drops[idx].count));
+    cJSON_AddItemToArray(drops_arr, item);
+  }
+
+  /* "sup": [[module, faults, restarts, stalls], ...] */
+  cJSON* sup_arr = cJSON_AddArrayToObject(bus_obj, "sup");
+  cnt = MGR_GetSupStats(sup, REG_BIT_MAX);
+  for (uint32_t idx = 0; sup_arr && (idx < cnt); ++idx) {
+    if ((sup[idx].faults == 0) && (sup[idx].restarts == 0) && (sup[idx].stalls == 0)) {
+      continue;
+    }
+    cJSON* item = cJSON_CreateArray();
+    cJSON_AddItemToArray(item, cJSON_CreateString(sup[idx].name));
+    cJSON_AddItemToArray(item, cJSON_CreateNumber((double) sup[idx].faults));
+    cJSON_AddItemToArray(item, cJSON_CreateNumber((double) sup[idx].restarts));
+    cJSON_AddItemToArray(item, cJSON_CreateNumber((double) sup[idx].stalls));
+    cJSON_AddItemToArray(sup_arr, item);
+  }
+}
+
+/** Max number of slowest (type, stage) pairs in the trace report. */
+#define SYS_TRACE_WORST_MAX     (4U)
+
+/**
+ * @brief Build message bus latency JSON object
+ *
+ * Merges the per-type histograms of the bus trace into one line per stage
+ * (`[count, p50, p99]` in us) and lists the slowest (type, stage) pairs by p99
+ * as `[type, stage, count, p99]`. Percentiles are bucket upper bounds, -1 for
+ * the open-ended last bucket. Per-type detail is in the CLI (`bus trace`).
+ *
+ * @param trace_obj cJSON object to fill with trace data
+ */
+static void sysctrl_BuildTraceInfo(cJSON* trace_obj) {
+#if CONFIG_MGR_BUS_TRACE_ENABLE
+  uint32_t total[BUS_STAGE_MAX][BUS_TRACE_BUCKET_MAX] = { 0 };
+  uint32_t worst[SYS_TRACE_WORST_MAX][4] = { 0 };
+  uint32_t worst_cnt = 0;
+
+  if (!trace_obj) {
+    return;
+  }
+
+  for (int type = 0; type < MSG_TYPE_MAX; ++type) {
+    for (int stage = 0; stage < BUS_STAGE_MAX; ++stage) {
+      uint32_t buckets[BUS_TRACE_BUCKET_MAX];
+      uint32_t count = bustrace_GetHist((msg_type_e) type, (bus_stage_e) stage, buckets);
+
+      if (count == 0) {
+        continue;
+      }
+      for (uint32_t bucket = 0; bucket < BUS_TRACE_BUCKET_MAX; ++bucket) {
+        total[stage][bucket] += buckets[bucket];
+      }
+
+      /* Keep the slowest pairs sorted by p99, descending */
+      uint32_t p99 = bustrace_GetPercentile(buckets, 99);
+      uint32_t pos = worst_cnt;
+      while ((pos > 0) && (worst[pos - 1][3] < p99)) {
+        if (pos < SYS_TRACE_WORST_MAX) {
+          memcpy(worst[pos], worst[pos - 1], sizeof(worst[pos]));
+        }
+        --pos;
+      }
+      if (pos < SYS_TRACE_WORST_MAX) {
+        worst[pos][0] = (uint32_t) type;
+        worst[pos][1] = (uint32_t) stage;
+        worst[pos][2] = count;
+        worst[pos][3] = p99;
+        if (worst_cnt < SYS_TRACE_WORST_MAX) {
+          ++worst_cnt;
+        }
+      }
+    }
+  }
+
+  /* "stages": [[count, p50, p99], ...] in bus_stage_e order */
+  cJSON* stages_arr = cJSON_AddArrayToObject(trace_obj, "stages");
+  for (int stage = 0; stages_arr && (stage < BUS_STAGE_MAX); ++stage) {
+    uint32_t count = 0;
+    for (uint32_t bucket = 0; bucket < BUS_TRACE_BUCKET_MAX; ++bucket) {
+      count += total[stage][bucket];
+    }
+    uint32_t p50 = bustrace_GetPercentile(total[stage], 50);
+    uint32_t p99 = bustrace_GetPercentile(total[stage], 99);
+    cJSON* item = cJSON_CreateArray();
+    cJSON_AddItemToArray(item, cJSON_CreateNumber((double) count));
+    cJSON_AddItemToArray(item, cJSON_CreateNumber((p50 == UINT32_MAX) ? -1.0 : (double) p50));
+    cJSON_AddItemToArray(item, cJSON_CreateNumber((p99 == UINT32_MAX) ? -1.0 : (double) p99));
+    cJSON_AddItemToArray(stages_arr, item);
+  }
+
+  /* "worst": [[type, stage, count, p99], ...] */
+  cJSON* worst_arr = cJSON_AddArrayToObject(trace_obj, "worst");
+  for (uint32_t idx = 0; worst_arr && (idx < worst_cnt); ++idx) {
+    cJSON* item = cJSON_CreateArray();
+    cJSON_AddItemToArray(item, cJSON_CreateNumber((double) worst[idx][0]));
+    cJSON_AddItemToArray(item, cJSON_CreateNumber((double) worst[idx][1]));
+    cJSON_AddItemToArray(item, cJSON_CreateNumber((double) worst[idx][2]));
+    cJSON_AddItemToArray(item, cJSON_CreateNumber((worst[idx][3] == UINT32_MAX) ? -1.0 : (double) worst[idx][3]));
+    cJSON_AddItemToArray(worst_arr, item);
+  }
+#else
+  (void) trace_obj;
+#endif /* CONFIG_MGR_BUS_TRACE_ENABLE */
+}
+
+/**
+ * @brief Build boot timing JSON object
+ *
+ * `marks` holds the milestones of boot_seq.h in bootseq_mark_e order, in ms
+ * since boot (-1 if not reached yet); each phase is `[wall, serial, workers, path]`
+ * with the times in ms and the critical path as "eth>wifi>mqtt". The per-module
+ * times are sent as separate events, see sysctrl_PrepareBootPhaseEvent().
+ *
+ * @param boot_obj cJSON object to fill with boot data
+ */
+static void sysctrl_BuildBootInfo(cJSON* boot_obj) {
+  if (!boot_obj) {
+    return;
+  }
+
+  cJSON* marks_arr = cJSON_AddArrayToObject(boot_obj, "marks");
+  for (int mark = 0; marks_arr && (mark < BOOTSEQ_MARK_MAX); ++mark) {
+    uint32_t at = bootseq_GetMark((bootseq_mark_e) mark);
+    cJSON_AddItemToArray(marks_arr, cJSON_CreateNumber((at != 0) ? (double) (at / 1000U) : -1.0));
+  }
+
+  for (int phase = 0; phase < BOOTSEQ_PHASE_MAX; ++phase) {
+    const bootseq_phase_t* info = bootseq_GetPhase((bootseq_phase_e) phase);
+    const bootseq_step_t* steps = bootseq_GetSteps((bootseq_phase_e) phase);
+    char path[64] = "";
+    int len = 0;
+
+    if (info == NULL) {
+      continue;
+    }
+    for (uint32_t pos = 0; (pos < info->path_cnt) && (len < (int) sizeof(path)); ++pos) {
+      len += snprintf(&path[len], sizeof(path) - len, "%s%s", (pos > 0) ? ">" : "",
+          MGR_GetModuleName(1UL << steps[info->path[pos]].id));
+    }
+    cJSON* item = cJSON_AddArrayToObject(boot_obj, bootseq_GetPhaseName((bootseq_phase_e) phase));
+    if (item) {
+      cJSON_AddItemToArray(item, cJSON_CreateNumber((double) ((info->end_us - info->begin_us) / 1000U)));
+      cJSON_AddItemToArray(item, cJSON_CreateNumber((double) (info->busy_us / 1000U)));
+      cJSON_AddItemToArray(item, cJSON_CreateNumber((double) info->workers));
+      cJSON_AddItemToArray(item, cJSON_CreateString(path));
+    }
+  }
+}
+
 /**
  * @brief Parse requested fields list into a bitmask
  *
@@ -424,6 +640,12 @@ static sys_fields_mask_e sysctrl_ParseFields(const cJSON* fields) {
       mask |= SYS_FIELDS_TIME;
     } else if (strcmp(field->valuestring, "ntp") == 0) {
       mask |= SYS_FIELDS_NTP;
+    } else if (strcmp(field->valuestring, "bus") == 0) {
+      mask |= SYS_FIELDS_BUS;
+    } else if (strcmp(field->valuestring, "trace") == 0) {
+      mask |= SYS_FIELDS_TRACE;
+    } else if (strcmp(field->valuestring, "boot") == 0) {
+      mask |= SYS_FIELDS_BOOT;
     }
   }
 
@@ -520,9 +742,39 @@ static esp_err_t sysctrl_PrepareResponseMask(sys_fields_mask_e fields_mask, cons
     sysctrl_BuildNtpInfo(ntp_obj);
   }
 
+  if (fields_mask & SYS_FIELDS_BUS) {
+    cJSON* bus_obj = cJSON_AddObjectToObject(response, "bus");
+    if (bus_obj == NULL) {
+      ESP_LOGE(TAG, "[%s] cJSON_AddObjectToObject(response, \"bus\") failed", __func__);
+      cJSON_Delete(response);
+      return ESP_FAIL;
+    }
+    sysctrl_BuildBusInfo(bus_obj);
+  }
+
+  if (fields_mask & SYS_FIELDS_TRACE) {
+    cJSON* trace_obj = cJSON_AddObjectToObject(response, "trace");
+    if (trace_obj == NULL) {
+      ESP_LOGE(TAG, "[%s] cJSON_AddObjectToObject(response, \"trace\") failed", __func__);
+      cJSON_Delete(response);
+      return ESP_FAIL;
+    }
+    sysctrl_BuildTraceInfo(trace_obj);
+  }
+
+  if (fields_mask & SYS_FIELDS_BOOT) {
+    cJSON* boot_obj = cJSON_AddObjectToObject(response, "boot");
+    if (boot_obj == NULL) {
+      ESP_LOGE(TAG, "[%s] cJSON_AddObjectToObject(response, \"boot\") failed", __func__);
+      cJSON_Delete(response);
+      return ESP_FAIL;
+    }
+    sysctrl_BuildBootInfo(boot_obj);
+  }
+
   int ret = cJSON_PrintPreallocated(response, msg.payload.mqtt.u.data.msg, DATA_MSG_SIZE, 0);
   if (ret == 1) {
-    snprintf(msg.payload.mqtt.u.data.topic, DATA_TOPIC_SIZE, "%s/res/sys", esp_uid);
+    memcpy(msg.payload.mqtt.u.data.topic, sys_res_topic, sizeof(data_topic_t));
     result = MGR_Send(&msg);
     if (result != ESP_OK) {
       ESP_LOGE(TAG, "[%s] MGR_Send() - Error: %d", __func__, result);
@@ -584,9 +836,14 @@ static esp_err_t sysctrl_PrepareEventMask(sys_fields_mask_e fields_mask, const c
     sysctrl_BuildNtpInfo(ntp_obj);
   }
 
+  if (fields_mask & SYS_FIELDS_BOOT) {
+    cJSON* boot_obj = cJSON_AddObjectToObject(event, "boot");
+    sysctrl_BuildBootInfo(boot_obj);
+  }
+
   int ret = cJSON_PrintPreallocated(event, msg.payload.mqtt.u.data.msg, DATA_MSG_SIZE, 0);
   if (ret == 1) {
-    snprintf(msg.payload.mqtt.u.data.topic, DATA_TOPIC_SIZE, "%s/event/sys", esp_uid);
+    memcpy(msg.payload.mqtt.u.data.topic, sys_event_topic, sizeof(data_topic_t));
     result = MGR_Send(&msg);
     if (result != ESP_OK) {
       ESP_LOGE(TAG, "[%s] MGR_Send() - Error: %d", __func__, result);
@@ -601,6 +858,82 @@ static esp_err_t sysctrl_PrepareEventMask(sys_fields_mask_e fields_mask, const c
   return result;
 }
 
+/**
+ * @brief Send the per-module times of one boot phase as a SYS event
+ *
+ * `{"boot":{"phase":"init","modules":[[name, start, took], ...]}}` with `start`
+ * in ms from the beginning of the phase. One event per phase keeps each of
+ * them within DATA_MSG_SIZE.
+ *
+ * @param phase Boot phase to report
+ * @return esp_err_t ESP_OK on success, or an error code on failure
+ */
+static esp_err_t sysctrl_PrepareBootPhaseEvent(bootseq_phase_e phase) {
+  const bootseq_phase_t* info = bootseq_GetPhase(phase);
+  const bootseq_step_t* steps = bootseq_GetSteps(phase);
+  msg_t msg = {
+    .type = MSG_TYPE_MQTT_PUBLISH,
+    .from = REG_SYS_CTRL,
+    .to = REG_MQTT_CTRL,
+  };
+  esp_err_t result = ESP_FAIL;
+
+  ESP_LOGI(TAG, "++%s(phase: %s)", __func__, bootseq_GetPhaseName(phase));
+  if (info == NULL) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  cJSON* event = cJSON_CreateObject();
+  if (event == NULL) {
+    return ESP_FAIL;
+  }
+
+  cJSON_AddStringToObject(event, "operation", "event");
+  cJSON_AddStringToObject(event, "status", "ok");
+  cJSON* boot_obj = cJSON_AddObjectToObject(event, "boot");
+  cJSON_AddStringToObject(boot_obj, "phase", bootseq_GetPhaseName(phase));
+  cJSON* modules_arr = cJSON_AddArrayToObject(boot_obj, "modules");
+  for (uint32_t idx = 0; modules_arr && (idx < info->cnt); ++idx) {
+    cJSON* item = cJSON_CreateArray();
+    cJSON_AddItemToArray(item, cJSON_CreateString(MGR_GetModuleName(1UL << steps[idx].id)));
+    cJSON_AddItemToArray(item, cJSON_CreateNumber((double) ((steps[idx].begin_us - info->begin_us) / 1000U)));
+    cJSON_AddItemToArray(item, cJSON_CreateNumber((double) ((steps[idx].end_us - steps[idx].begin_us) / 1000U)));
+    cJSON_AddItemToArray(modules_arr, item);
+  }
+
+  int ret = cJSON_PrintPreallocated(event, msg.payload.mqtt.u.data.msg, DATA_MSG_SIZE, 0);
+  if (ret == 1) {
+    memcpy(msg.payload.mqtt.u.data.topic, sys_event_topic, sizeof(data_topic_t));
+    result = MGR_Send(&msg);
+    if (result != ESP_OK) {
+      ESP_LOGE(TAG, "[%s] MGR_Send() - Error: %d", __func__, result);
+    }
+  } else {
+    ESP_LOGE(TAG, "[%s] cJSON_PrintPreallocated() - Error: %d", __func__, ret);
+  }
+
+  cJSON_Delete(event);
+
+  ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
+  return result;
+}
+
+/**
+ * @brief Publish the boot report once, on the first MQTT connection
+ *
+ * A summary event (`boot` field) followed by one event per phase.
+ */
+static void sysctrl_PublishBootReport(void) {
+  if (sys_boot_reported) {
+    return;
+  }
+  sys_boot_reported = true;
+  (void) sysctrl_PrepareEventMask(SYS_FIELDS_BOOT, "ok", ESP_OK, NULL);
+  for (int phase = 0; phase < BOOTSEQ_PHASE_MAX; ++phase) {
+    (void) sysctrl_PrepareBootPhaseEvent((bootseq_phase_e) phase);
+  }
+}
+
 /**
  * @brief Prepare and send MQTT response for SYS get request
  *
@@ -630,6 +963,7 @@ static esp_err_t sysctrl_SetTimeUnix(time_t unix_time) {
   }
 
   sntp_set_sync_status(SNTP_SYNC_STATUS_COMPLETED);
+  (void) sysstate_Set(SYSSTATE_TIME);
   return ESP_OK;
 }
 
@@ -853,6 +1187,30 @@ static esp_err_t sysctrl_EthNotify(data_eth_event_e event_id) {
   return result;
 }
 
+/**
+ * @brief Answer an MSG_TYPE_SYS_INFO_REQ call with uptime, heap and time
+ *
+ * @param msg Request, received with a correlation id
+ * @return esp_err_t ESP_OK on success, or an error code on failure
+ */
+static esp_err_t sysctrl_ReplyInfo(const msg_t* msg) {
+  msg_t reply = {
+    .from = REG_SYS_CTRL,
+  };
+  data_sys_info_t* info = &reply.payload.reply.u.sys;
+
+  info->uptime_s = (uint32_t) (esp_timer_get_time() / 1000000);
+  info->heap_free = esp_get_free_heap_size();
+  info->heap_min = esp_get_minimum_free_heap_size();
+  info->time = (uint32_t) time(NULL);
+  info->synced = (sysstate_GetFlags() & SYSSTATE_TIME) != 0U;
+  memcpy(info->uid, esp_uid, sizeof(info->uid));
+  reply.payload.reply.result = ESP_OK;
+
+  ESP_LOGD(TAG, "[%s] call: %lu, uptime: %lu s, heap: %lu", __func__, msg->call, info->uptime_s, info->heap_free);
+  return MGR_Reply(msg, &reply);
+}
+
 /**
  * @brief Parse incoming messages
  * 
@@ -887,6 +1245,8 @@ static esp_err_t sysctrl_ParseMsg(const msg_t* msg) {
       esp_uid[uid_len] = '\0';
 
       ESP_LOGD(TAG, "[%s] UID: '%s'", __func__, esp_uid);
+      snprintf(sys_res_topic, sizeof(sys_res_topic), "%s/res/sys", esp_uid);
+      snprintf(sys_event_topic, sizeof(sys_event_topic), "%s/event/sys", esp_uid);
       break;
     }
 
@@ -898,11 +1258,14 @@ static esp_err_t sysctrl_ParseMsg(const msg_t* msg) {
     case MSG_TYPE_MQTT_EVENT: {
       data_mqtt_event_e event_id = msg->payload.mqtt.u.event_id;
       ESP_LOGD(TAG, "[%s] event_id: %d [%s]", __func__, event_id, GET_DATA_MQTT_EVENT_NAME(event_id));
+      if (event_id == DATA_MQTT_EVENT_CONNECTED) {
+        sysctrl_PublishBootReport();
+      }
       break;
     }
 
     case MSG_TYPE_MQTT_DATA: {
-      const data_mqtt_data_t* data_ptr = &(msg->payload.mqtt.u.data);
+      const data_mqtt_in_t* data_ptr = &(msg->payload.mqtt.u.in);
 
       ESP_LOGD(TAG, "[%s] topic: '%s'", __func__, data_ptr->topic);
       ESP_LOGD(TAG, "[%s]   msg: '%s'", __func__, data_ptr->msg);
@@ -910,6 +1273,11 @@ static esp_err_t sysctrl_ParseMsg(const msg_t* msg) {
       break;
     }
 
+    case MSG_TYPE_SYS_INFO_REQ: {
+      result = sysctrl_ReplyInfo(msg);
+      break;
+    }
+
     default: {
       result = ESP_FAIL;
       break;
@@ -925,12 +1293,11 @@ static esp_err_t sysctrl_ParseMsg(const msg_t* msg) {
  * @param param 
  */
 static void sysctrl_TaskFn(void* param) {
-  msg_t msg;
+  msg_t* msg = NULL;
   bool loop = true;
   esp_err_t result;
 
   ESP_LOGI(TAG, "++%s()", __func__);
-  memset(&msg, 0x00, sizeof(msg_t));
 
   sysctrl_InitTimeZone();
 
@@ -941,12 +1308,23 @@ static void sysctrl_TaskFn(void* param) {
 
   while (loop) {
     TickType_t wait_ticks = sysctrl_GetQueueWaitTicks();
-    if (xQueueReceive(sys_msg_queue, &msg, wait_ticks) == pdTRUE) {
+    if (msgpool_Receive(sys_msg_queue, &msg, wait_ticks) == ESP_OK) {
       ESP_LOGD(TAG, "[%s] Message arrived: type: %d [%s], from: 0x%08lx, to: 0x%08lx", __func__, 
-          msg.type, GET_MSG_TYPE_NAME(msg.type),
-          msg.from, msg.to);
-      
-      result = sysctrl_ParseMsg(&msg);
+          msg->type, GET_MSG_TYPE_NAME(msg->type),
+          msg->from, msg->to);
+
+      if (msgpool_IsExpired(msg)) {
+        /* Stale: waited on the bus past its TTL, not worth parsing */
+        msgpool_Release(msg);
+        MGR_Heartbeat(REG_SYS_CTRL);
+        continue;
+      }
+
+      int64_t trace = bustrace_ModBegin(REG_SYS_CTRL, msg);
+      result = sysctrl_ParseMsg(msg);
+      bustrace_ModEnd(REG_SYS_CTRL, msg, trace);
+      msgpool_Release(msg);
+      MGR_Heartbeat(REG_SYS_CTRL);
       if (result == ESP_TASK_DONE) {
         loop = false;
         result = ESP_OK;
@@ -976,7 +1354,7 @@ static esp_err_t sysctrl_Send(const msg_t* msg) {
   esp_err_t result = ESP_OK;
 
   ESP_LOGI(TAG, "++%s()", __func__);
-  if (xQueueSend(sys_msg_queue, msg, (TickType_t) 0) != pdPASS) {
+  if (msgpool_Post(sys_msg_queue, msg, (TickType_t) 0) != ESP_OK) {
     ESP_LOGE(TAG, "[%s] Message error. type: %d, from: 0x%08lx, to: 0x%08lx", __func__, msg->type, msg->from, msg->to);
     result = ESP_FAIL;
   }
@@ -995,7 +1373,7 @@ static esp_err_t sysctrl_Init(void) {
   ESP_LOGI(TAG, "++%s()", __func__);
 
   /* Initialization message queue */
-  sys_msg_queue = xQueueCreate(SYS_MSG_MAX, sizeof(msg_t));
+  sys_msg_queue = msgpool_CreateQueue("sys", SYS_MSG_MAX);
   if (sys_msg_queue == NULL)
   {
     ESP_LOGE(TAG, "[%s] xQueueCreate() failed.", __func__);
@@ -1053,7 +1431,7 @@ static esp_err_t sysctrl_Done(void) {
     ESP_LOGD(TAG, "[%s] Task stopped", __func__);
   }
   if (sys_msg_queue) {
-    vQueueDelete(sys_msg_queue);
+    msgpool_DeleteQueue(sys_msg_queue);
     ESP_LOGD(TAG, "[%s] Queue deleted", __func__);
   }
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
@@ -22,13 +22,14 @@
 #include "err.h"
 #include "mgr_ctrl.h"
 #include "msg.h"
+#include "executor.h"
+#include "msg_pool.h"
 #include "template_ctrl.h"
 
 #include "err.h"
 #include "lut.h"
 
 
-#define TEMPLATE_TASK_NAME          "template-task"
 #define TEMPLATE_TASK_STACK_SIZE    4096
 #define TEMPLATE_TASK_PRIORITY      12
 
@@ -38,12 +39,13 @@
 static const char* TAG = "ESP::TEMPLATE";
 
 
-static QueueHandle_t      template_msg_queue = NULL;
-static TaskHandle_t       template_task_id = NULL;
-static SemaphoreHandle_t  template_sem_id = NULL;
+static executor_unit_t*   template_unit = NULL;
 
 static data_uid_t         esp_uid = {0};
 
+/* Topics of this device, built when the UID arrives */
+static data_topic_t       template_res_topic = {0};
+
 
 static esp_err_t templatectrl_PrepareResponse(const char* request_operation) {
   msg_t msg = {
@@ -64,7 +66,7 @@ static esp_err_t templatectrl_PrepareResponse(const char* request_operation) {
 
     ret = cJSON_PrintPreallocated(response, msg.payload.mqtt.u.data.msg, DATA_MSG_SIZE, 0);
     if (ret == 1) {
-      snprintf(msg.payload.mqtt.u.data.topic, DATA_TOPIC_SIZE, "%s/res/template", esp_uid);
+      memcpy(msg.payload.mqtt.u.data.topic, template_res_topic, sizeof(data_topic_t));
       result = MGR_Send(&msg);
       if (result != ESP_OK) {
         ESP_LOGE(TAG, "[%s] MGR_Send() - Error: %d", __func__, result);
@@ -161,6 +163,7 @@ static esp_err_t templatectrl_ParseMsg(const msg_t* msg) {
       esp_uid[uid_len] = '\0';
 
       ESP_LOGD(TAG, "[%s] UID: '%s'", __func__, esp_uid);
+      snprintf(template_res_topic, sizeof(template_res_topic), "%s/res/template", esp_uid);
       break;
     }
 
@@ -171,7 +174,7 @@ static esp_err_t templatectrl_ParseMsg(const msg_t* msg) {
     }
 
     case MSG_TYPE_MQTT_DATA: {
-      const data_mqtt_data_t* data_ptr = &(msg->payload.mqtt.u.data);
+      const data_mqtt_in_t* data_ptr = &(msg->payload.mqtt.u.in);
 
       ESP_LOGD(TAG, "[%s] topic: '%s'", __func__, data_ptr->topic);
       ESP_LOGD(TAG, "[%s]   msg: '%s'", __func__, data_ptr->msg);
@@ -188,50 +191,11 @@ static esp_err_t templatectrl_ParseMsg(const msg_t* msg) {
   return result;
 }
 
-/**
- * @brief Template task's function
- * 
- * @param param 
- */
-static void templatectrl_TaskFn(void* param) {
-  msg_t msg;
-  bool loop = true;
-  esp_err_t result;
-
-  ESP_LOGI(TAG, "++%s()", __func__);
-  memset(&msg, 0x00, sizeof(msg_t));
-  while (loop) {
-    ESP_LOGD(TAG, "[%s] Wait...", __func__);
-    if(xQueueReceive(template_msg_queue, &msg, portMAX_DELAY) == pdTRUE) {
-      ESP_LOGD(TAG, "[%s] Message arrived: type: %d [%s], from: 0x%08lx, to: 0x%08lx", __func__, 
-          msg.type, GET_MSG_TYPE_NAME(msg.type),
-          msg.from, msg.to);
-      
-      result = templatectrl_ParseMsg(&msg);
-      if (result == ESP_TASK_DONE) {
-        loop = false;
-        result = ESP_OK;
-      }
-
-      if (result != ESP_OK) {
-        // TODO - Send Error to the Broker
-        ESP_LOGE(TAG, "[%s] Error: %d", __func__, result);
-      }
-    } else {
-      ESP_LOGE(TAG, "[%s] Message error.", __func__);
-    }
-  }
-  if (template_sem_id) {
-    xSemaphoreGive(template_sem_id);
-  }
-  ESP_LOGI(TAG, "--%s()", __func__);
-}
-
 static esp_err_t templatectrl_Send(const msg_t* msg) {
   esp_err_t result = ESP_OK;
 
   ESP_LOGI(TAG, "++%s()", __func__);
-  if (xQueueSend(template_msg_queue, msg, (TickType_t) 0) != pdPASS) {
+  if (executor_Post(template_unit, msg, (TickType_t) 0) != ESP_OK) {
     ESP_LOGE(TAG, "[%s] Message error. type: %d, from: 0x%08lx, to: 0x%08lx", __func__, msg->type, msg->from, msg->to);
     result = ESP_FAIL;
   }
@@ -244,26 +208,17 @@ static esp_err_t templatectrl_Init(void) {
 
   ESP_LOGI(TAG, "++%s()", __func__);
 
-  /* Initialization message queue */
-  template_msg_queue = xQueueCreate(TEMPLATE_MSG_MAX, sizeof(msg_t));
-  if (template_msg_queue == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xQueueCreate() failed.", __func__);
-    return ESP_FAIL;
-  }
-
-  template_sem_id = xSemaphoreCreateCounting(1, 0);
-  if (template_sem_id == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xSemaphoreCreateCounting() failed.", __func__);
-    return ESP_FAIL;
-  }
-
-  /* Initialization thread */
-  xTaskCreate(templatectrl_TaskFn, TEMPLATE_TASK_NAME, TEMPLATE_TASK_STACK_SIZE, NULL, TEMPLATE_TASK_PRIORITY, &template_task_id);
-  if (template_task_id == NULL)
-  {
-    ESP_LOGE(TAG, "[%s] xTaskCreate() failed.", __func__);
+  executor_cfg_t cfg = {
+    .name     = "template",
+    .module   = REG_XXX_CTRL,
+    .depth    = TEMPLATE_MSG_MAX,
+    .handler  = templatectrl_ParseMsg,
+    .stack    = TEMPLATE_TASK_STACK_SIZE,
+    .priority = TEMPLATE_TASK_PRIORITY,
+  };
+  template_unit = executor_Create(&cfg);
+  if (template_unit == NULL) {
+    ESP_LOGE(TAG, "[%s] executor_Create() failed.", __func__);
     return ESP_FAIL;
   }
 
@@ -275,25 +230,17 @@ static esp_err_t templatectrl_Done(void) {
   esp_err_t result = ESP_OK;
 
   ESP_LOGI(TAG, "++%s()", __func__);
-  if (template_sem_id) {
+  if (template_unit) {
     msg_t msg = {
       .type = MSG_TYPE_DONE,
       .from = REG_XXX_CTRL,
       .to = REG_XXX_CTRL,
     };
-    result = templatectrl_Send(&msg);
-
-    ESP_LOGD(TAG, "[%s] Wait on xSemaphoreTake to finish task...", __func__);
-    xSemaphoreTake(template_sem_id, portMAX_DELAY);
-
-    vSemaphoreDelete(template_sem_id);
-    ESP_LOGD(TAG, "[%s] Semaphore deleted", __func__);
-
-    ESP_LOGD(TAG, "[%s] Task stopped", __func__);
-  }
-  if (template_msg_queue) {
-    vQueueDelete(template_msg_queue);
-    ESP_LOGD(TAG, "[%s] Queue deleted", __func__);
+    result = executor_Delete(template_unit, &msg);
+    if (result == ESP_OK) {
+      template_unit = NULL;
+      ESP_LOGD(TAG, "[%s] Unit deleted", __func__);
+    }
   }
   ESP_LOGI(TAG, "--%s() - result: %d", __func__, result);
   return result;
@@ -26,10 +26,16 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#include "boot_seq.h"
+#include "data_snap.h"
+#include "data_types.h"
 #include "err.h"
 #include "lut.h"
 #include "mgr_ctrl.h"
 #include "msg.h"
+#include "bus_trace.h"
+#include "msg_pool.h"
+#include "sys_state.h"
 #include "wifi_ctrl.h"
 
 /**
@@ -135,6 +141,7 @@ static void wifictrl_OnIpEvent(void *arg, esp_event_base_t event_base, int32_t e
   if (event_id != IP_EVENT_STA_GOT_IP) {
     return;
   }
+  bootseq_Mark(BOOTSEQ_MARK_IP);
 
   msg_t msg = {
     .type = MSG_TYPE_WIFI_CTRL_GOT_IP,
@@ -179,6 +186,7 @@ static esp_err_t wifictrl_PublishStaIpAndMac(void)
 
   ESP_LOGI(TAG, "WiFi got IP: " IPSTR " mask " IPSTR " gw " IPSTR,
            IP2STR(&ip_info.ip), IP2STR(&ip_info.netmask), IP2STR(&ip_info.gw));
+  (void)sysstate_SetIp(SYSSTATE_NETIF_WIFI, ip_info.ip.addr);
 
   err = MGR_Send(&msg);
   if (err != ESP_OK) {
@@ -228,11 +236,16 @@ static void wifictrl_OnWifiEvent(void *arg, esp_event_base_t event_base, int32_t
       break;
     }
     case WIFI_EVENT_STA_CONNECTED: {
+      bootseq_Mark(BOOTSEQ_MARK_LINK);
+      (void)sysstate_Set(SYSSTATE_WIFI_LINK);
       (void)wifictrl_SendWifiEvent(DATA_WIFI_EVENT_CONNECTED);
       break;
     }
     case WIFI_EVENT_STA_DISCONNECTED: {
-      (void)wifictrl_SendWifiEvent(DATA_WIFI_EVENT_DISCONNECTED);
+      /* Sent on every failed attempt as well; broadcast the transition only */
+      if (sysstate_Clear(SYSSTATE_WIFI_LINK)) {
+        (void)wifictrl_SendWifiEvent(DATA_WIFI_EVENT_DISCONNECTED);
+      }
       break;
     }
     default: {
@@ -241,12 +254,54 @@ static void wifictrl_OnWifiEvent(void *arg, esp_event_base_t event_base, int32_t
   }
 }
 
+static wifi_ui_security_e wifictrl_UiSecurity(wifi_auth_mode_t authmode)
+{
+  switch (authmode) {
+    case WIFI_AUTH_OPEN:          return WIFI_UI_SEC_OPEN;
+    case WIFI_AUTH_WEP:           return WIFI_UI_SEC_WEP;
+    case WIFI_AUTH_WPA_PSK:       return WIFI_UI_SEC_WPA_PSK;
+    case WIFI_AUTH_WPA2_PSK:
+    case WIFI_AUTH_WPA_WPA2_PSK:  return WIFI_UI_SEC_WPA2_PSK;
+    case WIFI_AUTH_WPA3_PSK:
+    case WIFI_AUTH_WPA2_WPA3_PSK: return WIFI_UI_SEC_WPA3_PSK;
+    default:                      return WIFI_UI_SEC_OTHER;
+  }
+}
+
+/**
+ * @brief Publish the rows of `s_ap_records` as the `DATA_TYPE_WIFI_SCAN_LIST` snapshot.
+ *
+ * Readers (`MGR_GetData()`, `datasnap_Acquire()`) get this copy, never `s_ap_records`,
+ * so the next scan can rewrite the buffer while they still read the previous list.
+ */
+static esp_err_t wifictrl_PublishScanList(void)
+{
+  data_snap_t *snap = datasnap_Alloc(DATA_TYPE_WIFI_SCAN_LIST, s_ap_count, s_ap_count * sizeof(wifi_ui_ap_row_t));
+  if (snap == NULL) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  wifi_ui_ap_row_t *rows = (wifi_ui_ap_row_t *)snap->buf;
+  for (uint16_t i = 0; i < s_ap_count; ++i) {
+    const wifi_ap_record_t *ap = &s_ap_records[i];
+    size_t sl = strnlen((const char *)ap->ssid, WIFI_UI_SSID_MAX - 1U);
+
+    memcpy(rows[i].ssid, ap->ssid, sl);
+    rows[i].ssid[sl] = '\0';
+    rows[i].rssi = ap->rssi;
+    rows[i].channel = ap->primary;
+    rows[i].security = wifictrl_UiSecurity(ap->authmode);
+  }
+  return datasnap_Publish(REG_WIFI_CTRL, snap);
+}
+
 /**
  * @brief Run a blocking STA scan and publish results to the manager.
  *
  * Clears `s_ap_count`, calls `esp_wifi_scan_start()` with `block=true`, fills `s_ap_records`,
- * then logs each AP (SSID, BSSID, channel, RSSI, auth) and sends `MSG_TYPE_WIFI_SCAN_RESULT`
- * with `ap_count` only. On failure, sends `DATA_WIFI_EVENT_SCAN_FAILED`.
+ * then logs each AP (SSID, BSSID, channel, RSSI, auth), publishes the rows as a new
+ * `DATA_TYPE_WIFI_SCAN_LIST` snapshot and sends `MSG_TYPE_WIFI_SCAN_RESULT` with `ap_count`
+ * only. On failure, sends `DATA_WIFI_EVENT_SCAN_FAILED`.
  *
  * @return ESP_OK after a successful scan (notification errors are logged only); driver errors on scan failure.
  */
@@ -298,6 +353,11 @@ static esp_err_t wifictrl_DoScan(void)
              ap->bssid[5], (unsigned)ap->primary, (int)ap->rssi, (int)ap->authmode);
   }
 
+  err = wifictrl_PublishScanList();
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "wifictrl_PublishScanList failed: %s", esp_err_to_name(err));
+  }
+
   msg.payload.wifi.u.scan.ap_count = s_ap_count;
 
   err = MGR_Send(&msg);
@@ -406,17 +466,25 @@ static esp_err_t wifictrl_ParseMsg(const msg_t *msg)
 static void wifictrl_TaskFn(void *param)
 {
   (void)param;
-  msg_t msg;
+  msg_t *msg = NULL;
   bool loop = true;
 
   ESP_LOGI(TAG, "worker task started");
-  memset(&msg, 0, sizeof(msg));
 
   while (loop) {
-    if (xQueueReceive(s_wifi_queue, &msg, portMAX_DELAY) != pdTRUE) {
+    if (msgpool_Receive(s_wifi_queue, &msg, portMAX_DELAY) != ESP_OK) {
+      continue;
+    }
+    if (msgpool_IsExpired(msg)) {
+      msgpool_Release(msg);
+      MGR_Heartbeat(REG_WIFI_CTRL);
       continue;
     }
-    esp_err_t r = wifictrl_ParseMsg(&msg);
+    int64_t trace = bustrace_ModBegin(REG_WIFI_CTRL, msg);
+    esp_err_t r = wifictrl_ParseMsg(msg);
+    bustrace_ModEnd(REG_WIFI_CTRL, msg, trace);
+    msgpool_Release(msg);
+    MGR_Heartbeat(REG_WIFI_CTRL);
     if (r == ESP_TASK_DONE) {
       loop = false;
     } else if (r != ESP_OK) {
@@ -442,7 +510,7 @@ static esp_err_t wifictrl_Enqueue(const msg_t *msg)
   if (s_wifi_queue == NULL) {
     return ESP_ERR_INVALID_STATE;
   }
-  if (xQueueSend(s_wifi_queue, msg, (TickType_t)0) != pdPASS) {
+  if (msgpool_Post(s_wifi_queue, msg, (TickType_t)0) != ESP_OK) {
     ESP_LOGE(TAG, "queue full, type %d", (int)msg->type);
     return ESP_FAIL;
   }
@@ -472,7 +540,7 @@ static esp_err_t wifictrl_RollbackInit(esp_err_t err)
     s_sta_netif = NULL;
   }
   if (s_wifi_queue) {
-    vQueueDelete(s_wifi_queue);
+    msgpool_DeleteQueue(s_wifi_queue);
     s_wifi_queue = NULL;
   }
   if (s_wifi_done_sem) {
@@ -503,7 +571,7 @@ esp_err_t WifiCtrl_Init(void)
     return result;
   }
 
-  s_wifi_queue = xQueueCreate(WIFI_MSG_MAX, sizeof(msg_t));
+  s_wifi_queue = msgpool_CreateQueue("wifi", WIFI_MSG_MAX);
   if (s_wifi_queue == NULL) {
     ESP_LOGE(TAG, "queue create failed");
     return wifictrl_RollbackInit(ESP_ERR_NO_MEM);
@@ -571,7 +639,7 @@ esp_err_t WifiCtrl_Done(void)
     };
 
     bool worker_stopped =
-        (xQueueSend(s_wifi_queue, &msg, pdMS_TO_TICKS(WIFI_CTRL_SHUTDOWN_QUEUE_TIMEOUT_MS)) == pdPASS);
+        (msgpool_Post(s_wifi_queue, &msg, pdMS_TO_TICKS(WIFI_CTRL_SHUTDOWN_QUEUE_TIMEOUT_MS)) == ESP_OK);
     if (worker_stopped && s_wifi_done_sem != NULL) {
       worker_stopped =
           (xSemaphoreTake(s_wifi_done_sem, pdMS_TO_TICKS(WIFI_CTRL_SHUTDOWN_SEM_TIMEOUT_MS)) == pdTRUE);
@@ -588,7 +656,7 @@ esp_err_t WifiCtrl_Done(void)
     }
 
     s_wifi_task = NULL;
-    vQueueDelete(s_wifi_queue);
+    msgpool_DeleteQueue(s_wifi_queue);
     s_wifi_queue = NULL;
   } else {
     s_wifi_task = NULL;
@@ -0,0 +1,651 @@
+/**
+ * @file bench_bus.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Host benchmark: throughput and latency of the manager bus, end to end
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Runs the real main/mgr_ctrl.c (with the pool, lanes, executor, supervisor and
+ * boot sequencer) on Linux, on top of host_port.c, with the stub modules of
+ * host/mgr_reg_list.h. Producer threads push a fixed mix of message kinds
+ * through `MGR_Send()`; the manager task routes them (`mgr_NotifyCtrl()`) to the
+ * module queues, and each stub measures, when its handler gets the message, how
+ * long ago it entered the bus (`msgpool_GetStamp()`).
+ *
+ *   event    MQTT_EVENT broadcast   small, control lane, block policy, fan-out to all five stubs
+ *   data     MQTT_DATA to relay     small + data buffer, control lane, direct_fn of relay (-x: its queue)
+ *   publish  MQTT_PUBLISH to mqtt   large, bulk lane, drop-oldest
+ *   lcd      LCD_DATA to lcd        small, bulk lane, coalesced
+ *
+ * Message i of a producer is the kind at position i of the mix pattern, so a run
+ * is repeatable. By default a producer retries a rejected send after a yield
+ * (closed loop: the bus sets the pace); -d counts it as dropped instead. A data
+ * message which gets no buffer (msg_buf.h) counts as rejected too, and each
+ * retry builds the message again: a failed send has freed its buffer.
+ *
+ * Build and run (from the repository root, no ESP-IDF needed):
+ *   sh scripts/bench_bus/build.sh && /tmp/bench_bus -h
+ *
+ * Host numbers compare builds and settings of the bus against each other. Module
+ * tasks run at once on the host cores instead of by FreeRTOS priority, so the
+ * latencies do not predict those of the ESP32.
+ */
+#include <getopt.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sdkconfig.h"
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "err.h"
+#include "executor.h"
+#include "mgr_ctrl.h"
+#include "msg.h"
+#include "msg_buf.h"
+#include "msg_pool.h"
+
+#include "mgr_reg_list.h"
+
+
+#define BENCH_STUB_DEPTH        (8U)
+#define BENCH_STUB_STACK        4096
+#define BENCH_STUB_PRIORITY     12
+
+#define BENCH_PRODUCER_MAX      (16U)
+#define BENCH_PATTERN_MAX       (256U)
+#define BENCH_DRAIN_MS          (10000U)
+#define BENCH_DROPS_MAX         (16U)
+
+typedef enum {
+  BENCH_KIND_EVENT,
+  BENCH_KIND_DATA,
+  BENCH_KIND_PUBLISH,
+  BENCH_KIND_LCD,
+
+  BENCH_KIND_MAX
+} bench_kind_e;
+
+typedef struct {
+  uint32_t* sample;       /* latency of each delivery, us */
+  uint32_t  cap;
+  uint32_t  cnt;          /* deliveries, may exceed cap */
+  uint32_t  sent;
+  uint32_t  rejected;     /* -d: MGR_Send() failed */
+  uint32_t  retries;      /* MGR_Send() failed and was repeated */
+} bench_stats_t;
+
+typedef struct {
+  uint32_t  id;
+  uint32_t  count;
+  pthread_t thread;
+} bench_producer_t;
+
+static const char* bench_kind_names[BENCH_KIND_MAX] = {
+  "event", "data", "publish", "lcd",
+};
+
+/* Options */
+static uint32_t bench_count = 100000;
+static uint32_t bench_producers = 2;
+static uint32_t bench_rate = 0;           /* per producer, msg/s, 0 = no limit */
+static uint32_t bench_cost_us = 0;        /* work per handled message */
+static bool     bench_drop = false;
+static bool     bench_direct = true;
+static bool     bench_check = false;
+static char     bench_mix[128] = "event:1,data:1,publish:4,lcd:2";
+
+static uint8_t        bench_pattern[BENCH_PATTERN_MAX];
+static uint32_t       bench_pattern_len = 0;
+static bench_stats_t  bench_stats[BENCH_KIND_MAX];
+
+static volatile bool  bench_start = false;
+
+
+/*
+==================================================================
+  Stub modules
+==================================================================
+*/
+
+static int bench_Kind(msg_type_e type) {
+  switch (type) {
+    case MSG_TYPE_MQTT_EVENT:   return BENCH_KIND_EVENT;
+    case MSG_TYPE_MQTT_DATA:    return BENCH_KIND_DATA;
+    case MSG_TYPE_MQTT_PUBLISH: return BENCH_KIND_PUBLISH;
+    case MSG_TYPE_LCD_DATA:     return BENCH_KIND_LCD;
+    default:                    return -1;
+  }
+}
+
+static void bench_Record(const msg_t* msg) {
+  int kind = bench_Kind(msg->type);
+  int64_t stamp = msgpool_GetStamp(msg);
+
+  if ((kind < 0) || (stamp <= 0)) {
+    return;
+  }
+  bench_stats_t* stats = &bench_stats[kind];
+  uint32_t idx = __atomic_fetch_add(&stats->cnt, 1U, __ATOMIC_RELAXED);
+
+  if (idx < stats->cap) {
+    stats->sample[idx] = (uint32_t) (esp_timer_get_time() - stamp);
+  }
+  if (bench_cost_us != 0U) {
+    int64_t end = esp_timer_get_time() + bench_cost_us;
+
+    while (esp_timer_get_time() < end) {
+    }
+  }
+}
+
+static esp_err_t bench_Handle(const msg_t* msg) {
+  if (msg->type == MSG_TYPE_DONE) {
+    return ESP_TASK_DONE;
+  }
+  bench_Record(msg);
+  return ESP_OK;
+}
+
+static esp_err_t bench_Create(executor_unit_t** unit, const char* name, uint32_t type) {
+  executor_cfg_t cfg = {
+    .name     = name,
+    .module   = type,
+    .depth    = BENCH_STUB_DEPTH,
+    .handler  = bench_Handle,
+    .stack    = BENCH_STUB_STACK,
+    .priority = BENCH_STUB_PRIORITY,
+  };
+
+  *unit = executor_Create(&cfg);
+  return (*unit != NULL) ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t bench_Delete(executor_unit_t** unit, uint32_t type) {
+  esp_err_t result = ESP_OK;
+
+  if (*unit) {
+    msg_t msg = {
+      .type = MSG_TYPE_DONE,
+      .from = type,
+      .to = type,
+    };
+    result = executor_Delete(*unit, &msg);
+    *unit = NULL;
+  }
+  return result;
+}
+
+#define BENCH_MODULE(_fn, _name, _type) \
+  static executor_unit_t* _fn##_unit = NULL; \
+  esp_err_t _fn##_Init(void) { return bench_Create(&_fn##_unit, _name, _type); } \
+  esp_err_t _fn##_Done(void) { return bench_Delete(&_fn##_unit, _type); } \
+  esp_err_t _fn##_Run(void) { return ESP_OK; } \
+  esp_err_t _fn##_Send(const msg_t* msg) { return executor_Post(_fn##_unit, msg, (TickType_t) 0); } \
+  esp_err_t _fn##_Direct(const msg_t* msg) { bench_Record(msg); return ESP_OK; }
+
+BENCH_MODULE(BenchRelay,  "relay",  REG_RELAY_CTRL)
+BENCH_MODULE(BenchLcd,    "lcd",    REG_LCD_CTRL)
+BENCH_MODULE(BenchSys,    "sys",    REG_SYS_CTRL)
+BENCH_MODULE(BenchSensor, "sensor", REG_SENSOR_CTRL)
+BENCH_MODULE(BenchMqtt,   "mqtt",   REG_MQTT_CTRL)
+
+/*
+==================================================================
+  Producers
+==================================================================
+*/
+
+static esp_err_t bench_Build(bench_kind_e kind, uint32_t seq, msg_t* msg) {
+  static const char data_topic[] = "ESP/123456/req/relay";
+
+  memset(msg, 0, sizeof(msg_t));
+  switch (kind) {
+    case BENCH_KIND_EVENT: {
+      msg->type = MSG_TYPE_MQTT_EVENT;
+      msg->from = REG_MQTT_CTRL;
+      msg->to = REG_ALL_CTRL & ~REG_MGR_CTRL;
+      msg->payload.mqtt.u.event_id = DATA_MQTT_EVENT_PUBLISHED;
+      break;
+    }
+    case BENCH_KIND_DATA: {
+      char* text = msgbuf_NewMqttData(&msg->payload.mqtt.u.in, data_topic, sizeof(data_topic) - 1U, DATA_MSG_SIZE);
+
+      if (text == NULL) {
+        return ESP_ERR_NO_MEM;
+      }
+      msg->type = MSG_TYPE_MQTT_DATA;
+      msg->from = REG_MQTT_CTRL;
+      msg->to = REG_RELAY_CTRL;
+      msg->payload.mqtt.u.in.msg_len = (uint32_t) snprintf(text, DATA_MSG_SIZE,
+          "{\"operation\":\"set\",\"seq\":%lu}", (unsigned long) seq);
+      break;
+    }
+    case BENCH_KIND_PUBLISH: {
+      msg->type = MSG_TYPE_MQTT_PUBLISH;
+      msg->from = REG_SENSOR_CTRL;
+      msg->to = REG_MQTT_CTRL;
+      snprintf(msg->payload.mqtt.u.data.topic, DATA_TOPIC_SIZE, "ESP/123456/res/sensor");
+      snprintf(msg->payload.mqtt.u.data.msg, DATA_MSG_SIZE, "{\"operation\":\"event\",\"seq\":%lu}", (unsigned long) seq);
+      break;
+    }
+    case BENCH_KIND_LCD:
+    default: {
+      msg->type = MSG_TYPE_LCD_DATA;
+      msg->from = REG_SYS_CTRL;
+      msg->to = REG_LCD_CTRL;
+      break;
+    }
+  }
+  return ESP_OK;
+}
+
+static void* bench_ProducerFn(void* param) {
+  bench_producer_t* producer = (bench_producer_t*) param;
+  int64_t period = (bench_rate != 0U) ? (1000000LL / bench_rate) : 0;
+  int64_t next = 0;
+  msg_t msg;
+
+  while (!__atomic_load_n(&bench_start, __ATOMIC_ACQUIRE)) {
+    sched_yield();
+  }
+  next = esp_timer_get_time();
+  for (uint32_t seq = 0; seq < producer->count; ++seq) {
+    bench_kind_e kind = (bench_kind_e) bench_pattern[seq % bench_pattern_len];
+
+    if (period != 0) {
+      int64_t now = esp_timer_get_time();
+
+      next += period;
+      if (next > now) {
+        struct timespec ts = {
+          .tv_sec = (next - now) / 1000000LL,
+          .tv_nsec = ((next - now) % 1000000LL) * 1000L,
+        };
+        nanosleep(&ts, NULL);
+      }
+    }
+    __atomic_fetch_add(&bench_stats[kind].sent, 1U, __ATOMIC_RELAXED);
+    while ((bench_Build(kind, seq, &msg) != ESP_OK) || (MGR_Send(&msg) != ESP_OK)) {
+      if (bench_drop) {
+        __atomic_fetch_add(&bench_stats[kind].rejected, 1U, __ATOMIC_RELAXED);
+        break;
+      }
+      __atomic_fetch_add(&bench_stats[kind].retries, 1U, __ATOMIC_RELAXED);
+      sched_yield();
+    }
+  }
+  return NULL;
+}
+
+/*
+==================================================================
+  Report
+==================================================================
+*/
+
+static int bench_Compare(const void* a, const void* b) {
+  uint32_t x = *(const uint32_t*) a;
+  uint32_t y = *(const uint32_t*) b;
+
+  return (x > y) - (x < y);
+}
+
+static uint32_t bench_Percentile(const uint32_t* sample, uint32_t cnt, uint32_t pct) {
+  if (cnt == 0U) {
+    return 0;
+  }
+  return sample[((uint64_t) (cnt - 1U) * pct) / 100U];
+}
+
+static void bench_ReportKind(const char* name, bench_stats_t* stats) {
+  uint32_t cnt = (stats->cnt < stats->cap) ? stats->cnt : stats->cap;
+
+  qsort(stats->sample, cnt, sizeof(uint32_t), bench_Compare);
+  printf("%-8s %9u %9u %9u %10u %8u %8u %8u\n", name,
+      stats->sent, stats->rejected, stats->retries, stats->cnt,
+      bench_Percentile(stats->sample, cnt, 50), bench_Percentile(stats->sample, cnt, 99),
+      cnt ? stats->sample[cnt - 1U] : 0U);
+}
+
+static void bench_Report(double elapsed_s) {
+  bench_stats_t total = {};
+  msgpool_stats_t pool;
+  msgbuf_stats_t buf;
+  mgr_drop_t drops[BENCH_DROPS_MAX];
+  uint32_t drops_cnt;
+
+  printf("\n%-8s %9s %9s %9s %10s %8s %8s %8s\n", "kind", "sent", "rejected", "retries", "delivered",
+      "p50 us", "p99 us", "max us");
+  for (int kind = 0; kind < BENCH_KIND_MAX; ++kind) {
+    bench_stats_t* stats = &bench_stats[kind];
+
+    if (stats->sent == 0U) {
+      continue;
+    }
+    bench_ReportKind(bench_kind_names[kind], stats);
+    total.sent += stats->sent;
+    total.rejected += stats->rejected;
+    total.retries += stats->retries;
+    total.cnt += stats->cnt;
+  }
+
+  /* All deliveries together, for the overall percentiles */
+  total.sample = malloc((size_t) (total.cnt + 1U) * sizeof(uint32_t));
+  if (total.sample) {
+    for (int kind = 0; kind < BENCH_KIND_MAX; ++kind) {
+      uint32_t cnt = (bench_stats[kind].cnt < bench_stats[kind].cap) ? bench_stats[kind].cnt : bench_stats[kind].cap;
+
+      memcpy(&total.sample[total.cap], bench_stats[kind].sample, cnt * sizeof(uint32_t));
+      total.cap += cnt;
+    }
+    total.cnt = total.cap;
+    bench_ReportKind("total", &total);
+    free(total.sample);
+  }
+
+  printf("\nelapsed: %.3f s, %.0f msg/s sent, %.0f deliveries/s\n", elapsed_s,
+      (double) (total.sent - total.rejected) / elapsed_s, (double) total.cnt / elapsed_s);
+
+  msgpool_GetStats(&pool);
+  printf("pool: posts: %u, copies: %u, copy_bytes: %u (%.1f B/msg), shares: %u, no_slot: %u, dropped: %u, "
+      "coalesced: %u, expired: %u\n",
+      pool.posts, pool.copies, pool.copy_bytes, pool.copies ? (double) pool.copy_bytes / pool.copies : 0.0,
+      pool.shares, pool.no_slot, pool.dropped, pool.coalesced, pool.expired);
+  for (int cls = 0; cls < MSGPOOL_CLASS_MAX; ++cls) {
+    printf("pool: class %d: %u x %u B, in_use_max: %u, alloc_fail: %u\n", cls,
+        pool.cls[cls].slots, pool.cls[cls].slot_size, pool.cls[cls].in_use_max, pool.cls[cls].alloc_fail);
+  }
+  msgbuf_GetStats(&buf);
+  printf("buf:  %u x %u B, in_use: %u, in_use_max: %u, allocs: %u, alloc_fail: %u\n",
+      buf.buffers, buf.size, buf.in_use, buf.in_use_max, buf.allocs, buf.alloc_fail);
+  for (int lane = 0; lane < MGR_LANE_MAX; ++lane) {
+    mgr_lane_stats_t stats;
+
+    if (MGR_GetLaneStats((mgr_lane_e) lane, &stats) == ESP_OK) {
+      printf("lane %-4s depth: %2u, posted: %u, dropped: %u, dispatched: %u, latency avg: %u us, max: %u us\n",
+          (lane == MGR_LANE_CTRL) ? "ctrl" : "bulk", stats.depth, stats.posted, stats.dropped, stats.dispatched,
+          stats.dispatched ? (uint32_t) (stats.latency_sum_us / stats.dispatched) : 0U, stats.latency_max_us);
+    }
+  }
+  drops_cnt = MGR_GetDrops(drops, BENCH_DROPS_MAX);
+  for (uint32_t idx = 0; idx < drops_cnt; ++idx) {
+    printf("drop: %s -> %s: %u\n", drops[idx].from, drops[idx].to, drops[idx].count);
+  }
+}
+
+/*
+==================================================================
+  Checks
+==================================================================
+*/
+
+/**
+ * @brief Pool slots referenced right now, both classes.
+ */
+static uint32_t bench_InUse(void) {
+  msgpool_stats_t pool;
+
+  msgpool_GetStats(&pool);
+  return pool.cls[MSGPOOL_CLASS_SMALL].in_use + pool.cls[MSGPOOL_CLASS_LARGE].in_use;
+}
+
+static esp_err_t bench_CheckHandle(const msg_t* msg) {
+  return (msg->type == MSG_TYPE_DONE) ? ESP_TASK_DONE : ESP_OK;
+}
+
+static int bench_CheckResult(const char* name, uint32_t in_use) {
+  printf("check %-24s in_use: %u %s\n", name, in_use, (in_use == 0U) ? "ok" : "FAIL");
+  return (in_use == 0U) ? 0 : 1;
+}
+
+/**
+ * @brief Deleting a queue or an executor unit frees every slot still waiting in it.
+ *
+ * A coalesced key holds two slots, the queued handle and the latest one; both
+ * must go back to the pool. Runs on an idle bus.
+ *
+ * @return Failed checks.
+ */
+static int bench_Check(void) {
+  msg_t lcd = {
+    .type = MSG_TYPE_LCD_DATA,
+    .from = REG_LCD_CTRL,
+    .to = REG_LCD_CTRL,
+    .payload.lcd.mask = 1U,
+  };
+  msg_t done = {
+    .type = MSG_TYPE_DONE,
+    .from = REG_LCD_CTRL,
+    .to = REG_LCD_CTRL,
+  };
+  executor_cfg_t cfg = {
+    .name     = "check",
+    .module   = REG_LCD_CTRL,
+    .depth    = BENCH_STUB_DEPTH,
+    .handler  = bench_CheckHandle,
+    .stack    = BENCH_STUB_STACK,
+    .priority = BENCH_STUB_PRIORITY,
+  };
+  int failed = 0;
+
+  QueueHandle_t queue = msgpool_CreateQueue("check", BENCH_STUB_DEPTH);
+  if (queue == NULL) {
+    fprintf(stderr, "msgpool_CreateQueue() failed\n");
+    return 1;
+  }
+  (void) msgpool_Post(queue, &lcd, (TickType_t) 0);
+  lcd.payload.lcd.d_uint32[0] = 1U;
+  (void) msgpool_Post(queue, &lcd, (TickType_t) 0);
+  msgpool_DeleteQueue(queue);
+  failed += bench_CheckResult("msgpool_DeleteQueue()", bench_InUse());
+
+  /* The unit stops at the DONE ahead of the key, executor_Delete() drops the rest */
+  executor_unit_t* unit = executor_Create(&cfg);
+  if (unit == NULL) {
+    fprintf(stderr, "executor_Create() failed\n");
+    return failed + 1;
+  }
+  (void) executor_Post(unit, &done, (TickType_t) 0);
+  lcd.payload.lcd.d_uint32[0] = 2U;
+  (void) executor_Post(unit, &lcd, (TickType_t) 0);
+  lcd.payload.lcd.d_uint32[0] = 3U;
+  (void) executor_Post(unit, &lcd, (TickType_t) 0);
+  if (executor_Delete(unit, &done) != ESP_OK) {
+    fprintf(stderr, "executor_Delete() failed\n");
+    return failed + 1;
+  }
+  failed += bench_CheckResult("executor_Delete()", bench_InUse());
+  return failed;
+}
+
+/*
+==================================================================
+  Main
+==================================================================
+*/
+
+static int bench_ParseMix(const char* mix) {
+  char buf[sizeof(bench_mix)];
+  char* save = NULL;
+
+  snprintf(buf, sizeof(buf), "%s", mix);
+  bench_pattern_len = 0;
+  for (char* item = strtok_r(buf, ",", &save); item; item = strtok_r(NULL, ",", &save)) {
+    char* colon = strchr(item, ':');
+    uint32_t weight = colon ? (uint32_t) strtoul(colon + 1, NULL, 10) : 1U;
+    int kind;
+
+    if (colon) {
+      *colon = '\0';
+    }
+    for (kind = 0; kind < BENCH_KIND_MAX; ++kind) {
+      if (strcmp(item, bench_kind_names[kind]) == 0) {
+        break;
+      }
+    }
+    if (kind == BENCH_KIND_MAX) {
+      fprintf(stderr, "unknown kind: '%s'\n", item);
+      return -1;
+    }
+    /* Interleave the kinds instead of sending each one in a burst */
+    for (uint32_t cnt = 0; (cnt < weight) && (bench_pattern_len < BENCH_PATTERN_MAX); ++cnt) {
+      bench_pattern[bench_pattern_len++] = (uint8_t) kind;
+    }
+  }
+  if (bench_pattern_len == 0U) {
+    fprintf(stderr, "empty mix\n");
+    return -1;
+  }
+  /* Spread: a stable shuffle by a fixed stride keeps the run repeatable */
+  if (bench_pattern_len > 2U) {
+    uint8_t spread[BENCH_PATTERN_MAX];
+    uint32_t stride = 1U;
+
+    for (uint32_t step = 2U; step < bench_pattern_len; ++step) {
+      uint32_t a = step;
+      uint32_t b = bench_pattern_len;
+
+      while (b != 0U) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+      }
+      if (a == 1U) {
+        stride = step;
+        break;
+      }
+    }
+    for (uint32_t idx = 0; idx < bench_pattern_len; ++idx) {
+      spread[idx] = bench_pattern[(idx * stride) % bench_pattern_len];
+    }
+    memcpy(bench_pattern, spread, bench_pattern_len);
+  }
+  return 0;
+}
+
+static void bench_Usage(const char* name) {
+  printf("usage: %s [-n messages] [-p producers] [-m mix] [-r rate] [-c cost_us] [-d] [-x] [-t] [-l level]\n"
+         "  -n  messages to send, all producers together (%u)\n"
+         "  -p  producer threads, 1..%u (%u)\n"
+         "  -m  mix of kinds with weights, event,data,publish,lcd (%s)\n"
+         "  -r  messages per second per producer, 0 = no limit (%u)\n"
+         "  -c  busy work of a stub handler per message, us (%u)\n"
+         "  -d  count a rejected MGR_Send() as dropped instead of retrying it\n"
+         "  -x  no direct dispatch (MGR_SetDirect(false))\n"
+         "  -t  check that deleted queues and units free their pool slots, no benchmark\n"
+         "  -l  log level, 0 = none .. 5 = verbose (0)\n",
+         name, bench_count, BENCH_PRODUCER_MAX, bench_producers, bench_mix, bench_rate, bench_cost_us);
+}
+
+int main(int argc, char** argv) {
+  bench_producer_t producers[BENCH_PRODUCER_MAX];
+  msgpool_stats_t pool;
+  int64_t begin;
+  int64_t drain;
+  int64_t end;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "n:p:m:r:c:dxtl:h")) != -1) {
+    switch (opt) {
+      case 'n': bench_count = (uint32_t) strtoul(optarg, NULL, 10); break;
+      case 'p': bench_producers = (uint32_t) strtoul(optarg, NULL, 10); break;
+      case 'm': snprintf(bench_mix, sizeof(bench_mix), "%s", optarg); break;
+      case 'r': bench_rate = (uint32_t) strtoul(optarg, NULL, 10); break;
+      case 'c': bench_cost_us = (uint32_t) strtoul(optarg, NULL, 10); break;
+      case 'd': bench_drop = true; break;
+      case 'x': bench_direct = false; break;
+      case 't': bench_check = true; break;
+      case 'l': host_log_level = (esp_log_level_t) strtoul(optarg, NULL, 10); break;
+      default:  bench_Usage(argv[0]); return (opt == 'h') ? 0 : 1;
+    }
+  }
+  if ((bench_producers == 0U) || (bench_producers > BENCH_PRODUCER_MAX) || (bench_count == 0U)
+      || (bench_ParseMix(bench_mix) != 0)) {
+    bench_Usage(argv[0]);
+    return 1;
+  }
+
+  /* Room for every delivery: a message reaches at most every registered module */
+  for (uint32_t idx = 0; idx < bench_pattern_len; ++idx) {
+    bench_stats[bench_pattern[idx]].cap += 1U;
+  }
+  for (int kind = 0; kind < BENCH_KIND_MAX; ++kind) {
+    bench_stats[kind].cap = (uint32_t) (((uint64_t) bench_count * bench_stats[kind].cap / bench_pattern_len + 1U)
+        * MGR_REG_ORDER_CNT);
+    bench_stats[kind].sample = calloc(bench_stats[kind].cap, sizeof(uint32_t));
+    if (bench_stats[kind].sample == NULL) {
+      fprintf(stderr, "no memory for %u samples\n", bench_stats[kind].cap);
+      return 1;
+    }
+  }
+
+  printf("bus bench: %u messages, %u producers, mix: %s, rate: %u/s, cost: %u us, %s, direct: %s, executor: %s\n",
+      bench_count, bench_producers, bench_mix, bench_rate, bench_cost_us, bench_drop ? "drop" : "retry",
+      bench_direct ? "on" : "off", CONFIG_MGR_EXECUTOR_ENABLE ? "pool" : "task");
+
+  if (MGR_Init() != ESP_OK) {
+    fprintf(stderr, "MGR_Init() failed\n");
+    return 1;
+  }
+  MGR_SetDirect(bench_direct);
+
+  if (bench_check) {
+    int failed;
+
+    /* Start from an idle bus: MGR_Init() still has its broadcasts in flight */
+    begin = esp_timer_get_time();
+    while ((bench_InUse() != 0U) && ((esp_timer_get_time() - begin) < (int64_t) BENCH_DRAIN_MS * 1000LL)) {
+      sched_yield();
+    }
+    failed = bench_Check();
+    MGR_Done();
+    return (failed == 0) ? 0 : 1;
+  }
+
+  for (uint32_t idx = 0; idx < bench_producers; ++idx) {
+    producers[idx].id = idx;
+    producers[idx].count = bench_count / bench_producers + ((idx < bench_count % bench_producers) ? 1U : 0U);
+    pthread_create(&producers[idx].thread, NULL, bench_ProducerFn, &producers[idx]);
+  }
+  begin = esp_timer_get_time();
+  __atomic_store_n(&bench_start, true, __ATOMIC_RELEASE);
+  for (uint32_t idx = 0; idx < bench_producers; ++idx) {
+    pthread_join(producers[idx].thread, NULL);
+  }
+
+  /* Done when the last reference to the last message is released */
+  drain = esp_timer_get_time();
+  for (;;) {
+    msgpool_GetStats(&pool);
+    end = esp_timer_get_time();
+    if ((pool.cls[MSGPOOL_CLASS_SMALL].in_use + pool.cls[MSGPOOL_CLASS_LARGE].in_use) == 0U) {
+      break;
+    }
+    if ((end - drain) > (int64_t) BENCH_DRAIN_MS * 1000LL) {
+      fprintf(stderr, "bus did not drain in %u ms\n", BENCH_DRAIN_MS);
+      break;
+    }
+    sched_yield();
+  }
+
+  bench_Report((double) (end - begin) / 1e6);
+  MGR_Done();
+  for (int kind = 0; kind < BENCH_KIND_MAX; ++kind) {
+    free(bench_stats[kind].sample);
+  }
+  return 0;
+}
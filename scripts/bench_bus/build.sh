@@ -0,0 +1,34 @@
+#!/bin/sh
+#
+# Host build of the manager bus and its benchmark (see bench_bus.c).
+#
+# usage: sh scripts/bench_bus/build.sh [output] [extra cc flags]
+#   sh scripts/bench_bus/build.sh /tmp/bench_bus -DCONFIG_MGR_EXECUTOR_ENABLE=1
+#
+set -e
+
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+OUT=${1:-/tmp/bench_bus}
+[ $# -gt 0 ] && shift
+CC=${CC:-cc}
+
+# host/ first: its sdkconfig.h and mgr_reg_list.h replace those of the firmware
+${CC} -O2 -g -std=gnu11 -pthread -D_GNU_SOURCE -Wall -Wno-format -Wno-unused-function \
+  -I"${ROOT}/scripts/bench_bus/host" -I"${ROOT}/include" "$@" \
+  "${ROOT}/main/mgr_ctrl.c" \
+  "${ROOT}/main/msg_pool.c" \
+  "${ROOT}/main/msg_buf.c" \
+  "${ROOT}/main/msg_codec.c" \
+  "${ROOT}/main/lut.c" \
+  "${ROOT}/main/bus_trace.c" \
+  "${ROOT}/main/data_snap.c" \
+  "${ROOT}/main/executor.c" \
+  "${ROOT}/main/mgr_call.c" \
+  "${ROOT}/main/mgr_isr.c" \
+  "${ROOT}/main/mgr_sup.c" \
+  "${ROOT}/main/sys_state.c" \
+  "${ROOT}/main/boot_seq.c" \
+  "${ROOT}/scripts/bench_bus/host_port.c" \
+  "${ROOT}/scripts/bench_bus/bench_bus.c" \
+  -o "${OUT}"
+echo "${OUT}"
@@ -0,0 +1,65 @@
+/**
+ * @file cJSON.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Host shim: cJSON calls of the manager, which build nothing
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * The manager only builds JSON for MQTT (module list, register parsing), which
+ * the benchmark never asks for. Every constructor fails, so those paths take
+ * their "returns NULL" branch.
+ */
+
+#ifndef __CJSON_H__
+#define __CJSON_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct cJSON cJSON;
+
+static inline cJSON* cJSON_Parse(const char* value) { (void) value; return NULL; }
+static inline cJSON* cJSON_CreateObject(void) { return NULL; }
+static inline cJSON* cJSON_CreateString(const char* string) { (void) string; return NULL; }
+static inline void cJSON_Delete(cJSON* item) { (void) item; }
+
+static inline cJSON* cJSON_GetObjectItem(const cJSON* object, const char* string) {
+  (void) object;
+  (void) string;
+  return NULL;
+}
+
+static inline char* cJSON_GetStringValue(const cJSON* item) { (void) item; return NULL; }
+static inline bool cJSON_IsString(const cJSON* item) { (void) item; return false; }
+
+static inline cJSON* cJSON_AddStringToObject(cJSON* object, const char* name, const char* string) {
+  (void) object;
+  (void) name;
+  (void) string;
+  return NULL;
+}
+
+static inline cJSON* cJSON_AddArrayToObject(cJSON* object, const char* name) {
+  (void) object;
+  (void) name;
+  return NULL;
+}
+
+static inline bool cJSON_AddItemToArray(cJSON* array, cJSON* item) {
+  (void) array;
+  (void) item;
+  return false;
+}
+
+static inline int cJSON_PrintPreallocated(cJSON* item, char* buffer, const int length, const int format) {
+  (void) item;
+  (void) buffer;
+  (void) length;
+  (void) format;
+  return 0;
+}
+
+#endif /* __CJSON_H__ */
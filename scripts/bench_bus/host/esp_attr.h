@@ -0,0 +1,17 @@
+/**
+ * @file esp_attr.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Host shim: placement attributes, nothing to place on the host
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ */
+
+#ifndef __ESP_ATTR_H__
+#define __ESP_ATTR_H__
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#endif /* __ESP_ATTR_H__ */
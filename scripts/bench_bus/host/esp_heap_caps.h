@@ -0,0 +1,36 @@
+/**
+ * @file esp_heap_caps.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Host shim: capability allocator on top of malloc
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ */
+
+#ifndef __ESP_HEAP_CAPS_H__
+#define __ESP_HEAP_CAPS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_8BIT         (1U << 2)
+#define MALLOC_CAP_INTERNAL     (1U << 11)
+#define MALLOC_CAP_SPIRAM       (1U << 10)
+
+static inline void* heap_caps_malloc(size_t size, uint32_t caps) {
+  (void) caps;
+  return malloc(size);
+}
+
+static inline void* heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+  (void) caps;
+  return calloc(n, size);
+}
+
+static inline void heap_caps_free(void* ptr) {
+  free(ptr);
+}
+
+#endif /* __ESP_HEAP_CAPS_H__ */
@@ -0,0 +1,53 @@
+/**
+ * @file esp_log.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Host shim: ESP_LOGx on stdout, one level for every tag
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * `esp_log_level_set()` is ignored: the modules raise their tags to the Kconfig
+ * level in their init_fn, which would flood the benchmark. `host_log_level`
+ * (bench_bus -l) applies to all tags and is checked before the arguments are
+ * evaluated, so a disabled log costs one compare.
+ */
+
+#ifndef __ESP_LOG_H__
+#define __ESP_LOG_H__
+
+#include <stdint.h>
+
+typedef enum {
+  ESP_LOG_NONE,
+  ESP_LOG_ERROR,
+  ESP_LOG_WARN,
+  ESP_LOG_INFO,
+  ESP_LOG_DEBUG,
+  ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+extern esp_log_level_t host_log_level;
+
+void host_Log(char letter, const char* tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+static inline void esp_log_level_set(const char* tag, esp_log_level_t level) {
+  (void) tag;
+  (void) level;
+}
+
+#define HOST_LOG(_level, _letter, _tag, _format, ...) \
+  do { \
+    if (host_log_level >= (_level)) { \
+      host_Log(_letter, _tag, _format, ##__VA_ARGS__); \
+    } \
+  } while (0)
+
+#define ESP_LOGE(_tag, _format, ...)  HOST_LOG(ESP_LOG_ERROR,   'E', _tag, _format, ##__VA_ARGS__)
+#define ESP_LOGW(_tag, _format, ...)  HOST_LOG(ESP_LOG_WARN,    'W', _tag, _format, ##__VA_ARGS__)
+#define ESP_LOGI(_tag, _format, ...)  HOST_LOG(ESP_LOG_INFO,    'I', _tag, _format, ##__VA_ARGS__)
+#define ESP_LOGD(_tag, _format, ...)  HOST_LOG(ESP_LOG_DEBUG,   'D', _tag, _format, ##__VA_ARGS__)
+#define ESP_LOGV(_tag, _format, ...)  HOST_LOG(ESP_LOG_VERBOSE, 'V', _tag, _format, ##__VA_ARGS__)
+
+#endif /* __ESP_LOG_H__ */
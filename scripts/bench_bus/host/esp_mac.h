@@ -0,0 +1,26 @@
+/**
+ * @file esp_mac.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Host shim: MAC address types
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ */
+
+#ifndef __ESP_MAC_H__
+#define __ESP_MAC_H__
+
+typedef enum {
+  ESP_MAC_WIFI_STA,
+  ESP_MAC_WIFI_SOFTAP,
+  ESP_MAC_BT,
+  ESP_MAC_ETH,
+  ESP_MAC_IEEE802154,
+  ESP_MAC_BASE,
+  ESP_MAC_EFUSE_FACTORY,
+  ESP_MAC_EFUSE_CUSTOM,
+  ESP_MAC_EFUSE_EXT,
+} esp_mac_type_t;
+
+#endif /* __ESP_MAC_H__ */
@@ -0,0 +1,18 @@
+/**
+ * @file esp_system.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Host shim: esp_restart() ends the benchmark
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ */
+
+#ifndef __ESP_SYSTEM_H__
+#define __ESP_SYSTEM_H__
+
+#include "esp_err.h"
+
+void esp_restart(void) __attribute__((noreturn));
+
+#endif /* __ESP_SYSTEM_H__ */
@@ -0,0 +1,18 @@
+/**
+ * @file esp_timer.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Host shim: microseconds since start, from CLOCK_MONOTONIC
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ */
+
+#ifndef __ESP_TIMER_H__
+#define __ESP_TIMER_H__
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
+
+#endif /* __ESP_TIMER_H__ */
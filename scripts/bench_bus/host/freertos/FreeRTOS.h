@@ -0,0 +1,74 @@
+/**
+ * @file FreeRTOS.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Host shim: FreeRTOS types and port macros on POSIX threads
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Only what the bus sources use (see ../../host_port.c). A tick is 1 ms. Tasks
+ * are threads without priorities and every task reports core 0, so the bus
+ * trace keeps a single ring. A critical section is a recursive mutex per
+ * portMUX_TYPE: it serializes the sections on the same lock, as the spinlock
+ * does across the two cores, but it does not stop the scheduler.
+ */
+
+#ifndef __FREERTOS_H__
+#define __FREERTOS_H__
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+typedef int32_t   BaseType_t;
+typedef uint32_t  UBaseType_t;
+typedef uint32_t  TickType_t;
+
+#define pdFALSE                 ((BaseType_t) 0)
+#define pdTRUE                  ((BaseType_t) 1)
+#define pdFAIL                  (pdFALSE)
+#define pdPASS                  (pdTRUE)
+
+#define portMAX_DELAY           ((TickType_t) 0xffffffffUL)
+#define portNUM_PROCESSORS      2
+#define portTICK_PERIOD_MS      ((TickType_t) 1)
+
+#define configTICK_RATE_HZ      1000
+#define configMAX_TASK_NAME_LEN 16
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES (CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES)
+
+#define pdMS_TO_TICKS(_ms)      ((TickType_t) (_ms))
+
+typedef struct {
+  pthread_mutex_t mutex;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED  { PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP }
+
+#define taskENTER_CRITICAL(_mux)          pthread_mutex_lock(&(_mux)->mutex)
+#define taskEXIT_CRITICAL(_mux)           pthread_mutex_unlock(&(_mux)->mutex)
+#define taskENTER_CRITICAL_ISR(_mux)      taskENTER_CRITICAL(_mux)
+#define taskEXIT_CRITICAL_ISR(_mux)       taskEXIT_CRITICAL(_mux)
+#define portENTER_CRITICAL(_mux)          taskENTER_CRITICAL(_mux)
+#define portEXIT_CRITICAL(_mux)           taskEXIT_CRITICAL(_mux)
+
+#define portYIELD_FROM_ISR(...)           do { } while (0)
+
+/* Size of the ESP32 control blocks, only for the RAM reports of the bus */
+typedef struct { uint8_t opaque[84]; } StaticQueue_t;
+typedef struct { uint8_t opaque[352]; } StaticTask_t;
+
+static inline BaseType_t xPortGetCoreID(void) {
+  return 0;
+}
+
+static inline BaseType_t xPortInIsrContext(void) {
+  return pdFALSE;
+}
+
+#endif /* __FREERTOS_H__ */
@@ -0,0 +1,27 @@
+/**
+ * @file event_groups.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Host shim: FreeRTOS event groups
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ */
+
+#ifndef __FREERTOS_EVENT_GROUPS_H__
+#define __FREERTOS_EVENT_GROUPS_H__
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_group_s* EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+EventGroupHandle_t xEventGroupCreate(void);
+void vEventGroupDelete(EventGroupHandle_t group);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear,
+                                BaseType_t all, TickType_t wait);
+
+#endif /* __FREERTOS_EVENT_GROUPS_H__ */
@@ -0,0 +1,31 @@
+/**
+ * @file queue.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Host shim: FreeRTOS queues
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ */
+
+#ifndef __FREERTOS_QUEUE_H__
+#define __FREERTOS_QUEUE_H__
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_queue_s* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t wait);
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t wait);
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+#define xQueueSendToBack(_queue, _item, _wait)  xQueueSend(_queue, _item, _wait)
+
+/* mgr_ctrl.c uses SemaphoreHandle_t with queue.h alone, as the IDF headers allow */
+#include "freertos/semphr.h"
+
+#endif /* __FREERTOS_QUEUE_H__ */
@@ -0,0 +1,27 @@
+/**
+ * @file semphr.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Host shim: FreeRTOS semaphores, queues of empty items as in the kernel
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ */
+
+#ifndef __FREERTOS_SEMPHR_H__
+#define __FREERTOS_SEMPHR_H__
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial);
+
+#define xSemaphoreCreateBinary()                xSemaphoreCreateCounting(1, 0)
+#define xSemaphoreCreateMutex()                 xSemaphoreCreateCounting(1, 1)
+#define vSemaphoreDelete(_sem)                  vQueueDelete(_sem)
+#define xSemaphoreTake(_sem, _wait)             xQueueReceive(_sem, NULL, _wait)
+#define xSemaphoreGive(_sem)                    xQueueSend(_sem, NULL, 0)
+
+#endif /* __FREERTOS_SEMPHR_H__ */
@@ -0,0 +1,35 @@
+/**
+ * @file task.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Host shim: FreeRTOS tasks and task notifications
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ */
+
+#ifndef __FREERTOS_TASK_H__
+#define __FREERTOS_TASK_H__
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_task_s* TaskHandle_t;
+typedef void (*TaskFunction_t)(void* param);
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* param,
+                       UBaseType_t priority, TaskHandle_t* task);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* param,
+                                   UBaseType_t priority, TaskHandle_t* task, BaseType_t core);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+TickType_t xTaskGetTickCount(void);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+BaseType_t xTaskNotifyGiveIndexed(TaskHandle_t task, UBaseType_t index);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait);
+uint32_t ulTaskNotifyTakeIndexed(UBaseType_t index, BaseType_t clear, TickType_t wait);
+
+#endif /* __FREERTOS_TASK_H__ */
@@ -0,0 +1,97 @@
+/**
+ * @file mgr_reg_list.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Benchmark registry: stub modules in place of the real ones
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Found ahead of include/mgr_reg_list.h (-I order of build.sh). Each stub sits
+ * at the bit of the module it stands for, with that module's `.subscribe` and
+ * `.direct` masks, so the route table and the fan-out match the firmware. The
+ * stubs themselves are in bench_bus.c: an executor unit which timestamps what
+ * it gets and drops it.
+ */
+
+#ifndef __MGR_REG_LIST_H__
+#define __MGR_REG_LIST_H__
+
+#include "mgr_reg.h"
+
+
+#define BENCH_MODULE_DECLARE(_fn) \
+  esp_err_t _fn##_Init(void); \
+  esp_err_t _fn##_Done(void); \
+  esp_err_t _fn##_Run(void); \
+  esp_err_t _fn##_Send(const msg_t* msg); \
+  esp_err_t _fn##_Direct(const msg_t* msg);
+
+BENCH_MODULE_DECLARE(BenchRelay)
+BENCH_MODULE_DECLARE(BenchLcd)
+BENCH_MODULE_DECLARE(BenchSys)
+BENCH_MODULE_DECLARE(BenchSensor)
+BENCH_MODULE_DECLARE(BenchMqtt)
+
+#define BENCH_REG(_name, _fn, _type, _subscribe, _direct, _direct_fn) \
+  { \
+    .name     = MGR_REG_NAME(_name), \
+    .type     = (_type), \
+    .subscribe= (_subscribe), \
+    .direct   = (_direct), \
+    .depends  = 0, \
+    .init_fn  = _fn##_Init, \
+    .done_fn  = _fn##_Done, \
+    .run_fn   = _fn##_Run, \
+    .send_fn  = _fn##_Send, \
+    .direct_fn= (_direct_fn), \
+    .get_fn   = NULL, \
+  }
+
+static const mgr_reg_t mgr_reg_list[REG_BIT_MAX] = {
+  [REG_RELAY_BIT] = BENCH_REG("relay", BenchRelay, REG_RELAY_CTRL,
+      MSG_MASK(MSG_TYPE_MGR_UID) | MSG_MASK(MSG_TYPE_MQTT_EVENT) | MSG_MASK(MSG_TYPE_MQTT_DATA) |
+      MSG_MASK(MSG_TYPE_MQTT_DATA_LOCAL),
+      MSG_MASK(MSG_TYPE_MQTT_DATA) | MSG_MASK(MSG_TYPE_MQTT_DATA_LOCAL), BenchRelay_Direct),
+
+  [REG_LCD_BIT] = BENCH_REG("lcd", BenchLcd, REG_LCD_CTRL,
+      MSG_MASK(MSG_TYPE_MGR_UID) |
+      MSG_MASK(MSG_TYPE_ETH_EVENT) | MSG_MASK(MSG_TYPE_ETH_MAC) | MSG_MASK(MSG_TYPE_ETH_IP) |
+      MSG_MASK(MSG_TYPE_WIFI_EVENT) | MSG_MASK(MSG_TYPE_WIFI_MAC) | MSG_MASK(MSG_TYPE_WIFI_IP) |
+      MSG_MASK(MSG_TYPE_MQTT_EVENT) | MSG_MASK(MSG_TYPE_MQTT_DATA) |
+      MSG_MASK(MSG_TYPE_MQTT_DATA_LOCAL) | MSG_MASK(MSG_TYPE_LCD_DATA),
+      MSG_MASK_NONE, NULL),
+
+  [REG_SYS_BIT] = BENCH_REG("sys", BenchSys, REG_SYS_CTRL,
+      MSG_MASK(MSG_TYPE_MGR_UID) | MSG_MASK(MSG_TYPE_ETH_EVENT) |
+      MSG_MASK(MSG_TYPE_MQTT_EVENT) | MSG_MASK(MSG_TYPE_MQTT_DATA) |
+      MSG_MASK(MSG_TYPE_SYS_INFO_REQ),
+      MSG_MASK_NONE, NULL),
+
+  [REG_SENSOR_BIT] = BENCH_REG("sensor", BenchSensor, REG_SENSOR_CTRL,
+      MSG_MASK(MSG_TYPE_MGR_UID) | MSG_MASK(MSG_TYPE_MQTT_EVENT) | MSG_MASK(MSG_TYPE_MQTT_DATA),
+      MSG_MASK_NONE, NULL),
+
+  [REG_MQTT_BIT] = BENCH_REG("mqtt", BenchMqtt, REG_MQTT_CTRL | REG_INT_CTRL,
+      MSG_MASK(MSG_TYPE_MGR_UID) |
+      MSG_MASK(MSG_TYPE_MQTT_START) | MSG_MASK(MSG_TYPE_MQTT_STOP) |
+      MSG_MASK(MSG_TYPE_MQTT_EVENT) | MSG_MASK(MSG_TYPE_MQTT_DATA) |
+      MSG_MASK(MSG_TYPE_MQTT_PUBLISH) | MSG_MASK(MSG_TYPE_MQTT_SUBSCRIBE) |
+      MSG_MASK(MSG_TYPE_MQTT_SUBSCRIBE_LIST),
+      MSG_MASK_NONE, NULL),
+};
+
+/* Same order as the firmware; mqtt last */
+static const uint8_t mgr_reg_order[] = {
+  REG_RELAY_BIT,
+  REG_LCD_BIT,
+  REG_SYS_BIT,
+  REG_SENSOR_BIT,
+  REG_MQTT_BIT,
+};
+
+#define MGR_REG_ORDER_CNT   (sizeof(mgr_reg_order)/sizeof(mgr_reg_order[0]))
+
+
+#endif /* __MGR_REG_LIST_H__ */
@@ -0,0 +1,101 @@
+/**
+ * @file sdkconfig.h
+ * @author A.Czerwinski@pistacje.net
+ * @brief Host shim: Kconfig of the bus for the benchmark build
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Defaults of main/Kconfig.mgr, with the modules of the benchmark registry
+ * (mgr_reg_list.h next to this file). Every value may be overridden from the
+ * compiler command line, e.g. -DCONFIG_MGR_LANE_BULK_DEPTH=32, to compare builds.
+ */
+
+#ifndef __SDKCONFIG_H__
+#define __SDKCONFIG_H__
+
+#ifndef CONFIG_MGR_CTRL_LOG_LEVEL
+#define CONFIG_MGR_CTRL_LOG_LEVEL             3
+#endif
+#ifndef CONFIG_MGR_MSG_POOL_SMALL_SLOTS
+#define CONFIG_MGR_MSG_POOL_SMALL_SLOTS       32
+#endif
+#ifndef CONFIG_MGR_MSG_POOL_LARGE_SLOTS
+#define CONFIG_MGR_MSG_POOL_LARGE_SLOTS       8
+#endif
+#ifndef CONFIG_MGR_MSG_BUF_COUNT
+#define CONFIG_MGR_MSG_BUF_COUNT              4
+#endif
+#ifndef CONFIG_MGR_MSG_BUF_SIZE
+#define CONFIG_MGR_MSG_BUF_SIZE               2048
+#endif
+#ifndef CONFIG_MGR_LANE_CTRL_DEPTH
+#define CONFIG_MGR_LANE_CTRL_DEPTH            8
+#endif
+#ifndef CONFIG_MGR_LANE_BULK_DEPTH
+#define CONFIG_MGR_LANE_BULK_DEPTH            16
+#endif
+#ifndef CONFIG_MGR_MSG_BLOCK_MS
+#define CONFIG_MGR_MSG_BLOCK_MS               20
+#endif
+#ifndef CONFIG_MGR_MSG_TTL_PUBLISH_MS
+#define CONFIG_MGR_MSG_TTL_PUBLISH_MS         30000
+#endif
+#ifndef CONFIG_MGR_MSG_TTL_LCD_MS
+#define CONFIG_MGR_MSG_TTL_LCD_MS             2000
+#endif
+#ifndef CONFIG_MGR_DIRECT_DISPATCH
+#define CONFIG_MGR_DIRECT_DISPATCH            1
+#endif
+#ifndef CONFIG_MGR_BUS_TRACE_ENABLE
+#define CONFIG_MGR_BUS_TRACE_ENABLE           1
+#endif
+#ifndef CONFIG_MGR_BUS_TRACE_DEPTH
+#define CONFIG_MGR_BUS_TRACE_DEPTH            64
+#endif
+#ifndef CONFIG_MGR_EXECUTOR_ENABLE
+#define CONFIG_MGR_EXECUTOR_ENABLE            0
+#endif
+#ifndef CONFIG_MGR_EXECUTOR_WORKERS
+#define CONFIG_MGR_EXECUTOR_WORKERS           2
+#endif
+#ifndef CONFIG_MGR_EXECUTOR_STACK_SIZE
+#define CONFIG_MGR_EXECUTOR_STACK_SIZE        6144
+#endif
+#ifndef CONFIG_MGR_EXECUTOR_PRIORITY
+#define CONFIG_MGR_EXECUTOR_PRIORITY          12
+#endif
+#ifndef CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES
+#define CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES 2
+#endif
+#ifndef CONFIG_MGR_CALL_PENDING_MAX
+#define CONFIG_MGR_CALL_PENDING_MAX           8
+#endif
+#ifndef CONFIG_MGR_ISR_SOURCE_MAX
+#define CONFIG_MGR_ISR_SOURCE_MAX             4
+#endif
+#ifndef CONFIG_MGR_SUP_STALL_MS
+#define CONFIG_MGR_SUP_STALL_MS               30000
+#endif
+#ifndef CONFIG_MGR_SUP_BACKOFF_MS
+#define CONFIG_MGR_SUP_BACKOFF_MS             1000
+#endif
+#ifndef CONFIG_MGR_SUP_BACKOFF_MAX_MS
+#define CONFIG_MGR_SUP_BACKOFF_MAX_MS         60000
+#endif
+#ifndef CONFIG_MGR_SUP_RESTART_MAX
+#define CONFIG_MGR_SUP_RESTART_MAX            5
+#endif
+#ifndef CONFIG_MGR_SUP_STABLE_MS
+#define CONFIG_MGR_SUP_STABLE_MS              300000
+#endif
+#ifndef CONFIG_MGR_BOOT_WORKERS
+#define CONFIG_MGR_BOOT_WORKERS               2
+#endif
+#ifndef CONFIG_MGR_BOOT_STACK_SIZE
+#define CONFIG_MGR_BOOT_STACK_SIZE            6144
+#endif
+
+#endif /* __SDKCONFIG_H__ */
@@ -0,0 +1,525 @@
+/**
+ * @file host_port.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Host port of the FreeRTOS / ESP-IDF calls used by the message bus
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Just enough of the kernel to run main/mgr_ctrl.c and its helpers on Linux
+ * (see host/freertos/FreeRTOS.h for what differs from the target):
+ *
+ *   task            pthread, with a mutex / condition pair for its notification
+ *   queue           ring of items behind a mutex, two conditions for the waiters
+ *   semaphore       queue of empty items, as in the kernel
+ *   event group     bits behind a mutex, one condition
+ *
+ * Timed waits use CLOCK_MONOTONIC, a tick is 1 ms. The control block of a
+ * deleted task is kept: someone may still hold its handle (mgr_Send() reads
+ * `mgr_task_id` without a lock), and a benchmark run creates only a few tasks.
+ */
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+
+#include "tools.h"
+
+
+struct host_task_s {
+  char            name[configMAX_TASK_NAME_LEN];
+  TaskFunction_t  fn;
+  void*           param;
+  UBaseType_t     priority;
+  pthread_t       thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+  uint32_t        notify[configTASK_NOTIFICATION_ARRAY_ENTRIES];
+};
+
+struct host_queue_s {
+  pthread_mutex_t mutex;
+  pthread_cond_t  not_empty;
+  pthread_cond_t  not_full;
+  uint32_t        length;
+  uint32_t        item_size;    /* 0 for a semaphore */
+  uint32_t        count;
+  uint32_t        head;
+  uint8_t*        buf;
+};
+
+struct host_group_s {
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+  EventBits_t     bits;
+};
+
+esp_log_level_t host_log_level = ESP_LOG_NONE;
+
+static struct timespec          host_start;
+static __thread struct host_task_s* host_self = NULL;
+static pthread_mutex_t          host_log_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+__attribute__((constructor)) static void host_Start(void) {
+  clock_gettime(CLOCK_MONOTONIC, &host_start);
+}
+
+/**
+ * @brief Absolute CLOCK_MONOTONIC time @p ticks from now.
+ */
+static struct timespec host_Deadline(TickType_t ticks) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  ts.tv_sec += ticks / 1000U;
+  ts.tv_nsec += (long) (ticks % 1000U) * 1000000L;
+  if (ts.tv_nsec >= 1000000000L) {
+    ts.tv_sec += 1;
+    ts.tv_nsec -= 1000000000L;
+  }
+  return ts;
+}
+
+static void host_InitCond(pthread_cond_t* cond) {
+  pthread_condattr_t attr;
+
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(cond, &attr);
+  pthread_condattr_destroy(&attr);
+}
+
+/**
+ * @brief Wait on @p cond until @p ready holds or the deadline passes; called with @p mutex held.
+ *
+ * @return true when @p ready holds.
+ */
+#define HOST_WAIT(_ready, _cond, _mutex, _wait) \
+  ({ \
+    bool _ok = true; \
+    if (!(_ready)) { \
+      if ((_wait) == 0U) { \
+        _ok = false; \
+      } else if ((_wait) == portMAX_DELAY) { \
+        while (!(_ready)) { \
+          pthread_cond_wait(_cond, _mutex); \
+        } \
+      } else { \
+        struct timespec _deadline = host_Deadline(_wait); \
+        while (!(_ready)) { \
+          if (pthread_cond_timedwait(_cond, _mutex, &_deadline) == ETIMEDOUT) { \
+            _ok = (_ready); \
+            break; \
+          } \
+        } \
+      } \
+    } \
+    _ok; \
+  })
+
+static struct host_task_s* host_NewTask(const char* name, UBaseType_t priority) {
+  struct host_task_s* task = calloc(1, sizeof(struct host_task_s));
+
+  if (task == NULL) {
+    return NULL;
+  }
+  snprintf(task->name, sizeof(task->name), "%s", name);
+  task->priority = priority;
+  pthread_mutex_init(&task->mutex, NULL);
+  host_InitCond(&task->cond);
+  return task;
+}
+
+static void* host_TaskMain(void* param) {
+  struct host_task_s* task = (struct host_task_s*) param;
+
+  host_self = task;
+  task->fn(task->param);
+  /* A task function must not return, vTaskDelete(NULL) is the way out */
+  fprintf(stderr, "host: task '%s' returned\n", task->name);
+  abort();
+  return NULL;
+}
+
+/*
+==================================================================
+  Tasks
+==================================================================
+*/
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* param,
+                       UBaseType_t priority, TaskHandle_t* handle) {
+  struct host_task_s* task = host_NewTask(name, priority);
+  pthread_attr_t attr;
+
+  (void) stack;
+  if (handle) {
+    *handle = NULL;
+  }
+  if (task == NULL) {
+    return pdFAIL;
+  }
+  task->fn = fn;
+  task->param = param;
+  /* The handle is in place before the task runs, as with a higher-priority creator */
+  if (handle) {
+    *handle = task;
+  }
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  if (pthread_create(&task->thread, &attr, host_TaskMain, task) != 0) {
+    pthread_attr_destroy(&attr);
+    if (handle) {
+      *handle = NULL;
+    }
+    free(task);
+    return pdFAIL;
+  }
+  pthread_attr_destroy(&attr);
+  return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* param,
+                                   UBaseType_t priority, TaskHandle_t* task, BaseType_t core) {
+  (void) core;
+  return xTaskCreate(fn, name, stack, param, priority, task);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  if ((task == NULL) || (task == host_self)) {
+    pthread_exit(NULL);
+  }
+  /* No code of the bus deletes another task */
+  fprintf(stderr, "host: vTaskDelete('%s') of another task is not supported\n", task->name);
+  abort();
+}
+
+void vTaskDelay(TickType_t ticks) {
+  struct timespec ts = {
+    .tv_sec = ticks / 1000U,
+    .tv_nsec = (long) (ticks % 1000U) * 1000000L,
+  };
+
+  if (ticks == 0U) {
+    sched_yield();
+    return;
+  }
+  while (nanosleep(&ts, &ts) != 0) {
+  }
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+  if (host_self == NULL) {
+    /* main() or another thread not created by xTaskCreate() */
+    host_self = host_NewTask("main", 1);
+  }
+  return host_self;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task) {
+  if (task == NULL) {
+    task = xTaskGetCurrentTaskHandle();
+  }
+  return task ? task->priority : 0U;
+}
+
+TickType_t xTaskGetTickCount(void) {
+  return (TickType_t) (esp_timer_get_time() / 1000);
+}
+
+BaseType_t xTaskNotifyGiveIndexed(TaskHandle_t task, UBaseType_t index) {
+  if ((task == NULL) || (index >= configTASK_NOTIFICATION_ARRAY_ENTRIES)) {
+    return pdFAIL;
+  }
+  pthread_mutex_lock(&task->mutex);
+  ++task->notify[index];
+  pthread_cond_signal(&task->cond);
+  pthread_mutex_unlock(&task->mutex);
+  return pdPASS;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  return xTaskNotifyGiveIndexed(task, 0);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+  (void) xTaskNotifyGive(task);
+  if (woken) {
+    *woken = pdTRUE;
+  }
+}
+
+uint32_t ulTaskNotifyTakeIndexed(UBaseType_t index, BaseType_t clear, TickType_t wait) {
+  struct host_task_s* task = xTaskGetCurrentTaskHandle();
+  uint32_t value = 0;
+
+  pthread_mutex_lock(&task->mutex);
+  if (HOST_WAIT(task->notify[index] != 0U, &task->cond, &task->mutex, wait)) {
+    value = task->notify[index];
+    task->notify[index] = (clear != pdFALSE) ? 0U : (task->notify[index] - 1U);
+  }
+  pthread_mutex_unlock(&task->mutex);
+  return value;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait) {
+  return ulTaskNotifyTakeIndexed(0, clear, wait);
+}
+
+/*
+==================================================================
+  Queues and semaphores
+==================================================================
+*/
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+  struct host_queue_s* queue = NULL;
+
+  if (length == 0U) {
+    return NULL;
+  }
+  queue = calloc(1, sizeof(struct host_queue_s));
+  if (queue == NULL) {
+    return NULL;
+  }
+  if (item_size != 0U) {
+    queue->buf = calloc(length, item_size);
+    if (queue->buf == NULL) {
+      free(queue);
+      return NULL;
+    }
+  }
+  queue->length = length;
+  queue->item_size = item_size;
+  pthread_mutex_init(&queue->mutex, NULL);
+  host_InitCond(&queue->not_empty);
+  host_InitCond(&queue->not_full);
+  return queue;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial) {
+  struct host_queue_s* sem = xQueueCreate(max, 0U);
+
+  if (sem) {
+    sem->count = (initial < max) ? initial : max;
+  }
+  return sem;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+  if (queue == NULL) {
+    return;
+  }
+  pthread_mutex_destroy(&queue->mutex);
+  pthread_cond_destroy(&queue->not_empty);
+  pthread_cond_destroy(&queue->not_full);
+  free(queue->buf);
+  free(queue);
+}
+
+static BaseType_t host_QueuePut(QueueHandle_t queue, const void* item, TickType_t wait, bool front) {
+  BaseType_t result = pdFAIL;
+
+  if (queue == NULL) {
+    return pdFAIL;
+  }
+  pthread_mutex_lock(&queue->mutex);
+  if (HOST_WAIT(queue->count < queue->length, &queue->not_full, &queue->mutex, wait)) {
+    if (queue->item_size != 0U) {
+      uint32_t pos;
+
+      if (front) {
+        queue->head = (queue->head + queue->length - 1U) % queue->length;
+        pos = queue->head;
+      } else {
+        pos = (queue->head + queue->count) % queue->length;
+      }
+      memcpy(&queue->buf[pos * queue->item_size], item, queue->item_size);
+    }
+    ++queue->count;
+    pthread_cond_signal(&queue->not_empty);
+    result = pdPASS;
+  }
+  pthread_mutex_unlock(&queue->mutex);
+  return result;
+}
+
+static BaseType_t host_QueueGet(QueueHandle_t queue, void* item, TickType_t wait, bool peek) {
+  BaseType_t result = pdFAIL;
+
+  if (queue == NULL) {
+    return pdFAIL;
+  }
+  pthread_mutex_lock(&queue->mutex);
+  if (HOST_WAIT(queue->count != 0U, &queue->not_empty, &queue->mutex, wait)) {
+    if ((queue->item_size != 0U) && (item != NULL)) {
+      memcpy(item, &queue->buf[queue->head * queue->item_size], queue->item_size);
+    }
+    if (!peek) {
+      queue->head = (queue->head + 1U) % queue->length;
+      --queue->count;
+      pthread_cond_signal(&queue->not_full);
+    }
+    result = pdPASS;
+  }
+  pthread_mutex_unlock(&queue->mutex);
+  return result;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t wait) {
+  return host_QueuePut(queue, item, wait, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t wait) {
+  return host_QueuePut(queue, item, wait, true);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t wait) {
+  return host_QueueGet(queue, item, wait, false);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t wait) {
+  return host_QueueGet(queue, item, wait, true);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  UBaseType_t count;
+
+  if (queue == NULL) {
+    return 0;
+  }
+  pthread_mutex_lock(&queue->mutex);
+  count = queue->count;
+  pthread_mutex_unlock(&queue->mutex);
+  return count;
+}
+
+/*
+==================================================================
+  Event groups
+==================================================================
+*/
+
+EventGroupHandle_t xEventGroupCreate(void) {
+  struct host_group_s* group = calloc(1, sizeof(struct host_group_s));
+
+  if (group) {
+    pthread_mutex_init(&group->mutex, NULL);
+    host_InitCond(&group->cond);
+  }
+  return group;
+}
+
+void vEventGroupDelete(EventGroupHandle_t group) {
+  if (group == NULL) {
+    return;
+  }
+  pthread_mutex_destroy(&group->mutex);
+  pthread_cond_destroy(&group->cond);
+  free(group);
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+  EventBits_t value;
+
+  pthread_mutex_lock(&group->mutex);
+  group->bits |= bits;
+  value = group->bits;
+  pthread_cond_broadcast(&group->cond);
+  pthread_mutex_unlock(&group->mutex);
+  return value;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+  EventBits_t value;
+
+  pthread_mutex_lock(&group->mutex);
+  value = group->bits;
+  group->bits &= ~bits;
+  pthread_mutex_unlock(&group->mutex);
+  return value;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group) {
+  EventBits_t value;
+
+  pthread_mutex_lock(&group->mutex);
+  value = group->bits;
+  pthread_mutex_unlock(&group->mutex);
+  return value;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear,
+                                BaseType_t all, TickType_t wait) {
+  EventBits_t value;
+
+  pthread_mutex_lock(&group->mutex);
+#define HOST_GROUP_READY  ((all != pdFALSE) ? ((group->bits & bits) == bits) : ((group->bits & bits) != 0U))
+  bool ready = HOST_WAIT(HOST_GROUP_READY, &group->cond, &group->mutex, wait);
+#undef HOST_GROUP_READY
+  value = group->bits;
+  if (ready && (clear != pdFALSE)) {
+    group->bits &= ~bits;
+  }
+  pthread_mutex_unlock(&group->mutex);
+  return value;
+}
+
+/*
+==================================================================
+  ESP-IDF
+==================================================================
+*/
+
+int64_t esp_timer_get_time(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  /* +1: the bus treats a stamp of 0 as "not stamped" */
+  return (int64_t) (ts.tv_sec - host_start.tv_sec) * 1000000LL + (ts.tv_nsec - host_start.tv_nsec) / 1000 + 1;
+}
+
+void esp_restart(void) {
+  fprintf(stderr, "host: esp_restart()\n");
+  exit(2);
+}
+
+void host_Log(char letter, const char* tag, const char* format, ...) {
+  va_list args;
+
+  pthread_mutex_lock(&host_log_lock);
+  printf("%c (%lld) %s: ", letter, (long long) (esp_timer_get_time() / 1000), tag);
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+  printf("\n");
+  pthread_mutex_unlock(&host_log_lock);
+}
+
+esp_err_t tools_GetMacAddress(uint8_t *mac_ptr, esp_mac_type_t type) {
+  static const uint8_t mac[6] = { 0x24, 0x0A, 0xC4, 0x12, 0x34, 0x56 };
+
+  (void) type;
+  if (mac_ptr == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  memcpy(mac_ptr, mac, sizeof(mac));
+  return ESP_OK;
+}
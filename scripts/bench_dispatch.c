@@ -0,0 +1,192 @@
+/**
+ * @file bench_dispatch.c
+ * @author A.Czerwinski@pistacje.net
+ * @brief Host benchmark: manager dispatch, linear registry scan vs. bit-indexed registry
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026 4Embedded.Systems
+ *
+ * @details
+ * Runs the receiver lookup of `mgr_NotifyCtrl()` / `MGR_GetData()` with every
+ * module of include/msg.h registered, once as the former linear walk over a dense
+ * `mgr_reg_list[]` (test `route & type` on each entry) and once as the walk over
+ * the set bits of the route mask into the 32-entry table (count trailing zeros).
+ * `send_fn` only counts calls, so the numbers are the dispatch overhead alone.
+ *
+ * Build and run on the host (no ESP-IDF needed):
+ *   cc -O2 -std=gnu11 -Iinclude scripts/bench_dispatch.c -o /tmp/bench_dispatch
+ *   /tmp/bench_dispatch [iterations]
+ *
+ * Host numbers compare the two lookups; they do not predict absolute cost on the
+ * ESP32 (Xtensa has no ctz instruction, GCC uses `nsau` on `x & -x`).
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "msg.h"
+
+
+typedef int (*bench_send_f)(const msg_t* msg);
+
+typedef struct {
+  const char*   name;
+  uint32_t      type;
+  bench_send_f  send_fn;
+} bench_reg_t;
+
+static volatile uint32_t bench_calls = 0;
+
+static int __attribute__((noinline)) bench_Send(const msg_t* msg) {
+  (void) msg;
+  ++bench_calls;
+  return 0;
+}
+
+/* Every module bit of msg.h, in the init order of mgr_reg_order */
+static const bench_reg_t bench_list[] = {
+  { "eth",      REG_ETH_CTRL,     bench_Send },
+  { "wifi",     REG_WIFI_CTRL,    bench_Send },
+  { "gpio",     REG_GPIO_CTRL,    bench_Send },
+  { "power",    REG_POWER_CTRL,   bench_Send },
+  { "relay",    REG_RELAY_CTRL,   bench_Send },
+  { "lcd",      REG_LCD_CTRL,     bench_Send },
+  { "cfg",      REG_CFG_CTRL,     bench_Send },
+  { "sys",      REG_SYS_CTRL,     bench_Send },
+  { "sensor",   REG_SENSOR_CTRL,  bench_Send },
+  { "template", REG_XXX_CTRL,     bench_Send },
+  { "cli",      REG_CLI_CTRL,     bench_Send },
+  { "mqtt",     REG_MQTT_CTRL,    bench_Send },
+};
+
+#define BENCH_LIST_CNT    ((int) (sizeof(bench_list)/sizeof(bench_list[0])))
+
+static bench_reg_t bench_table[REG_BIT_MAX];
+static uint32_t bench_send_mask = 0;
+
+static double bench_Now(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+static inline int bench_PopBit(uint32_t* mask) {
+  int bit = __builtin_ctz(*mask);
+
+  *mask &= *mask - 1U;
+  return bit;
+}
+
+static uint32_t __attribute__((noinline)) bench_Linear(const msg_t* msg, uint32_t route) {
+  uint32_t skipped = 0;
+
+  for (int idx = 0; idx < BENCH_LIST_CNT; ++idx) {
+    if (route & bench_list[idx].type) {
+      if (bench_list[idx].send_fn) {
+        bench_list[idx].send_fn(msg);
+      }
+    } else if ((msg->to & bench_list[idx].type) && bench_list[idx].send_fn) {
+      ++skipped;
+    }
+  }
+  return skipped;
+}
+
+static uint32_t __attribute__((noinline)) bench_Bits(const msg_t* msg, uint32_t route) {
+  uint32_t skipped = msg->to & bench_send_mask & ~route;
+  uint32_t cnt = 0;
+
+  while (route != 0U) {
+    bench_table[bench_PopBit(&route)].send_fn(msg);
+  }
+  while (skipped != 0U) {
+    bench_PopBit(&skipped);
+    ++cnt;
+  }
+  return cnt;
+}
+
+static const bench_reg_t* __attribute__((noinline)) bench_FindLinear(uint32_t module_type) {
+  for (int idx = 0; idx < BENCH_LIST_CNT; ++idx) {
+    if (bench_list[idx].type & module_type) {
+      return &bench_list[idx];
+    }
+  }
+  return NULL;
+}
+
+static const bench_reg_t* __attribute__((noinline)) bench_FindBits(uint32_t module_type) {
+  return (module_type & bench_send_mask) ? &bench_table[__builtin_ctz(module_type)] : NULL;
+}
+
+typedef struct {
+  const char* name;
+  uint32_t    to;
+  uint32_t    route;
+} bench_case_t;
+
+int main(int argc, char** argv) {
+  long iterations = (argc > 1) ? atol(argv[1]) : 10000000L;
+  uint32_t all = 0;
+
+  for (int idx = 0; idx < BENCH_LIST_CNT; ++idx) {
+    int bit = __builtin_ctz(bench_list[idx].type);
+
+    bench_table[bit] = bench_list[idx];
+    bench_send_mask |= bench_list[idx].type;
+    all |= bench_list[idx].type;
+  }
+
+  const bench_case_t cases[] = {
+    { "broadcast, 3 subscribers",  (uint32_t) REG_ALL_CTRL, REG_LCD_CTRL | REG_SYS_CTRL | REG_MQTT_CTRL },
+    { "broadcast, all subscribed", (uint32_t) REG_ALL_CTRL, all },
+    { "unicast (relay)",           REG_RELAY_CTRL,          REG_RELAY_CTRL },
+    { "unicast (mqtt, last)",      REG_MQTT_CTRL,           REG_MQTT_CTRL },
+  };
+
+  printf("modules: %d, iterations: %ld\n\n", BENCH_LIST_CNT, iterations);
+  printf("| case | linear ns | bits ns | speed-up |\n");
+  printf("|------|----------:|--------:|---------:|\n");
+  for (size_t c = 0; c < sizeof(cases)/sizeof(cases[0]); ++c) {
+    msg_t msg = { .type = MSG_TYPE_MQTT_EVENT, .from = REG_MQTT_CTRL, .to = cases[c].to };
+    volatile uint32_t route = cases[c].route;
+    volatile uint32_t sink = 0;
+    double t0, t1, t2;
+
+    t0 = bench_Now();
+    for (long it = 0; it < iterations; ++it) {
+      sink += bench_Linear(&msg, route);
+    }
+    t1 = bench_Now();
+    for (long it = 0; it < iterations; ++it) {
+      sink += bench_Bits(&msg, route);
+    }
+    t2 = bench_Now();
+    printf("| %s | %.1f | %.1f | %.2fx |\n", cases[c].name,
+        (t1 - t0) / iterations, (t2 - t1) / iterations, (t1 - t0) / (t2 - t1));
+  }
+
+  {
+    volatile uint32_t module = REG_MQTT_CTRL;
+    volatile uintptr_t sink = 0;
+    double t0, t1, t2;
+
+    t0 = bench_Now();
+    for (long it = 0; it < iterations; ++it) {
+      sink += (uintptr_t) bench_FindLinear(module);
+    }
+    t1 = bench_Now();
+    for (long it = 0; it < iterations; ++it) {
+      sink += (uintptr_t) bench_FindBits(module);
+    }
+    t2 = bench_Now();
+    printf("| MGR_GetData lookup (mqtt) | %.1f | %.1f | %.2fx |\n",
+        (t1 - t0) / iterations, (t2 - t1) / iterations, (t1 - t0) / (t2 - t1));
+  }
+  printf("\nsend_fn calls: %lu\n", (unsigned long) bench_calls);
+  return 0;
+}
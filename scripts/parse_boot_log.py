@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+"""
+Parse idf_monitor / serial logs (or the output of the CLI `boot` command) for
+the boot timing report of main/boot_seq.c and print Markdown tables: the
+milestones since power-on and the per-module init/run times with the critical
+path. With --baseline, every value is compared against an older log, so a
+release can be checked against the previous one.
+
+Report lines are `[<section>][<name>] key=value ...`, e.g.:
+  I (t) ESP::BOOT: [mark][mqtt] t_ms=2310
+  I (t) ESP::BOOT: [init][total] modules=9 workers=2 begin_ms=352 end_ms=910 wall_ms=558 serial_ms=801 saved_ms=243
+  I (t) ESP::BOOT: [init][eth] ready_ms=352 start_ms=352 end_ms=701 took_ms=349 after=- worker=0 result=0
+  I (t) ESP::BOOT: [init][path] steps=eth>wifi>mqtt took_ms=540
+
+The phase lines are logged when each phase ends and the whole report once MQTT
+connects (or on `boot` in the CLI). A new block starts at every `[mark][app]`
+line (a full report) and at an `[init][total]` line which follows phase lines
+(the next boot); the last block is reported, so a log holding several boots or
+reports yields the most recent one.
+"""
+
+from __future__ import annotations
+
+import argparse
+import re
+import sys
+from typing import Dict, Iterable, List, Optional, TextIO
+
+
+ANSI_RE = re.compile(r"\x1b\[[0-9;]*m")
+BOOT_LINE_RE = re.compile(r"\[(mark|init|run)\]\[([\w-]+)\]((?:\s+\w+=\S+)+)")
+FIELD_RE = re.compile(r"(\w+)=(\S+)")
+
+MARK_ORDER = ["app", "nvs", "init", "run", "link", "ip", "mqtt", "publish"]
+PHASES = ["init", "run"]
+
+Fields = Dict[str, str]
+Boot = Dict[str, Dict[str, Fields]]
+
+
+def strip_ansi(s: str) -> str:
+    return ANSI_RE.sub("", s)
+
+
+def parse_boots(lines: Iterable[str]) -> List[Boot]:
+    boots: List[Boot] = []
+    for raw in lines:
+        m = BOOT_LINE_RE.search(strip_ansi(raw))
+        if not m:
+            continue
+        section, name = m.group(1), m.group(2)
+        if not boots or (boots[-1] and (
+                (section == "mark" and name == "app") or
+                (section == "init" and name == "total" and ("init" in boots[-1] or "run" in boots[-1])))):
+            boots.append({})
+        boots[-1].setdefault(section, {})[name] = dict(FIELD_RE.findall(m.group(3)))
+    return boots
+
+
+def read_lines(path: str) -> List[str]:
+    if path == "-":
+        fh: TextIO = sys.stdin
+        return fh.readlines()
+    with open(path, "r", encoding="utf-8", errors="replace") as fh:
+        return fh.readlines()
+
+
+def as_int(fields: Optional[Fields], key: str) -> Optional[int]:
+    if not fields or key not in fields:
+        return None
+    try:
+        value = int(fields[key])
+    except ValueError:
+        return None
+    return None if value < 0 and key == "t_ms" else value
+
+
+def fmt(value: Optional[int]) -> str:
+    return "-" if value is None else str(value)
+
+
+def fmt_delta(new: Optional[int], old: Optional[int]) -> str:
+    if new is None or old is None:
+        return "-"
+    return f"{new - old:+d}"
+
+
+def mark_names(*boots: Boot) -> List[str]:
+    names = list(MARK_ORDER)
+    for boot in boots:
+        names += [n for n in boot.get("mark", {}) if n not in names]
+    return names
+
+
+def module_names(phase: str, *boots: Boot) -> List[str]:
+    names: List[str] = []
+    for boot in boots:
+        names += [n for n in boot.get(phase, {}) if n not in ("total", "path") and n not in names]
+    return names
+
+
+def print_marks(boot: Boot) -> None:
+    marks = boot.get("mark", {})
+    if not marks:
+        print("No `[mark]` lines found.\n")
+        return
+    print("### Milestones (ms since boot)\n")
+    print("| Mark | t_ms | Δ from prev |")
+    print("|------|-----:|------------:|")
+    prev: Optional[int] = None
+    for name in mark_names(boot):
+        t = as_int(marks.get(name), "t_ms")
+        if name not in marks:
+            continue
+        print(f"| {name} | {fmt(t)} | {fmt_delta(t, prev)} |")
+        if t is not None:
+            prev = t
+    print()
+
+
+def print_phase(boot: Boot, phase: str) -> None:
+    lines = boot.get(phase, {})
+    if not lines:
+        print(f"No `[{phase}]` lines found.\n")
+        return
+    total = lines.get("total", {})
+    print(f"### {phase} phase\n")
+    if total:
+        print(
+            f"{total.get('modules', '?')} modules, {total.get('workers', '?')} workers: "
+            f"**{total.get('wall_ms', '?')} ms** (serial: {total.get('serial_ms', '?')} ms, "
+            f"saved: {total.get('saved_ms', '?')} ms), done at {total.get('end_ms', '?')} ms\n"
+        )
+    print("| Module | ready | start | end | took | after | worker | result |")
+    print("|--------|------:|------:|----:|-----:|-------|-------:|-------:|")
+    for name in module_names(phase, boot):
+        f = lines[name]
+        print(
+            f"| {name} | {f.get('ready_ms', '-')} | {f.get('start_ms', '-')} | {f.get('end_ms', '-')} | "
+            f"{f.get('took_ms', '-')} | {f.get('after', '-')} | {f.get('worker', '-')} | {f.get('result', '-')} |"
+        )
+    path = lines.get("path")
+    if path:
+        print(f"\nCritical path: `{path.get('steps', '-')}` ({path.get('took_ms', '?')} ms)")
+    print()
+
+
+def print_compare_marks(new: Boot, old: Boot) -> None:
+    print("### Milestones (ms since boot)\n")
+    print("| Mark | baseline | current | Δ |")
+    print("|------|---------:|--------:|--:|")
+    for name in mark_names(new, old):
+        if name not in new.get("mark", {}) and name not in old.get("mark", {}):
+            continue
+        t_old = as_int(old.get("mark", {}).get(name), "t_ms")
+        t_new = as_int(new.get("mark", {}).get(name), "t_ms")
+        print(f"| {name} | {fmt(t_old)} | {fmt(t_new)} | {fmt_delta(t_new, t_old)} |")
+    print()
+
+
+def print_compare_phase(new: Boot, old: Boot, phase: str) -> None:
+    lines_new = new.get(phase, {})
+    lines_old = old.get(phase, {})
+    if not lines_new and not lines_old:
+        return
+    print(f"### {phase} phase (ms)\n")
+    print("| Module | baseline | current | Δ |")
+    print("|--------|---------:|--------:|--:|")
+    for name in module_names(phase, new, old):
+        t_old = as_int(lines_old.get(name), "took_ms")
+        t_new = as_int(lines_new.get(name), "took_ms")
+        print(f"| {name} | {fmt(t_old)} | {fmt(t_new)} | {fmt_delta(t_new, t_old)} |")
+    for key in ("wall_ms", "serial_ms"):
+        t_old = as_int(lines_old.get("total"), key)
+        t_new = as_int(lines_new.get("total"), key)
+        print(f"| **{key}** | {fmt(t_old)} | {fmt(t_new)} | {fmt_delta(t_new, t_old)} |")
+    path_old = lines_old.get("path", {}).get("steps", "-")
+    path_new = lines_new.get("path", {}).get("steps", "-")
+    print(f"\nCritical path: `{path_old}` → `{path_new}`\n")
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(
+        description="Summarize the ESP::BOOT timing report (milestones, per-module init/run) from monitor logs.",
+    )
+    ap.add_argument(
+        "logfile",
+        nargs="?",
+        default="-",
+        help="Path to log file, or '-' for stdin (default: stdin)",
+    )
+    ap.add_argument(
+        "--baseline",
+        metavar="LOG",
+        help="Older log to compare against; prints baseline, current and delta columns",
+    )
+    args = ap.parse_args()
+
+    boots = parse_boots(read_lines(args.logfile))
+    if not boots:
+        print("No ESP::BOOT report lines found.", file=sys.stderr)
+        return 1
+    boot = boots[-1]
+
+    if args.baseline:
+        old_boots = parse_boots(read_lines(args.baseline))
+        if not old_boots:
+            print(f"No ESP::BOOT report lines found in {args.baseline}.", file=sys.stderr)
+            return 1
+        print_compare_marks(boot, old_boots[-1])
+        for phase in PHASES:
+            print_compare_phase(boot, old_boots[-1], phase)
+        return 0
+
+    print_marks(boot)
+    for phase in PHASES:
+        print_phase(boot, phase)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,243 @@
+#!/usr/bin/env python3
+"""
+Decode a binary bus trace dump captured from the console and print the records,
+the hop chain of every message and a latency summary per message type.
+
+The dump comes from the CLI command `bus trace bin [count]` (modules/cli_ctrl/cli_mgr.c):
+one `BTRC <hex>` line for the header (bus_trace_hdr_t) followed by one line per
+record (bus_trace_rec_t), all little endian, e.g.:
+  BTRC 4254524301001800030000001c2f0900
+  BTRC 102e0900a4c1fc3f000000000400000000000000130080c1
+
+Message type names are read from include/msg_schema.h (MSG_TYPE_SCHEMA) and
+module names from include/msg.h (REG_*_BIT), so the script follows the firmware
+without edits. Other log lines
+are ignored and ANSI color codes are stripped.
+"""
+
+from __future__ import annotations
+
+import argparse
+import os
+import re
+import struct
+import sys
+from collections import defaultdict
+from dataclasses import dataclass
+from typing import Dict, Iterable, List, Optional, TextIO, Tuple
+
+
+ANSI_RE = re.compile(r"\x1b\[[0-9;]*m")
+BTRC_LINE_RE = re.compile(r"BTRC\s+([0-9a-fA-F]+)\s*$")
+ENUM_RE = re.compile(r"typedef\s+enum\s*\{(.*?)\}\s*msg_type_e\s*;", re.S)
+SCHEMA_RE = re.compile(r"#define\s+MSG_TYPE_SCHEMA\(X\)((?:[^\n]*\\\n)*[^\n]*)")
+SCHEMA_ENTRY_RE = re.compile(r"\bX\(\s*(\w+)\s*,")
+REG_RE = re.compile(r"^\s*#define\s+REG_(\w+)_BIT\s+(\d+)\b", re.M)
+
+BUS_TRACE_MAGIC = 0x43525442
+HDR_FMT = "<IHHII"
+REC_FMT = "<IIIIIBBBB"
+
+HOPS = ["send", "drop", "mgr-recv", "mgr-done", "notify", "mod-recv", "mod-done", "direct"]
+# Hops which carry a latency, in pipeline order (bus_stage_e); a direct hop is a module parse
+STAGES = [("mgr-wait", (2,)), ("mgr-parse", (3,)), ("delivery", (5,)), ("mod-parse", (6, 7))]
+
+DEFAULT_MSG_H = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "include", "msg.h")
+
+
+@dataclass
+class TraceRec:
+    ts: int
+    id: int
+    src: int
+    dst: int
+    val: int
+    type: int
+    hop: int
+    core: int
+    seq: int
+
+
+def strip_ansi(s: str) -> str:
+    return ANSI_RE.sub("", s)
+
+
+def load_names(msg_h: str) -> Tuple[List[str], Dict[int, str]]:
+    """Message type names by value and module names by REG_*_BIT."""
+    types: List[str] = []
+    modules: Dict[int, str] = {}
+    try:
+        with open(msg_h, "r", encoding="utf-8", errors="replace") as fh:
+            text = fh.read()
+    except OSError:
+        return types, modules
+
+    m = ENUM_RE.search(text)
+    if m and "MSG_TYPE_SCHEMA" in m.group(1):
+        # Generated from the schema next to msg.h, one X(name, size) per type
+        try:
+            schema_h = os.path.join(os.path.dirname(msg_h), "msg_schema.h")
+            with open(schema_h, "r", encoding="utf-8", errors="replace") as fh:
+                sm = SCHEMA_RE.search(fh.read())
+        except OSError:
+            sm = None
+        if sm:
+            body = re.sub(r"/\*.*?\*/", "", sm.group(1), flags=re.S)
+            types.extend(SCHEMA_ENTRY_RE.findall(body))
+    elif m:
+        body = re.sub(r"/\*.*?\*/|//[^\n]*", "", m.group(1), flags=re.S)
+        for item in body.split(","):
+            name = item.strip()
+            if name:
+                types.append(name.replace("MSG_TYPE_", ""))
+    for name, bit in REG_RE.findall(text):
+        modules.setdefault(1 << int(bit), name.lower())
+    return types, modules
+
+
+def parse_dump(lines: Iterable[str]) -> Tuple[Optional[Tuple[int, ...]], List[TraceRec]]:
+    """Return the last header found and the records following it."""
+    hdr: Optional[Tuple[int, ...]] = None
+    recs: List[TraceRec] = []
+    rec_size = struct.calcsize(REC_FMT)
+    for raw in lines:
+        m = BTRC_LINE_RE.search(strip_ansi(raw))
+        if not m:
+            continue
+        data = bytes.fromhex(m.group(1))
+        if len(data) == struct.calcsize(HDR_FMT) and struct.unpack_from("<I", data)[0] == BUS_TRACE_MAGIC:
+            hdr = struct.unpack(HDR_FMT, data)
+            recs = []
+            if hdr[2] != rec_size:
+                print(f"Record size {hdr[2]} does not match decoder ({rec_size}).", file=sys.stderr)
+                hdr = None
+            continue
+        if hdr is not None and len(data) == rec_size:
+            recs.append(TraceRec(*struct.unpack(REC_FMT, data)))
+    return hdr, recs
+
+
+def type_name(types: List[str], t: int) -> str:
+    return types[t] if t < len(types) else str(t)
+
+
+def module_name(modules: Dict[int, str], mask: int) -> str:
+    if mask == 0xFFFFFFFF or mask == 0x7FFFFFFF:
+        return "all"
+    names = [name for bit, name in sorted(modules.items()) if mask & bit]
+    return "|".join(names) if names else f"0x{mask:08x}"
+
+
+def print_records(recs: List[TraceRec], types: List[str], modules: Dict[int, str]) -> None:
+    t0 = recs[0].ts
+    print("| t (us) | core | hop | type | from | to | id | val |")
+    print("|-------:|-----:|-----|------|------|----|----|----:|")
+    for r in recs:
+        hop = HOPS[r.hop] if r.hop < len(HOPS) else str(r.hop)
+        print(f"| {(r.ts - t0) & 0xFFFFFFFF} | {r.core} | {hop} | {type_name(types, r.type)} | "
+              f"{module_name(modules, r.src)} | {module_name(modules, r.dst)} | {r.id:08x} | {r.val} |")
+    print()
+
+
+def print_chains(recs: List[TraceRec], types: List[str], modules: Dict[int, str]) -> None:
+    """One line per pooled message: every hop with its value, in order."""
+    chains: Dict[int, List[TraceRec]] = defaultdict(list)
+    for r in recs:
+        if r.id != 0:
+            chains[r.id].append(r)
+    if not chains:
+        return
+    print("### Hop chains\n")
+    for rid, chain in chains.items():
+        # Pool slots are reused: split the chain when the manager takes a new message
+        parts: List[List[TraceRec]] = [[]]
+        for r in chain:
+            if r.hop == 2 and parts[-1]:
+                parts.append([])
+            parts[-1].append(r)
+        for part in parts:
+            steps = []
+            for r in part:
+                hop = HOPS[r.hop] if r.hop < len(HOPS) else str(r.hop)
+                who = f"@{module_name(modules, r.dst)}" if r.hop >= 4 else ""
+                steps.append(f"{hop}{who}={r.val}")
+            print(f"- `{rid:08x}` {type_name(types, part[0].type)}: " + " → ".join(steps))
+    print()
+
+
+def percentile(values: List[int], pct: int) -> int:
+    values = sorted(values)
+    idx = max(0, (len(values) * pct + 99) // 100 - 1)
+    return values[idx]
+
+
+def print_summary(recs: List[TraceRec], types: List[str]) -> None:
+    per_type: Dict[int, Dict[int, List[int]]] = defaultdict(lambda: defaultdict(list))
+    for r in recs:
+        per_type[r.type][r.hop].append(r.val)
+    print("### Latency per type (us, from the records in this dump)\n")
+    print("| type | stage | count | p50 | p99 | max |")
+    print("|------|-------|------:|----:|----:|----:|")
+    for t in sorted(per_type):
+        for stage, hops in STAGES:
+            vals = [v for hop in hops for v in per_type[t].get(hop, [])]
+            if not vals:
+                continue
+            print(f"| {type_name(types, t)} | {stage} | {len(vals)} | {percentile(vals, 50)} | "
+                  f"{percentile(vals, 99)} | {max(vals)} |")
+    drops = sum(1 for r in recs if r.hop == 1)
+    if drops:
+        print(f"\n_{drops} message(s) dropped by `MGR_Send()` in this dump._")
+    print()
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(
+        description="Decode `bus trace bin` output (BTRC lines) from monitor logs.",
+    )
+    ap.add_argument(
+        "logfile",
+        nargs="?",
+        default="-",
+        help="Path to log file, or '-' for stdin (default: stdin)",
+    )
+    ap.add_argument(
+        "--msg-h",
+        default=DEFAULT_MSG_H,
+        help="Path to include/msg.h for type and module names (msg_schema.h is read from the same directory)",
+    )
+    ap.add_argument(
+        "--no-records",
+        action="store_true",
+        help="Skip the raw record table",
+    )
+    args = ap.parse_args()
+
+    if args.logfile == "-":
+        fh: TextIO = sys.stdin
+        lines = fh.readlines()
+    else:
+        with open(args.logfile, "r", encoding="utf-8", errors="replace") as fh:
+            lines = fh.readlines()
+
+    hdr, recs = parse_dump(lines)
+    if hdr is None:
+        print("No BTRC header found (run `bus trace bin` on the console).", file=sys.stderr)
+        return 1
+    if len(recs) != hdr[3]:
+        print(f"Header announces {hdr[3]} records, found {len(recs)}.", file=sys.stderr)
+    if not recs:
+        print("Dump holds no records.", file=sys.stderr)
+        return 0
+
+    types, modules = load_names(args.msg_h)
+    print(f"## Bus trace (version {hdr[1]}, {len(recs)} records)\n")
+    if not args.no_records:
+        print_records(recs, types, modules)
+    print_chains(recs, types, modules)
+    print_summary(recs, types)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())